@@ -371,13 +371,13 @@ test_result_t map_test_unmap(const map_args_unmap_t *args,
 
 /*
  * Utility function to wait for all CPUs other than the caller to be
- * OFF.
+ * OFF, or parked with PARK_SECONDARY_CPUS.
  */
 void wait_for_non_lead_cpus(void);
 
 /*
  * Utility function to wait for a given CPU other than the caller to be
- * OFF.
+ * OFF, or parked with PARK_SECONDARY_CPUS.
  */
 void wait_for_core_to_turn_off(unsigned int mpidr);
 
@@ -30,6 +30,13 @@ int page_pool_init(uint64_t heap_base, uint64_t heap_len);
  */
 void *page_alloc(u_register_t bytes_size);
 
+/*
+ * Return the pointer to the allocated pages, aligned to 'align' bytes
+ * @bytes_size: pages to allocate in byte unit
+ * @align: alignment in bytes, a power of two
+ */
+void *page_alloc_aligned(u_register_t bytes_size, u_register_t align);
+
 /*
  * Reset heap memory usage cursor to heap base address
  */
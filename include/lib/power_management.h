@@ -10,6 +10,7 @@
 #include <platform_def.h>
 #include <psci.h>
 #include <spinlock.h>
+#include <stdbool.h>
 #include <stdint.h>
 
 /* Set of states of an affinity node as seen by the Test Framework */
@@ -17,6 +18,7 @@ typedef enum {
 	TFTF_AFFINITY_STATE_OFF = 0,
 	TFTF_AFFINITY_STATE_ON_PENDING,
 	TFTF_AFFINITY_STATE_ON,
+	TFTF_AFFINITY_STATE_PARKED,
 } tftf_affinity_info_t;
 
 /* Structure for keeping track of CPU state */
@@ -37,6 +39,23 @@ typedef struct suspend_info {
 	unsigned int save_system_context;
 } suspend_info_t;
 
+/* Set of CPUs, indexed by core position */
+typedef struct {
+	uint64_t bits[(PLATFORM_CORE_COUNT + 63) / 64];
+} tftf_cpu_mask_t;
+
+static inline void tftf_cpu_mask_set(tftf_cpu_mask_t *mask,
+				     unsigned int core_pos)
+{
+	mask->bits[core_pos / 64U] |= 1ULL << (core_pos % 64U);
+}
+
+static inline bool tftf_cpu_mask_test(const tftf_cpu_mask_t *mask,
+				      unsigned int core_pos)
+{
+	return (mask->bits[core_pos / 64U] & (1ULL << (core_pos % 64U))) != 0U;
+}
+
 /*
  * Power up a core.
  * This uses the PSCI CPU_ON API, which means it relies on the EL3 firmware's
@@ -76,6 +95,32 @@ int32_t tftf_try_cpu_on(u_register_t target_cpu,
 		    uintptr_t entrypoint,
 		    u_register_t context_id);
 
+/*
+ * Power up all the cores of 'mask' but the calling one, or all the cores but
+ * the calling one if 'mask' is NULL.
+ * The CPU_ON calls are issued back to back, then this waits for all the cores
+ * powered up to be online, i.e. about to jump to 'entrypoint'. It must not run
+ * concurrently with other calls powering cores up.
+ *
+ * With PARK_SECONDARY_CPUS, the cores park in WFE when they return from
+ * 'entrypoint' instead of powering off, and the next call to tftf_cpu_on() or
+ * tftf_cpu_on_all() for them, possibly in a later test, wakes them up without
+ * a CPU_ON. Parked cores are on as far as PSCI is concerned, so this is only
+ * suitable for tests that do not expect the other cores to be off.
+ *
+ *    Return: PSCI_E_SUCCESS, or the return code of the first CPU_ON call that
+ *            failed
+ */
+int32_t tftf_cpu_on_all(uintptr_t entrypoint, const tftf_cpu_mask_t *mask);
+
+/*
+ * Power up the core 'target_cpu' with tftf_cpu_on_all(), for tests that bring
+ * the cores up one at a time but let them park like tftf_cpu_on_all() does.
+ *
+ *    Return: Same as tftf_cpu_on_all()
+ */
+int32_t tftf_cpu_on_parkable(u_register_t target_cpu, uintptr_t entrypoint);
+
 /*
  * Power down the calling core.
  * This uses the PSCI CPU_OFF API, which means it relies on the EL3 firmware's
@@ -153,6 +198,28 @@ unsigned int tftf_is_cpu_online(unsigned int mpid);
 
 unsigned int tftf_is_core_pos_online(unsigned int core_pos);
 
+/*
+ * Query whether a core is parked in WFE by the framework, which only happens
+ * with PARK_SECONDARY_CPUS (see tftf_cpu_on_all()).
+ *   Return: 1 if the core is parked, 0 otherwise.
+ */
+unsigned int tftf_is_cpu_parked(unsigned int mpid);
+
+/*
+ * Called by the framework when the calling core returns from its test
+ * function. If it was powered up by tftf_cpu_on_all() with
+ * PARK_SECONDARY_CPUS, park it until it is given a new test function and
+ * return 1 once its state is reset as after a warm boot. Otherwise, return 0
+ * right away and let the caller power it off.
+ */
+unsigned int tftf_park_cpu(void);
+
+/*
+ * Return the system counter value read by a core as it last entered
+ * tftf_warm_boot_main() after a CPU_ON, or 0 if it never did.
+ */
+uint64_t tftf_get_warm_boot_ts(unsigned int core_pos);
+
 /* TFTF Suspend helpers */
 static inline int tftf_cpu_suspend(unsigned int pwr_state)
 {
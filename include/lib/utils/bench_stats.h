@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef BENCH_STATS_H
+#define BENCH_STATS_H
+
+#include <stdint.h>
+
+/*
+ * Summary of a series of latency samples, all in system counter ticks.
+ * Percentiles are computed with the nearest-rank method.
+ */
+struct bench_stats {
+	unsigned int count;
+	uint64_t min;
+	uint64_t max;
+	uint64_t avg;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+};
+
+/*
+ * Compute the statistics of 'count' samples. The samples are sorted in place.
+ */
+void bench_stats_compute(uint64_t *samples, unsigned int count,
+			 struct bench_stats *stats);
+
+/*
+ * Convert a number of system counter ticks to nanoseconds.
+ */
+uint64_t bench_ticks_to_ns(uint64_t ticks);
+
+/*
+ * Rate of 'ops' operations taking 'ticks' system counter ticks in total, in
+ * operations per second. Returns 0 if 'ticks' is 0.
+ */
+uint64_t bench_ops_per_sec(uint64_t ops, uint64_t ticks);
+
+/*
+ * Print the statistics in nanoseconds on the console, on one line starting
+ * with 'name'. Tables of them do not fit in the output of a test case.
+ */
+void bench_stats_print(const char *name, const struct bench_stats *stats);
+
+#endif /* BENCH_STATS_H */
@@ -11,7 +11,7 @@
  * Pairs a command id with a function call, to handle the command ID.
  */
 struct cactus_cmd_handler {
-	const uint64_t id;
+	uint64_t id;
 	struct ffa_value (*fn)(const struct ffa_value *args,
 			       struct mailbox_buffers *mb);
 };
@@ -40,5 +40,12 @@ struct cactus_cmd_handler {
 	};								\
 	CACTUS_HANDLER_FN(name)
 
+/**
+ * Sort the command table by command ID, such that 'cactus_handle_cmd' can
+ * look up handlers with a binary search. Must be called once, before any
+ * command is handled.
+ */
+void cactus_cmd_handlers_init(void);
+
 bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 		       struct mailbox_buffers *mb);
@@ -125,6 +125,46 @@ static inline uint64_t cactus_echo_get_val(struct ffa_value ret)
 	return (uint64_t)ret.arg4;
 }
 
+/**
+ * Send the echo command using the SMC32 convention. The response is also an
+ * SMC32 direct message response, such that the echoed value is 32-bit.
+ */
+static inline struct ffa_value cactus_echo32_send_cmd(
+	ffa_id_t source, ffa_id_t dest, uint32_t echo_val)
+{
+	return ffa_msg_send_direct_req32(source, dest, CACTUS_ECHO_CMD,
+					 echo_val, 0, 0, 0);
+}
+
+/**
+ * With this test command the sender transmits 32 bytes of data in the
+ * registers of a direct message request. The SP replies with the checksum of
+ * the data, as computed by 'ffa_msg_checksum'.
+ *
+ * The id is the hex representation of the string 'data'.
+ */
+#define CACTUS_DATA_CMD U(0x64617461)
+
+static inline struct ffa_value cactus_data_send_cmd(
+	ffa_id_t source, ffa_id_t dest, const uint64_t data[4])
+{
+	return cactus_send_cmd(source, dest, CACTUS_DATA_CMD, data[0], data[1],
+			       data[2], data[3]);
+}
+
+static inline void cactus_data_get(struct ffa_value ret, uint64_t data[4])
+{
+	data[0] = ret.arg4;
+	data[1] = ret.arg5;
+	data[2] = ret.arg6;
+	data[3] = ret.arg7;
+}
+
+static inline uint32_t cactus_data_get_checksum(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg4;
+}
+
 /**
  * Command to request a cactus secure partition to send an echo command to
  * another partition.
@@ -224,6 +264,47 @@ static inline uint16_t cactus_mem_send_words_to_write(struct ffa_value ret)
 	return (uint16_t)ret.arg7;
 }
 
+/**
+ * Response to CACTUS_MEM_SEND_CMD, also reporting the time the retrieve and
+ * the relinquish of the memory region took, in system counter ticks.
+ */
+static inline struct ffa_value cactus_mem_send_success_resp(
+	ffa_id_t source, ffa_id_t dest, uint64_t value,
+	uint64_t retrieve_ticks, uint64_t relinquish_ticks)
+{
+	return cactus_send_response(source, dest, CACTUS_SUCCESS, value,
+				    retrieve_ticks, relinquish_ticks, 0);
+}
+
+static inline uint64_t cactus_mem_send_get_retrieve_ticks(struct ffa_value ret)
+{
+	return (uint64_t)ret.arg5;
+}
+
+static inline uint64_t cactus_mem_send_get_relinquish_ticks(
+	struct ffa_value ret)
+{
+	return (uint64_t)ret.arg6;
+}
+
+/**
+ * Command to request cactus to retrieve a memory region, and to relinquish it
+ * unless it was donated, without accessing it. The response is the same as
+ * for CACTUS_MEM_SEND_CMD, such that the time taken by each operation can be
+ * read with the same helpers.
+ *
+ * The command id is the hex representation of the string "memtime".
+ */
+#define CACTUS_MEM_RETRIEVE_TIMED_CMD U(0x6d656d74696d65)
+
+static inline struct ffa_value cactus_mem_retrieve_timed_cmd(
+	ffa_id_t source, ffa_id_t dest, uint32_t mem_func,
+	ffa_memory_handle_t handle)
+{
+	return cactus_send_cmd(source, dest, CACTUS_MEM_RETRIEVE_TIMED_CMD,
+			       mem_func, handle, 0, 0);
+}
+
 /**
  * Command to request a memory management operation. The 'mem_func' argument
  * identifies the operation that is to be performend, and 'receiver' is the id
@@ -256,6 +337,45 @@ static inline bool cactus_req_mem_send_get_non_secure(struct ffa_value ret)
 	return (bool)ret.arg6;
 }
 
+/**
+ * Response to CACTUS_REQ_MEM_SEND_CMD, reporting the time taken by each phase
+ * of the memory management operation, in system counter ticks. The retrieve
+ * and relinquish are timed by the receiver. The relinquish and reclaim are
+ * not done for a memory donate.
+ */
+static inline struct ffa_value cactus_req_mem_send_success_resp(
+	ffa_id_t source, ffa_id_t dest, uint64_t send_ticks,
+	uint64_t retrieve_ticks, uint64_t relinquish_ticks,
+	uint64_t reclaim_ticks)
+{
+	return cactus_send_response(source, dest, CACTUS_SUCCESS, send_ticks,
+				    retrieve_ticks, relinquish_ticks,
+				    reclaim_ticks);
+}
+
+static inline uint64_t cactus_req_mem_send_get_send_ticks(struct ffa_value ret)
+{
+	return (uint64_t)ret.arg4;
+}
+
+static inline uint64_t cactus_req_mem_send_get_retrieve_ticks(
+	struct ffa_value ret)
+{
+	return (uint64_t)ret.arg5;
+}
+
+static inline uint64_t cactus_req_mem_send_get_relinquish_ticks(
+	struct ffa_value ret)
+{
+	return (uint64_t)ret.arg6;
+}
+
+static inline uint64_t cactus_req_mem_send_get_reclaim_ticks(
+	struct ffa_value ret)
+{
+	return (uint64_t)ret.arg7;
+}
+
 /**
  * Request to fill SIMD vectors with dummy values with purpose to check a
  * save/restore routine during the context switches between secure world and
@@ -400,6 +520,101 @@ static inline struct ffa_value cactus_send_dma_cmd(
 			       0);
 }
 
+/**
+ * Request to time a DMA transaction by the SMMUv3 test engine, upstream of an
+ * SMMUv3 IP. The 'size' bytes of the scratch memory are split evenly between
+ * 'frames' engine frames, which are started together and run the engine
+ * command selected by 'mode'. Each frame accesses its range with 'stride',
+ * which is 1 for contiguous accesses or a multiple of 8. All frames use the
+ * given stream ID, and substream ID unless it is CACTUS_DMA_NO_SUBSTREAMID.
+ *
+ * The command id is the hex representation of the string "SMMUtime".
+ */
+#define CACTUS_DMA_SMMUv3_BENCH_CMD	U(0x534d4d5574696d65)
+
+#define CACTUS_DMA_NO_SUBSTREAMID	U(0xFFFFFFFF)
+
+enum cactus_dma_bench_mode {
+	/* Read the source range and write it to the target range. */
+	CACTUS_DMA_BENCH_MEMCPY = 0,
+	/* Write random data to the target range. */
+	CACTUS_DMA_BENCH_RAND48,
+	/* Read and sum the source range. */
+	CACTUS_DMA_BENCH_SUM64,
+};
+
+static inline struct ffa_value cactus_send_dma_bench_cmd(
+	ffa_id_t source, ffa_id_t dest, uint32_t size, uint32_t stride,
+	uint32_t frames, enum cactus_dma_bench_mode mode, uint32_t stream_id,
+	uint32_t substream_id)
+{
+	return cactus_send_cmd(source, dest, CACTUS_DMA_SMMUv3_BENCH_CMD,
+			       size, ((uint64_t)frames << 32) | stride,
+			       (uint64_t)mode,
+			       ((uint64_t)substream_id << 32) | stream_id);
+}
+
+static inline uint32_t cactus_dma_bench_get_size(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg4;
+}
+
+static inline uint32_t cactus_dma_bench_get_stride(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg5;
+}
+
+static inline uint32_t cactus_dma_bench_get_frames(struct ffa_value ret)
+{
+	return (uint32_t)(ret.arg5 >> 32);
+}
+
+static inline enum cactus_dma_bench_mode cactus_dma_bench_get_mode(
+	struct ffa_value ret)
+{
+	return (enum cactus_dma_bench_mode)ret.arg6;
+}
+
+static inline uint32_t cactus_dma_bench_get_stream_id(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg7;
+}
+
+static inline uint32_t cactus_dma_bench_get_substream_id(struct ffa_value ret)
+{
+	return (uint32_t)(ret.arg7 >> 32);
+}
+
+/**
+ * Response to CACTUS_DMA_SMMUv3_BENCH_CMD, with the time from starting the
+ * first frame to the completion of the last one, and the sum and maximum of
+ * the completion latency of each frame, in system counter ticks.
+ */
+static inline struct ffa_value cactus_dma_bench_resp(
+	ffa_id_t source, ffa_id_t dest, uint64_t total_ticks,
+	uint64_t latency_sum_ticks, uint64_t latency_max_ticks)
+{
+	return cactus_send_response(source, dest, CACTUS_SUCCESS, total_ticks,
+				    latency_sum_ticks, latency_max_ticks, 0);
+}
+
+static inline uint64_t cactus_dma_bench_get_total_ticks(struct ffa_value ret)
+{
+	return ret.arg4;
+}
+
+static inline uint64_t cactus_dma_bench_get_latency_sum_ticks(
+	struct ffa_value ret)
+{
+	return ret.arg5;
+}
+
+static inline uint64_t cactus_dma_bench_get_latency_max_ticks(
+	struct ffa_value ret)
+{
+	return ret.arg6;
+}
+
 /*
  * Request SP to bind a notification to a FF-A endpoint. In case of error
  * when using the FFA_NOTIFICATION_BIND interface, include the error code
@@ -623,4 +838,92 @@ static inline uint32_t cactus_get_espi_id(struct ffa_value ret)
 	return (uint32_t)ret.arg4;
 }
 
+/**
+ * Request SP to read the batch of indirect messages in its RX buffer, sent by
+ * the requester with FFA_MSG_SEND2, and to release the buffer. The response
+ * holds the number of messages, the number of bytes and the sum of the
+ * checksums of the messages.
+ *
+ * The command id is the hex representation of the string "indmsg".
+ */
+#define CACTUS_INDIRECT_MSG_RECV_CMD U(0x696e646d7367)
+
+static inline struct ffa_value cactus_indirect_msg_recv_send_cmd(
+	ffa_id_t source, ffa_id_t dest)
+{
+	return cactus_send_cmd(source, dest, CACTUS_INDIRECT_MSG_RECV_CMD, 0,
+			       0, 0, 0);
+}
+
+static inline struct ffa_value cactus_indirect_msg_recv_resp(
+	ffa_id_t source, ffa_id_t dest, uint32_t count, uint32_t bytes,
+	uint32_t checksum)
+{
+	return cactus_send_response(source, dest, CACTUS_SUCCESS, count, bytes,
+				    checksum, 0);
+}
+
+static inline uint32_t cactus_indirect_msg_get_count(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg4;
+}
+
+static inline uint32_t cactus_indirect_msg_get_bytes(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg5;
+}
+
+static inline uint32_t cactus_indirect_msg_get_checksum(struct ffa_value ret)
+{
+	return (uint32_t)ret.arg6;
+}
+
+/**
+ * Request SP to return the time spent dispatching commands on the current
+ * core, since boot or since the last reset. The response holds the number of
+ * commands handled, the total time spent looking up their handlers and the
+ * total time spent running the handlers, in system counter ticks. Requests
+ * of this command are not accounted.
+ *
+ * The command id is the hex representation of the string "dispatch".
+ */
+#define CACTUS_DISPATCH_STATS_CMD U(0x6469737061746368)
+
+static inline struct ffa_value cactus_dispatch_stats_send_cmd(
+	ffa_id_t source, ffa_id_t dest, bool reset)
+{
+	return cactus_send_cmd(source, dest, CACTUS_DISPATCH_STATS_CMD,
+			       reset ? 1U : 0U, 0, 0, 0);
+}
+
+static inline bool cactus_dispatch_stats_get_reset(struct ffa_value ret)
+{
+	return ret.arg4 != 0U;
+}
+
+static inline struct ffa_value cactus_dispatch_stats_resp(
+	ffa_id_t source, ffa_id_t dest, uint64_t count, uint64_t lookup_ticks,
+	uint64_t handler_ticks)
+{
+	return cactus_send_response(source, dest, CACTUS_SUCCESS, count,
+				    lookup_ticks, handler_ticks, 0);
+}
+
+static inline uint64_t cactus_dispatch_stats_get_count(struct ffa_value ret)
+{
+	return ret.arg4;
+}
+
+static inline uint64_t cactus_dispatch_stats_get_lookup_ticks(
+	struct ffa_value ret)
+{
+	return ret.arg5;
+}
+
+static inline uint64_t cactus_dispatch_stats_get_handler_ticks(
+	struct ffa_value ret)
+{
+	return ret.arg6;
+}
+
 #endif
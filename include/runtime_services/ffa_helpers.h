@@ -147,6 +147,46 @@ struct ffa_boot_info_header {
 /** Partition property: partition runs in the AArch64 execution state. */
 #define FFA_PARTITION_AARCH64_EXEC (UINT32_C(1) << 8)
 
+/**
+ * Partition message header, at the start of the RX/TX buffer for indirect
+ * messages, as defined in FF-A v1.1 EAC0 Table 4.1.
+ */
+struct ffa_partition_rxtx_header {
+	uint32_t flags; /* MBZ */
+	uint32_t reserved;
+	/* Offset from the beginning of the buffer to the message payload. */
+	uint32_t offset;
+	/* Sender ID in bits[31:16] and receiver ID in bits[15:0]. */
+	uint32_t sender_receiver;
+	/* Size of the message payload, in bytes. */
+	uint32_t size;
+};
+
+#define FFA_RXTX_HEADER_SIZE	sizeof(struct ffa_partition_rxtx_header)
+
+static inline void ffa_rxtx_header_init(
+	struct ffa_partition_rxtx_header *header, ffa_id_t sender,
+	ffa_id_t receiver, uint32_t size)
+{
+	header->flags = 0U;
+	header->reserved = 0U;
+	header->offset = FFA_RXTX_HEADER_SIZE;
+	header->sender_receiver = ((uint32_t)sender << 16) | receiver;
+	header->size = size;
+}
+
+static inline ffa_id_t ffa_rxtx_header_sender(
+	const struct ffa_partition_rxtx_header *header)
+{
+	return (ffa_id_t)(header->sender_receiver >> 16);
+}
+
+static inline ffa_id_t ffa_rxtx_header_receiver(
+	const struct ffa_partition_rxtx_header *header)
+{
+	return (ffa_id_t)(header->sender_receiver & U(0xFFFF));
+}
+
 /** Partition info descriptor as defined in FF-A v1.1 EAC0 Table 13.37 */
 struct ffa_partition_info {
 	/** The ID of the VM the information is about */
@@ -656,6 +696,15 @@ static inline ffa_memory_handle_t ffa_mem_success_handle(struct ffa_value r)
 	return ffa_assemble_handle(r.arg2, r.arg3);
 }
 
+/*
+ * Handle of the memory transaction a FFA_MEM_FRAG_RX or FFA_MEM_FRAG_TX
+ * refers to.
+ */
+static inline ffa_memory_handle_t ffa_frag_handle(struct ffa_value r)
+{
+	return ffa_assemble_handle(r.arg1, r.arg2);
+}
+
 /**
  * Gets the `ffa_composite_memory_region` for the given receiver from an
  * `ffa_memory_region`, or NULL if it is not valid.
@@ -706,6 +755,12 @@ uint32_t ffa_memory_region_init(
 	enum ffa_memory_shareability shareability, uint32_t *total_length,
 	uint32_t *fragment_length);
 
+uint32_t ffa_memory_fragment_init(
+	struct ffa_memory_region_constituent *fragment,
+	size_t fragment_max_size,
+	const struct ffa_memory_region_constituent constituents[],
+	uint32_t constituent_count, uint32_t *fragment_length);
+
 static inline ffa_id_t ffa_dir_msg_dest(struct ffa_value val) {
 	return (ffa_id_t)val.arg1 & U(0xFFFF);
 }
@@ -734,6 +789,8 @@ struct ffa_value ffa_msg_send_direct_resp32(ffa_id_t source_id,
 					    uint32_t arg1, uint32_t arg2,
 					    uint32_t arg3, uint32_t arg4);
 
+struct ffa_value ffa_msg_send2(uint32_t flags);
+
 struct ffa_value ffa_run(uint32_t dest_id, uint32_t vcpu_id);
 struct ffa_value ffa_version(uint32_t input_version);
 struct ffa_value ffa_id_get(void);
@@ -757,6 +814,10 @@ struct ffa_value ffa_mem_retrieve_req(uint32_t descriptor_length,
 				      uint32_t fragment_length);
 struct ffa_value ffa_mem_relinquish(void);
 struct ffa_value ffa_mem_reclaim(uint64_t handle, uint32_t flags);
+struct ffa_value ffa_mem_frag_rx(ffa_memory_handle_t handle,
+				 uint32_t fragment_offset);
+struct ffa_value ffa_mem_frag_tx(ffa_memory_handle_t handle,
+				 uint32_t fragment_length);
 struct ffa_value ffa_notification_bitmap_create(ffa_id_t vm_id,
 						ffa_vcpu_count_t vcpu_count);
 struct ffa_value ffa_notification_bitmap_destroy(ffa_id_t vm_id);
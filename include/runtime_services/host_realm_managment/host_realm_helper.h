@@ -10,21 +10,43 @@
 #include <host_realm_rmi.h>
 #include <tftf_lib.h>
 
-bool host_create_realm_payload(u_register_t realm_payload_adr,
+/* How the realm image is mapped by host_create_realm_payload_sized() */
+enum host_realm_loader {
+	/* Page by page, from the calling core */
+	HOST_REALM_LOAD_PAGES,
+	/* Folded into 2MB blocks where aligned, from the calling core */
+	HOST_REALM_LOAD_BLOCKS,
+	/* Folded into 2MB blocks, populated from all online cores */
+	HOST_REALM_LOAD_BLOCKS_ALL_CORES,
+};
+
+bool host_create_realm_payload(struct realm *realm_ptr,
+		u_register_t realm_payload_adr,
 		u_register_t plat_mem_pool_adr,
 		u_register_t plat_mem_pool_size,
 		u_register_t realm_pages_size,
 		u_register_t feature_flag,
 		const u_register_t *rec_flag,
 		unsigned int rec_count);
-bool host_create_shared_mem(
+bool host_create_realm_payload_sized(struct realm *realm_ptr,
+		u_register_t realm_payload_adr,
+		u_register_t plat_mem_pool_adr,
+		u_register_t plat_mem_pool_size,
+		u_register_t realm_pages_size,
+		u_register_t feature_flag,
+		const u_register_t *rec_flag,
+		unsigned int rec_count,
+		u_register_t par_size,
+		enum host_realm_loader loader);
+bool host_create_shared_mem(struct realm *realm_ptr,
 		u_register_t ns_shared_mem_adr,
 		u_register_t ns_shared_mem_size);
-bool host_destroy_realm(void);
-void host_rec_send_sgi(unsigned int sgi, unsigned int rec_num);
-bool host_enter_realm_execute(uint8_t cmd, struct realm **realm_ptr,
+bool host_destroy_realm(struct realm *realm_ptr);
+void host_rec_send_sgi(struct realm *realm_ptr, unsigned int sgi,
+		unsigned int rec_num);
+bool host_enter_realm_execute(struct realm *realm_ptr, uint8_t cmd,
 		int test_exit_reason, unsigned int rec_num);
 test_result_t host_cmp_result(void);
-void realm_print_handler(unsigned int rec_num);
+void realm_print_handler(struct realm *realm_ptr, unsigned int rec_num);
 
 #endif /* HOST_REALM_HELPER_H */
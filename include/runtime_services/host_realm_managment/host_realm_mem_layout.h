@@ -46,11 +46,17 @@
 #ifdef ENABLE_REALM_PAYLOAD_TESTS
  /* 1MB for shared buffer between Realm and Host */
  #define NS_REALM_SHARED_MEM_SIZE	U(0x100000)
- /* 3MB of memory used as a pool for realm's objects creation */
- #define PAGE_POOL_MAX_SIZE		U(0x300000)
+ /*
+  * 12MB of memory used as a pool for realm's objects creation, enough for
+  * a realm image of up to 8MB mapped with 2MB blocks
+  */
+ #define PAGE_POOL_MAX_SIZE		U(0xC00000)
 #else
  #define NS_REALM_SHARED_MEM_SIZE       U(0x0)
  #define PAGE_POOL_MAX_SIZE             U(0x0)
 #endif
 
+/* Share of the shared region of each realm, when several exist at once */
+#define NS_REALM_SHARED_MEM_SLICE	(NS_REALM_SHARED_MEM_SIZE / MAX_REALM_COUNT)
+
 #endif /* HOST_REALM_MEM_LAYOUT_H */
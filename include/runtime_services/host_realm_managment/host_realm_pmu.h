@@ -23,6 +23,29 @@
 #define GET_CNT_NUM	\
 	((read_pmcr_el0() >> PMCR_EL0_N_SHIFT) & PMCR_EL0_N_MASK)
 
+/* Kernels the realm runs on REALM_PMU_BENCH */
+enum realm_pmu_bench_kernel {
+	REALM_PMU_BENCH_RSI_VERSION = 0U,
+	REALM_PMU_BENCH_STREAM_PROTECTED,
+	REALM_PMU_BENCH_STREAM_UNPROTECTED,
+	REALM_PMU_BENCH_SVE,
+};
+
+/* Index in realm_out_val of each result of REALM_PMU_BENCH */
+enum realm_pmu_bench_result {
+	REALM_PMU_BENCH_CYCLES = 0U,
+	REALM_PMU_BENCH_INSTS,
+	REALM_PMU_BENCH_L1D_REFILLS,
+	REALM_PMU_BENCH_TLB_REFILLS,
+	REALM_PMU_BENCH_TICKS,
+};
+
+/* Largest number of bytes the streaming kernels read on each iteration */
+#define REALM_PMU_BENCH_STREAM_MAX	U(0x10000)
+
+/* Result of an event the realm had no event counter left for */
+#define REALM_PMU_BENCH_NOT_COUNTED	(~0UL)
+
 void host_set_pmu_state(void);
 bool host_check_pmu_state(void);
 
@@ -252,6 +252,10 @@
 #define RMI_EXIT_SERROR			6U
 #define RMI_EXIT_INVALID		0xFFFFFU
 
+/* RmiRecEnterFlags */
+#define REC_ENTRY_FLAG_TRAP_WFI		(UL(1) << 2)
+#define REC_ENTRY_FLAG_TRAP_WFE		(UL(1) << 3)
+
 /* RmiRecRunnable types */
 #define RMI_NOT_RUNNABLE		0U
 #define RMI_RUNNABLE			1U
@@ -350,6 +354,10 @@ typedef enum {
 #define PAGE_SHIFT			FOUR_KB_SHIFT
 #define RTT_LEVEL_SHIFT(l)		XLAT_ADDR_SHIFT(l)
 #define RTT_L2_BLOCK_SIZE		(1UL << RTT_LEVEL_SHIFT(2U))
+#define RTT_ENTRIES			(PAGE_SIZE / sizeof(uint64_t))
+
+/* RTTs below the starting level the host keeps a shadow of, per realm */
+#define REALM_MAX_SHADOW_RTTS		U(64)
 
 #define REC_CREATE_NR_GPRS		8U
 #define REC_HVC_NR_GPRS			7U
@@ -495,6 +503,19 @@ struct rtt_entry {
 	u_register_t ripas;
 };
 
+/*
+ * Host copy of an RTT created for a realm, below the starting level. Bit 'i'
+ * of 'assigned' is set when entry 'i' maps protected data or NS memory at the
+ * level of the RTT. Entries which point to a lower level RTT are described by
+ * the shadow of that RTT.
+ */
+struct realm_shadow_rtt {
+	u_register_t ipa;
+	u_register_t pa;
+	u_register_t level;
+	uint64_t assigned[RTT_ENTRIES / 64U];
+};
+
 enum realm_state {
 	REALM_STATE_NULL,
 	REALM_STATE_NEW,
@@ -523,12 +544,41 @@ struct realm {
 	uint8_t      num_wps;
 	uint8_t      pmu_num_ctrs;
 	enum realm_state state;
+	/* NS buffer of host_shared_data_t, one per REC */
+	u_register_t host_shared_data;
+	bool payload_created;
+	bool shared_mem_created;
+	/*
+	 * RTTs mapped by the host, such that teardown only visits populated
+	 * entries. Teardown walks the RTTs with RMI_RTT_READ_ENTRY instead
+	 * when the shadow is not valid.
+	 */
+	struct realm_shadow_rtt shadow_rtt[REALM_MAX_SHADOW_RTTS];
+	unsigned int shadow_rtt_count;
+	bool shadow_rtt_valid;
+};
+
+/*
+ * Statistics of the RMI calls made with one function ID, when the host is
+ * built with HOST_RMI_STATS. Times are in system counter ticks, and a call
+ * is counted as an error when its status is not RMI_SUCCESS.
+ */
+struct host_rmi_stats {
+	uint64_t count;
+	uint64_t errors;
+	uint64_t total_ticks;
+	uint64_t max_ticks;
 };
 
 /* RMI/SMC */
 u_register_t host_rmi_version(u_register_t req_ver);
 u_register_t host_rmi_granule_delegate(u_register_t addr);
 u_register_t host_rmi_granule_undelegate(u_register_t addr);
+u_register_t host_rmi_granule_delegate_range(u_register_t addr,
+					     u_register_t size);
+u_register_t host_rmi_granule_undelegate_range(u_register_t addr,
+					       u_register_t size);
+bool host_granule_is_delegated(u_register_t addr);
 u_register_t host_rmi_realm_create(u_register_t rd, u_register_t params_ptr);
 u_register_t host_rmi_realm_destroy(u_register_t rd);
 u_register_t host_rmi_features(u_register_t index, u_register_t *features);
@@ -537,6 +587,9 @@ u_register_t host_rmi_features(u_register_t index, u_register_t *features);
 u_register_t host_realm_create(struct realm *realm);
 u_register_t host_realm_map_payload_image(struct realm *realm,
 					  u_register_t realm_payload_adr);
+u_register_t host_realm_map_payload_image_blocks(struct realm *realm,
+						 u_register_t realm_payload_adr,
+						 bool all_cores);
 u_register_t host_realm_map_ns_shared(struct realm *realm,
 					u_register_t ns_shared_mem_adr,
 					u_register_t ns_shared_mem_size);
@@ -554,5 +607,17 @@ u_register_t host_rmi_psci_complete(u_register_t calling_rec, u_register_t targe
 		unsigned long status);
 void host_rmi_init_cmp_result(void);
 bool host_rmi_get_cmp_result(void);
+unsigned int host_rmi_regs_check_set(unsigned int rate);
+unsigned int host_rmi_regs_check_fid(u_register_t fid);
+
+/* Pool of granules delegated once, that realm objects are taken from */
+u_register_t host_realm_delegated_pool_init(u_register_t base,
+					    u_register_t size);
+u_register_t host_realm_delegated_pool_destroy(void);
+
+/* RMI call statistics */
+void host_rmi_stats_reset(void);
+bool host_rmi_stats_get(u_register_t fid, struct host_rmi_stats *stats);
+void host_rmi_stats_print(const char *title);
 
 #endif /* HOST_REALM_RMI_H */
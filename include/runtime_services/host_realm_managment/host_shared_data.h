@@ -7,21 +7,78 @@
 #ifndef HOST_SHARED_DATA_H
 #define HOST_SHARED_DATA_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <spinlock.h>
 
-#define MAX_BUF_SIZE		10240U
 #define MAX_DATA_SIZE		5U
 
+/* Size of the log ring of each Rec, a power of 2 */
+#define REALM_LOG_RING_SIZE	8192U
+
+/*
+ * Longest message the Realm logs at once. The Realm asks the Host to drain its
+ * log ring when it has less free space than that left.
+ */
+#define REALM_LOG_LINE_MAX	256U
+
 #define REALM_CMD_BUFFER_SIZE	1024U
 
+/* Number of entries of the command and completion rings, a power of 2 */
+#define REALM_CMD_RING_SIZE	32U
+
+struct realm;
+
+/*
+ * Command queued by the Host on the command ring, with the parameters the
+ * Realm reads in place of host_param_val while it runs the command.
+ */
+struct realm_cmd_desc {
+	u_register_t cmd;
+	u_register_t args[MAX_DATA_SIZE];
+};
+
+/*
+ * Completion posted by the Realm for each command it takes from the command
+ * ring, with the values it writes in place of realm_out_val.
+ */
+struct realm_cmd_compl {
+	u_register_t cmd;
+	u_register_t result;
+	u_register_t out[MAX_DATA_SIZE];
+};
+
+/*
+ * Single producer, single consumer rings. 'head' and 'tail' count the entries
+ * written and read since the realm was created, the producer only writes
+ * 'head' and the consumer only writes 'tail'.
+ */
+struct realm_cmd_ring {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	struct realm_cmd_desc desc[REALM_CMD_RING_SIZE];
+};
+
+struct realm_compl_ring {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	struct realm_cmd_compl compl[REALM_CMD_RING_SIZE];
+};
+
+/* Ring of the bytes logged by the Realm, with the Host as consumer */
+struct realm_log_ring {
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	char buf[REALM_LOG_RING_SIZE];
+};
+
 /*
  * This structure maps the shared memory to be used between the Host and Realm
  * payload
  */
 typedef struct host_shared_data {
-	/* Buffer used from Realm for logging */
-	uint8_t log_buffer[MAX_BUF_SIZE];
+	/* Messages logged by Realm, printed by Host on REC exits */
+	struct realm_log_ring log_ring;
 
 	/* Command set from Host and used by Realm */
 	uint8_t realm_cmd;
@@ -34,6 +91,12 @@ typedef struct host_shared_data {
 
 	/* Buffer to save Realm command results */
 	uint8_t realm_cmd_output_buffer[REALM_CMD_BUFFER_SIZE];
+
+	/* Commands queued by Host, run by Realm on REALM_CMD_RING */
+	struct realm_cmd_ring cmd_ring;
+
+	/* Results of the commands of cmd_ring, in the same order */
+	struct realm_compl_ring compl_ring;
 } host_shared_data_t;
 
 /*
@@ -61,7 +124,12 @@ enum realm_cmd {
 	REALM_PAUTH_CHECK_CMD,
 	REALM_PAUTH_FAULT,
 	REALM_SME_ID_REGISTERS,
-	REALM_SME_UNDEF_ABORT
+	REALM_SME_UNDEF_ABORT,
+	REALM_NOP_HOST_CALL,
+	REALM_NOP_WFI,
+	REALM_NOP_PSCI,
+	REALM_CMD_RING,
+	REALM_PMU_BENCH
 };
 
 /*
@@ -69,14 +137,17 @@ enum realm_cmd {
  */
 enum host_param_index {
 	HOST_CMD_INDEX = 0U,
-	HOST_ARG1_INDEX
+	HOST_ARG1_INDEX,
+	HOST_ARG2_INDEX,
+	HOST_ARG3_INDEX
 };
 
 enum host_call_cmd {
         HOST_CALL_GET_SHARED_BUFF_CMD = 1U,
         HOST_CALL_EXIT_SUCCESS_CMD,
 	HOST_CALL_EXIT_FAILED_CMD,
-	HOST_CALL_EXIT_PRINT_CMD
+	HOST_CALL_EXIT_PRINT_CMD,
+	HOST_CALL_NOP_CMD
 };
 
 /***************************************
@@ -86,17 +157,42 @@ enum host_call_cmd {
 /*
  * Return shared buffer pointer mapped as host_shared_data_t structure
  */
-host_shared_data_t *host_get_shared_structure(unsigned int rec_num);
+host_shared_data_t *host_get_shared_structure(struct realm *realm_ptr,
+					      unsigned int rec_num);
 
 /*
  * Set data to be shared from Host to realm
  */
-void host_shared_data_set_host_val(unsigned int rec_num, uint8_t index, u_register_t val);
+void host_shared_data_set_host_val(struct realm *realm_ptr,
+				   unsigned int rec_num, uint8_t index,
+				   u_register_t val);
+
+/*
+ * Return data shared by realm in realm_out_val.
+ */
+u_register_t host_shared_data_get_realm_val(struct realm *realm_ptr,
+					    unsigned int rec_num,
+					    uint8_t index);
 
 /*
  * Set command to be send from Host to realm
  */
-void host_shared_data_set_realm_cmd(uint8_t cmd, unsigned int rec_num);
+void host_shared_data_set_realm_cmd(struct realm *realm_ptr, uint8_t cmd,
+				    unsigned int rec_num);
+
+/*
+ * Queue a command with MAX_DATA_SIZE parameters, or none if 'args' is NULL,
+ * on the command ring of a Rec. Returns false if the ring is full.
+ */
+bool host_cmd_ring_push(struct realm *realm_ptr, unsigned int rec_num,
+			uint8_t cmd, const u_register_t *args);
+
+/*
+ * Take the oldest completion of a Rec off its completion ring. Returns false
+ * if there is none.
+ */
+bool host_compl_ring_pop(struct realm *realm_ptr, unsigned int rec_num,
+			 struct realm_cmd_compl *compl);
 
 
 /****************************************
@@ -128,4 +224,17 @@ uint8_t realm_shared_data_get_my_realm_cmd(void);
  */
 void realm_shared_data_set_my_realm_val(uint8_t index, u_register_t val);
 
+/*
+ * Return the oldest command on the command ring of my Rec, which the host
+ * values and realm values of my Rec then refer to, or NULL if the ring is
+ * empty or the completion ring is full.
+ */
+struct realm_cmd_desc *realm_cmd_ring_peek(void);
+
+/*
+ * Post the result of the command returned by realm_cmd_ring_peek() on the
+ * completion ring of my Rec, and take the command off the command ring.
+ */
+void realm_cmd_ring_complete(bool result);
+
 #endif /* HOST_SHARED_DATA_H */
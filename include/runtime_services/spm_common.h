@@ -62,6 +62,18 @@ struct ffa_features_test {
 	unsigned int version_added;
 };
 
+/*
+ * Largest number of constituents sent in a memory transaction by the tests,
+ * and size of the descriptor describing them, which spans several fragments.
+ */
+#define MEM_SHARE_MAX_CONSTITUENTS	U(4096)
+#define MEM_SHARE_MAX_DESC_SIZE						\
+	(sizeof(struct ffa_memory_region) +				\
+	 sizeof(struct ffa_memory_access) +				\
+	 sizeof(struct ffa_composite_memory_region) +			\
+	 (MEM_SHARE_MAX_CONSTITUENTS *					\
+	  sizeof(struct ffa_memory_region_constituent)))
+
 struct mailbox_buffers {
 	void *recv;
 	void *send;
@@ -112,6 +124,17 @@ bool memory_retrieve(struct mailbox_buffers *mb,
 		     ffa_id_t sender, ffa_id_t receiver,
 		     ffa_memory_region_flags_t flags, uint32_t mem_func);
 
+/**
+ * Same as memory_retrieve, for descriptors that may be split across several
+ * fragments. The descriptor is reassembled in 'buf', and the RX buffer is
+ * released before returning.
+ */
+bool memory_retrieve_frag(struct mailbox_buffers *mb,
+			  struct ffa_memory_region **retrieved,
+			  void *buf, size_t buf_size, uint64_t handle,
+			  ffa_id_t sender, ffa_id_t receiver,
+			  ffa_memory_region_flags_t flags, uint32_t mem_func);
+
 /**
  * Helper to conduct a memory relinquish. The caller is usually the receiver,
  * after it being done with the memory shared, identified by the 'handle'.
@@ -123,6 +146,12 @@ ffa_memory_handle_t memory_send(
 	struct ffa_memory_region *memory_region, uint32_t mem_func,
 	uint32_t fragment_length, uint32_t total_length, struct ffa_value *ret);
 
+ffa_memory_handle_t memory_send_fragments(
+	void *send, size_t send_size, ffa_memory_handle_t handle,
+	uint32_t offset,
+	const struct ffa_memory_region_constituent *constituents,
+	uint32_t constituents_count, struct ffa_value *ret);
+
 ffa_memory_handle_t memory_init_and_send(
 	struct ffa_memory_region *memory_region, size_t memory_region_max_size,
 	ffa_id_t sender, ffa_id_t receiver,
@@ -139,4 +168,73 @@ bool disable_trusted_wdog_interrupt(ffa_id_t source, ffa_id_t dest);
 bool ffa_partition_info_regs_helper(const struct ffa_uuid uuid,
 		       const struct ffa_partition_info *expected,
 		       const uint16_t expected_size);
+
+/*
+ * Cache of the partition information of all partitions, as returned by
+ * FFA_PARTITION_INFO_GET with the NULL UUID: ID, UUID, execution context count
+ * and properties. It is filled once per boot, after FFA_VERSION negotiation,
+ * and allows finding partitions by ID or UUID in constant time instead of
+ * calling the ABI each time.
+ */
+#define FFA_PARTITION_INFO_CACHE_MAX	U(16)
+
+/*
+ * Fill the cache if it isn't already, using the RX buffer of 'mb'. Returns
+ * false if the partition information couldn't be cached, e.g. with FF-A v1.0
+ * descriptors which don't hold a UUID.
+ */
+bool ffa_partition_info_cache_init(struct mailbox_buffers *mb);
+uint32_t ffa_partition_info_cache_count(void);
+
+/* Return the cached information of a partition, or NULL if not found. */
+const struct ffa_partition_info *ffa_partition_info_cache_find_id(
+	ffa_id_t id);
+const struct ffa_partition_info *ffa_partition_info_cache_find_uuid(
+	const struct ffa_uuid uuid);
+
+/*
+ * Batch of messages sent with a single FFA_MSG_SEND2. The messages are written
+ * in place in the TX buffer of the sender, after the partition message
+ * header, each preceded by its size and padded to a multiple of 4 bytes. The
+ * receiver reads them in place from its RX buffer, and releases the buffer
+ * once for the whole batch.
+ */
+struct ffa_msg_batch {
+	struct ffa_partition_rxtx_header *header;
+	uint8_t *payload;
+	uint32_t max_size;
+	uint32_t size;
+	uint32_t count;
+};
+
+#define FFA_MSG_BATCH_ENTRY_HDR_SIZE	sizeof(uint32_t)
+#define FFA_MSG_BATCH_ENTRY_SIZE(size)					\
+	(FFA_MSG_BATCH_ENTRY_HDR_SIZE + (((size) + 3U) & ~3U))
+
+void ffa_msg_batch_init(struct ffa_msg_batch *batch, void *send,
+			size_t send_size, ffa_id_t sender, ffa_id_t receiver);
+
+/*
+ * Reserve room for a message of 'size' bytes in the batch, and return where
+ * to write it, or NULL if the batch is full.
+ */
+void *ffa_msg_batch_reserve(struct ffa_msg_batch *batch, uint32_t size);
+
+/*
+ * Send all messages of the batch with FFA_MSG_SEND2, and empty the batch.
+ */
+struct ffa_value ffa_msg_batch_send(struct ffa_msg_batch *batch);
+
+/*
+ * Iterate over the messages of a batch received in 'recv'. 'cursor' must be
+ * 0 for the first message. Returns false once there are no more messages, or
+ * if the batch is malformed.
+ */
+bool ffa_msg_batch_next(const void *recv, size_t recv_size, uint32_t *cursor,
+			const void **msg, uint32_t *size);
+
+/*
+ * Checksum of a message, used to check indirect messages made it through.
+ */
+uint32_t ffa_msg_checksum(const void *msg, uint32_t size);
 #endif /* SPM_COMMON_H */
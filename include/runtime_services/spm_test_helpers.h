@@ -90,6 +90,23 @@ bool reset_tftf_mailbox(void);
  */
 bool get_tftf_mailbox(struct mailbox_buffers *mb);
 
+/* Sizes of the RX/TX buffers the TFTF mailbox can be configured with. */
+#define TFTF_MAILBOX_SIZE_4K	(4U * 1024U)
+#define TFTF_MAILBOX_SIZE_16K	(16U * 1024U)
+#define TFTF_MAILBOX_SIZE_64K	(64U * 1024U)
+
+/*
+ * Select the size of the RX/TX buffers of the TFTF global mailbox. The buffer
+ * pair of each size is allocated once and kept for the session. If the
+ * mailbox is mapped with the SPMC and its size changes, the current pair is
+ * unmapped and the new one mapped, such that 'mb' views returned before by
+ * get_tftf_mailbox() are no longer valid.
+ * Returns false if the size isn't supported, by TFTF or by the SPMC, in which
+ * case the mailbox is left as it was. The size defaults to 4KiB.
+ */
+bool set_tftf_mailbox_size(size_t size);
+size_t get_tftf_mailbox_size(void);
+
 test_result_t check_spmc_testing_set_up(uint32_t ffa_version_major,
         uint32_t ffa_version_minor, const struct ffa_uuid *ffa_uuids,
         size_t ffa_uuids_size);
@@ -83,6 +83,40 @@ unlock_failed:/* failed allocation */
 	return HEAP_NULL_PTR;
 }
 
+/*
+ * Return the pointer to the allocated pages, aligned to 'align' bytes. The
+ * memory skipped to align the allocation is not used.
+ * @bytes_size: pages to allocate in byte unit
+ * @align: alignment in bytes, a power of two
+ */
+void *page_alloc_aligned(u_register_t bytes_size, u_register_t align)
+{
+	uint64_t addr;
+
+	if (heap_initialised != HEAP_INIT_SUCCESS) {
+		ERROR("heap need to be initialised first\n");
+		return HEAP_NULL_PTR;
+	}
+	if ((bytes_size == 0UL) || !IS_POWER_OF_TWO(align)) {
+		ERROR("bytes_size must be non-zero value and align a power "
+			"of two\n");
+		return HEAP_NULL_PTR;
+	}
+
+	spin_lock(&mem_lock);
+
+	addr = round_up(memory_used, align);
+	if ((addr + bytes_size) >= (heap_base_addr + heap_size)) {
+		ERROR("Reached to max KB allowed[%llu]\n", (heap_size/1024U));
+		spin_unlock(&mem_lock);
+		return HEAP_NULL_PTR;
+	}
+	memory_used = addr + bytes_size;
+	spin_unlock(&mem_lock);
+
+	return (void *)addr;
+}
+
 /*
  * Reset heap memory usage cursor to heap base address
  */
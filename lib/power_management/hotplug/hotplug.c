@@ -12,6 +12,7 @@
 #include <drivers/console.h>
 #include <irq.h>
 #include <pauth.h>
+#include <plat_topology.h>
 #include <platform.h>
 #include <platform_def.h>
 #include <power_management.h>
@@ -47,6 +48,19 @@ volatile test_function_t test_entrypoint[PLATFORM_CORE_COUNT];
 
 u_register_t tftf_primary_core = INVALID_MPID;
 
+/* System counter value read by each CPU on entry to tftf_warm_boot_main() */
+static volatile uint64_t warm_boot_ts[PLATFORM_CORE_COUNT];
+
+/*
+ * Number of times a CPU came online after a CPU_ON or after being parked,
+ * which tftf_cpu_on_all() waits on.
+ */
+static volatile unsigned int booted_cnt;
+static spinlock_t booted_cnt_lock;
+
+/* Whether each CPU parks instead of powering off at the end of its test */
+static volatile bool park_on_exit[PLATFORM_CORE_COUNT];
+
 unsigned int tftf_inc_ref_cnt(void)
 {
 	unsigned int cnt;
@@ -141,6 +155,42 @@ unsigned int tftf_is_core_pos_online(unsigned int core_pos)
 	return cpus_status_map[core_pos].state == TFTF_AFFINITY_STATE_ON;
 }
 
+unsigned int tftf_is_cpu_parked(unsigned int mpid)
+{
+	unsigned int core_pos = platform_get_core_pos(mpid);
+	return cpus_status_map[core_pos].state == TFTF_AFFINITY_STATE_PARKED;
+}
+
+static void tftf_inc_booted_cnt(void)
+{
+	spin_lock(&booted_cnt_lock);
+	booted_cnt++;
+	spin_unlock(&booted_cnt_lock);
+}
+
+/*
+ * Hand a new test entrypoint to a parked core and wake it up. Must be called
+ * with the lock of the core held.
+ */
+static void tftf_unpark_cpu(unsigned int core_pos, uintptr_t entrypoint,
+			    u_register_t context_id)
+{
+	assert(cpus_status_map[core_pos].state == TFTF_AFFINITY_STATE_PARKED);
+
+	tftf_set_cpu_on_ctx_id(core_pos, context_id);
+	test_entrypoint[core_pos] = (test_function_t) entrypoint;
+	cpus_status_map[core_pos].state = TFTF_AFFINITY_STATE_ON_PENDING;
+
+	dsbish();
+	sev();
+}
+
+uint64_t tftf_get_warm_boot_ts(unsigned int core_pos)
+{
+	assert(core_pos < PLATFORM_CORE_COUNT);
+	return warm_boot_ts[core_pos];
+}
+
 int32_t tftf_cpu_on(u_register_t target_cpu,
 		    uintptr_t entrypoint,
 		    u_register_t context_id)
@@ -162,6 +212,12 @@ int32_t tftf_cpu_on(u_register_t target_cpu,
 		return PSCI_E_SUCCESS;
 	}
 
+	if (cpu_state == TFTF_AFFINITY_STATE_PARKED) {
+		tftf_unpark_cpu(core_pos, entrypoint, context_id);
+		spin_unlock(&cpus_status_map[core_pos].lock);
+		return PSCI_E_SUCCESS;
+	}
+
 	assert(cpu_state == TFTF_AFFINITY_STATE_OFF);
 
 	do {
@@ -199,6 +255,15 @@ int32_t tftf_try_cpu_on(u_register_t target_cpu,
 	int32_t ret;
 	unsigned int core_pos = platform_get_core_pos(target_cpu);
 
+	/* A parked core is on, it would only get PSCI_E_ALREADY_ON */
+	spin_lock(&cpus_status_map[core_pos].lock);
+	if (cpus_status_map[core_pos].state == TFTF_AFFINITY_STATE_PARKED) {
+		tftf_unpark_cpu(core_pos, entrypoint, context_id);
+		spin_unlock(&cpus_status_map[core_pos].lock);
+		return PSCI_E_SUCCESS;
+	}
+	spin_unlock(&cpus_status_map[core_pos].lock);
+
 	ret = tftf_psci_cpu_on(target_cpu,
 		       (uintptr_t) tftf_hotplug_entry,
 		       context_id);
@@ -223,6 +288,50 @@ int32_t tftf_try_cpu_on(u_register_t target_cpu,
 	return ret;
 }
 
+int32_t tftf_cpu_on_all(uintptr_t entrypoint, const tftf_cpu_mask_t *mask)
+{
+	unsigned int mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int booted = booted_cnt;
+	unsigned int started = 0U;
+	unsigned int cpu_node, core_pos, target_mpid;
+	int32_t ret, first_err = PSCI_E_SUCCESS;
+
+	for_each_cpu(cpu_node) {
+		target_mpid = tftf_get_mpidr_from_node(cpu_node);
+		core_pos = platform_get_core_pos(target_mpid);
+
+		if ((target_mpid == mpid) ||
+		    ((mask != NULL) && !tftf_cpu_mask_test(mask, core_pos)))
+			continue;
+
+		park_on_exit[core_pos] = (PARK_SECONDARY_CPUS != 0);
+
+		ret = tftf_cpu_on(target_mpid, entrypoint, 0);
+		if (ret == PSCI_E_SUCCESS) {
+			started++;
+		} else {
+			park_on_exit[core_pos] = false;
+			if (first_err == PSCI_E_SUCCESS)
+				first_err = ret;
+		}
+	}
+
+	/* Each core counts itself once it is online */
+	while ((booted_cnt - booted) < started)
+		;
+
+	return first_err;
+}
+
+int32_t tftf_cpu_on_parkable(u_register_t target_cpu, uintptr_t entrypoint)
+{
+	tftf_cpu_mask_t mask = { 0 };
+
+	tftf_cpu_mask_set(&mask, platform_get_core_pos(target_cpu));
+
+	return tftf_cpu_on_all(entrypoint, &mask);
+}
+
 /*
  * Prepare the core to power off. Any driver which needs to perform specific
  * tasks before powering off a CPU, e.g. migrating interrupts to another
@@ -251,6 +360,12 @@ int32_t tftf_cpu_off(void)
 {
 	int32_t ret;
 
+	/*
+	 * A CPU powered off, whether by its test or as the last CPU of a
+	 * test, does not park when it is next powered on.
+	 */
+	park_on_exit[platform_get_core_pos(read_mpidr_el1())] = false;
+
 	tftf_prepare_cpu_off();
 	tftf_set_cpu_offline();
 
@@ -282,11 +397,54 @@ int32_t tftf_cpu_off(void)
 	return ret;
 }
 
+unsigned int tftf_park_cpu(void)
+{
+	unsigned int mpid = read_mpidr_el1();
+	unsigned int core_pos = platform_get_core_pos(mpid);
+
+	if (!park_on_exit[core_pos])
+		return 0;
+
+	park_on_exit[core_pos] = false;
+
+	/* Stop taking interrupts meant for the cores in the next tests */
+	tftf_prepare_cpu_off();
+
+	spin_lock(&cpus_status_map[core_pos].lock);
+	assert(tftf_is_cpu_online(mpid));
+	cpus_status_map[core_pos].state = TFTF_AFFINITY_STATE_PARKED;
+	spin_unlock(&cpus_status_map[core_pos].lock);
+
+	VERBOSE("Parked\n");
+
+	while (cpus_status_map[core_pos].state == TFTF_AFFINITY_STATE_PARKED)
+		wfe();
+
+	/*
+	 * The previous test may have changed the EL2 and GIC CPU interface
+	 * configuration, so set them up again as tftf_warm_boot_main() does.
+	 */
+	tftf_arch_setup();
+	arm_gic_setup_local();
+	tftf_irq_enable(IRQ_WAKE_SGI, GIC_HIGHEST_NS_PRIORITY);
+	enable_irq();
+
+	tftf_set_cpu_online();
+	tftf_inc_booted_cnt();
+
+	return 1;
+}
+
 /*
  * C entry point for a CPU that has just been powered up.
  */
 void __dead2 tftf_warm_boot_main(void)
 {
+	/* Read first, so that it marks the end of the CPU_ON latency */
+	uint64_t ts = syscounter_read();
+
+	warm_boot_ts[platform_get_core_pos(read_mpidr_el1())] = ts;
+
 	/* Initialise the CPU */
 	tftf_arch_setup();
 
@@ -309,6 +467,7 @@ void __dead2 tftf_warm_boot_main(void)
 	INFO("Booting\n");
 
 	tftf_set_cpu_online();
+	tftf_inc_booted_cnt();
 
 	/* Enter the test session */
 	run_tests();
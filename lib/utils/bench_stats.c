@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <bench_stats.h>
+#include <stdio.h>
+#include <tftf_lib.h>
+
+static void sift_down(uint64_t *samples, unsigned int root, unsigned int end)
+{
+	unsigned int child;
+	uint64_t tmp;
+
+	while ((child = (2U * root) + 1U) < end) {
+		if ((child + 1U < end) && (samples[child] < samples[child + 1U])) {
+			child++;
+		}
+
+		if (samples[root] >= samples[child]) {
+			return;
+		}
+
+		tmp = samples[root];
+		samples[root] = samples[child];
+		samples[child] = tmp;
+		root = child;
+	}
+}
+
+/*
+ * Heap sort, so that sorting a large series doesn't need any extra memory nor
+ * take quadratic time.
+ */
+static void sort_samples(uint64_t *samples, unsigned int count)
+{
+	uint64_t tmp;
+
+	for (unsigned int i = count / 2U; i > 0U; i--) {
+		sift_down(samples, i - 1U, count);
+	}
+
+	for (unsigned int end = count; end > 1U; end--) {
+		tmp = samples[0];
+		samples[0] = samples[end - 1U];
+		samples[end - 1U] = tmp;
+		sift_down(samples, 0U, end - 1U);
+	}
+}
+
+static uint64_t percentile(const uint64_t *sorted, unsigned int count,
+			   unsigned int pct)
+{
+	unsigned int rank = ((pct * count) + 99U) / 100U;
+
+	return sorted[(rank == 0U) ? 0U : rank - 1U];
+}
+
+void bench_stats_compute(uint64_t *samples, unsigned int count,
+			 struct bench_stats *stats)
+{
+	uint64_t sum = 0ULL;
+
+	assert(samples != NULL);
+	assert(stats != NULL);
+
+	stats->count = count;
+
+	if (count == 0U) {
+		stats->min = stats->max = stats->avg = 0ULL;
+		stats->p50 = stats->p90 = stats->p99 = 0ULL;
+		return;
+	}
+
+	sort_samples(samples, count);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		sum += samples[i];
+	}
+
+	stats->min = samples[0];
+	stats->max = samples[count - 1U];
+	stats->avg = sum / count;
+	stats->p50 = percentile(samples, count, 50U);
+	stats->p90 = percentile(samples, count, 90U);
+	stats->p99 = percentile(samples, count, 99U);
+}
+
+uint64_t bench_ticks_to_ns(uint64_t ticks)
+{
+	return (ticks * 1000000000ULL) / read_cntfrq_el0();
+}
+
+uint64_t bench_ops_per_sec(uint64_t ops, uint64_t ticks)
+{
+	if (ticks == 0ULL) {
+		return 0ULL;
+	}
+
+	return (ops * read_cntfrq_el0()) / ticks;
+}
+
+void bench_stats_print(const char *name, const struct bench_stats *stats)
+{
+	printf("%s: avg %llu ns, min %llu, p50 %llu, p90 %llu, p99 %llu, "
+	       "max %llu (%u samples)\n", name,
+	       (unsigned long long)bench_ticks_to_ns(stats->avg),
+	       (unsigned long long)bench_ticks_to_ns(stats->min),
+	       (unsigned long long)bench_ticks_to_ns(stats->p50),
+	       (unsigned long long)bench_ticks_to_ns(stats->p90),
+	       (unsigned long long)bench_ticks_to_ns(stats->p99),
+	       (unsigned long long)bench_ticks_to_ns(stats->max),
+	       stats->count);
+}
@@ -40,6 +40,10 @@ FWU_BL_TEST := 1
 # framework should try to resume a previous one if it was interrupted
 NEW_TEST_SESSION	:= 1
 
+# Park the CPUs powered on by tftf_cpu_on_all() in WFE at the end of their test
+# instead of powering them off, such that the next tests reuse them
+PARK_SECONDARY_CPUS	:= 0
+
 # Use non volatile memory for storing results
 USE_NVM			:= 0
 
@@ -52,6 +56,15 @@ BRANCH_PROTECTION	:= 0
 # Build RME stack
 ENABLE_REALM_PAYLOAD_TESTS	:= 0
 
+# Keep per-FID counts and timings of the RMI calls made by the realm tests
+HOST_RMI_STATS		:= 0
+
+# Check the host shadow of the realm RTTs against the RMM before teardown
+HOST_RTT_SHADOW_CHECK	:= 0
+
+# Check the registers preserved by the RMM in 1 of this many RMI calls
+HOST_RMI_REGS_CHECK	:= 1
+
 # Use the Firmware Handoff framework to receive configurations from preceding
 # bootloader.
 TRANSFER_LIST		:= 0
@@ -7,37 +7,71 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
-#include <string.h>
 
 #include <arch_helpers.h>
 #include <host_shared_data.h>
 #include <realm_rsi.h>
 
+/*
+ * Ask the Host to drain the log ring of this Rec.
+ */
+static void realm_log_flush(void)
+{
+	rsi_exit_to_host(HOST_CALL_EXIT_PRINT_CMD);
+}
+
+/*
+ * Append 'len' bytes to the log ring of this Rec, without exiting to the Host
+ * unless the ring is nearly full. The Host prints the ring on the next REC
+ * exit. One byte is always left free, such that the Host can tell whether
+ * the oldest byte it has not printed starts a line.
+ */
+static void realm_log_write(const char *buf, size_t len)
+{
+	struct realm_log_ring *ring = &realm_get_my_shared_structure()->log_ring;
+	uint32_t head = ring->head;
+
+	while ((REALM_LOG_RING_SIZE - (head - ring->tail)) <= len) {
+		realm_log_flush();
+	}
+
+	for (size_t i = 0UL; i < len; i++) {
+		ring->buf[(head + i) & (REALM_LOG_RING_SIZE - 1U)] = buf[i];
+	}
+
+	/* Publish the bytes before the Host can see them */
+	dmbishst();
+	head += len;
+	ring->head = head;
+
+	if ((REALM_LOG_RING_SIZE - (head - ring->tail)) <= REALM_LOG_LINE_MAX) {
+		realm_log_flush();
+	}
+}
+
 /*
  * A printf formatted function used in the Realm world to log messages
- * in the shared buffer.
- * Locate the shared logging buffer and print its content
+ * in the shared log ring, of at most REALM_LOG_LINE_MAX - 1 characters.
  */
 void realm_printf(const char *fmt, ...)
 {
-	host_shared_data_t *guest_shared_data = realm_get_my_shared_structure();
-	char *log_buffer = (char *)guest_shared_data->log_buffer;
+	char buf[REALM_LOG_LINE_MAX];
 	va_list args;
+	int len;
 
 	va_start(args, fmt);
-	if (strnlen((const char *)log_buffer, MAX_BUF_SIZE) == MAX_BUF_SIZE) {
-		(void)memset((char *)log_buffer, 0, MAX_BUF_SIZE);
-	}
-	(void)vsnprintf((char *)log_buffer +
-			strnlen((const char *)log_buffer, MAX_BUF_SIZE),
-			MAX_BUF_SIZE, fmt, args);
+	len = vsnprintf(buf, sizeof(buf), fmt, args);
 	va_end(args);
-	rsi_exit_to_host(HOST_CALL_EXIT_PRINT_CMD);
+
+	if (len > 0) {
+		realm_log_write(buf, MIN((size_t)len, sizeof(buf) - 1UL));
+	}
 }
 
 void __attribute__((__noreturn__)) do_panic(const char *file, int line)
 {
 	realm_printf("PANIC in file: %s line: %d\n", file, line);
+	realm_log_flush();
 	while (true) {
 		continue;
 	}
@@ -46,16 +80,12 @@ void __attribute__((__noreturn__)) do_panic(const char *file, int line)
 /* This is used from printf() when crash dump is reached */
 int console_putc(int c)
 {
-	host_shared_data_t *guest_shared_data = realm_get_my_shared_structure();
-	char *log_buffer = (char *)guest_shared_data->log_buffer;
+	char ch = (char)c;
 
 	if ((c < 0) || (c > 127)) {
 		return -1;
 	}
-	if (strnlen((const char *)log_buffer, MAX_BUF_SIZE) == MAX_BUF_SIZE) {
-		(void)memset((char *)log_buffer, 0, MAX_BUF_SIZE);
-	}
-	*((char *)log_buffer + strnlen((const char *)log_buffer, MAX_BUF_SIZE)) = c;
+	realm_log_write(&ch, 1UL);
 
 	return c;
 }
@@ -8,12 +8,14 @@
 #include <stdio.h>
 
 #include <arch_features.h>
+#include <arch_helpers.h>
 #include <debug.h>
 #include <fpu.h>
 #include <host_realm_helper.h>
 #include <host_shared_data.h>
 #include <pauth.h>
 #include "realm_def.h"
+#include <realm_psci.h>
 #include <realm_rsi.h>
 #include <realm_tests.h>
 #include <tftf_lib.h>
@@ -40,6 +42,32 @@ static void realm_loop_cmd(void)
 	}
 }
 
+/*
+ * Exit to the host as many times as the host asks, with the cheapest exit of
+ * each kind the host measures:
+ * - REALM_NOP_HOST_CALL: host call the host returns from straight away.
+ * - REALM_NOP_WFI: WFI, which the host asks the RMM to trap.
+ * - REALM_NOP_PSCI: PSCI_AFFINITY_INFO of REC 1, which the host completes.
+ */
+static void realm_nop_exit_cmd(uint8_t cmd)
+{
+	uint64_t count = realm_shared_data_get_my_host_val(HOST_ARG1_INDEX);
+
+	for (uint64_t i = 0UL; i < count; i++) {
+		switch (cmd) {
+		case REALM_NOP_HOST_CALL:
+			rsi_exit_to_host(HOST_CALL_NOP_CMD);
+			break;
+		case REALM_NOP_WFI:
+			wfi();
+			break;
+		default:
+			(void)realm_psci_affinity_info(1U, MPIDR_AFFLVL0);
+			break;
+		}
+	}
+}
+
 /*
  * This function requests RSI/ABI version from RMM.
  */
@@ -61,6 +89,119 @@ static bool realm_get_rsi_version(void)
 	return true;
 }
 
+/*
+ * Run a command sent by the Host, and return whether it succeeded.
+ */
+static bool realm_run_cmd(uint8_t cmd)
+{
+	bool test_succeed = false;
+
+	switch (cmd) {
+	case REALM_SLEEP_CMD:
+		realm_sleep_cmd();
+		test_succeed = true;
+		break;
+	case REALM_LOOP_CMD:
+		realm_loop_cmd();
+		test_succeed = true;
+		break;
+	case REALM_MULTIPLE_REC_PSCI_DENIED_CMD:
+		test_succeed = test_realm_multiple_rec_psci_denied_cmd();
+		break;
+	case REALM_PAUTH_SET_CMD:
+		test_succeed = test_realm_pauth_set_cmd();
+		break;
+	case REALM_PAUTH_CHECK_CMD:
+		test_succeed = test_realm_pauth_check_cmd();
+		break;
+	case REALM_PAUTH_FAULT:
+		test_succeed = test_realm_pauth_fault();
+		break;
+	case REALM_GET_RSI_VERSION:
+		test_succeed = realm_get_rsi_version();
+		break;
+	case REALM_PMU_CYCLE:
+		test_succeed = test_pmuv3_cycle_works_realm();
+		break;
+	case REALM_PMU_EVENT:
+		test_succeed = test_pmuv3_event_works_realm();
+		break;
+	case REALM_PMU_PRESERVE:
+		test_succeed = test_pmuv3_rmm_preserves();
+		break;
+	case REALM_PMU_INTERRUPT:
+		test_succeed = test_pmuv3_overflow_interrupt();
+		break;
+	case REALM_PMU_BENCH:
+		test_succeed = realm_pmu_bench();
+		break;
+	case REALM_REQ_FPU_FILL_CMD:
+		fpu_state_write_rand(&rl_fpu_state_write);
+		test_succeed = true;
+		break;
+	case REALM_REQ_FPU_CMP_CMD:
+		fpu_state_read(&rl_fpu_state_read);
+		test_succeed = !fpu_state_compare(&rl_fpu_state_write,
+						  &rl_fpu_state_read);
+		break;
+	case REALM_SVE_RDVL:
+		test_succeed = test_realm_sve_rdvl();
+		break;
+	case REALM_SVE_ID_REGISTERS:
+		test_succeed = test_realm_sve_read_id_registers();
+		break;
+	case REALM_SVE_PROBE_VL:
+		test_succeed = test_realm_sve_probe_vl();
+		break;
+	case REALM_SVE_OPS:
+		test_succeed = test_realm_sve_ops();
+		break;
+	case REALM_SVE_FILL_REGS:
+		test_succeed = test_realm_sve_fill_regs();
+		break;
+	case REALM_SVE_CMP_REGS:
+		test_succeed = test_realm_sve_cmp_regs();
+		break;
+	case REALM_SVE_UNDEF_ABORT:
+		test_succeed = test_realm_sve_undef_abort();
+		break;
+	case REALM_SME_ID_REGISTERS:
+		test_succeed = test_realm_sme_read_id_registers();
+		break;
+	case REALM_SME_UNDEF_ABORT:
+		test_succeed = test_realm_sme_undef_abort();
+		break;
+	case REALM_NOP_HOST_CALL:
+	case REALM_NOP_WFI:
+	case REALM_NOP_PSCI:
+		realm_nop_exit_cmd(cmd);
+		test_succeed = true;
+		break;
+	default:
+		realm_printf("%s() invalid cmd %u\n", __func__, cmd);
+		break;
+	}
+
+	return test_succeed;
+}
+
+/*
+ * Run the commands queued on the command ring of this REC, until it is empty
+ * or the completion ring is full, and post the result of each of them on the
+ * completion ring.
+ */
+static bool realm_cmd_ring_drain(void)
+{
+	struct realm_cmd_desc *desc = realm_cmd_ring_peek();
+
+	while (desc != NULL) {
+		realm_cmd_ring_complete(realm_run_cmd((uint8_t)desc->cmd));
+		desc = realm_cmd_ring_peek();
+	}
+
+	return true;
+}
+
 /*
  * This is the entry function for Realm payload, it first requests the shared buffer
  * IPA address from Host using HOST_CALL/RSI, it reads the command to be executed,
@@ -77,81 +218,10 @@ void realm_payload_main(void)
 	if (realm_get_my_shared_structure() != NULL) {
 		uint8_t cmd = realm_shared_data_get_my_realm_cmd();
 
-		switch (cmd) {
-		case REALM_SLEEP_CMD:
-			realm_sleep_cmd();
-			test_succeed = true;
-			break;
-		case REALM_LOOP_CMD:
-			realm_loop_cmd();
-			test_succeed = true;
-			break;
-		case REALM_MULTIPLE_REC_PSCI_DENIED_CMD:
-			test_succeed = test_realm_multiple_rec_psci_denied_cmd();
-			break;
-		case REALM_PAUTH_SET_CMD:
-			test_succeed = test_realm_pauth_set_cmd();
-			break;
-		case REALM_PAUTH_CHECK_CMD:
-			test_succeed = test_realm_pauth_check_cmd();
-			break;
-		case REALM_PAUTH_FAULT:
-			test_succeed = test_realm_pauth_fault();
-			break;
-		case REALM_GET_RSI_VERSION:
-			test_succeed = realm_get_rsi_version();
-			break;
-		case REALM_PMU_CYCLE:
-			test_succeed = test_pmuv3_cycle_works_realm();
-			break;
-		case REALM_PMU_EVENT:
-			test_succeed = test_pmuv3_event_works_realm();
-			break;
-		case REALM_PMU_PRESERVE:
-			test_succeed = test_pmuv3_rmm_preserves();
-			break;
-		case REALM_PMU_INTERRUPT:
-			test_succeed = test_pmuv3_overflow_interrupt();
-			break;
-		case REALM_REQ_FPU_FILL_CMD:
-			fpu_state_write_rand(&rl_fpu_state_write);
-			test_succeed = true;
-			break;
-		case REALM_REQ_FPU_CMP_CMD:
-			fpu_state_read(&rl_fpu_state_read);
-			test_succeed = !fpu_state_compare(&rl_fpu_state_write,
-							  &rl_fpu_state_read);
-			break;
-		case REALM_SVE_RDVL:
-			test_succeed = test_realm_sve_rdvl();
-			break;
-		case REALM_SVE_ID_REGISTERS:
-			test_succeed = test_realm_sve_read_id_registers();
-			break;
-		case REALM_SVE_PROBE_VL:
-			test_succeed = test_realm_sve_probe_vl();
-			break;
-		case REALM_SVE_OPS:
-			test_succeed = test_realm_sve_ops();
-			break;
-		case REALM_SVE_FILL_REGS:
-			test_succeed = test_realm_sve_fill_regs();
-			break;
-		case REALM_SVE_CMP_REGS:
-			test_succeed = test_realm_sve_cmp_regs();
-			break;
-		case REALM_SVE_UNDEF_ABORT:
-			test_succeed = test_realm_sve_undef_abort();
-			break;
-		case REALM_SME_ID_REGISTERS:
-			test_succeed = test_realm_sme_read_id_registers();
-			break;
-		case REALM_SME_UNDEF_ABORT:
-			test_succeed = test_realm_sme_undef_abort();
-			break;
-		default:
-			realm_printf("%s() invalid cmd %u\n", __func__, cmd);
-			break;
+		if (cmd == REALM_CMD_RING) {
+			test_succeed = realm_cmd_ring_drain();
+		} else {
+			test_succeed = realm_run_cmd(cmd);
 		}
 	}
 
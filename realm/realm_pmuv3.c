@@ -4,16 +4,22 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_features.h>
 #include <arch_helpers.h>
 #include <arm_arch_svc.h>
 #include <debug.h>
 #include <drivers/arm/gic_v3.h>
+#include <lib/extensions/sve.h>
+#include <xlat_tables_defs.h>
 
 #include <host_realm_pmu.h>
+#include <host_shared_data.h>
 #include <realm_rsi.h>
 
 /* PMUv3 events */
 #define PMU_EVT_SW_INCR		0x0
+#define PMU_EVT_L1D_CACHE_REFILL	0x3
+#define PMU_EVT_L1D_TLB_REFILL	0x5
 #define PMU_EVT_INST_RETIRED	0x8
 #define PMU_EVT_CPU_CYCLES	0x11
 #define PMU_EVT_MEM_ACCESS	0x13
@@ -25,6 +31,25 @@
 
 #define	DELAY_MS		3000ULL
 
+/* Elements of each array of the SVE kernel */
+#define PMU_BENCH_SVE_ARRAYSIZE	512U
+
+/* Events counted by REALM_PMU_BENCH, in the order of its results */
+static const unsigned int pmu_bench_events[] = {
+	PMU_EVT_INST_RETIRED,
+	PMU_EVT_L1D_CACHE_REFILL,
+	PMU_EVT_L1D_TLB_REFILL,
+};
+
+/* Protected memory read by REALM_PMU_BENCH_STREAM_PROTECTED */
+static uint64_t pmu_bench_buf[REALM_PMU_BENCH_STREAM_MAX / sizeof(uint64_t)]
+	__aligned(PAGE_SIZE);
+
+static int pmu_bench_sve_op[2][PMU_BENCH_SVE_ARRAYSIZE];
+
+/* Keeps the results of the kernels live */
+static volatile u_register_t pmu_bench_sink;
+
 static inline void read_all_counters(u_register_t *array, int impl_ev_ctrs)
 {
 	array[0] = read_pmccntr_el0();
@@ -107,7 +132,7 @@ static inline void enable_cycle_counter(void)
 	isb();
 }
 
-static inline void enable_event_counter(int ctr_num)
+static inline void enable_event_counter(int ctr_num, unsigned int event)
 {
 	/*
 	 * Set PMEVTYPER_EL0.U != PMEVTYPER_EL0.RLU
@@ -121,7 +146,7 @@ static inline void enable_event_counter(int ctr_num)
 			PMEVTYPER_EL0_U_BIT |
 			PMEVTYPER_EL0_P_BIT | PMEVTYPER_EL0_RLK_BIT |
 			PMEVTYPER_EL0_NSH_BIT | PMEVTYPER_EL0_RLH_BIT |
-			(PMU_EVT_INST_RETIRED & PMEVTYPER_EL0_EVTCOUNT_BITS));
+			(event & PMEVTYPER_EL0_EVTCOUNT_BITS));
 	write_pmcntenset_el0(read_pmcntenset_el0() |
 		PMCNTENSET_EL0_P_BIT(ctr_num));
 	isb();
@@ -177,7 +202,7 @@ bool test_pmuv3_event_works_realm(void)
 
 	pmu_reset();
 
-	enable_event_counter(0);
+	enable_event_counter(0, PMU_EVT_INST_RETIRED);
 	enable_counting();
 
 	/*
@@ -216,7 +241,7 @@ bool test_pmuv3_rmm_preserves(void)
 
 	/* Pretend counters have just been used */
 	enable_cycle_counter();
-	enable_event_counter(0);
+	enable_event_counter(0, PMU_EVT_INST_RETIRED);
 	enable_counting();
 	execute_nops();
 	disable_counting();
@@ -279,7 +304,7 @@ bool test_pmuv3_overflow_interrupt(void)
 	enable_irq();
 
 	write_pmevcntrn_el0(0, PRE_OVERFLOW);
-	enable_event_counter(0);
+	enable_event_counter(0, PMU_EVT_INST_RETIRED);
 
 	/* Enable interrupt on event counter #0 */
 	write_pmintenset_el1((1UL << 0));
@@ -314,3 +339,144 @@ bool test_pmuv3_overflow_interrupt(void)
 
 	return true;
 }
+
+static u_register_t pmu_bench_rsi_version(u_register_t iterations)
+{
+	u_register_t sum = 0UL;
+
+	for (u_register_t i = 0UL; i < iterations; i++) {
+		sum += rsi_get_version(RSI_ABI_VERSION_VAL);
+	}
+
+	return sum;
+}
+
+static u_register_t pmu_bench_stream(const volatile uint64_t *buf,
+				     u_register_t size,
+				     u_register_t iterations)
+{
+	u_register_t sum = 0UL;
+
+	for (u_register_t i = 0UL; i < iterations; i++) {
+		for (u_register_t j = 0UL; j < (size / sizeof(uint64_t));
+		     j++) {
+			sum += buf[j];
+		}
+	}
+
+	return sum;
+}
+
+static u_register_t pmu_bench_sve(u_register_t iterations)
+{
+	for (u_register_t i = 0UL; i < iterations; i++) {
+		sve_subtract_arrays(pmu_bench_sve_op[0], pmu_bench_sve_op[0],
+				    pmu_bench_sve_op[1],
+				    PMU_BENCH_SVE_ARRAYSIZE);
+	}
+
+	return (u_register_t)pmu_bench_sve_op[0][0];
+}
+
+/*
+ * Run the kernel the host asks for in HOST_ARG1_INDEX as many times as it
+ * asks in HOST_ARG2_INDEX, over HOST_ARG3_INDEX bytes for the streaming
+ * kernels, with the cycle counter and an event counter for each of
+ * pmu_bench_events[] counting in Realm EL1. The unprotected streaming kernel
+ * reads the shared memory of this REC and of the next ones, which the host
+ * must have mapped. The counts and the system counter ticks taken are
+ * returned in realm_out_val, with REALM_PMU_BENCH_NOT_COUNTED for the events
+ * there are not enough event counters for. The time the RMM spends on RSI
+ * calls at Realm EL2 is in the ticks, but not in the counts.
+ *
+ * The realm runs with the MMU and the data cache off, so the streaming
+ * kernels make non-cacheable accesses only. Their L1D cache refills are
+ * returned as REALM_PMU_BENCH_NOT_COUNTED, as they say nothing about the
+ * memory read.
+ */
+bool realm_pmu_bench(void)
+{
+	u_register_t kernel = realm_shared_data_get_my_host_val(HOST_ARG1_INDEX);
+	u_register_t iterations =
+		realm_shared_data_get_my_host_val(HOST_ARG2_INDEX);
+	u_register_t size = realm_shared_data_get_my_host_val(HOST_ARG3_INDEX);
+	u_register_t counts[1U + ARRAY_SIZE(pmu_bench_events)];
+	unsigned int nevents = GET_CNT_NUM;
+	uint64_t start, ticks;
+
+	if (nevents > ARRAY_SIZE(pmu_bench_events)) {
+		nevents = ARRAY_SIZE(pmu_bench_events);
+	}
+
+	switch (kernel) {
+	case REALM_PMU_BENCH_STREAM_PROTECTED:
+	case REALM_PMU_BENCH_STREAM_UNPROTECTED:
+		if (size > REALM_PMU_BENCH_STREAM_MAX) {
+			realm_printf("Realm: stream size 0x%lx too large\n",
+				     size);
+			return false;
+		}
+		break;
+	case REALM_PMU_BENCH_SVE:
+		if (!is_armv8_2_sve_present()) {
+			realm_printf("Realm: SVE not supported\n");
+			return false;
+		}
+		sve_config_vq(SVE_VQ_ARCH_MAX);
+		break;
+	case REALM_PMU_BENCH_RSI_VERSION:
+		break;
+	default:
+		realm_printf("Realm: invalid PMU bench kernel %lu\n", kernel);
+		return false;
+	}
+
+	pmu_reset();
+
+	enable_cycle_counter();
+	for (unsigned int i = 0U; i < nevents; i++) {
+		enable_event_counter(i, pmu_bench_events[i]);
+	}
+
+	start = syscounter_read();
+	enable_counting();
+
+	switch (kernel) {
+	case REALM_PMU_BENCH_RSI_VERSION:
+		pmu_bench_sink = pmu_bench_rsi_version(iterations);
+		break;
+	case REALM_PMU_BENCH_STREAM_PROTECTED:
+		pmu_bench_sink = pmu_bench_stream(pmu_bench_buf, size,
+						  iterations);
+		break;
+	case REALM_PMU_BENCH_STREAM_UNPROTECTED:
+		pmu_bench_sink = pmu_bench_stream(
+			(const volatile uint64_t *)
+			realm_get_my_shared_structure(), size, iterations);
+		break;
+	default:
+		pmu_bench_sink = pmu_bench_sve(iterations);
+		break;
+	}
+
+	disable_counting();
+	ticks = syscounter_read() - start;
+
+	read_all_counters(counts, nevents);
+	pmu_reset();
+
+	realm_shared_data_set_my_realm_val(REALM_PMU_BENCH_CYCLES, counts[0]);
+	for (unsigned int i = 0U; i < ARRAY_SIZE(pmu_bench_events); i++) {
+		realm_shared_data_set_my_realm_val(REALM_PMU_BENCH_INSTS + i,
+			(i < nevents) ? counts[i + 1U] :
+			REALM_PMU_BENCH_NOT_COUNTED);
+	}
+	if (kernel != REALM_PMU_BENCH_RSI_VERSION &&
+	    kernel != REALM_PMU_BENCH_SVE) {
+		realm_shared_data_set_my_realm_val(REALM_PMU_BENCH_L1D_REFILLS,
+						   REALM_PMU_BENCH_NOT_COUNTED);
+	}
+	realm_shared_data_set_my_realm_val(REALM_PMU_BENCH_TICKS, ticks);
+
+	return true;
+}
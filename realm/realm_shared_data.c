@@ -8,6 +8,7 @@
 #include <arch_helpers.h>
 #include <assert.h>
 #include <host_shared_data.h>
+#include "realm_def.h"
 
 /**
  *   @brief    - Returns the base address of the shared region
@@ -17,6 +18,13 @@
 
 static host_shared_data_t *guest_shared_data;
 
+/*
+ * Command of the command ring each Rec runs, if any, and the completion it
+ * writes its results to.
+ */
+static struct realm_cmd_desc *ring_desc[MAX_REC_COUNT];
+static struct realm_cmd_compl *ring_compl[MAX_REC_COUNT];
+
 /*
  * Set guest mapped shared buffer pointer
  */
@@ -38,8 +46,13 @@ host_shared_data_t *realm_get_my_shared_structure(void)
  */
 u_register_t realm_shared_data_get_my_host_val(uint8_t index)
 {
+	unsigned int rec = read_mpidr_el1() & MPID_MASK;
+
 	assert(index < MAX_DATA_SIZE);
-	return guest_shared_data[read_mpidr_el1() & MPID_MASK].host_param_val[index];
+	if (ring_desc[rec] != NULL) {
+		return ring_desc[rec]->args[index];
+	}
+	return guest_shared_data[rec].host_param_val[index];
 }
 
 /*
@@ -55,7 +68,66 @@ uint8_t realm_shared_data_get_my_realm_cmd(void)
  */
 void realm_shared_data_set_my_realm_val(uint8_t index, u_register_t val)
 {
+	unsigned int rec = read_mpidr_el1() & MPID_MASK;
+
 	assert(index < MAX_DATA_SIZE);
-	guest_shared_data[read_mpidr_el1() & MPID_MASK].realm_out_val[index] = val;
+	if (ring_compl[rec] != NULL) {
+		ring_compl[rec]->out[index] = val;
+		return;
+	}
+	guest_shared_data[rec].realm_out_val[index] = val;
+}
+
+/*
+ * Return the oldest command on the command ring of this rec, which the host
+ * values and realm values of this rec then refer to, or NULL if the ring is
+ * empty or the completion ring is full.
+ */
+struct realm_cmd_desc *realm_cmd_ring_peek(void)
+{
+	unsigned int rec = read_mpidr_el1() & MPID_MASK;
+	host_shared_data_t *shared = &guest_shared_data[rec];
+	struct realm_cmd_ring *cmd_ring = &shared->cmd_ring;
+	struct realm_compl_ring *compl_ring = &shared->compl_ring;
+	uint32_t compl_head = compl_ring->head;
+
+	if (cmd_ring->tail == cmd_ring->head ||
+	    (compl_head - compl_ring->tail) == REALM_CMD_RING_SIZE) {
+		return NULL;
+	}
+
+	/* Read the descriptor after its index */
+	dmbishld();
+
+	ring_desc[rec] = &cmd_ring->desc[cmd_ring->tail &
+					 (REALM_CMD_RING_SIZE - 1U)];
+	ring_compl[rec] = &compl_ring->compl[compl_head &
+					     (REALM_CMD_RING_SIZE - 1U)];
+	(void)memset(ring_compl[rec], 0, sizeof(*ring_compl[rec]));
+
+	return ring_desc[rec];
+}
+
+/*
+ * Post the result of the command returned by realm_cmd_ring_peek() on the
+ * completion ring of this rec, and take the command off the command ring.
+ */
+void realm_cmd_ring_complete(bool result)
+{
+	unsigned int rec = read_mpidr_el1() & MPID_MASK;
+	host_shared_data_t *shared = &guest_shared_data[rec];
+
+	assert(ring_desc[rec] != NULL);
+
+	ring_compl[rec]->cmd = ring_desc[rec]->cmd;
+	ring_compl[rec]->result = result ? 1UL : 0UL;
+
+	/* Publish the completion, then free the descriptor */
+	dmbish();
+	shared->compl_ring.head++;
+	shared->cmd_ring.tail++;
+
+	ring_desc[rec] = NULL;
+	ring_compl[rec] = NULL;
 }
 
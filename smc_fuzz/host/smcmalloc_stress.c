@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host-side stress harness for the SMC fuzzing module allocator.
+ *
+ * Replays a random alloc/free trace against smcmalloc()/smcfree() and
+ * reports the throughput and how fragmented the arena gets. Every
+ * allocation is filled with a pattern that is verified when it is freed,
+ * which catches blocks handed out twice.
+ *
+ * Usage: smcmalloc_stress [ops] [seed] [max_size]
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "fifo3d.h"
+
+#define MAX_LIVE		(256U)
+#define DEFAULT_OPS		(1000000UL)
+#define DEFAULT_MAX_SIZE	(2048U)
+#define SAMPLE_PERIOD		(1024UL)
+
+struct live_alloc {
+	unsigned char *ptr;
+	unsigned int size;
+	unsigned char pattern;
+};
+
+static struct memmod mmod __attribute__((aligned(16)));
+static struct live_alloc live[MAX_LIVE];
+
+/*
+ * Mostly small requests, like the bias tree nodes and name strings, with
+ * the occasional large array.
+ */
+static unsigned int random_size(unsigned int max_size)
+{
+	unsigned int r = (unsigned int)rand() % 100U;
+
+	if (r < 70U) {
+		return 1U + ((unsigned int)rand() % 64U);
+	}
+	if (r < 95U) {
+		return 1U + ((unsigned int)rand() % 512U);
+	}
+	return 1U + ((unsigned int)rand() % max_size);
+}
+
+static double now_sec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static int check_pattern(const struct live_alloc *la)
+{
+	for (unsigned int i = 0U; i < la->size; i++) {
+		if (la->ptr[i] != la->pattern) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long ops = DEFAULT_OPS;
+	unsigned int seed = 1U;
+	unsigned int max_size = DEFAULT_MAX_SIZE;
+	unsigned long nalloc = 0UL, nfree = 0UL, nfail = 0UL, nsample = 0UL;
+	unsigned int nlive = 0U;
+	double frag_sum = 0.0, frag_max = 0.0;
+	struct smcmalloc_stats st;
+	double start, elapsed;
+
+	if (argc > 1) {
+		ops = strtoul(argv[1], NULL, 0);
+	}
+	if (argc > 2) {
+		seed = (unsigned int)strtoul(argv[2], NULL, 0);
+	}
+	if (argc > 3) {
+		max_size = (unsigned int)strtoul(argv[3], NULL, 0);
+	}
+
+	srand(seed);
+	smcmalloc_init(&mmod);
+	mmod.checkadd = 1U;
+
+	start = now_sec();
+	for (unsigned long op = 0UL; op < ops; op++) {
+		unsigned int slot = (unsigned int)rand() % MAX_LIVE;
+		struct live_alloc *la = &live[slot];
+
+		if (la->ptr == NULL) {
+			la->size = random_size(max_size);
+			la->ptr = smcmalloc(la->size, &mmod);
+			if (la->ptr == NULL) {
+				mmod.memerror = 0U;
+				nfail++;
+				continue;
+			}
+			if (((uintptr_t)la->ptr % SMCMALLOC_GRANULE) != 0U) {
+				printf("FAIL: misaligned allocation %p\n",
+				       (void *)la->ptr);
+				return 1;
+			}
+			la->pattern = (unsigned char)(op & 0xffU);
+			memset(la->ptr, la->pattern, la->size);
+			nalloc++;
+			nlive++;
+		} else {
+			if (check_pattern(la) != 0) {
+				printf("FAIL: allocation %p of %u bytes was overwritten\n",
+				       (void *)la->ptr, la->size);
+				return 1;
+			}
+			smcfree(la->ptr, &mmod);
+			la->ptr = NULL;
+			nfree++;
+			nlive--;
+		}
+
+		if (mmod.memerror != 0U) {
+			printf("FAIL: allocator error %u at op %lu\n",
+			       mmod.memerror, op);
+			return 1;
+		}
+
+		if ((op % SAMPLE_PERIOD) == 0UL) {
+			double frag;
+
+			smcmalloc_stats(&mmod, &st);
+			frag = (st.freebytes == 0U) ? 0.0 :
+				1.0 - ((double)st.largestfree / st.freebytes);
+			frag_sum += frag;
+			if (frag > frag_max) {
+				frag_max = frag;
+			}
+			nsample++;
+		}
+	}
+	elapsed = now_sec() - start;
+
+	for (unsigned int i = 0U; i < MAX_LIVE; i++) {
+		if (live[i].ptr != NULL) {
+			if (check_pattern(&live[i]) != 0) {
+				printf("FAIL: allocation %p of %u bytes was overwritten\n",
+				       (void *)live[i].ptr, live[i].size);
+				return 1;
+			}
+			smcfree(live[i].ptr, &mmod);
+			live[i].ptr = NULL;
+		}
+	}
+
+	smcmalloc_stats(&mmod, &st);
+	if ((st.nusedblk != 0U) || (st.nfreeblk != 1U)) {
+		printf("FAIL: arena not fully coalesced, %u used %u free blocks\n",
+		       st.nusedblk, st.nfreeblk);
+		return 1;
+	}
+
+	printf("smcmalloc stress: %lu ops seed %u max size %u\n",
+	       ops, seed, max_size);
+	printf("  allocs %lu frees %lu failed allocs %lu live at end %u\n",
+	       nalloc, nfree, nfail, nlive);
+	printf("  throughput %.0f ops/s\n", (double)ops / elapsed);
+	printf("  peak usage %u of %u bytes\n", mmod.peakbytes,
+	       (unsigned int)TOTALMEMORYSIZE);
+	printf("  fragmentation (1 - largest free / total free) avg %.3f max %.3f\n",
+	       (nsample != 0UL) ? (frag_sum / nsample) : 0.0, frag_max);
+
+	return 0;
+}
@@ -14,10 +14,13 @@
 #include <string.h>
 #include "smcmalloc.h"
 
+struct fuzz_call_desc;
+
 struct fifo3d {
 	char ***nnfifo;
 	char ***fnamefifo;
 	int **biasfifo;
+	struct fuzz_call_desc ***cdfifo;
 	int col;
 	int curr_col;
 	int *row;
@@ -33,6 +36,15 @@ void push_3dfifo_fname(struct fifo3d *f3d, char *fname);
  */
 void push_3dfifo_bias(struct fifo3d *f3d, int bias);
 
+/*
+ * Push argument description into raw data structure. The description is
+ * allocated on the first argument of a node and handed over to the bias
+ * tree together with the node.
+ */
+void push_3dfifo_arg(struct fifo3d *f3d, unsigned int argn,
+		     const uint32_t *cells, unsigned int ncells,
+		     struct memmod *mmod);
+
 /*
  * Create new column and/or row for raw data structure for newly
  * found node from device tree
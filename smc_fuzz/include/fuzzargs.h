@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef FUZZARGS_H
+#define FUZZARGS_H
+
+#include <stdint.h>
+
+#include <tftf_lib.h>
+#include <utils_def.h>
+
+/*
+ * Typed argument generation for the SMC fuzzer.
+ *
+ * A leaf of the bias tree can describe the arguments of its SMC call with
+ * "argN" properties, N being the argument register (1 to 7). Each property
+ * is a list of argument classes, four cells per class:
+ *
+ *	argN = <class weight lo hi>, <class weight lo hi>, ...;
+ *
+ * On every call one class is drawn for each argument according to the
+ * weights and a value is generated from it. Arguments that are not
+ * described are passed as zero. The classes and the meaning of lo and hi
+ * are listed below.
+ */
+#define FUZZ_ARG_CONST		(0U)	/* lo */
+#define FUZZ_ARG_RANGE		(1U)	/* uniform within [lo, hi] */
+#define FUZZ_ARG_EVENT		(2U)	/* event number within [lo, hi], sign extended from 32 bits */
+#define FUZZ_ARG_MPIDR		(3U)	/* MPIDR of a present CPU */
+#define FUZZ_ARG_MPIDR_BAD	(4U)	/* MPIDR with random affinity fields */
+#define FUZZ_ARG_ADDR_MAPPED	(5U)	/* address within a mapped buffer, offset within [lo, hi] */
+#define FUZZ_ARG_ADDR_UNMAPPED	(6U)	/* address within [lo, hi], or an unmapped default when both are 0 */
+#define FUZZ_ARG_FLAGS		(7U)	/* random subset of the bits set in lo */
+#define FUZZ_ARG_NUM_CLASSES	(8U)
+
+#define FUZZ_ARG_MAX_ARGS	(7U)
+#define FUZZ_ARG_MAX_CLASSES	(4U)
+#define FUZZ_ARG_CELLS		(4U)
+
+/*
+ * Size of the mapped buffer addresses are generated in
+ */
+#define FUZZ_ARG_BUF_SIZE	(4096U)
+
+/*
+ * Region used by FUZZ_ARG_ADDR_UNMAPPED when the DTS gives no range.
+ * Nothing is mapped this high in the TFTF address space.
+ */
+#define FUZZ_ARG_UNMAPPED_BASE	(ULL(1) << 47)
+#define FUZZ_ARG_UNMAPPED_SIZE	(ULL(1) << 30)
+
+/*
+ * Identifier of a leaf whose function name has no SMC behind it
+ */
+#define FUZZ_FUNC_NONE		(-1)
+
+struct fuzz_arg_class {
+	uint32_t cls;
+	uint32_t weight;
+	uint32_t lo;
+	uint32_t hi;
+};
+
+struct fuzz_arg_desc {
+	uint32_t nclasses;
+	uint32_t totweight;
+	struct fuzz_arg_class classes[FUZZ_ARG_MAX_CLASSES];
+};
+
+/*
+ * Argument description of a bias tree leaf
+ */
+struct fuzz_call_desc {
+	uint32_t nargs;
+	struct fuzz_arg_desc args[FUZZ_ARG_MAX_ARGS];
+};
+
+/*
+ * Collect the CPU topology used by the MPIDR classes
+ */
+void fuzz_args_init(void);
+
+/*
+ * Resolve a function name from the DTS to a function identifier. This is
+ * done once when the bias tree is built so that calls do not compare
+ * strings. Returns FUZZ_FUNC_NONE for unknown names.
+ */
+int fuzz_func_lookup(const char *name);
+const char *fuzz_func_name(int funcid);
+
+/*
+ * Parse the big endian cells of an argN property into a description.
+ * Returns 0 on success, -1 if the property is malformed.
+ */
+int fuzz_args_parse(struct fuzz_call_desc *cd, unsigned int argn,
+		    const uint32_t *cells, unsigned int ncells);
+
+/*
+ * Build the SMC arguments of a call to funcid from its description,
+ * which may be NULL. The index of the class drawn for each argument is
+ * stored in chosen when it is not NULL.
+ */
+void fuzz_args_gen(int funcid, const struct fuzz_call_desc *cd,
+		   smc_args *args, uint8_t *chosen);
+
+/*
+ * Raise the weight of the classes drawn for a call
+ */
+void fuzz_args_reward(struct fuzz_call_desc *cd, const uint8_t *chosen,
+		      uint32_t step, uint32_t max);
+
+/*
+ * Print the argN properties of a description in DTS form
+ */
+void fuzz_args_print(const struct fuzz_call_desc *cd, unsigned int depth);
+
+#endif /* FUZZARGS_H */
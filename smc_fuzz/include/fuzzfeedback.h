@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef FUZZFEEDBACK_H
+#define FUZZFEEDBACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Maximum number of distinct return codes tracked per SMC call
+ */
+#define FUZZ_FB_MAX_RETCODES	(8U)
+
+/*
+ * Number of calls of a given function before latency outliers are
+ * considered. This lets the running average settle first.
+ */
+#define FUZZ_FB_WARMUP_CALLS	(8U)
+
+/*
+ * A call is an outlier when its latency exceeds the running average
+ * of the function by this factor.
+ */
+#define FUZZ_FB_OUTLIER_FACTOR	(4U)
+
+/*
+ * Bias increment applied on every node of the selection path when a
+ * call produces new behaviour, and the ceiling a bias can reach.
+ */
+#define FUZZ_FB_BIAS_STEP	(5)
+#define FUZZ_FB_BIAS_MAX	(1000)
+
+/*
+ * Maximum depth of the bias tree tracked for feedback
+ */
+#define FUZZ_FB_MAX_DEPTH	(16U)
+
+/*
+ * Measurement taken around a single SMC call. On entry to
+ * fuzz_fb_sample_end() the fields hold the start values; on exit
+ * they hold the deltas.
+ */
+struct fuzz_fb_sample {
+	unsigned long long ticks;
+	unsigned long long cycles;
+	unsigned long long insts;
+};
+
+/*
+ * Feedback statistics accumulated for a single entry of the bias tree
+ */
+struct fuzz_fb_stats {
+	unsigned int calls;
+	unsigned int nretcodes;
+	int64_t retcodes[FUZZ_FB_MAX_RETCODES];
+	unsigned long long ticks_sum;
+	unsigned long long ticks_min;
+	unsigned long long ticks_max;
+	unsigned long long cycles_sum;
+	unsigned long long insts_sum;
+	unsigned int rewards;
+};
+
+/*
+ * Probe for FEAT_PMUv3 and program the cycle and instruction counters
+ */
+void fuzz_fb_init(void);
+
+/*
+ * Restore the PMU configuration that fuzz_fb_init() changed
+ */
+void fuzz_fb_teardown(void);
+
+/*
+ * Reset the statistics of a bias tree entry
+ */
+void fuzz_fb_stats_init(struct fuzz_fb_stats *st);
+
+/*
+ * Take the start and end measurements around an SMC call. A NULL
+ * sample is ignored so the call sites need not test for feedback mode.
+ */
+void fuzz_fb_sample_start(struct fuzz_fb_sample *s);
+void fuzz_fb_sample_end(struct fuzz_fb_sample *s);
+
+/*
+ * Account a call outcome. Returns true when the call produced a return
+ * code not seen before or an outlier latency, in which case the caller
+ * should reward the selection path that led to it.
+ */
+bool fuzz_fb_record(struct fuzz_fb_stats *st, int64_t ret,
+		    const struct fuzz_fb_sample *s);
+
+/*
+ * Print statistics of a bias tree entry as a DTS comment
+ */
+void fuzz_fb_print_stats(const struct fuzz_fb_stats *st);
+
+#endif /* FUZZFEEDBACK_H */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2024, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -8,57 +8,62 @@
 #define SMCMALLOC_H
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "fifo3d.h"
 
 #define TOTALMEMORYSIZE (0x10000)
-#define BLKSPACEDIV (4)
-#define TOPBITSIZE (20)
 #define MAX_NAME_CHARS 50
 
-struct memblk {
-	unsigned int address;
-	unsigned int size;
-	int valid;
-};
+/*
+ * Blocks are carved out of the arena in multiples of SMCMALLOC_GRANULE so
+ * that the low bits of the size field are free to hold the block flags.
+ * Every block starts with an 8 byte header, which keeps the returned
+ * addresses SMCMALLOC_GRANULE aligned.
+ */
+#define SMCMALLOC_GRANULE	(16U)
+#define SMCMALLOC_HDR_SIZE	(8U)
+#define SMCMALLOC_MIN_BLOCK	(32U)
+
+/*
+ * Free blocks are kept on segregated lists, one per power of two size
+ * class. Class n holds the free blocks whose size lies within
+ * [2^(n + SMCMALLOC_MIN_SHIFT), 2^(n + SMCMALLOC_MIN_SHIFT + 1)).
+ */
+#define SMCMALLOC_MIN_SHIFT	(5U)
+#define SMCMALLOC_NUM_CLASSES	(12U)
 
 struct memmod {
 	char memory[TOTALMEMORYSIZE];
-	unsigned int nmemblk;
-	unsigned int maxmemblk;
+	uint32_t freelist[SMCMALLOC_NUM_CLASSES];
+	uint32_t classmap;
 	unsigned int checkadd;
-	struct memblk *memptr;
-	struct memblk *memptrend;
-	unsigned int mallocdeladd[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	struct memblk *precblock[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	struct memblk *trailblock[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	struct memblk *memblkqueue[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int memallocsize[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int mallocdeladd_valid[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int mallocdeladd_queue[((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int checksa[4*((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int checkea[4*((TOTALMEMORYSIZE/BLKSPACEDIV)/sizeof(struct memblk))];
-	unsigned int cntdeladd;
-	unsigned int ptrmemblkqueue;
-	unsigned int mallocdeladd_queue_cnt;
-	unsigned int checknumentries;
+	unsigned int nalloc;
+	unsigned int allocbytes;
+	unsigned int peakbytes;
 	unsigned int memerror;
 };
 
-struct peret {
-	unsigned int tbit;
-	unsigned int pow2;
+/*
+ * Snapshot of the arena usage, see smcmalloc_stats()
+ */
+struct smcmalloc_stats {
+	unsigned int usedbytes;
+	unsigned int freebytes;
+	unsigned int largestfree;
+	unsigned int nfreeblk;
+	unsigned int nusedblk;
 };
 
-void initmem(void);
-struct peret priorityencoder(unsigned int);
+void smcmalloc_init(struct memmod *mmod);
 void *smcmalloc(unsigned int, struct memmod*);
 int smcfree(void*, struct memmod *);
+void smcmalloc_stats(struct memmod *mmod, struct smcmalloc_stats *st);
 #ifdef DEBUG_SMC_MALLOC
+int smcmalloc_check(struct memmod *);
 void displayblocks(struct memmod *);
-void displaymalloctable(struct memmod *);
 #endif
 
 #endif /* SMCMALLOC_H */
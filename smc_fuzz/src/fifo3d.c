@@ -8,6 +8,7 @@
 #include <drivers/arm/private_timer.h>
 #include <events.h>
 #include "fifo3d.h"
+#include "fuzzargs.h"
 #include <libfdt.h>
 
 #include <power_management.h>
@@ -43,6 +44,28 @@ void push_3dfifo_bias(struct fifo3d *f3d, int bias)
 	f3d->biasfifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1] = bias;
 }
 
+/*
+ * Push argument description into raw data structure
+ */
+void push_3dfifo_arg(struct fifo3d *f3d, unsigned int argn,
+		     const uint32_t *cells, unsigned int ncells,
+		     struct memmod *mmod)
+{
+	struct fuzz_call_desc **cd =
+		&f3d->cdfifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1];
+
+	if (*cd == NULL) {
+		*cd = GENMALLOC(sizeof(struct fuzz_call_desc));
+		if (mmod->memerror != 0) {
+			return;
+		}
+		memset(*cd, 0, sizeof(struct fuzz_call_desc));
+	}
+	if (fuzz_args_parse(*cd, argn, cells, ncells) != 0) {
+		mmod->memerror = 10U;
+	}
+}
+
 /*
  * Create new column and/or row for raw data structure for newly
  * found node from device tree
@@ -52,6 +75,7 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 	char ***tnnfifo;
 	char ***tfnamefifo;
 	int **tbiasfifo;
+	struct fuzz_call_desc ***tcdfifo;
 
 	if (f3d->col == f3d->curr_col) {
 		f3d->col++;
@@ -81,10 +105,12 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 		tnnfifo = GENMALLOC(f3d->col * sizeof(char **));
 		tfnamefifo = GENMALLOC(f3d->col * sizeof(char **));
 		tbiasfifo = GENMALLOC((f3d->col) * sizeof(int *));
+		tcdfifo = GENMALLOC((f3d->col) * sizeof(struct fuzz_call_desc **));
 		for (unsigned int i = 0U; (int)i < f3d->col; i++) {
 			tnnfifo[i] = GENMALLOC(f3d->row[i] * sizeof(char *));
 			tfnamefifo[i] = GENMALLOC(f3d->row[i] * sizeof(char *));
 			tbiasfifo[i] = GENMALLOC((f3d->row[i]) * sizeof(int));
+			tcdfifo[i] = GENMALLOC((f3d->row[i]) * sizeof(struct fuzz_call_desc *));
 			for (unsigned int j = 0U; (int)j < f3d->row[i]; j++) {
 				tnnfifo[i][j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
 				tfnamefifo[i][j] =
@@ -95,6 +121,7 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 					strlcpy(tfnamefifo[i][j],
 						f3d->fnamefifo[i][j], MAX_NAME_CHARS);
 					tbiasfifo[i][j] = f3d->biasfifo[i][j];
+					tcdfifo[i][j] = f3d->cdfifo[i][j];
 				}
 			}
 		}
@@ -107,6 +134,7 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 		strlcpy(tfnamefifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1],
 			"none", MAX_NAME_CHARS);
 		tbiasfifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1] = 0;
+		tcdfifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1] = NULL;
 
 		/*
 		 * Free the old raw data structres
@@ -119,11 +147,13 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 			GENFREE(f3d->nnfifo[i]);
 			GENFREE(f3d->fnamefifo[i]);
 			GENFREE(f3d->biasfifo[i]);
+			GENFREE(f3d->cdfifo[i]);
 		}
 		if (f3d->col > 1) {
 			GENFREE(f3d->nnfifo);
 			GENFREE(f3d->fnamefifo);
 			GENFREE(f3d->biasfifo);
+			GENFREE(f3d->cdfifo);
 		}
 
 		/*
@@ -132,6 +162,7 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 		f3d->nnfifo = tnnfifo;
 		f3d->fnamefifo = tfnamefifo;
 		f3d->biasfifo = tbiasfifo;
+		f3d->cdfifo = tcdfifo;
 	}
 	if (f3d->col != f3d->curr_col) {
 		/*
@@ -146,10 +177,12 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 		tnnfifo = GENMALLOC(f3d->col * sizeof(char **));
 		tfnamefifo = GENMALLOC(f3d->col * sizeof(char **));
 		tbiasfifo = GENMALLOC((f3d->col) * sizeof(int *));
+		tcdfifo = GENMALLOC((f3d->col) * sizeof(struct fuzz_call_desc **));
 		for (unsigned int i = 0U; (int)i < f3d->col; i++) {
 			tnnfifo[i] = GENMALLOC(f3d->row[i] * sizeof(char *));
 			tfnamefifo[i] = GENMALLOC(f3d->row[i] * sizeof(char *));
 			tbiasfifo[i] = GENMALLOC((f3d->row[i]) * sizeof(int));
+			tcdfifo[i] = GENMALLOC((f3d->row[i]) * sizeof(struct fuzz_call_desc *));
 			for (unsigned int j = 0U; (int)j < f3d->row[i]; j++) {
 				tnnfifo[i][j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
 				tfnamefifo[i][j] =
@@ -160,6 +193,7 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 					strlcpy(tfnamefifo[i][j],
 						f3d->fnamefifo[i][j], MAX_NAME_CHARS);
 					tbiasfifo[i][j] = f3d->biasfifo[i][j];
+					tcdfifo[i][j] = f3d->cdfifo[i][j];
 				}
 			}
 		}
@@ -172,6 +206,7 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 		strlcpy(tfnamefifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1],
 			"none", MAX_NAME_CHARS);
 		tbiasfifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1] = 0;
+		tcdfifo[f3d->col - 1][f3d->row[f3d->col - 1] - 1] = NULL;
 
 		/*
 		 * Free the old raw data structres
@@ -187,10 +222,12 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 			GENFREE(f3d->nnfifo[i]);
 			GENFREE(f3d->fnamefifo[i]);
 			GENFREE(f3d->biasfifo[i]);
+			GENFREE(f3d->cdfifo[i]);
 		}
 		GENFREE(f3d->nnfifo);
 		GENFREE(f3d->fnamefifo);
 		GENFREE(f3d->biasfifo);
+		GENFREE(f3d->cdfifo);
 
 		/*
 		 * Point to new data
@@ -198,5 +235,6 @@ void push_3dfifo_col(struct fifo3d *f3d, char *entry, struct memmod *mmod)
 		f3d->nnfifo = tnnfifo;
 		f3d->fnamefifo = tfnamefifo;
 		f3d->biasfifo = tbiasfifo;
+		f3d->cdfifo = tcdfifo;
 	}
 }
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch.h>
+#include <debug.h>
+#include "fuzzargs.h"
+#include <libfdt.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <sdei.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct fuzz_func {
+	const char *name;
+	uint32_t fid;
+};
+
+/*
+ * SMC calls the bias tree leaves can name through "functionname"
+ */
+static const struct fuzz_func fuzz_funcs[] = {
+	{ "sdei_version",		SDEI_VERSION },
+	{ "sdei_event_register",	SDEI_EVENT_REGISTER },
+	{ "sdei_event_enable",		SDEI_EVENT_ENABLE },
+	{ "sdei_event_disable",		SDEI_EVENT_DISABLE },
+	{ "sdei_event_context",		SDEI_EVENT_CONTEXT },
+	{ "sdei_event_unregister",	SDEI_EVENT_UNREGISTER },
+	{ "sdei_event_status",		SDEI_EVENT_STATUS },
+	{ "sdei_event_get_info",	SDEI_EVENT_GET_INFO },
+	{ "sdei_event_routing_set",	SDEI_EVENT_ROUTING_SET },
+	{ "sdei_pe_mask",		SDEI_PE_MASK },
+	{ "sdei_pe_unmask",		SDEI_PE_UNMASK },
+	{ "sdei_interrupt_bind",	SDEI_INTERRUPT_BIND },
+	{ "sdei_interrupt_release",	SDEI_INTERRUPT_RELEASE },
+	{ "sdei_event_signal",		SDEI_EVENT_SIGNAL },
+	{ "sdei_features",		SDEI_FEATURES },
+	{ "sdei_private_reset",		SDEI_PRIVATE_RESET },
+	{ "sdei_shared_reset",		SDEI_SHARED_RESET },
+};
+
+static uint8_t fuzz_arg_buf[FUZZ_ARG_BUF_SIZE] __aligned(PAGE_SIZE);
+static u_register_t fuzz_mpidrs[PLATFORM_CORE_COUNT];
+static unsigned int fuzz_nmpidrs;
+
+void fuzz_args_init(void)
+{
+	unsigned int cpu_node;
+
+	fuzz_nmpidrs = 0U;
+	for_each_cpu(cpu_node) {
+		fuzz_mpidrs[fuzz_nmpidrs++] = tftf_get_mpidr_from_node(cpu_node);
+	}
+}
+
+int fuzz_func_lookup(const char *name)
+{
+	for (unsigned int i = 0U; i < ARRAY_SIZE(fuzz_funcs); i++) {
+		if (strcmp(name, fuzz_funcs[i].name) == 0) {
+			return (int)i;
+		}
+	}
+	return FUZZ_FUNC_NONE;
+}
+
+const char *fuzz_func_name(int funcid)
+{
+	return (funcid == FUZZ_FUNC_NONE) ? "none" : fuzz_funcs[funcid].name;
+}
+
+int fuzz_args_parse(struct fuzz_call_desc *cd, unsigned int argn,
+		    const uint32_t *cells, unsigned int ncells)
+{
+	struct fuzz_arg_desc *ad;
+
+	if ((argn == 0U) || (argn > FUZZ_ARG_MAX_ARGS) ||
+	    (ncells == 0U) || ((ncells % FUZZ_ARG_CELLS) != 0U) ||
+	    ((ncells / FUZZ_ARG_CELLS) > FUZZ_ARG_MAX_CLASSES)) {
+		printf("ERROR: malformed arg%u property, %u cells\n",
+		       argn, ncells);
+		return -1;
+	}
+
+	ad = &cd->args[argn - 1U];
+	ad->nclasses = ncells / FUZZ_ARG_CELLS;
+	ad->totweight = 0U;
+	for (unsigned int i = 0U; i < ad->nclasses; i++) {
+		struct fuzz_arg_class *ac = &ad->classes[i];
+
+		ac->cls = fdt32_to_cpu(cells[(i * FUZZ_ARG_CELLS) + 0U]);
+		ac->weight = fdt32_to_cpu(cells[(i * FUZZ_ARG_CELLS) + 1U]);
+		ac->lo = fdt32_to_cpu(cells[(i * FUZZ_ARG_CELLS) + 2U]);
+		ac->hi = fdt32_to_cpu(cells[(i * FUZZ_ARG_CELLS) + 3U]);
+		if ((ac->cls >= FUZZ_ARG_NUM_CLASSES) || (ac->lo > ac->hi &&
+		    ((ac->cls == FUZZ_ARG_RANGE) || (ac->cls == FUZZ_ARG_EVENT) ||
+		     (ac->cls == FUZZ_ARG_ADDR_MAPPED) ||
+		     (ac->cls == FUZZ_ARG_ADDR_UNMAPPED)))) {
+			printf("ERROR: bad class %u range 0x%x-0x%x in arg%u\n",
+			       ac->cls, ac->lo, ac->hi, argn);
+			ad->nclasses = 0U;
+			return -1;
+		}
+		ad->totweight += ac->weight;
+	}
+
+	if (ad->totweight == 0U) {
+		printf("ERROR: arg%u has no weight\n", argn);
+		ad->nclasses = 0U;
+		return -1;
+	}
+
+	if (argn > cd->nargs) {
+		cd->nargs = argn;
+	}
+	return 0;
+}
+
+static inline uint64_t fuzz_rand64(void)
+{
+	return ((uint64_t)rand() << 62) ^ ((uint64_t)rand() << 31) ^
+		(uint64_t)rand();
+}
+
+/*
+ * Uniform value within [lo, hi]
+ */
+static inline uint64_t fuzz_rand_range(uint64_t lo, uint64_t hi)
+{
+	uint64_t span = hi - lo + 1ULL;
+
+	return (span == 0ULL) ? fuzz_rand64() : (lo + (fuzz_rand64() % span));
+}
+
+static u_register_t fuzz_arg_value(const struct fuzz_arg_class *ac)
+{
+	switch (ac->cls) {
+	case FUZZ_ARG_CONST:
+		return ac->lo;
+	case FUZZ_ARG_RANGE:
+		return fuzz_rand_range(ac->lo, ac->hi);
+	case FUZZ_ARG_EVENT:
+		return (u_register_t)(int64_t)(int32_t)fuzz_rand_range(ac->lo, ac->hi);
+	case FUZZ_ARG_MPIDR:
+		return fuzz_mpidrs[(unsigned int)rand() % fuzz_nmpidrs];
+	case FUZZ_ARG_MPIDR_BAD:
+		return fuzz_rand64() & (MPIDR_AFFLVL_MASK << MPIDR_AFF3_SHIFT |
+					MPIDR_AFFLVL_MASK << MPIDR_AFF2_SHIFT |
+					MPIDR_AFFLVL_MASK << MPIDR_AFF1_SHIFT |
+					MPIDR_AFFLVL_MASK << MPIDR_AFF0_SHIFT);
+	case FUZZ_ARG_ADDR_MAPPED:
+		return (uintptr_t)fuzz_arg_buf +
+			(fuzz_rand_range(ac->lo, ac->hi) % FUZZ_ARG_BUF_SIZE);
+	case FUZZ_ARG_ADDR_UNMAPPED:
+		if ((ac->lo == 0U) && (ac->hi == 0U)) {
+			return FUZZ_ARG_UNMAPPED_BASE +
+				(fuzz_rand64() % FUZZ_ARG_UNMAPPED_SIZE);
+		}
+		return fuzz_rand_range(ac->lo, ac->hi);
+	case FUZZ_ARG_FLAGS:
+		return fuzz_rand64() & ac->lo;
+	default:
+		return 0U;
+	}
+}
+
+void fuzz_args_gen(int funcid, const struct fuzz_call_desc *cd,
+		   smc_args *args, uint8_t *chosen)
+{
+	u_register_t regs[FUZZ_ARG_MAX_ARGS] = { 0 };
+
+	*args = (smc_args){ fuzz_funcs[funcid].fid };
+	if (cd == NULL) {
+		return;
+	}
+
+	for (unsigned int i = 0U; i < cd->nargs; i++) {
+		const struct fuzz_arg_desc *ad = &cd->args[i];
+		unsigned int sel = 0U;
+
+		if (ad->nclasses == 0U) {
+			continue;
+		}
+
+		if (ad->nclasses > 1U) {
+			uint32_t nch = (uint32_t)rand() % ad->totweight;
+
+			while (nch >= ad->classes[sel].weight) {
+				nch -= ad->classes[sel].weight;
+				sel++;
+			}
+		}
+
+		regs[i] = fuzz_arg_value(&ad->classes[sel]);
+		if (chosen != NULL) {
+			chosen[i] = (uint8_t)sel;
+		}
+	}
+
+	args->arg1 = regs[0];
+	args->arg2 = regs[1];
+	args->arg3 = regs[2];
+	args->arg4 = regs[3];
+	args->arg5 = regs[4];
+	args->arg6 = regs[5];
+	args->arg7 = regs[6];
+}
+
+void fuzz_args_reward(struct fuzz_call_desc *cd, const uint8_t *chosen,
+		      uint32_t step, uint32_t max)
+{
+	for (unsigned int i = 0U; i < cd->nargs; i++) {
+		struct fuzz_arg_desc *ad = &cd->args[i];
+		struct fuzz_arg_class *ac;
+		uint32_t nweight;
+
+		if (ad->nclasses < 2U) {
+			continue;
+		}
+
+		ac = &ad->classes[chosen[i]];
+		nweight = MIN(ac->weight + step, max);
+		ad->totweight += nweight - ac->weight;
+		ac->weight = nweight;
+	}
+}
+
+void fuzz_args_print(const struct fuzz_call_desc *cd, unsigned int depth)
+{
+	for (unsigned int i = 0U; i < cd->nargs; i++) {
+		const struct fuzz_arg_desc *ad = &cd->args[i];
+
+		if (ad->nclasses == 0U) {
+			continue;
+		}
+
+		for (unsigned int d = 0U; d < depth; d++) {
+			printf("\t");
+		}
+		printf("arg%u = ", i + 1U);
+		for (unsigned int j = 0U; j < ad->nclasses; j++) {
+			const struct fuzz_arg_class *ac = &ad->classes[j];
+
+			printf("%s<%u %u 0x%x 0x%x>", (j == 0U) ? "" : ", ",
+			       ac->cls, ac->weight, ac->lo, ac->hi);
+		}
+		printf(";\n");
+	}
+}
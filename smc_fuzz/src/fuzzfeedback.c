@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_features.h>
+#include <arch_helpers.h>
+#include <debug.h>
+#include "fuzzfeedback.h"
+
+#include <utils_def.h>
+
+#define PMU_EVT_INST_RETIRED	(0x0008)
+
+static bool fuzz_fb_pmu;
+
+/* PMU configuration of tftf before fuzz_fb_init(), put back on teardown */
+static u_register_t saved_pmcr;
+static u_register_t saved_pmccfiltr;
+static u_register_t saved_pmevtyper0;
+static u_register_t saved_pmcntenset;
+
+/*
+ * tftf runs in EL2, so only count at non-secure EL2. Whatever the secure
+ * world lets leak into the counters is part of the feedback as well.
+ */
+void fuzz_fb_init(void)
+{
+	fuzz_fb_pmu = false;
+
+#ifdef __aarch64__
+	if (!get_feat_pmuv3_supported()) {
+		return;
+	}
+
+	saved_pmcr = read_pmcr_el0();
+	saved_pmccfiltr = read_pmccfiltr_el0();
+	saved_pmevtyper0 = read_pmevtyper0_el0();
+	saved_pmcntenset = read_pmcntenset_el0();
+
+	write_pmccfiltr_el0(PMCCFILTR_EL0_NSH_BIT);
+	write_pmevtyper0_el0(PMEVTYPER_EL0_NSH_BIT |
+		(PMU_EVT_INST_RETIRED & PMEVTYPER_EL0_EVTCOUNT_BITS));
+	write_pmcntenset_el0(saved_pmcntenset | PMCNTENSET_EL0_C_BIT |
+			     PMCNTENSET_EL0_P_BIT(0));
+	write_pmcr_el0(saved_pmcr | PMCR_EL0_LC_BIT | PMCR_EL0_E_BIT);
+	isb();
+
+	fuzz_fb_pmu = true;
+#endif
+}
+
+void fuzz_fb_teardown(void)
+{
+#ifdef __aarch64__
+	if (!fuzz_fb_pmu) {
+		return;
+	}
+
+	write_pmcr_el0(saved_pmcr);
+	write_pmcntenclr_el0(~saved_pmcntenset &
+			     (PMCNTENSET_EL0_C_BIT | PMCNTENSET_EL0_P_BIT(0)));
+	write_pmccfiltr_el0(saved_pmccfiltr);
+	write_pmevtyper0_el0(saved_pmevtyper0);
+	isb();
+
+	fuzz_fb_pmu = false;
+#endif
+}
+
+void fuzz_fb_stats_init(struct fuzz_fb_stats *st)
+{
+	st->calls = 0U;
+	st->nretcodes = 0U;
+	st->ticks_sum = 0ULL;
+	st->ticks_min = UINT64_MAX;
+	st->ticks_max = 0ULL;
+	st->cycles_sum = 0ULL;
+	st->insts_sum = 0ULL;
+	st->rewards = 0U;
+}
+
+void fuzz_fb_sample_start(struct fuzz_fb_sample *s)
+{
+	if (s == NULL) {
+		return;
+	}
+
+#ifdef __aarch64__
+	if (fuzz_fb_pmu) {
+		s->cycles = read_pmccntr_el0();
+		s->insts = read_pmevcntr0_el0();
+	}
+#endif
+	isb();
+	s->ticks = read_cntpct_el0();
+}
+
+void fuzz_fb_sample_end(struct fuzz_fb_sample *s)
+{
+	if (s == NULL) {
+		return;
+	}
+
+	isb();
+	s->ticks = read_cntpct_el0() - s->ticks;
+#ifdef __aarch64__
+	if (fuzz_fb_pmu) {
+		s->cycles = read_pmccntr_el0() - s->cycles;
+		s->insts = (read_pmevcntr0_el0() - s->insts) & UINT32_MAX;
+		return;
+	}
+#endif
+	s->cycles = 0ULL;
+	s->insts = 0ULL;
+}
+
+bool fuzz_fb_record(struct fuzz_fb_stats *st, int64_t ret,
+		    const struct fuzz_fb_sample *s)
+{
+	bool novel = true;
+
+	for (unsigned int i = 0U; i < st->nretcodes; i++) {
+		if (st->retcodes[i] == ret) {
+			novel = false;
+			break;
+		}
+	}
+
+	if (novel && (st->nretcodes < FUZZ_FB_MAX_RETCODES)) {
+		st->retcodes[st->nretcodes++] = ret;
+	}
+
+	/*
+	 * Compare against the average before this sample is accounted so a
+	 * single slow call is not hidden by its own contribution.
+	 */
+	if (st->calls >= FUZZ_FB_WARMUP_CALLS) {
+		unsigned long long avg = st->ticks_sum / st->calls;
+
+		/* Calls faster than a tick give no latency to compare with */
+		if ((avg != 0ULL) &&
+		    (s->ticks > (avg * FUZZ_FB_OUTLIER_FACTOR))) {
+			novel = true;
+		}
+	}
+
+	st->calls++;
+	st->ticks_sum += s->ticks;
+	st->ticks_min = MIN(st->ticks_min, s->ticks);
+	st->ticks_max = MAX(st->ticks_max, s->ticks);
+	st->cycles_sum += s->cycles;
+	st->insts_sum += s->insts;
+
+	if (novel) {
+		st->rewards++;
+	}
+
+	return novel;
+}
+
+void fuzz_fb_print_stats(const struct fuzz_fb_stats *st)
+{
+	if (st->calls == 0U) {
+		printf("/* not called */\n");
+		return;
+	}
+
+	printf("/* calls %u rewards %u ticks avg %llu min %llu max %llu",
+	       st->calls, st->rewards, st->ticks_sum / st->calls,
+	       st->ticks_min, st->ticks_max);
+	if (fuzz_fb_pmu) {
+		printf(" cycles avg %llu insts avg %llu",
+		       st->cycles_sum / st->calls, st->insts_sum / st->calls);
+	}
+	printf(" retcodes");
+	for (unsigned int i = 0U; i < st->nretcodes; i++) {
+		printf(" %lld", (long long)st->retcodes[i]);
+	}
+	printf(" */\n");
+}
@@ -9,12 +9,15 @@
 #include <drivers/arm/private_timer.h>
 #include <events.h>
 #include "fifo3d.h"
+#include "fuzzargs.h"
+#include "fuzzfeedback.h"
 #include <libfdt.h>
 
 #include <power_management.h>
 #include <sdei.h>
 #include <tftf_lib.h>
 #include <timer.h>
+#include <utils_def.h>
 
 #include <plat_topology.h>
 #include <platform.h>
@@ -126,6 +129,11 @@ struct rand_smc_node {
 	int biasent;				// Number that gives the total number of entries in biasarray
 						// based on all biases of the nodes
 	char **nname;				// Array of node names
+	int *funcid;				// Function identifiers of the leaf nodes
+	struct fuzz_call_desc **calldesc;	// Argument descriptions of the leaf nodes, NULL if none
+#if SMC_FUZZ_FEEDBACK
+	struct fuzz_fb_stats *fbstats;		// Feedback statistics of the individual nodes
+#endif
 };
 
 
@@ -241,6 +249,14 @@ struct rand_smc_node *createsmctree(int *casz,
 					bias_count = 0U;
 				}
 			}
+			if ((strncmp(cset, "arg", 3) == 0) && (cset[3] >= '1') &&
+			    (cset[3] <= '7') && (cset[4] == 0)) {
+				unsigned int plen = fdt32_to_cpu(pv.len);
+
+				push_3dfifo_arg(&f3d, cset[3] - '0', (uint32_t *)dtb,
+						plen / sizeof(uint32_t), mmod);
+				dtb += (plen + 3U) & ~3U;
+			}
 			if (strcmp(cset, "functionname") == 0) {
 				pullstringdt(&dtb, dtb_beg, 0, cset);
 				push_3dfifo_fname(&f3d, cset);
@@ -282,6 +298,8 @@ struct rand_smc_node *createsmctree(int *casz,
 					tndarray[j].norcall = GENMALLOC(ndarray[j].entries * sizeof(int));
 					tndarray[j].nname = GENMALLOC(ndarray[j].entries * sizeof(char *));
 					tndarray[j].treenodes = GENMALLOC(ndarray[j].entries * sizeof(struct rand_smc_node));
+					tndarray[j].funcid = GENMALLOC(ndarray[j].entries * sizeof(int));
+					tndarray[j].calldesc = GENMALLOC(ndarray[j].entries * sizeof(struct fuzz_call_desc *));
 					tndarray[j].entries = ndarray[j].entries;
 					for (unsigned int i = 0U; (int)i < ndarray[j].entries; i++) {
 						tndarray[j].snames[i] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
@@ -290,6 +308,8 @@ struct rand_smc_node *createsmctree(int *casz,
 						strlcpy(tndarray[j].nname[i], ndarray[j].nname[i], MAX_NAME_CHARS);
 						tndarray[j].biases[i] = ndarray[j].biases[i];
 						tndarray[j].norcall[i] = ndarray[j].norcall[i];
+						tndarray[j].funcid[i] = ndarray[j].funcid[i];
+						tndarray[j].calldesc[i] = ndarray[j].calldesc[i];
 						if (tndarray[j].norcall[i] == 1) {
 							tndarray[j].treenodes[i] = tndarray[treenodetrackmal];
 							treenodetrackmal++;
@@ -306,6 +326,8 @@ struct rand_smc_node *createsmctree(int *casz,
 				tndarray[cntndarray].norcall = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(int));
 				tndarray[cntndarray].nname = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(char *));
 				tndarray[cntndarray].treenodes = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(struct rand_smc_node));
+				tndarray[cntndarray].funcid = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(int));
+				tndarray[cntndarray].calldesc = GENMALLOC(f3d.row[f3d.col + 1] * sizeof(struct fuzz_call_desc *));
 				tndarray[cntndarray].entries = f3d.row[f3d.col + 1];
 
 				/*
@@ -319,10 +341,14 @@ struct rand_smc_node *createsmctree(int *casz,
 					tndarray[cntndarray].nname[j] = GENMALLOC(1 * sizeof(char[MAX_NAME_CHARS]));
 					strlcpy(tndarray[cntndarray].nname[j], f3d.nnfifo[f3d.col + 1][j], MAX_NAME_CHARS);
 					tndarray[cntndarray].biases[j] = f3d.biasfifo[f3d.col + 1][j];
+					tndarray[cntndarray].calldesc[j] = f3d.cdfifo[f3d.col + 1][j];
+					tndarray[cntndarray].funcid[j] = FUZZ_FUNC_NONE;
 					cntbias += tndarray[cntndarray].biases[j];
 					if (strcmp(tndarray[cntndarray].snames[j], "none") != 0) {
 						strlcpy(tndarray[cntndarray].snames[j], f3d.fnamefifo[f3d.col + 1][j], MAX_NAME_CHARS);
 						tndarray[cntndarray].norcall[j] = 0;
+						tndarray[cntndarray].funcid[j] =
+							fuzz_func_lookup(tndarray[cntndarray].snames[j]);
 						tndarray[cntndarray].treenodes[j] = nrnode;
 					} else {
 						tndarray[cntndarray].norcall[j] = 1;
@@ -357,6 +383,8 @@ struct rand_smc_node *createsmctree(int *casz,
 						GENFREE(ndarray[j].snames);
 						GENFREE(ndarray[j].nname);
 						GENFREE(ndarray[j].treenodes);
+						GENFREE(ndarray[j].funcid);
+						GENFREE(ndarray[j].calldesc);
 					}
 					GENFREE(ndarray);
 				}
@@ -377,6 +405,7 @@ struct rand_smc_node *createsmctree(int *casz,
 				GENFREE(f3d.nnfifo[f3d.col + 1]);
 				GENFREE(f3d.fnamefifo[f3d.col + 1]);
 				GENFREE(f3d.biasfifo[f3d.col + 1]);
+				GENFREE(f3d.cdfifo[f3d.col + 1]);
 				f3d.curr_col -= 1;
 			}
 		}
@@ -393,10 +422,12 @@ struct rand_smc_node *createsmctree(int *casz,
 				GENFREE(f3d.nnfifo[i]);
 				GENFREE(f3d.fnamefifo[i]);
 				GENFREE(f3d.biasfifo[i]);
+				GENFREE(f3d.cdfifo[i]);
 			}
 			GENFREE(f3d.nnfifo);
 			GENFREE(f3d.fnamefifo);
 			GENFREE(f3d.biasfifo);
+			GENFREE(f3d.cdfifo);
 			GENFREE(f3d.row);
 			dtdone = 1;
 		}
@@ -408,66 +439,146 @@ struct rand_smc_node *createsmctree(int *casz,
 }
 
 /*
- * Running SMC call from what function name is selected
+ * Running SMC call of the selected leaf. The arguments are generated from
+ * the leaf argument description, if any, and the index of the argument
+ * class drawn for each argument is returned in chosen.
+ * When a sample is supplied the SMC call itself is measured into it.
+ * Returns the value returned by the SMC call.
  */
-void runtestfunction(char *funcstr)
+int64_t runtestfunction(int funcid, const struct fuzz_call_desc *cd,
+			uint8_t *chosen, struct fuzz_fb_sample *sample)
 {
-	if (strcmp(funcstr, "sdei_version") == 0) {
-		long long ret = sdei_version();
-		if (ret != MAKE_SDEI_VERSION(1, 0, 0)) {
-			tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
+	smc_args args;
+	smc_ret_values ret;
+
+	if (funcid == FUZZ_FUNC_NONE) {
+		return 0;
 	}
-	if (strcmp(funcstr, "sdei_pe_unmask") == 0) {
-		long long ret = sdei_pe_unmask();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI pe unmask failed: 0x%llx\n",
-					     ret);
-		}
-		printf("running %s\n", funcstr);
+
+	fuzz_args_gen(funcid, cd, &args, chosen);
+
+	fuzz_fb_sample_start(sample);
+	ret = tftf_smc(&args);
+	fuzz_fb_sample_end(sample);
+
+	/*
+	 * Failures are only worth reporting for calls made with fixed
+	 * arguments, generated arguments are expected to be rejected.
+	 */
+	if ((args.fid == SDEI_VERSION) &&
+	    (ret.ret0 != MAKE_SDEI_VERSION(1, 0, 0))) {
+		tftf_testcase_printf("Unexpected SDEI version: 0x%llx\n",
+				     (unsigned long long)ret.ret0);
+	} else if ((cd == NULL) && ((int64_t)ret.ret0 < 0)) {
+		tftf_testcase_printf("%s failed: 0x%llx\n",
+				     fuzz_func_name(funcid),
+				     (unsigned long long)ret.ret0);
 	}
-	if (strcmp(funcstr, "sdei_pe_mask") == 0) {
-		int64_t ret = sdei_pe_mask();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI pe mask failed: 0x%llx\n", ret);
+	printf("running %s\n", fuzz_func_name(funcid));
+
+	return (int64_t)ret.ret0;
+}
+
+#if SMC_FUZZ_FEEDBACK
+/*
+ * Attach feedback statistics to every node reachable from the top of the
+ * bias tree. Traversal always goes through the treenodes copies held by the
+ * parents, so that is where the statistics have to live.
+ */
+static void fb_alloc_tree(struct rand_smc_node *node, struct memmod *mmod)
+{
+	node->fbstats = GENMALLOC(node->entries * sizeof(struct fuzz_fb_stats));
+	for (unsigned int i = 0U; (int)i < node->entries; i++) {
+		fuzz_fb_stats_init(&node->fbstats[i]);
+		if (node->norcall[i] == 1) {
+			fb_alloc_tree(&node->treenodes[i], mmod);
 		}
-		printf("running %s\n", funcstr);
 	}
-	if (strcmp(funcstr, "sdei_event_status") == 0) {
-		int64_t ret = sdei_event_status(0);
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI event status failed: 0x%llx\n",
-					     ret);
+}
+
+static void fb_free_tree(struct rand_smc_node *node, struct memmod *mmod)
+{
+	for (unsigned int i = 0U; (int)i < node->entries; i++) {
+		if (node->norcall[i] == 1) {
+			fb_free_tree(&node->treenodes[i], mmod);
 		}
-		printf("running %s\n", funcstr);
 	}
-	if (strcmp(funcstr, "sdei_event_signal") == 0) {
-		int64_t ret = sdei_event_signal(0);
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI event signal failed: 0x%llx\n",
-					     ret);
+	GENFREE(node->fbstats);
+}
+
+/*
+ * Select an entry of a node by walking its biases. The biasarray lookup
+ * table goes stale as soon as biases are adjusted, so feedback mode draws
+ * against the running total in biasent instead.
+ */
+static int fb_select_entry(struct rand_smc_node *node)
+{
+	int nch = rand() % node->biasent;
+
+	for (int i = 0; i < node->entries; i++) {
+		if (nch < node->biases[i]) {
+			return i;
 		}
-		printf("running %s\n", funcstr);
+		nch -= node->biases[i];
 	}
-	if (strcmp(funcstr, "sdei_private_reset") == 0) {
-		int64_t ret = sdei_private_reset();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI private reset failed: 0x%llx\n",
-					     ret);
+	return node->entries - 1;
+}
+
+/*
+ * Raise the bias of every entry along the selection path that produced
+ * new behaviour so the subtree it belongs to is visited more often.
+ * The argument classes drawn for the call are rewarded by the caller.
+ */
+static void fb_reward_path(struct rand_smc_node **pnodes, int *pents,
+			   unsigned int depth)
+{
+	for (unsigned int i = 0U; i < depth; i++) {
+		struct rand_smc_node *node = pnodes[i];
+		int ent = pents[i];
+		int nbias = MIN(node->biases[ent] + FUZZ_FB_BIAS_STEP,
+				FUZZ_FB_BIAS_MAX);
+
+		node->biasent += nbias - node->biases[ent];
+		node->biases[ent] = nbias;
+		if (node->norcall[ent] == 1) {
+			node->fbstats[ent].rewards++;
 		}
-		printf("running %s\n", funcstr);
 	}
-	if (strcmp(funcstr, "sdei_shared_reset") == 0) {
-		int64_t ret = sdei_shared_reset();
-		if (ret < 0) {
-			tftf_testcase_printf("SDEI shared reset failed: 0x%llx\n",
-					     ret);
+}
+
+static void fb_print_indent(unsigned int depth)
+{
+	for (unsigned int i = 0U; i < depth; i++) {
+		printf("\t");
+	}
+}
+
+/*
+ * Print the learned biases in DTS form so they can seed the next run
+ */
+static void fb_print_tree(struct rand_smc_node *node, unsigned int depth)
+{
+	for (unsigned int i = 0U; (int)i < node->entries; i++) {
+		fb_print_indent(depth);
+		printf("%s {\n", node->nname[i]);
+		fb_print_indent(depth + 1U);
+		printf("bias = <%d>;\n", node->biases[i]);
+		if (node->norcall[i] == 0) {
+			fb_print_indent(depth + 1U);
+			printf("functionname = \"%s\";\n", node->snames[i]);
+			if (node->calldesc[i] != NULL) {
+				fuzz_args_print(node->calldesc[i], depth + 1U);
+			}
+			fb_print_indent(depth + 1U);
+			fuzz_fb_print_stats(&node->fbstats[i]);
+		} else {
+			fb_print_tree(&node->treenodes[i], depth + 1U);
 		}
-		printf("running %s\n", funcstr);
+		fb_print_indent(depth);
+		printf("};\n");
 	}
 }
+#endif /* SMC_FUZZ_FEEDBACK */
 
 /*
  * Function executes a single SMC fuzz test instance with a supplied seed.
@@ -477,22 +588,8 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 	/*
 	 * Setting up malloc block parameters
 	 */
-	tmod.memptr = (void *)tmod.memory;
-	tmod.memptrend = (void *)tmod.memory;
-	tmod.maxmemblk = ((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk));
-	tmod.nmemblk = 1;
-	tmod.memptr->address = 0U;
-	tmod.memptr->size = TOTALMEMORYSIZE - (TOTALMEMORYSIZE / BLKSPACEDIV);
-	tmod.memptr->valid = 1;
-	tmod.mallocdeladd[0] = 0U;
-	tmod.precblock[0] = (void *)tmod.memory;
-	tmod.trailblock[0] = NULL;
-	tmod.cntdeladd = 0U;
-	tmod.ptrmemblkqueue = 0U;
-	tmod.mallocdeladd_queue_cnt = 0U;
+	smcmalloc_init(&tmod);
 	tmod.checkadd = 1U;
-	tmod.checknumentries = 0U;
-	tmod.memerror = 0U;
 	struct memmod *mmod;
 	mmod = &tmod;
 	int cntndarray;
@@ -511,6 +608,7 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 	 * Initialize pseudo random number generator with supplied seed.
 	 */
 	srand(seed);
+	fuzz_args_init();
 
 	/*
 	 * Code to traverse the bias tree and select function based on the biaes within
@@ -532,6 +630,61 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 	 * another loop to continue the process of selection until an eventual leaf
 	 * node is found.
 	 */
+#if SMC_FUZZ_FEEDBACK
+	/*
+	 * In feedback mode every call is measured and the selection path is
+	 * recorded. Whenever a call returns a code not seen before for that
+	 * node, or takes much longer than it usually does, the biases along
+	 * the path are raised so the fuzzer keeps exploring in that direction.
+	 */
+	struct rand_smc_node *pnodes[FUZZ_FB_MAX_DEPTH];
+	int pents[FUZZ_FB_MAX_DEPTH];
+	struct fuzz_fb_sample sample;
+	uint8_t chosen[FUZZ_ARG_MAX_ARGS];
+
+	fuzz_fb_init();
+	fb_alloc_tree(&ndarray[cntndarray - 1], mmod);
+
+	for (unsigned int i = 0U; i < SMC_FUZZ_CALLS_PER_INSTANCE; i++) {
+		unsigned int depth = 0U;
+
+		tlnode = &ndarray[cntndarray - 1];
+		int nd = 0;
+		while (nd == 0) {
+			int selent = fb_select_entry(tlnode);
+			if (depth < FUZZ_FB_MAX_DEPTH) {
+				pnodes[depth] = tlnode;
+				pents[depth] = selent;
+				depth++;
+			}
+			if (tlnode->norcall[selent] == 0) {
+				struct fuzz_call_desc *cd = tlnode->calldesc[selent];
+				int64_t ret = runtestfunction(tlnode->funcid[selent],
+							      cd, chosen, &sample);
+				if (fuzz_fb_record(&tlnode->fbstats[selent], ret,
+						   &sample)) {
+					fb_reward_path(pnodes, pents, depth);
+					if (cd != NULL) {
+						fuzz_args_reward(cd, chosen,
+								 FUZZ_FB_BIAS_STEP,
+								 FUZZ_FB_BIAS_MAX);
+					}
+				}
+				nd = 1;
+			} else {
+				tlnode = &tlnode->treenodes[selent];
+			}
+		}
+	}
+
+	printf("SMC fuzz learned bias table:\n");
+	printf("/dts-v1/;\n\n/ {\n");
+	fb_print_tree(&ndarray[cntndarray - 1], 1U);
+	printf("};\n");
+
+	fb_free_tree(&ndarray[cntndarray - 1], mmod);
+	fuzz_fb_teardown();
+#else
 	for (unsigned int i = 0U; i < SMC_FUZZ_CALLS_PER_INSTANCE; i++) {
 		tlnode = &ndarray[cntndarray - 1];
 		int nd = 0;
@@ -539,13 +692,15 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 			int nch = rand()%tlnode->biasent;
 			int selent = tlnode->biasarray[nch];
 			if (tlnode->norcall[selent] == 0) {
-				runtestfunction(tlnode->snames[selent]);
+				runtestfunction(tlnode->funcid[selent],
+						tlnode->calldesc[selent], NULL, NULL);
 				nd = 1;
 			} else {
 				tlnode = &tlnode->treenodes[selent];
 			}
 		}
 	}
+#endif /* SMC_FUZZ_FEEDBACK */
 
 	/*
 	 * End of test SMC selection and freeing of nodes
@@ -555,6 +710,9 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 			for (unsigned int i = 0U; i < ndarray[j].entries; i++) {
 				GENFREE(ndarray[j].snames[i]);
 				GENFREE(ndarray[j].nname[i]);
+				if (ndarray[j].calldesc[i] != NULL) {
+					GENFREE(ndarray[j].calldesc[i]);
+				}
 			}
 			GENFREE(ndarray[j].biases);
 			GENFREE(ndarray[j].norcall);
@@ -562,6 +720,8 @@ test_result_t smc_fuzzing_instance(uint32_t seed)
 			GENFREE(ndarray[j].snames);
 			GENFREE(ndarray[j].nname);
 			GENFREE(ndarray[j].treenodes);
+			GENFREE(ndarray[j].funcid);
+			GENFREE(ndarray[j].calldesc);
 		}
 		GENFREE(ndarray);
 	}
@@ -616,6 +776,7 @@ test_result_t smc_fuzzing_top(void)
 		SMC_FUZZ_INSTANCE_COUNT);
 	printf("  SMC_FUZZ_CALLS_PER_INSTANCE=%u\n",
 		SMC_FUZZ_CALLS_PER_INSTANCE);
+	printf("  SMC_FUZZ_FEEDBACK=%u\n", SMC_FUZZ_FEEDBACK);
 	printf("  SMC_FUZZ_SEEDS=0x%x", seeds[0]);
 	for (i = 1U; i < SMC_FUZZ_INSTANCE_COUNT; i++) {
 		printf(",0x%x", seeds[i]);
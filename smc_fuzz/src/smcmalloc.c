@@ -1,559 +1,456 @@
 /*
- * Copyright (c) 2020, Arm Limited. All rights reserved.
+ * Copyright (c) 2020-2024, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
-#include <debug.h>
-#include <drivers/arm/private_timer.h>
-#include <events.h>
+#include <stdbool.h>
 #include "fifo3d.h"
-#include <libfdt.h>
 
-#include <power_management.h>
-#include <sdei.h>
-#include <tftf_lib.h>
-#include <timer.h>
+/*
+ * Memory allocator for the SMC fuzzing module.
+ *
+ * The arena is managed as a sequence of blocks, each starting with a header
+ * that holds the block size and its flags. Free blocks also carry a footer
+ * with their size (boundary tag) so that a block being freed can find and
+ * merge with its predecessor without any search. Free blocks are linked into
+ * segregated lists by power of two size class and a bitmap records which
+ * classes are populated, so allocation and free are constant time.
+ *
+ * Arena layout:
+ *
+ *   0          8                                        TOTALMEMORYSIZE - 8
+ *   | unused   | block | block | ... | block              | epilogue |
+ *
+ * The epilogue is a zero sized allocated header that stops forward merging.
+ */
+
+#define BLK_ALLOC		(1U << 0)
+#define BLK_PREV_FREE		(1U << 1)
+#define BLK_FLAGS_MASK		(SMCMALLOC_GRANULE - 1U)
+
+#define BLK_MAGIC_USED		(0x534d4355U)
+#define BLK_MAGIC_FREE		(0x534d4346U)
 
-#include <plat_topology.h>
-#include <platform.h>
+#define ARENA_FIRST_BLOCK	(SMCMALLOC_HDR_SIZE)
+#define ARENA_EPILOGUE		(TOTALMEMORYSIZE - SMCMALLOC_HDR_SIZE)
+
+struct blkhdr {
+	uint32_t sizeflags;
+	uint32_t magic;
+};
 
 /*
- * Priority encoder for enabling proper alignment of returned malloc
- * addresses
+ * Free block links, stored in the payload of free blocks as arena offsets.
+ * Offset 0 is never a block, so it terminates the lists.
  */
-struct peret priorityencoder(unsigned int num)
+struct blklinks {
+	uint32_t next;
+	uint32_t prev;
+};
+
+static inline struct blkhdr *blk_hdr(struct memmod *mmod, uint32_t off)
 {
-	unsigned int topbit = 0U;
-	struct peret prt;
-	unsigned int cntbit = 0U;
-
-	for (unsigned int i = TOPBITSIZE; i != 0U; i--) {
-		if (((num >> i) & 1U) == 1U) {
-			if (topbit < i) {
-				topbit = i;
-			}
-			cntbit++;
-		}
+	return (struct blkhdr *)(mmod->memory + off);
+}
+
+static inline struct blklinks *blk_links(struct memmod *mmod, uint32_t off)
+{
+	return (struct blklinks *)(mmod->memory + off + SMCMALLOC_HDR_SIZE);
+}
+
+static inline uint32_t *blk_footer(struct memmod *mmod, uint32_t off,
+				   uint32_t size)
+{
+	return (uint32_t *)(mmod->memory + off + size - sizeof(uint32_t));
+}
+
+static inline uint32_t blk_size(const struct blkhdr *hdr)
+{
+	return hdr->sizeflags & ~BLK_FLAGS_MASK;
+}
+
+/*
+ * Size class holding a block of the given size
+ */
+static inline unsigned int size_class(uint32_t size)
+{
+	unsigned int cls = (31U - (unsigned int)__builtin_clz(size)) -
+			   SMCMALLOC_MIN_SHIFT;
+
+	return (cls < SMCMALLOC_NUM_CLASSES) ? cls : (SMCMALLOC_NUM_CLASSES - 1U);
+}
+
+static void list_insert(struct memmod *mmod, uint32_t off, uint32_t size)
+{
+	unsigned int cls = size_class(size);
+	struct blklinks *lnk = blk_links(mmod, off);
+
+	lnk->next = mmod->freelist[cls];
+	lnk->prev = 0U;
+	if (lnk->next != 0U) {
+		blk_links(mmod, lnk->next)->prev = off;
 	}
-	if ((num  & 1U) == 1U) {
-		cntbit++;
+	mmod->freelist[cls] = off;
+	mmod->classmap |= (1U << cls);
+}
+
+static void list_remove(struct memmod *mmod, uint32_t off, uint32_t size)
+{
+	unsigned int cls = size_class(size);
+	struct blklinks *lnk = blk_links(mmod, off);
+
+	if (lnk->prev != 0U) {
+		blk_links(mmod, lnk->prev)->next = lnk->next;
+	} else {
+		mmod->freelist[cls] = lnk->next;
+	}
+	if (lnk->next != 0U) {
+		blk_links(mmod, lnk->next)->prev = lnk->prev;
 	}
+	if (mmod->freelist[cls] == 0U) {
+		mmod->classmap &= ~(1U << cls);
+	}
+}
 
-	prt.pow2 = 0U;
-	if (cntbit == 1U) {
-		prt.pow2 = 1U;
+/*
+ * Turn the given range into a free block and put it on its list.
+ * The predecessor of a free block is always allocated since neighbours
+ * are merged eagerly, so BLK_PREV_FREE is never set here.
+ */
+static void make_free_block(struct memmod *mmod, uint32_t off, uint32_t size)
+{
+	struct blkhdr *hdr = blk_hdr(mmod, off);
+
+	hdr->sizeflags = size;
+	hdr->magic = BLK_MAGIC_FREE;
+	*blk_footer(mmod, off, size) = size;
+	blk_hdr(mmod, off + size)->sizeflags |= BLK_PREV_FREE;
+	list_insert(mmod, off, size);
+}
+
+/*
+ * Initialise the arena as one free block
+ */
+void smcmalloc_init(struct memmod *mmod)
+{
+	struct blkhdr *epi = blk_hdr(mmod, ARENA_EPILOGUE);
+
+	for (unsigned int i = 0U; i < SMCMALLOC_NUM_CLASSES; i++) {
+		mmod->freelist[i] = 0U;
 	}
-	prt.tbit = topbit;
-	return prt;
+	mmod->classmap = 0U;
+	mmod->nalloc = 0U;
+	mmod->allocbytes = 0U;
+	mmod->peakbytes = 0U;
+	mmod->memerror = 0U;
+
+	epi->sizeflags = BLK_ALLOC;
+	epi->magic = BLK_MAGIC_USED;
+	make_free_block(mmod, ARENA_FIRST_BLOCK,
+			ARENA_EPILOGUE - ARENA_FIRST_BLOCK);
 }
 
 /*
- * Generic malloc function requesting memory.  Alignment of
- * returned memory is the next largest size if not a power
- * of two. The memmod structure is required to represent memory image
+ * Find a free block of at least size bytes. Any block on a class above
+ * the one holding size is large enough, so the bitmap gives the answer
+ * directly. Only when all of those classes are empty is the class of
+ * size itself searched for a block that happens to be large enough.
  */
-void *smcmalloc(unsigned int rsize,
-		struct memmod *mmod)
+static uint32_t find_free_block(struct memmod *mmod, uint32_t size)
 {
-	unsigned int alignnum;
-	unsigned int modval;
-	unsigned int aladd;
-	unsigned int mallocdeladd_pos = 0U;
-	struct memblk *newblk = NULL;
-	bool foundmem = false;
-	struct peret prt;
-	int incrnmemblk = 0;
-	int incrcntdeladd = 0;
+	unsigned int cls = size_class(size);
+	unsigned int fitcls = cls;
+	uint32_t mask;
 
-	/*
-	 * minimum size is 16
-	 */
-	if (rsize < 16U) {
-		rsize = 16U;
+	if ((size & (size - 1U)) != 0U) {
+		fitcls++;
 	}
 
-	/*
-	 * Is size on a power of 2 boundary?  if not select next largest power of 2
-	 * to place the memory request in
-	 */
-	prt = priorityencoder(rsize);
-	if (prt.pow2 == 1U) {
-		alignnum = 1U << prt.tbit;
-	} else {
-		alignnum = 1U << (prt.tbit + 1);
+	mask = (fitcls < SMCMALLOC_NUM_CLASSES) ?
+		(mmod->classmap & ~((1U << fitcls) - 1U)) : 0U;
+	if (mask != 0U) {
+		return mmod->freelist[__builtin_ctz(mask)];
 	}
-	mmod->memptr = (void *)mmod->memory;
-	for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-		modval = mmod->memptr->address % alignnum;
-		if (modval == 0U) {
-			aladd = 0U;
-		} else {
-			aladd = alignnum - modval;
+
+	for (uint32_t off = mmod->freelist[cls]; off != 0U;
+	     off = blk_links(mmod, off)->next) {
+		if (blk_size(blk_hdr(mmod, off)) >= size) {
+			return off;
 		}
+	}
 
-		/*
-		 * Searching sizes and alignments of memory blocks to find a candidate that will
-		 * accept the size
-		 */
-		if ((rsize <= (mmod->memptr->size - aladd)) &&
-		    (mmod->memptr->size > aladd) && (mmod->memptr->valid == 1)) {
-			foundmem = true;
-
-			/*
-			 * Reuse malloc table entries that have been retired.
-			 * If none exists create new entry
-			 */
-			if (mmod->mallocdeladd_queue_cnt > 0U) {
-				mmod->mallocdeladd_queue_cnt--;
-				mallocdeladd_pos =
-					mmod->mallocdeladd_queue[mmod->
-								 mallocdeladd_queue_cnt];
-			} else {
-				mallocdeladd_pos = mmod->cntdeladd;
-				incrcntdeladd = 1;
-			}
+	return 0U;
+}
 
-			/*
-			 * Determining if the size adheres to power of 2 boundary and
-			 * if a retired malloc block
-			 * can be utilized from the malloc table
-			 */
-			if (modval == 0U) {
-				if (mmod->ptrmemblkqueue > 0U) {
-					newblk = mmod->memblkqueue[mmod->ptrmemblkqueue - 1U];
-					mmod->ptrmemblkqueue--;
-				} else {
-					newblk = mmod->memptrend;
-					newblk++;
-					incrnmemblk = 1;
-				}
-
-				/*
-				 * Setting memory block parameters for newly created memory
-				 */
-				newblk->size = 0U;
-				newblk->address = mmod->memptr->address;
-				newblk->valid = 1;
-				mmod->precblock[mallocdeladd_pos] = newblk;
-
-				/*
-				 * Scrolling through the malloc attribute table to
-				 * find entries that have values that
-				 * match the newly created block and replace them with it
-				 */
-				unsigned int fadd = newblk->address + newblk->size;
-				for (unsigned int j = 0U; j < mmod->cntdeladd; j++) {
-					if ((fadd == mmod->mallocdeladd[j]) && (mmod->mallocdeladd_valid[j] == 1U)) {
-						mmod->precblock[j] = newblk;
-					}
-					if ((fadd ==
-					     (mmod->mallocdeladd[j] + mmod->memallocsize[j])) && (mmod->mallocdeladd_valid[j] == 1U)) {
-						mmod->trailblock[j] = newblk;
-					}
-				}
-
-				/*
-				 * Setting table parameters
-				 */
-				mmod->mallocdeladd[mallocdeladd_pos] =
-					mmod->memptr->address;
-				mmod->memallocsize[mallocdeladd_pos] = rsize;
-				mmod->memptr->size -= rsize;
-				mmod->memptr->address += (rsize);
-				mmod->trailblock[mallocdeladd_pos] = mmod->memptr;
-				mmod->mallocdeladd_valid[mallocdeladd_pos] = 1U;
-				mmod->memptr = (void *)mmod->memory;
-
-				/*
-				 * Removing entries from malloc table that can be
-				 * merged with other blocks
-				 */
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (mmod->memptr->valid == 1) {
-						if ((mmod->trailblock[mallocdeladd_pos]->address +
-						     mmod->trailblock[mallocdeladd_pos]->size) == mmod->memptr->address) {
-							if ((mmod->memptr->size ==
-							     0U) && (mmod->trailblock[mallocdeladd_pos]->size != 0U)) {
-								mmod->memptr->valid = 0;
-								mmod->memblkqueue[mmod->ptrmemblkqueue] = mmod->memptr;
-								mmod->ptrmemblkqueue++;
-								if (mmod->ptrmemblkqueue >= mmod->maxmemblk) {
-									mmod->memerror = 1U;
-								}
-							}
-						}
-					}
-					mmod->memptr++;
-				}
-			} else {
-				/*
-				 * Allocating memory that is aligned with power of 2
-				 */
-				unsigned int nblksize = mmod->memptr->size - rsize - (alignnum - modval);
-				if (mmod->ptrmemblkqueue > 0U) {
-					newblk = mmod->memblkqueue[mmod->ptrmemblkqueue - 1U];
-					mmod->ptrmemblkqueue--;
-				} else {
-					newblk = mmod->memptrend;
-					newblk++;
-					incrnmemblk = 1;
-				}
-				newblk->size = nblksize;
-				newblk->address = mmod->memptr->address +
-						  (alignnum - modval) + rsize;
-				newblk->valid = 1;
-				mmod->trailblock[mallocdeladd_pos] = newblk;
-
-				/*
-				 * Scrolling through the malloc attribute table to find entries
-				 * that have values that
-				 * match the newly created block and replace them with it
-				 */
-				unsigned int fadd = newblk->address + newblk->size;
-				for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-					if ((fadd == mmod->mallocdeladd[i]) && (mmod->mallocdeladd_valid[i] == 1U)) {
-					    mmod->precblock[i] = newblk;
-					}
-					if ((fadd == (mmod->mallocdeladd[i] +
-					      mmod->memallocsize[i])) && (mmod->mallocdeladd_valid[i] == 1U)) {
-						mmod->trailblock[i] = newblk;
-					}
-				}
-
-				/*
-				 * Setting table parameters
-				 */
-				mmod->memallocsize[mallocdeladd_pos] = rsize;
-				mmod->memptr->size = (alignnum - modval);
-				mmod->mallocdeladd[mallocdeladd_pos] = mmod->memptr->address + mmod->memptr->size;
-				mmod->precblock[mallocdeladd_pos] = mmod->memptr;
-				mmod->mallocdeladd_valid[mallocdeladd_pos] = 1U;
-			}
-			if (incrcntdeladd == 1) {
-				mmod->cntdeladd++;
-				if (mmod->cntdeladd >= mmod->maxmemblk) {
-					printf("ERROR: size of GENMALLOC table exceeded\n");
-					mmod->memerror = 2U;
-				}
-			}
-			break;
-		}
-		mmod->memptr++;
+/*
+ * Generic malloc function requesting memory. Returned memory is aligned on
+ * SMCMALLOC_GRANULE. The memmod structure is required to represent memory
+ * image
+ */
+void *smcmalloc(unsigned int rsize,
+		struct memmod *mmod)
+{
+	uint32_t need;
+	uint32_t off;
+	uint32_t bsize;
+	struct blkhdr *hdr;
+
+	if (rsize > (ARENA_EPILOGUE - ARENA_FIRST_BLOCK)) {
+		printf("ERROR: SMC GENMALLOC did not find memory region, size is %u\n", rsize);
+		mmod->memerror = 4U;
+		return NULL;
 	}
-	if (incrnmemblk == 1) {
-		mmod->nmemblk++;
-		mmod->memptrend++;
-		if (mmod->nmemblk >=
-		    ((TOTALMEMORYSIZE / BLKSPACEDIV)/sizeof(struct memblk))) {
-			printf("SMC GENMALLOC exceeded block limit of %ld\n",
-					((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk)));
-			mmod->memerror = 3U;
-		}
+
+	need = (rsize + SMCMALLOC_HDR_SIZE + SMCMALLOC_GRANULE - 1U) &
+	       ~(SMCMALLOC_GRANULE - 1U);
+	if (need < SMCMALLOC_MIN_BLOCK) {
+		need = SMCMALLOC_MIN_BLOCK;
 	}
-	if (foundmem == false) {
+
+	off = find_free_block(mmod, need);
+	if (off == 0U) {
 		printf("ERROR: SMC GENMALLOC did not find memory region, size is %u\n", rsize);
 		mmod->memerror = 4U;
+		return NULL;
 	}
 
-/*
- * Debug functions
- */
+	hdr = blk_hdr(mmod, off);
+	bsize = blk_size(hdr);
+	list_remove(mmod, off, bsize);
 
-#ifdef DEBUG_SMC_MALLOC
-	if (mmod->checkadd == 1) {
-		for (unsigned int i = 0U; i < mmod->checknumentries; i++) {
-			if (((mmod->mallocdeladd[mallocdeladd_pos] >
-			      mmod->checksa[i])
-			     && (mmod->mallocdeladd[mallocdeladd_pos] <
-				 mmod->checkea[i]))
-			    || (((mmod->mallocdeladd[mallocdeladd_pos] + rsize) >
-				 mmod->checksa[i])
-				&& ((mmod->mallocdeladd[mallocdeladd_pos] + rsize) <
-				    mmod->checkea[i]))) {
-				printf("ERROR: found overlap with previous addressin smc GENMALLOC\n");
-				printf("New address %u size %u\n", mmod->mallocdeladd[mallocdeladd_pos], rsize);
-				printf("Conflicting address %u size %u\n", mmod->checksa[i], (mmod->checkea[i] - mmod->checksa[i]));
-				mmod->memerror = 5U;
-			}
-		}
-		mmod->checksa[mmod->checknumentries] =
-			mmod->mallocdeladd[mallocdeladd_pos];
-		mmod->checkea[mmod->checknumentries] =
-			mmod->mallocdeladd[mallocdeladd_pos] + rsize;
-		mmod->checknumentries++;
-		if (mmod->checknumentries >= (4U * mmod->maxmemblk)) {
-			printf("ERROR: check queue size exceeded\n"); mmod->memerror = 6U;
-		}
-		mmod->memptr = (void *)mmod->memory;
-		for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-			if (mmod->memptr->valid == 1) {
-				if (((mmod->mallocdeladd[mallocdeladd_pos] >
-				      mmod->memptr->address)
-				     && (mmod->mallocdeladd[mallocdeladd_pos] < (mmod->memptr->address + mmod->memptr->size)))
-				    || (((mmod->mallocdeladd[mallocdeladd_pos] + rsize) > mmod->memptr->address)
-					&& ((mmod->mallocdeladd[mallocdeladd_pos] +
-					     rsize) < (mmod->memptr->address + mmod->memptr->size)))) {
-					printf("ERROR: found overlap with GENFREE memory region in smc GENMALLOC\n");
-					printf("New address %u size %u\n", mmod->mallocdeladd[mallocdeladd_pos], rsize);
-					printf("Conflicting address %u size %u\n", mmod->memptr->address, mmod->memptr->size);
-					mmod->memerror = 7U;
-				}
-			}
-			mmod->memptr++;
-		}
-		for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-			if (mmod->mallocdeladd_valid[i] == 1) {
-				mmod->memptr = (void *)mmod->memory;
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (mmod->memptr->valid == 1) {
-						if (((mmod->mallocdeladd[i] >
-						      mmod->memptr->address)
-						     && (mmod->mallocdeladd[i] < (mmod->memptr->address + mmod->memptr->size)))
-						    || (((mmod->mallocdeladd[i] + mmod->memallocsize[i]) > mmod->memptr->address)
-							&& ((mmod->mallocdeladd[i] + mmod->memallocsize[i]) <
-								(mmod->memptr->address + mmod->memptr->size)))) {
-							printf("ERROR: found overlap with GENFREE memory region ");
-							printf("full search in smc GENMALLOC\n");
-							printf("New address %u size %u\n", mmod->mallocdeladd[i],
-									mmod->memallocsize[i]);
-							printf("Conflicting address %u size %u\n", mmod->memptr->address,
-									mmod->memptr->size);
-							mmod->memerror = 8U;
-						}
-					}
-					mmod->memptr++;
-				}
-			}
-		}
-		mmod->memptr = (void *)mmod->memory;
-		newblk = (void *)mmod->memory;
-		for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-			if (mmod->memptr->valid == 1) {
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (newblk->valid == 1) {
-						if (((mmod->memptr->address >
-						      newblk->address) && (mmod->memptr->address < (newblk->address + newblk->size)))
-						    || (((mmod->memptr->address + mmod->memptr->size) >
-							 newblk->address) && ((mmod->memptr->address +
-							 mmod->memptr->size) < (newblk->address + newblk->size)))) {
-							printf("ERROR: found overlap in GENFREE memory regions in smc GENMALLOC\n");
-							printf("Region 1 address %u size %u\n", mmod->memptr->address, mmod->memptr->size);
-							printf("Region 2 address %u size %u\n", newblk->address, newblk->size);
-							mmod->memerror = 9U;
-						}
-					}
-					newblk++;
-				}
-			}
-			mmod->memptr++;
-			newblk = (void *)mmod->memory;
-		}
+	/*
+	 * Split the block if the remainder can stand as a free block on its
+	 * own, otherwise hand out the whole block.
+	 */
+	if ((bsize - need) >= SMCMALLOC_MIN_BLOCK) {
+		make_free_block(mmod, off + need, bsize - need);
+	} else {
+		need = bsize;
+		blk_hdr(mmod, off + need)->sizeflags &= ~BLK_PREV_FREE;
 	}
-#endif
-	return (void *)mmod->memory + ((TOTALMEMORYSIZE / BLKSPACEDIV)) +
-	       mmod->mallocdeladd[mallocdeladd_pos];
+
+	hdr->sizeflags = need | BLK_ALLOC;
+	hdr->magic = BLK_MAGIC_USED;
+
+	mmod->nalloc++;
+	mmod->allocbytes += need;
+	if (mmod->allocbytes > mmod->peakbytes) {
+		mmod->peakbytes = mmod->allocbytes;
+	}
+
 #ifdef DEBUG_SMC_MALLOC
-	return (void *)mmod->memory + 0x100U + mmod->mallocdeladd[mallocdeladd_pos];
+	if (mmod->checkadd == 1U) {
+		smcmalloc_check(mmod);
+	}
 #endif
+
+	return mmod->memory + off + SMCMALLOC_HDR_SIZE;
 }
 
 /*
  * Memory free function for memory allocated from malloc function.
- * The memmod structure is
- * required to represent memory image
+ * The block is merged with its free neighbours before going back on the
+ * free lists. The memmod structure is required to represent memory image
  */
-
 int smcfree(void *faddptr,
 	    struct memmod *mmod)
 {
-	unsigned int fadd = faddptr - ((TOTALMEMORYSIZE/BLKSPACEDIV)) -
-			    (void *)mmod->memory;
-	int fentry = 0;
-	struct memblk *newblk = NULL;
-	int incrnmemblk = 0;
+	uintptr_t addr = (uintptr_t)faddptr;
+	uintptr_t base = (uintptr_t)mmod->memory;
+	uint32_t off;
+	uint32_t size;
+	struct blkhdr *hdr;
+	struct blkhdr *nhdr;
+
+	if ((addr < (base + ARENA_FIRST_BLOCK + SMCMALLOC_HDR_SIZE)) ||
+	    (addr >= (base + ARENA_EPILOGUE)) ||
+	    (((addr - base) % SMCMALLOC_GRANULE) != 0U)) {
+		printf("ERROR: smcGENFREE cannot find address to GENFREE %lu\n",
+		       (unsigned long)(addr - base));
+		exit(1);
+	}
+
+	off = (uint32_t)(addr - base) - SMCMALLOC_HDR_SIZE;
+	hdr = blk_hdr(mmod, off);
+	if (((hdr->sizeflags & BLK_ALLOC) == 0U) ||
+	    (hdr->magic != BLK_MAGIC_USED)) {
+		printf("ERROR: smcGENFREE cannot find address to GENFREE %u\n", off);
+		exit(1);
+	}
+
+	size = blk_size(hdr);
+	mmod->nalloc--;
+	mmod->allocbytes -= size;
 
 	/*
-	 * Scrolling through the malloc attribute table to find entries that match
-	 * the user supplied address
+	 * Merge with the following block
 	 */
+	nhdr = blk_hdr(mmod, off + size);
+	if ((nhdr->sizeflags & BLK_ALLOC) == 0U) {
+		uint32_t nsize = blk_size(nhdr);
 
+		list_remove(mmod, off + size, nsize);
+		size += nsize;
+	}
 
-	for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-		if ((fadd == mmod->mallocdeladd[i]) &&
-		    (mmod->mallocdeladd_valid[i] == 1U)) {
-			fentry = 1;
-			if (mmod->trailblock[i] != NULL) {
-				if ((mmod->precblock[i]->address + mmod->precblock[i]->size) == fadd) {
-
-					/*
-					 * Found matching attribute block and then proceed to merge with
-					 * surrounding blocks
-					 */
-
-					mmod->precblock[i]->size += mmod->memallocsize[i] + mmod->trailblock[i]->size;
-					mmod->memblkqueue[mmod->ptrmemblkqueue] = mmod->trailblock[i];
-					mmod->ptrmemblkqueue++;
-					if (mmod->ptrmemblkqueue >= mmod->maxmemblk) {
-						printf("ERROR: GENMALLOC size exceeded in memory block queue\n");
-						exit(1);
-					}
-					mmod->trailblock[i]->valid = 0;
-					newblk = mmod->precblock[i];
-					mmod->memptr = (void *)mmod->memory;
-
-					/*
-					 * Scrolling through the malloc attribute table to find entries that have values that
-					 * match the newly merged block and replace them with it
-					 */
-
-					for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-						if (mmod->memptr->valid == 1) {
-							if ((mmod->trailblock[i]->address + mmod->trailblock[i]->size) == mmod->memptr->address) {
-								if ((mmod->memptr->size == 0U) &&
-								    (mmod->trailblock[i]->size != 0U)) {
-									mmod->memptr->valid = 0;
-									mmod->memblkqueue[mmod->ptrmemblkqueue] = mmod->memptr;
-									mmod->ptrmemblkqueue++;
-									if (mmod->ptrmemblkqueue >= mmod->maxmemblk) {
-										printf("ERROR: GENMALLOC size exceeded in memory block queue\n");
-										exit(1);
-									}
-								}
-							}
-						}
-						mmod->memptr++;
-					}
-				}
-			}
+	/*
+	 * Merge with the preceding block, found through its footer
+	 */
+	if ((hdr->sizeflags & BLK_PREV_FREE) != 0U) {
+		uint32_t psize = *(uint32_t *)(mmod->memory + off -
+					       sizeof(uint32_t));
 
-			/*
-			 * Setting table parameters
-			 */
+		off -= psize;
+		list_remove(mmod, off, psize);
+		size += psize;
+	}
 
-			mmod->mallocdeladd_valid[i] = 0U;
-			mmod->mallocdeladd_queue[mmod->mallocdeladd_queue_cnt] = i;
-			mmod->mallocdeladd_queue_cnt++;
-			if (mmod->mallocdeladd_queue_cnt >= mmod->maxmemblk) {
-				printf("ERROR: GENMALLOC reuse queue size exceeded\n");
-				exit(1);
-			}
+	hdr->magic = BLK_MAGIC_FREE;
+	make_free_block(mmod, off, size);
 
-			/*
-			 * Scrolling through the malloc attribute table to find entries
-			 * that have values that
-			 * match the newly merged block and replace them with it
-			 */
-
-			unsigned int faddGENFREE = newblk->address + newblk->size;
-			for (unsigned int j = 0U; j < mmod->cntdeladd; j++) {
-				if ((faddGENFREE == mmod->mallocdeladd[j]) &&
-				    (mmod->mallocdeladd_valid[j] == 1U))
-					mmod->precblock[j] = newblk;
-				if ((faddGENFREE ==
-				     (mmod->mallocdeladd[j] +
-				      mmod->memallocsize[i])) &&
-				    (mmod->mallocdeladd_valid[j] == 1U))
-					mmod->trailblock[j] = newblk;
-			}
-		}
+#ifdef DEBUG_SMC_MALLOC
+	if (mmod->checkadd == 1U) {
+		smcmalloc_check(mmod);
 	}
-	if (incrnmemblk == 1) {
-		mmod->nmemblk++;
-		mmod->memptrend++;
-		if (mmod->nmemblk >=
-		    ((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk))) {
-			printf("SMC GENFREE exceeded block limit of %ld\n",
-					((TOTALMEMORYSIZE / BLKSPACEDIV) / sizeof(struct memblk)));
-			exit(1);
+#endif
+	return 0;
+}
+
+/*
+ * Walk the arena and report how it is split between used and free blocks
+ */
+void smcmalloc_stats(struct memmod *mmod, struct smcmalloc_stats *st)
+{
+	uint32_t off = ARENA_FIRST_BLOCK;
+
+	st->usedbytes = 0U;
+	st->freebytes = 0U;
+	st->largestfree = 0U;
+	st->nfreeblk = 0U;
+	st->nusedblk = 0U;
+
+	while (off < ARENA_EPILOGUE) {
+		struct blkhdr *hdr = blk_hdr(mmod, off);
+		uint32_t size = blk_size(hdr);
+
+		if ((hdr->sizeflags & BLK_ALLOC) != 0U) {
+			st->usedbytes += size;
+			st->nusedblk++;
+		} else {
+			st->freebytes += size;
+			st->nfreeblk++;
+			if (size > st->largestfree) {
+				st->largestfree = size;
+			}
 		}
+		off += size;
 	}
-	if (fentry == 0) {
-		printf("ERROR: smcGENFREE cannot find address to GENFREE %u\n", fadd);
-		exit(1);
-	}
-#ifdef DEBUG_SMC_MALLOC
+}
 
 /*
  * Debug functions
  */
 
-	if (mmod->checkadd == 1) {
-		for (unsigned int i = 0U; i < mmod->checknumentries; i++) {
-			if (fadd == mmod->checksa[i]) {
-				mmod->checksa[i] = 0U;
-				mmod->checkea[i] = 0U;
+#ifdef DEBUG_SMC_MALLOC
+/*
+ * Consistency checker. Walks every block of the arena and every free
+ * list, and verifies that the two views agree. Returns the error code
+ * also recorded in memerror, 0 if the arena is consistent.
+ */
+int smcmalloc_check(struct memmod *mmod)
+{
+	uint32_t off = ARENA_FIRST_BLOCK;
+	bool prevfree = false;
+	unsigned int nfree = 0U;
+	unsigned int nlisted = 0U;
+
+	while (off < ARENA_EPILOGUE) {
+		struct blkhdr *hdr = blk_hdr(mmod, off);
+		uint32_t size = blk_size(hdr);
+		bool isfree = ((hdr->sizeflags & BLK_ALLOC) == 0U);
+
+		if ((size < SMCMALLOC_MIN_BLOCK) ||
+		    ((off + size) > ARENA_EPILOGUE)) {
+			printf("ERROR: corrupt block in smc GENMALLOC\n");
+			printf("Block address %u size %u\n", off, size);
+			mmod->memerror = 5U;
+			return mmod->memerror;
+		}
+		if (((hdr->sizeflags & BLK_PREV_FREE) != 0U) != prevfree) {
+			printf("ERROR: stale boundary tag in smc GENMALLOC\n");
+			printf("Block address %u size %u\n", off, size);
+			mmod->memerror = 6U;
+		}
+		if (isfree) {
+			if (prevfree) {
+				printf("ERROR: found adjacent GENFREE memory regions in smc GENMALLOC\n");
+				printf("Block address %u size %u\n", off, size);
+				mmod->memerror = 7U;
+			}
+			if ((*blk_footer(mmod, off, size) != size) ||
+			    (hdr->magic != BLK_MAGIC_FREE)) {
+				printf("ERROR: corrupt GENFREE memory region in smc GENMALLOC\n");
+				printf("Block address %u size %u\n", off, size);
+				mmod->memerror = 8U;
 			}
+			nfree++;
+		} else if (hdr->magic != BLK_MAGIC_USED) {
+			printf("ERROR: corrupt GENMALLOC memory region in smc GENMALLOC\n");
+			printf("Block address %u size %u\n", off, size);
+			mmod->memerror = 8U;
 		}
-		mmod->memptr = (void *)mmod->memory;
-		newblk = (void *)mmod->memory;
-		for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-			if (mmod->memptr->valid == 1) {
-				for (unsigned int j = 0U; j < mmod->nmemblk; j++) {
-					if (newblk->valid == 1) {
-						if (((mmod->memptr->address > newblk->address)
-						     && (mmod->memptr->address < (newblk->address + newblk->size)))
-						    || (((mmod->memptr->address + mmod->memptr->size) > newblk->address)
-							&& ((mmod->memptr->address + mmod->memptr->size) < ((newblk->address + newblk->size))))) {
-							printf("ERROR: found overlap in GENFREE memory regions in smc GENMALLOC\n");
-							printf("Region 1 address %u size %u\n", mmod->memptr->address, mmod->memptr->size);
-							printf("Region 2 address %u size %u\n", newblk->address, newblk->size);
-						}
-					}
-					newblk++;
-				}
+		prevfree = isfree;
+		off += size;
+	}
+
+	for (unsigned int cls = 0U; cls < SMCMALLOC_NUM_CLASSES; cls++) {
+		uint32_t prev = 0U;
+
+		if (((mmod->classmap >> cls) & 1U) != (mmod->freelist[cls] != 0U)) {
+			printf("ERROR: class map out of sync for class %u\n", cls);
+			mmod->memerror = 9U;
+		}
+		for (uint32_t lo = mmod->freelist[cls]; lo != 0U;
+		     lo = blk_links(mmod, lo)->next) {
+			struct blkhdr *hdr = blk_hdr(mmod, lo);
+
+			if (((hdr->sizeflags & BLK_ALLOC) != 0U) ||
+			    (size_class(blk_size(hdr)) != cls) ||
+			    (blk_links(mmod, lo)->prev != prev)) {
+				printf("ERROR: bad free list entry %u in class %u\n",
+				       lo, cls);
+				mmod->memerror = 9U;
+				return mmod->memerror;
 			}
-			mmod->memptr++;
-			newblk = (void *)mmod->memory;
+			prev = lo;
+			nlisted++;
 		}
 	}
-#endif
-	return 0;
+
+	if (nlisted != nfree) {
+		printf("ERROR: %u GENFREE regions but %u on free lists\n",
+		       nfree, nlisted);
+		mmod->memerror = 9U;
+	}
+
+	return mmod->memerror;
 }
 
 /*
- * Diplay malloc tables for debug purposes
+ * Diplay blocks for debug purposes
  */
-
-#ifdef DEBUG_SMC_MALLOC
 void displayblocks(struct memmod *mmod)
 {
-	mmod->memptr = (void *)mmod->memory;
+	uint32_t off = ARENA_FIRST_BLOCK;
+
 	printf("Displaying blocks:\n");
-	for (unsigned int i = 0U; i < mmod->nmemblk; i++) {
-		if (mmod->memptr->valid == 1) {
-			printf("*********************************************************************************************\n");
-			printf("%u * Address: %u * Size: %u * Valid: %u *\n", i, mmod->memptr->address, mmod->memptr->size, mmod->memptr->valid);
-		}
-		mmod->memptr++;
-	}
-}
+	while (off < ARENA_EPILOGUE) {
+		struct blkhdr *hdr = blk_hdr(mmod, off);
 
-void displaymalloctable(struct memmod *mmod)
-{
-	printf("\n\nDisplaying GENMALLOC table\n");
-	for (unsigned int i = 0U; i < mmod->cntdeladd; i++) {
-		if (mmod->mallocdeladd_valid[i] == 1U) {
-			printf("**********************************************************************************************\n");
-			printf("GENMALLOC Address: %u\n", mmod->mallocdeladd[i]);
-			printf("**********************************************************************************************\n");
-			printf("GENMALLOC Size: %u\n", mmod->memallocsize[i]);
-			printf("**********************************************************************************************\n");
-			if (mmod->trailblock[i] != NULL) {
-				printf("Trail Block:\n");
-				printf("* Address: %u * Size: %u *\n",
-				       mmod->trailblock[i]->address,
-				       mmod->trailblock[i]->size);
-			}
-			printf("**********************************************************************************************\n");
-			if (mmod->precblock[i] != NULL) {
-				printf("Previous Block:\n");
-				printf("* Address: %u * Size: %u *\n",
-				       mmod->precblock[i]->address,
-				       mmod->precblock[i]->size);
-			}
-			printf("**********************************************************************************************\n\n\n");
-		}
+		printf("* Address: %u * Size: %u * Allocated: %u *\n", off,
+		       blk_size(hdr), hdr->sizeflags & BLK_ALLOC);
+		off += blk_size(hdr);
 	}
 }
 #endif
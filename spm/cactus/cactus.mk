@@ -51,6 +51,7 @@ CACTUS_SOURCES	:=					\
 		cactus_message_loop.c			\
 		cactus_test_cpu_features.c		\
 		cactus_test_direct_messaging.c		\
+		cactus_test_indirect_messaging.c	\
 		cactus_test_interrupts.c		\
 		cactus_test_memory_sharing.c		\
 		cactus_tests_smmuv3.c			\
@@ -81,10 +82,16 @@ CACTUS_SOURCES	+= 	drivers/arm/pl011/${ARCH}/pl011_console.S	\
 
 CACTUS_LINKERFILE	:=	spm/cactus/cactus.ld.S
 
+# Print every command received by cactus, at LOG_LEVEL_VERBOSE.
+CACTUS_PRINT_CMD	?= 0
+
+$(eval $(call assert_boolean,CACTUS_PRINT_CMD))
+
 CACTUS_DEFINES	:=
 
 $(eval $(call add_define,CACTUS_DEFINES,ARM_ARCH_MAJOR))
 $(eval $(call add_define,CACTUS_DEFINES,ARM_ARCH_MINOR))
+$(eval $(call add_define,CACTUS_DEFINES,CACTUS_PRINT_CMD))
 $(eval $(call add_define,CACTUS_DEFINES,DEBUG))
 $(eval $(call add_define,CACTUS_DEFINES,ENABLE_ASSERTIONS))
 $(eval $(call add_define,CACTUS_DEFINES,ENABLE_BTI))
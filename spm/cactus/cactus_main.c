@@ -255,6 +255,9 @@ void __dead2 cactus_main(bool primary_cold_boot,
 		/* Initialize locks for tail end interrupt handler */
 		sp_handler_spin_lock_init();
 
+		/* Sort the command table for the message loop. */
+		cactus_cmd_handlers_init();
+
 		if (boot_info_header != NULL) {
 			/*
 			 * TODO: Currently just validating that cactus can
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_helpers.h>
 #include <debug.h>
 
 #include <cactus_message_loop.h>
@@ -19,6 +20,17 @@
  */
 static uint32_t requests_counter[PLATFORM_CORE_COUNT];
 
+/**
+ * Time spent dispatching commands, for each CPU, in system counter ticks.
+ */
+struct cactus_dispatch_stats {
+	uint64_t count;
+	uint64_t lookup_ticks;
+	uint64_t handler_ticks;
+};
+
+static struct cactus_dispatch_stats dispatch_stats[PLATFORM_CORE_COUNT];
+
 /**
  * Begin and end of command handler table, respectively. Both symbols defined by
  * the linker.
@@ -26,22 +38,92 @@ static uint32_t requests_counter[PLATFORM_CORE_COUNT];
 extern struct cactus_cmd_handler cactus_cmd_handler_begin[];
 extern struct cactus_cmd_handler cactus_cmd_handler_end[];
 
+/**
+ * Printing every command is costly, and skews the direct messaging latencies
+ * measured from the normal world. It is only done if CACTUS_PRINT_CMD is set.
+ */
+#if CACTUS_PRINT_CMD
 #define PRINT_CMD(smc_ret)						\
 	VERBOSE("cmd %lx; args: %lx, %lx, %lx, %lx\n",	 		\
 		smc_ret.arg3, smc_ret.arg4, smc_ret.arg5, 		\
 		smc_ret.arg6, smc_ret.arg7)
+#else
+#define PRINT_CMD(smc_ret)
+#endif
 
 /* Global FFA_MSG_DIRECT_REQ source ID */
 ffa_id_t g_dir_req_source_id;
 
 /**
- * Traverses command table from section ".cactus_handler", searches for a
- * registered command and invokes the respective handler.
+ * The section ".cactus_handler" is filled in link order, so it is sorted in
+ * place by command ID at boot. The table is small, an insertion sort is
+ * enough.
+ */
+void cactus_cmd_handlers_init(void)
+{
+	struct cactus_cmd_handler *it_cmd, *prev;
+	struct cactus_cmd_handler tmp;
+
+	for (it_cmd = cactus_cmd_handler_begin + 1;
+	     it_cmd < cactus_cmd_handler_end;
+	     it_cmd++) {
+		tmp = *it_cmd;
+
+		for (prev = it_cmd;
+		     prev > cactus_cmd_handler_begin && (prev - 1)->id > tmp.id;
+		     prev--) {
+			*prev = *(prev - 1);
+		}
+
+		*prev = tmp;
+	}
+
+	for (it_cmd = cactus_cmd_handler_begin + 1;
+	     it_cmd < cactus_cmd_handler_end;
+	     it_cmd++) {
+		if (it_cmd->id == (it_cmd - 1)->id) {
+			WARN("Command %llx has more than one handler\n",
+			     it_cmd->id);
+		}
+	}
+}
+
+/**
+ * Binary search of the command table, sorted by 'cactus_cmd_handlers_init'.
+ */
+static struct cactus_cmd_handler *cactus_cmd_handler_find(uint64_t id)
+{
+	struct cactus_cmd_handler *lo = cactus_cmd_handler_begin;
+	struct cactus_cmd_handler *hi = cactus_cmd_handler_end;
+	struct cactus_cmd_handler *mid;
+
+	while (lo < hi) {
+		mid = lo + ((hi - lo) / 2);
+
+		if (mid->id == id) {
+			return mid;
+		}
+
+		if (mid->id < id) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Searches for a registered command in the table from section
+ * ".cactus_handler" and invokes the respective handler.
  */
 bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 		       struct mailbox_buffers *mb)
 {
-	uint64_t in_cmd;
+	struct cactus_dispatch_stats *stats;
+	struct cactus_cmd_handler *handler;
+	uint64_t in_cmd, start, found;
 
 	/* Get which core it is running from. */
 	unsigned int core_pos = platform_get_core_pos(
@@ -52,6 +134,8 @@ bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 		return false;
 	}
 
+	start = read_cntpct_el0();
+
 	/* Get the source of the Direct Request message. */
 	if (ffa_func_id(*cmd_args) == FFA_MSG_SEND_DIRECT_REQ_SMC32 ||
 	    ffa_func_id(*cmd_args) == FFA_MSG_SEND_DIRECT_REQ_SMC64) {
@@ -62,20 +146,25 @@ bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 
 	in_cmd = cactus_get_cmd(*cmd_args);
 
-	for (struct cactus_cmd_handler *it_cmd = cactus_cmd_handler_begin;
-	     it_cmd < cactus_cmd_handler_end;
-	     it_cmd++) {
-		if (it_cmd->id == in_cmd) {
-			*ret = it_cmd->fn(cmd_args, mb);
+	stats = &dispatch_stats[core_pos];
 
-			/*
-			 * Increment the number of requests handled in current
-			 * core.
-			 */
-			requests_counter[core_pos]++;
+	handler = cactus_cmd_handler_find(in_cmd);
+	if (handler != NULL) {
+		found = read_cntpct_el0();
 
-			return true;
-		}
+		*ret = handler->fn(cmd_args, mb);
+
+		stats->count++;
+		stats->lookup_ticks += found - start;
+		stats->handler_ticks += read_cntpct_el0() - found;
+
+		/*
+		 * Increment the number of requests handled in current
+		 * core.
+		 */
+		requests_counter[core_pos]++;
+
+		return true;
 	}
 
 	/* Handle special command. */
@@ -94,6 +183,21 @@ bool cactus_handle_cmd(struct ffa_value *cmd_args, struct ffa_value *ret,
 		return true;
 	}
 
+	if (in_cmd == CACTUS_DISPATCH_STATS_CMD) {
+		*ret = cactus_dispatch_stats_resp(
+			ffa_dir_msg_dest(*cmd_args),
+			ffa_dir_msg_source(*cmd_args),
+			stats->count, stats->lookup_ticks,
+			stats->handler_ticks);
+
+		if (cactus_dispatch_stats_get_reset(*cmd_args)) {
+			stats->count = 0U;
+			stats->lookup_ticks = 0U;
+			stats->handler_ticks = 0U;
+		}
+		return true;
+	}
+
 	*ret = cactus_error_resp(ffa_dir_msg_dest(*cmd_args),
 				 ffa_dir_msg_source(*cmd_args),
 				 CACTUS_ERROR_UNHANDLED);
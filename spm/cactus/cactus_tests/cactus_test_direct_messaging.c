@@ -16,11 +16,30 @@ CACTUS_CMD_HANDLER(echo_cmd, CACTUS_ECHO_CMD)
 	VERBOSE("Received echo at %x, value %llx.\n", ffa_dir_msg_dest(*args),
 						      echo_val);
 
+	/* Reply with the same calling convention as the request. */
+	if (ffa_func_id(*args) == FFA_MSG_SEND_DIRECT_REQ_SMC32) {
+		return ffa_msg_send_direct_resp32(ffa_dir_msg_dest(*args),
+						  ffa_dir_msg_source(*args),
+						  CACTUS_SUCCESS,
+						  (uint32_t)echo_val, 0, 0, 0);
+	}
+
 	return cactus_success_resp(ffa_dir_msg_dest(*args),
 				   ffa_dir_msg_source(*args),
 				   echo_val);
 }
 
+CACTUS_CMD_HANDLER(data_cmd, CACTUS_DATA_CMD)
+{
+	uint64_t data[4];
+
+	cactus_data_get(*args, data);
+
+	return cactus_success_resp(ffa_dir_msg_dest(*args),
+				   ffa_dir_msg_source(*args),
+				   ffa_msg_checksum(data, sizeof(data)));
+}
+
 CACTUS_CMD_HANDLER(req_echo_cmd, CACTUS_REQ_ECHO_CMD)
 {
 	struct ffa_value ffa_ret;
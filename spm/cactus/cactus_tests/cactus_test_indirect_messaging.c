@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "cactus_message_loop.h"
+#include "cactus_test_cmds.h"
+#include <debug.h>
+#include <ffa_helpers.h>
+#include <spm_common.h>
+#include <xlat_tables_defs.h>
+
+CACTUS_CMD_HANDLER(indirect_msg_recv_cmd, CACTUS_INDIRECT_MSG_RECV_CMD)
+{
+	ffa_id_t vm_id = ffa_dir_msg_dest(*args);
+	ffa_id_t source = ffa_dir_msg_source(*args);
+	const struct ffa_partition_rxtx_header *header = mb->recv;
+	uint32_t cursor = 0U;
+	uint32_t count = 0U;
+	uint32_t bytes = 0U;
+	uint32_t checksum = 0U;
+	uint32_t size;
+	const void *msg;
+	struct ffa_value ret;
+
+	if (ffa_rxtx_header_receiver(header) != vm_id ||
+	    ffa_rxtx_header_sender(header) != source) {
+		ERROR("Unexpected indirect message %x -> %x\n",
+		      ffa_rxtx_header_sender(header),
+		      ffa_rxtx_header_receiver(header));
+		ffa_rx_release();
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
+	}
+
+	/* Read all messages in place, before handing the buffer back. */
+	while (ffa_msg_batch_next(mb->recv, PAGE_SIZE, &cursor, &msg, &size)) {
+		checksum += ffa_msg_checksum(msg, size);
+		bytes += size;
+		count++;
+	}
+
+	VERBOSE("Received %u indirect messages, %u bytes, from %x\n", count,
+		bytes, source);
+
+	ret = ffa_rx_release();
+	if (is_ffa_call_error(ret)) {
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_FFA_CALL);
+	}
+
+	return cactus_indirect_msg_recv_resp(vm_id, source, count, bytes,
+					     checksum);
+}
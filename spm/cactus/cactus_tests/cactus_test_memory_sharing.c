@@ -17,6 +17,9 @@
 
 static volatile uint32_t data_abort_gpf_triggered;
 
+/* Buffer the retrieved descriptor is reassembled in, from its fragments. */
+static __aligned(PAGE_SIZE) uint8_t retrieved_desc[MEM_SHARE_MAX_DESC_SIZE];
+
 static bool data_abort_gpf_handler(void)
 {
 	uint64_t esr_el1 = read_esr_el1();
@@ -73,6 +76,10 @@ CACTUS_CMD_HANDLER(mem_send_cmd, CACTUS_MEM_SEND_CMD)
 	int ret;
 	unsigned int mem_attrs;
 	uint32_t *ptr;
+	uint32_t page_count = 0U;
+	uint64_t start;
+	uint64_t retrieve_ticks;
+	uint64_t relinquish_ticks = 0U;
 	ffa_id_t source = ffa_dir_msg_source(*args);
 	ffa_id_t vm_id = ffa_dir_msg_dest(*args);
 	uint32_t mem_func = cactus_req_mem_send_get_mem_func(*args);
@@ -81,14 +88,29 @@ CACTUS_CMD_HANDLER(mem_send_cmd, CACTUS_MEM_SEND_CMD)
 					 cactus_mem_send_get_retrv_flags(*args);
 	uint32_t words_to_write = cactus_mem_send_words_to_write(*args);
 
-	expect(memory_retrieve(mb, &m, handle, source, vm_id,
-			       retrv_flags, mem_func), true);
+	start = read_cntpct_el0();
+	expect(memory_retrieve_frag(mb, &m, retrieved_desc,
+				    sizeof(retrieved_desc), handle, source,
+				    vm_id, retrv_flags, mem_func), true);
+	retrieve_ticks = read_cntpct_el0() - start;
 
 	composite = ffa_memory_region_get_composite(m, 0);
 
-	VERBOSE("Address: %p; page_count: %x %x\n",
+	VERBOSE("Address: %p; page_count: %x %x; constituents: %u\n",
 		composite->constituents[0].address,
-		composite->constituents[0].page_count, PAGE_SIZE);
+		composite->constituents[0].page_count, PAGE_SIZE,
+		composite->constituent_count);
+
+	/* Check the descriptor has been reassembled from all its fragments. */
+	for (uint32_t i = 0U; i < composite->constituent_count; i++) {
+		page_count += composite->constituents[i].page_count;
+	}
+
+	if (page_count != composite->page_count) {
+		ERROR("Constituents describe %u pages, expected %u!\n",
+		      page_count, composite->page_count);
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
+	}
 
 	/* This test is only concerned with RW permissions. */
 	if (ffa_get_data_access_attr(
@@ -161,21 +183,51 @@ CACTUS_CMD_HANDLER(mem_send_cmd, CACTUS_MEM_SEND_CMD)
 						 CACTUS_ERROR_TEST);
 		}
 
+		start = read_cntpct_el0();
 		if (!memory_relinquish((struct ffa_mem_relinquish *)mb->send,
 					m->handle, vm_id)) {
 			return cactus_error_resp(vm_id, source,
 						 CACTUS_ERROR_TEST);
 		}
+		relinquish_ticks = read_cntpct_el0() - start;
 	}
 
-	if (ffa_func_id(ffa_rx_release()) != FFA_SUCCESS_SMC32) {
-		ERROR("Failed to release buffer!\n");
-		return cactus_error_resp(vm_id, source,
-					 CACTUS_ERROR_FFA_CALL);
+	return cactus_mem_send_success_resp(vm_id, source,
+					    data_abort_gpf_triggered,
+					    retrieve_ticks, relinquish_ticks);
+}
+
+CACTUS_CMD_HANDLER(mem_retrieve_timed_cmd, CACTUS_MEM_RETRIEVE_TIMED_CMD)
+{
+	struct ffa_memory_region *m;
+	ffa_id_t source = ffa_dir_msg_source(*args);
+	ffa_id_t vm_id = ffa_dir_msg_dest(*args);
+	uint32_t mem_func = cactus_req_mem_send_get_mem_func(*args);
+	uint64_t handle = cactus_mem_send_get_handle(*args);
+	uint64_t start;
+	uint64_t retrieve_ticks;
+	uint64_t relinquish_ticks = 0U;
+
+	start = read_cntpct_el0();
+	if (!memory_retrieve_frag(mb, &m, retrieved_desc,
+				  sizeof(retrieved_desc), handle, source,
+				  vm_id, 0, mem_func)) {
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
+	}
+	retrieve_ticks = read_cntpct_el0() - start;
+
+	if (mem_func != FFA_MEM_DONATE_SMC32) {
+		start = read_cntpct_el0();
+		if (!memory_relinquish((struct ffa_mem_relinquish *)mb->send,
+					m->handle, vm_id)) {
+			return cactus_error_resp(vm_id, source,
+						 CACTUS_ERROR_TEST);
+		}
+		relinquish_ticks = read_cntpct_el0() - start;
 	}
 
-	return cactus_success_resp(vm_id,
-				   source, data_abort_gpf_triggered);
+	return cactus_mem_send_success_resp(vm_id, source, 0, retrieve_ticks,
+					    relinquish_ticks);
 }
 
 CACTUS_CMD_HANDLER(req_mem_send_cmd, CACTUS_REQ_MEM_SEND_CMD)
@@ -191,6 +243,11 @@ CACTUS_CMD_HANDLER(req_mem_send_cmd, CACTUS_REQ_MEM_SEND_CMD)
 		non_secure ? share_page_non_secure(vm_id) : share_page(vm_id);
 	unsigned int mem_attrs;
 	int ret;
+	uint64_t start;
+	uint64_t send_ticks;
+	uint64_t retrieve_ticks;
+	uint64_t relinquish_ticks;
+	uint64_t reclaim_ticks = 0U;
 
 	VERBOSE("%x requested to send memory to %x (func: %x), page: %llx\n",
 		source, receiver, mem_func, (uint64_t)share_page_addr);
@@ -222,10 +279,12 @@ CACTUS_CMD_HANDLER(req_mem_send_cmd, CACTUS_REQ_MEM_SEND_CMD)
 					 CACTUS_ERROR_TEST);
 	}
 
+	start = read_cntpct_el0();
 	handle = memory_init_and_send(
 		(struct ffa_memory_region *)mb->send, PAGE_SIZE,
 		vm_id, receiver, constituents,
 		constituents_count, mem_func, &ffa_ret);
+	send_ticks = read_cntpct_el0() - start;
 
 	/*
 	 * If returned an invalid handle, we should break the test.
@@ -249,13 +308,19 @@ CACTUS_CMD_HANDLER(req_mem_send_cmd, CACTUS_REQ_MEM_SEND_CMD)
 		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
 	}
 
+	/* Keep the receiver's timings before ffa_ret is reused. */
+	retrieve_ticks = cactus_mem_send_get_retrieve_ticks(ffa_ret);
+	relinquish_ticks = cactus_mem_send_get_relinquish_ticks(ffa_ret);
+
 	if (mem_func != FFA_MEM_DONATE_SMC32) {
 		/*
 		 * Do a memory reclaim only if the mem_func regards to memory
 		 * share or lend operations, as with a donate the owner is
 		 * permanently given up access to the memory region.
 		 */
+		start = read_cntpct_el0();
 		ffa_ret = ffa_mem_reclaim(handle, 0);
+		reclaim_ticks = read_cntpct_el0() - start;
 		if (is_ffa_call_error(ffa_ret)) {
 			return cactus_error_resp(vm_id, source,
 						 CACTUS_ERROR_TEST);
@@ -288,5 +353,8 @@ CACTUS_CMD_HANDLER(req_mem_send_cmd, CACTUS_REQ_MEM_SEND_CMD)
 					 CACTUS_ERROR_TEST);
 	}
 
-	return cactus_success_resp(vm_id, source, 0);
+	return cactus_req_mem_send_success_resp(vm_id, source, send_ticks,
+						retrieve_ticks,
+						relinquish_ticks,
+						reclaim_ticks);
 }
@@ -29,6 +29,54 @@
 #define TRANSFER_SIZE	(MEMPCY_TOTAL_SIZE / FRAME_COUNT)
 #define LOOP_COUNT	(5000U)
 
+/* Frames the benchmark can start together, within the mapped User Frame. */
+#define BENCH_MAX_FRAMES	(16U)
+
+static const uint32_t bench_engine_cmds[] = {
+	[CACTUS_DMA_BENCH_MEMCPY] = ENGINE_MEMCPY,
+	[CACTUS_DMA_BENCH_RAND48] = ENGINE_RAND48,
+	[CACTUS_DMA_BENCH_SUM64] = ENGINE_SUM64,
+};
+
+/*
+ * Program frame 'f' of the test engine and start 'cmd' on the range
+ * [begin, end_incl], with 'udata' as the command specific data. Returns false
+ * if the engine found the frame misconfigured.
+ */
+static bool smmuv3_frame_start(unsigned int f, uint32_t cmd,
+			       uint32_t stream_id, uint32_t substream_id,
+			       uint64_t begin_addr, uint64_t end_addr,
+			       uint64_t stride, uint64_t udata)
+{
+	mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), PCTRL_OFF, 0);
+	mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), DOWNSTREAM_PORT_OFF, 0);
+	mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), STREAM_ID_OFF, stream_id);
+	mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), SUBSTREAM_ID_OFF, substream_id);
+
+	mmio_write32_offset(USR_BASE_FRAME + F_IDX(f), UCTRL_OFF, 0);
+	mmio_write32_offset(USR_BASE_FRAME + F_IDX(f), SEED_OFF, 0);
+	mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), BEGIN_OFF, begin_addr);
+	mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), END_CTRL_OFF, end_addr);
+
+	/* Legal values for stride: 1 and any multiples of 8 */
+	mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), STRIDE_OFF, stride);
+	mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), UDATA_OFF, udata);
+
+	mmio_write32_offset(USR_BASE_FRAME + F_IDX(f), CMD_OFF, cmd);
+
+	/*
+	 * It is guaranteed that a read of "cmd" fields after writing to it will
+	 * immediately return ENGINE_FRAME_MISCONFIGURED if the command was
+	 * invalid.
+	 */
+	if (mmio_read32_offset(USR_BASE_FRAME + F_IDX(f), CMD_OFF) == ENGINE_MIS_CFG) {
+		ERROR("SMMUv3TestEngine: Misconfigured for frame: %u\n", f);
+		return false;
+	}
+
+	return true;
+}
+
 static bool run_smmuv3_test(void)
 {
 	uint64_t source_addr, cpy_range, target_addr;
@@ -78,32 +126,12 @@ static bool run_smmuv3_test(void)
 		dest_addr = target_addr + (TRANSFER_SIZE * f);
 
 		/* Initiate DMA sequence */
-		mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), PCTRL_OFF, 0);
-		mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), DOWNSTREAM_PORT_OFF, 0);
-		mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), STREAM_ID_OFF, streamID_list[f%2]);
-		mmio_write32_offset(PRIV_BASE_FRAME + F_IDX(f), SUBSTREAM_ID_OFF, NO_SUBSTREAMID);
-
-		mmio_write32_offset(USR_BASE_FRAME + F_IDX(f), UCTRL_OFF, 0);
-		mmio_write32_offset(USR_BASE_FRAME + F_IDX(f), SEED_OFF, 0);
-		mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), BEGIN_OFF, begin_addr);
-		mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), END_CTRL_OFF, end_addr);
-
-		/* Legal values for stride: 1 and any multiples of 8 */
-		mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), STRIDE_OFF, 1);
-		mmio_write64_offset(USR_BASE_FRAME + F_IDX(f), UDATA_OFF, dest_addr);
-
-		mmio_write32_offset(USR_BASE_FRAME + F_IDX(f), CMD_OFF, ENGINE_MEMCPY);
-		VERBOSE("SMMUv3TestEngine: Waiting for MEMCPY completion for frame: %u\n", f);
-
-		/*
-		 * It is guaranteed that a read of "cmd" fields after writing to it will
-		 * immediately return ENGINE_FRAME_MISCONFIGURED if the command was
-		 * invalid.
-		 */
-		if (mmio_read32_offset(USR_BASE_FRAME + F_IDX(f), CMD_OFF) == ENGINE_MIS_CFG) {
-			ERROR("SMMUv3TestEngine: Misconfigured for frame: %u\n", f);
+		if (!smmuv3_frame_start(f, ENGINE_MEMCPY, streamID_list[f%2],
+					NO_SUBSTREAMID, begin_addr, end_addr,
+					1U, dest_addr)) {
 			return false;
 		}
+		VERBOSE("SMMUv3TestEngine: Waiting for MEMCPY completion for frame: %u\n", f);
 
 		/* Wait for mem copy to be complete */
 		while (attempts++ < LOOP_COUNT) {
@@ -173,3 +201,155 @@ CACTUS_CMD_HANDLER(smmuv3_cmd, CACTUS_DMA_SMMUv3_CMD)
 
 	return ffa_ret;
 }
+
+/*
+ * Start 'frames' frames of the test engine together, each running 'mode' on
+ * its share of 'size' bytes of the scratch memory, and wait for all of them
+ * to complete. The time from starting the first frame to the completion of
+ * the last one, and the sum and maximum of the latency from starting each
+ * frame to its completion, are returned in system counter ticks.
+ */
+static bool run_smmuv3_bench(uint32_t size, uint32_t stride, uint32_t frames,
+			     enum cactus_dma_bench_mode mode,
+			     uint32_t stream_id, uint32_t substream_id,
+			     uint64_t *total_ticks, uint64_t *latency_sum,
+			     uint64_t *latency_max)
+{
+	uint64_t frame_start[BENCH_MAX_FRAMES];
+	uint64_t source_addr = MEMCPY_SOURCE_BASE;
+	uint64_t target_addr = MEMCPY_TARGET_BASE;
+	uint64_t chunk = size / frames;
+	uint64_t begin_addr, udata, start, now, latency;
+	uint32_t pending = 0U;
+	uint32_t status;
+	unsigned int i, f, attempts = 0U;
+
+	/* The source is not read by ENGINE_RAND48. */
+	if (mode != CACTUS_DMA_BENCH_RAND48) {
+		for (i = 0U; i < (size / 8U); i++) {
+			mmio_write64_offset(source_addr, i * 8,
+					    ULL(0x0123456776543210) + i);
+		}
+		clean_dcache_range(source_addr, size);
+	}
+	dsbsy();
+
+	*latency_sum = 0U;
+	*latency_max = 0U;
+
+	start = read_cntpct_el0();
+
+	for (f = 0U; f < frames; f++) {
+		/* ENGINE_RAND48 writes to the range it is given. */
+		begin_addr = ((mode == CACTUS_DMA_BENCH_RAND48) ?
+			      target_addr : source_addr) + (chunk * f);
+		udata = target_addr + (chunk * f);
+
+		frame_start[f] = read_cntpct_el0();
+
+		if (!smmuv3_frame_start(f, bench_engine_cmds[mode], stream_id,
+					substream_id, begin_addr,
+					begin_addr + chunk - 1U, stride,
+					udata)) {
+			return false;
+		}
+
+		pending |= BIT_32(f);
+	}
+
+	while (pending != 0U) {
+		if (attempts++ == (LOOP_COUNT * frames)) {
+			ERROR("SMMUv3: Benchmark timed out, frames %x\n",
+			      pending);
+			return false;
+		}
+
+		for (f = 0U; f < frames; f++) {
+			if ((pending & BIT_32(f)) == 0U) {
+				continue;
+			}
+
+			status = mmio_read32_offset(USR_BASE_FRAME + F_IDX(f),
+						    CMD_OFF);
+			if (status == ENGINE_ERROR) {
+				ERROR("SMMUv3: Benchmark failed, frame %u\n",
+				      f);
+				return false;
+			}
+
+			if (status != ENGINE_HALTED) {
+				continue;
+			}
+
+			now = read_cntpct_el0();
+			latency = now - frame_start[f];
+			*latency_sum += latency;
+			if (latency > *latency_max) {
+				*latency_max = latency;
+			}
+			*total_ticks = now - start;
+
+			pending &= ~BIT_32(f);
+		}
+	}
+
+	dsbsy();
+
+	/* Only contiguous copies are checked, as the source is known. */
+	if (mode == CACTUS_DMA_BENCH_MEMCPY && stride == 1U) {
+		inv_dcache_range(source_addr, size);
+		inv_dcache_range(target_addr, size);
+
+		for (i = 0U; i < (size / 8U); i++) {
+			if (mmio_read_64(source_addr + 8 * i) !=
+			    mmio_read_64(target_addr + 8 * i)) {
+				ERROR("SMMUv3: Mem copy failed: %llx\n",
+				      target_addr + 8 * i);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+CACTUS_CMD_HANDLER(smmuv3_bench_cmd, CACTUS_DMA_SMMUv3_BENCH_CMD)
+{
+	ffa_id_t vm_id = ffa_dir_msg_dest(*args);
+	ffa_id_t source = ffa_dir_msg_source(*args);
+	uint32_t size = cactus_dma_bench_get_size(*args);
+	uint32_t stride = cactus_dma_bench_get_stride(*args);
+	uint32_t frames = cactus_dma_bench_get_frames(*args);
+	enum cactus_dma_bench_mode mode = cactus_dma_bench_get_mode(*args);
+	uint64_t total_ticks, latency_sum, latency_max;
+
+	/* There is only one SMMUv3TestEngine IP, used by the first SP. */
+	if (vm_id != SPM_VM_ID_FIRST) {
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_INVALID);
+	}
+
+	/*
+	 * Each frame is given a range of at least 8 bytes, made of whole
+	 * 64-bit words, and legal values for stride are 1 and any multiples
+	 * of 8.
+	 */
+	if (frames == 0U || frames > BENCH_MAX_FRAMES ||
+	    size > MEMPCY_TOTAL_SIZE || size == 0U ||
+	    (size % (frames * 8U)) != 0U ||
+	    (stride != 1U && (stride % 8U) != 0U) ||
+	    (stride > (size / frames)) ||
+	    (uint64_t)mode >= ARRAY_SIZE(bench_engine_cmds)) {
+		ERROR("SMMUv3: Invalid benchmark parameters\n");
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_INVALID);
+	}
+
+	if (!run_smmuv3_bench(size, stride, frames, mode,
+			      cactus_dma_bench_get_stream_id(*args),
+			      cactus_dma_bench_get_substream_id(*args),
+			      &total_ticks, &latency_sum, &latency_max)) {
+		return cactus_error_resp(vm_id, source, CACTUS_ERROR_TEST);
+	}
+
+	return cactus_dma_bench_resp(vm_id, source, total_ticks, latency_sum,
+				     latency_max);
+}
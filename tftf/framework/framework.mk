@@ -67,6 +67,7 @@ FRAMEWORK_SOURCES	+=						\
         lib/errata_abi/errata_abi.c                                     \
 	lib/transfer_list/transfer_list.c				\
 	lib/trusted_os/trusted_os.c					\
+	lib/utils/bench_stats.c						\
 	lib/utils/mp_printf.c						\
 	lib/utils/uuid.c						\
 	${XLAT_TABLES_LIB_SRCS}						\
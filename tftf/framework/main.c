@@ -46,6 +46,9 @@ static u_register_t cpu_on_ctx_id_arr[PLATFORM_CORE_COUNT];
 
 static unsigned int test_is_rebooting;
 
+/* System counter value when the current test started, 0 after a reset */
+static uint64_t test_start_ticks;
+
 /* Parameters arg0 and arg1 passed from BL31 */
 #if TRANSFER_LIST
 u_register_t ns_tl;
@@ -139,18 +142,26 @@ static void prepare_next_test(void)
 	/* This function should be called by the lead CPU only */
 	assert((read_mpidr_el1() & MPID_MASK) == lead_cpu_mpid);
 
+	/*
+	 * The duration of the test includes waiting for the CPUs of the
+	 * previous one to power off.
+	 */
+	test_start_ticks = syscounter_read();
+
 	/*
 	 * Only the lead CPU should be powered on at this stage. All other CPUs
-	 * should be powered off or powering off. If some CPUs are not powered
-	 * off yet, wait for them to power off.
+	 * should be powered off or powering off, or parked with
+	 * PARK_SECONDARY_CPUS. If some CPUs are not powered off or parked yet,
+	 * wait for them.
 	 */
 	for_each_cpu(cpu_node) {
 		mpid = tftf_get_mpidr_from_node(cpu_node);
 		if (mpid == lead_cpu_mpid)
 			assert(tftf_is_cpu_online(mpid));
 		else
-			while (tftf_psci_affinity_info(mpid, MPIDR_AFFLVL0)
-					  == PSCI_STATE_ON)
+			while ((tftf_psci_affinity_info(mpid, MPIDR_AFFLVL0)
+					  == PSCI_STATE_ON) &&
+			       !tftf_is_cpu_parked(mpid))
 				;
 	}
 
@@ -176,8 +187,6 @@ static void prepare_next_test(void)
 	/* Program the watchdog */
 	tftf_platform_watchdog_set();
 
-	/* TODO: Take a 1st timestamp to be able to measure test duration */
-
 	tftf_set_test_progress(TEST_IN_PROGRESS);
 }
 
@@ -254,6 +263,7 @@ static test_result_t get_overall_test_result(void)
 static unsigned int close_test(void)
 {
 	const test_case_t *next_test;
+	unsigned long long duration_us = 0ULL;
 
 #if DEBUG
 	/*
@@ -272,7 +282,11 @@ static unsigned int close_test(void)
 	tftf_set_test_progress(TEST_COMPLETE);
 	test_is_rebooting = 0;
 
-	/* TODO: Take a 2nd timestamp and compute test duration */
+	/* Test duration in microseconds, unknown if the platform was reset */
+	if (test_start_ticks != 0ULL) {
+		duration_us = ((syscounter_read() - test_start_ticks) *
+			       1000000ULL) / read_cntfrq_el0();
+	}
 
 	/* Reset watchdog */
 	tftf_platform_watchdog_reset();
@@ -283,7 +297,7 @@ static unsigned int close_test(void)
 	/* Save test result in NVM */
 	tftf_testcase_set_result(current_testcase(),
 				get_overall_test_result(),
-				0);
+				duration_us);
 
 	print_test_end(current_testcase());
 
@@ -428,6 +442,10 @@ void __dead2 run_tests(void)
 				bug_unreachable();
 			}
 		} else {
+			/* Run the next test, if parked and given one */
+			if (tftf_park_cpu())
+				continue;
+
 			tftf_cpu_off();
 			panic();
 		}
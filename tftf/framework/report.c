@@ -52,6 +52,7 @@ void print_tests_summary(void)
 {
 	int total_tests = 0;
 	int tests_stats[TEST_RESULT_MAX] = { 0 };
+	unsigned long long total_duration = 0ULL;
 
 	mp_printf("******************************* Summary *******************************\n");
 
@@ -87,6 +88,7 @@ void print_tests_summary(void)
 
 			total_tests++;
 			tests_stats[result.result]++;
+			total_duration += result.duration;
 		}
 		mp_printf("%70s\n", passed ? "Passed" : "Failed");
 	}
@@ -98,5 +100,6 @@ void print_tests_summary(void)
 			test_result_to_string(i), tests_stats[i]);
 	}
 	mp_printf("%-14s: %d\n", "Total tests", total_tests);
+	mp_printf("%-14s: %llu ms\n", "Total time", total_duration / 1000ULL);
 	mp_printf("=================================\n");
 }
@@ -9,6 +9,7 @@
 #include <arch_helpers.h>
 #include <plat_topology.h>
 #include <platform.h>
+#include <power_management.h>
 #include <test_helpers.h>
 #include <tftf_lib.h>
 
@@ -150,7 +151,8 @@ void wait_for_core_to_turn_off(unsigned int mpidr)
 	if (mpidr == (read_mpidr_el1() & MPID_MASK))
 		return;
 
-	while (tftf_psci_affinity_info(mpidr, MPIDR_AFFLVL0) != PSCI_STATE_OFF) {
+	while ((tftf_psci_affinity_info(mpidr, MPIDR_AFFLVL0) !=
+		PSCI_STATE_OFF) && !tftf_is_cpu_parked(mpidr)) {
 		continue;
 	}
 }
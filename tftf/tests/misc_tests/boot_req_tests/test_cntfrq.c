@@ -45,21 +45,10 @@ test_result_t test_cntfrq_check(void)
 	int rc;
 
 	/* Bring every CPU online */
-	for_each_cpu(cpu_node) {
-		cpu_mpid = tftf_get_mpidr_from_node(cpu_node);
-		/* Skip lead CPU as it is already on */
-		if (cpu_mpid == lead_mpid)
-			continue;
-
-		rc = tftf_cpu_on(cpu_mpid,
-				(uintptr_t) cntfrq_check,
-				0);
-		if (rc != PSCI_E_SUCCESS) {
-			tftf_testcase_printf(
-				"Failed to power on CPU 0x%x (%d)\n",
-				cpu_mpid, rc);
-			return TEST_RESULT_FAIL;
-		}
+	rc = tftf_cpu_on_all((uintptr_t) cntfrq_check, NULL);
+	if (rc != PSCI_E_SUCCESS) {
+		tftf_testcase_printf("Failed to power on the CPUs (%d)\n", rc);
+		return TEST_RESULT_FAIL;
 	}
 
 	rc = cntfrq_check();
@@ -73,9 +62,7 @@ test_result_t test_cntfrq_check(void)
 			continue;
 
 		/* Wait for the target CPU to turn OFF */
-		while (tftf_psci_affinity_info(cpu_mpid,
-				MPIDR_AFFLVL0) != PSCI_STATE_OFF)
-			;
+		wait_for_core_to_turn_off(cpu_mpid);
 	}
 
 	return rc;
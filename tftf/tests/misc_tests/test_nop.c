@@ -50,18 +50,10 @@ test_result_t test_nop(void)
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 
 	/* Start all other CPUs */
-	for_each_cpu(cpu_node) {
-		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
-
-		if (lead_mpid == target_mpid) {
-			continue;
-		}
-
-		ret = tftf_cpu_on(target_mpid, (uintptr_t)secondary_cpu, 0);
-		if (ret != PSCI_E_SUCCESS) {
-			ERROR("CPU ON failed for 0x0x%llx\n", (unsigned long long)target_mpid);
-			return TEST_RESULT_FAIL;
-		}
+	ret = tftf_cpu_on_all((uintptr_t)secondary_cpu, NULL);
+	if (ret != PSCI_E_SUCCESS) {
+		ERROR("CPU ON failed (%lld)\n", ret);
+		return TEST_RESULT_FAIL;
 	}
 
 	/* Do the actual work */
@@ -75,9 +67,7 @@ test_result_t test_nop(void)
 			continue;
 		}
 
-		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) != PSCI_STATE_OFF) {
-			continue;
-		}
+		wait_for_core_to_turn_off(target_mpid);
 	}
 
 	return TEST_RESULT_SUCCESS;
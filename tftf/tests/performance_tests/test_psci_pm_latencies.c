@@ -0,0 +1,569 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the latencies of the PSCI CPU_ON,
+ * CPU_OFF, CPU_SUSPEND and SYSTEM_SUSPEND calls as seen from TFTF, and break
+ * them down in phases with the timestamps that the PMF runtime
+ * instrumentation service of TF-A captures in the PSCI paths, if enabled.
+ *
+ * The TFTF and the PMF timestamps are both system counter values. A PMF
+ * timestamp older than the start of the operation measured was captured by
+ * an earlier PSCI call, and the phases it delimits are not sampled.
+ */
+
+#include <arch_helpers.h>
+#include <assert.h>
+#include <bench_stats.h>
+#include <debug.h>
+#include <plat_topology.h>
+#include <platform.h>
+#include <platform_def.h>
+#include <pmf.h>
+#include <power_management.h>
+#include <psci.h>
+#include <smccc.h>
+#include <stdio.h>
+#include <string.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <timer.h>
+#include <utils_def.h>
+
+/* Number of CPU_ON/CPU_OFF sequences of each non-lead CPU */
+#define PM_BENCH_HOTPLUG_ITERATIONS	U(8)
+/* Number of suspends to each power state */
+#define PM_BENCH_SUSPEND_ITERATIONS	U(16)
+#define PM_BENCH_SYS_SUSPEND_ITERATIONS	U(4)
+
+#define PM_BENCH_MAX_SAMPLES		U(256)
+#define PM_BENCH_MAX_PHASES		U(8)
+
+/* Timestamps of the PMF runtime instrumentation service */
+#define RT_INSTR_ENTER_PSCI		U(0)
+#define RT_INSTR_EXIT_PSCI		U(1)
+#define RT_INSTR_ENTER_HW_LOW_PWR	U(2)
+#define RT_INSTR_EXIT_HW_LOW_PWR	U(3)
+#define RT_INSTR_ENTER_CFLUSH		U(4)
+#define RT_INSTR_EXIT_CFLUSH		U(5)
+#define RT_INSTR_TOTAL_IDS		U(6)
+
+#define RT_INSTR_TID	((PMF_ARM_TIF_IMPL_ID << PMF_IMPL_ID_SHIFT) | \
+			 (PMF_RT_INSTR_SVC_ID << PMF_SVC_ID_SHIFT))
+
+enum {
+	ON_TOTAL = 0,
+	ON_PSCI_ENTRY,
+	ON_POWER_UP,
+	ON_WARM_BOOT,
+	ON_TFTF_ENTRY,
+	ON_CALLER_SMC,
+	ON_PHASES
+};
+
+static const char *const on_phase_names[ON_PHASES] = {
+	[ON_TOTAL] = "total (CPU_ON to tftf_warm_boot_main)",
+	[ON_PSCI_ENTRY] = "TFTF to PSCI entry",
+	[ON_POWER_UP] = "PSCI entry to EL3 warm boot entry",
+	[ON_WARM_BOOT] = "EL3 warm boot",
+	[ON_TFTF_ENTRY] = "PSCI exit to tftf_warm_boot_main",
+	[ON_CALLER_SMC] = "CPU_ON SMC on the caller",
+};
+
+enum {
+	OFF_TOTAL = 0,
+	OFF_PSCI_ENTRY,
+	OFF_POWER_DOWN,
+	OFF_CFLUSH,
+	OFF_AFF_INFO,
+	OFF_PHASES
+};
+
+static const char *const off_phase_names[OFF_PHASES] = {
+	[OFF_TOTAL] = "total (test return to AFFINITY_INFO OFF)",
+	[OFF_PSCI_ENTRY] = "test return to PSCI entry",
+	[OFF_POWER_DOWN] = "PSCI entry to low power entry",
+	[OFF_CFLUSH] = "cache flush",
+	[OFF_AFF_INFO] = "low power entry to AFFINITY_INFO OFF",
+};
+
+enum {
+	SUSP_TOTAL = 0,
+	SUSP_PSCI_ENTRY,
+	SUSP_POWER_DOWN,
+	SUSP_CFLUSH,
+	SUSP_LOW_PWR,
+	SUSP_WAKE_UP,
+	SUSP_RESUME,
+	SUSP_PHASES
+};
+
+static const char *const suspend_phase_names[SUSP_PHASES] = {
+	[SUSP_TOTAL] = "total (suspend to resume)",
+	[SUSP_PSCI_ENTRY] = "TFTF to PSCI entry",
+	[SUSP_POWER_DOWN] = "PSCI entry to low power entry",
+	[SUSP_CFLUSH] = "cache flush",
+	[SUSP_LOW_PWR] = "low power (wake up timer)",
+	[SUSP_WAKE_UP] = "wake up to PSCI exit",
+	[SUSP_RESUME] = "PSCI exit to resume",
+};
+
+static struct {
+	const char *name;
+	unsigned int count;
+	uint64_t samples[PM_BENCH_MAX_SAMPLES];
+} phases[PM_BENCH_MAX_PHASES];
+
+static unsigned int phase_count;
+
+/* What each CPU powered on records for the lead CPU */
+static struct {
+	uint64_t ts[RT_INSTR_TOTAL_IDS];
+	uint64_t test_return;
+	volatile bool done;
+} pm_slot[PLATFORM_CORE_COUNT];
+
+static void pm_phases_init(const char *const names[], unsigned int count)
+{
+	assert(count <= PM_BENCH_MAX_PHASES);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		phases[i].name = names[i];
+		phases[i].count = 0U;
+	}
+
+	phase_count = count;
+}
+
+/*
+ * Add the time from 'from' to 'to' to the samples of 'phase', unless 'from'
+ * is older than 'since', the start of the operation measured, or the
+ * timestamps are out of order.
+ */
+static void pm_phase_add(unsigned int phase, uint64_t since, uint64_t from,
+			 uint64_t to)
+{
+	assert(phase < phase_count);
+
+	if (from < since || to < from ||
+	    phases[phase].count == PM_BENCH_MAX_SAMPLES) {
+		return;
+	}
+
+	phases[phase].samples[phases[phase].count++] = to - from;
+}
+
+static void pm_phases_print(const char *prefix)
+{
+	struct bench_stats stats;
+	char name[128];
+
+	for (unsigned int i = 0U; i < phase_count; i++) {
+		snprintf(name, sizeof(name), "%s %s", prefix, phases[i].name);
+
+		if (phases[i].count == 0U) {
+			printf("%s: no samples\n", name);
+			continue;
+		}
+
+		bench_stats_compute(phases[i].samples, phases[i].count, &stats);
+		bench_stats_print(name, &stats);
+	}
+}
+
+/*
+ * Get the PMF runtime instrumentation timestamps of the CPU 'mpid'. They are
+ * all 0 if the service is not enabled in TF-A.
+ */
+static bool pm_get_rt_instr_ts(u_register_t mpid,
+			       uint64_t ts[RT_INSTR_TOTAL_IDS])
+{
+	smc_args args = { 0 };
+	smc_ret_values ret;
+
+	for (unsigned int i = 0U; i < RT_INSTR_TOTAL_IDS; i++) {
+		args.fid = PMF_SMC_GET_TIMESTAMP;
+		args.arg1 = RT_INSTR_TID | i;
+		args.arg2 = mpid;
+		args.arg3 = PMF_CACHE_MAINT;
+		ret = tftf_smc(&args);
+
+		if (ret.ret0 != 0UL) {
+			memset(ts, 0, RT_INSTR_TOTAL_IDS * sizeof(ts[0]));
+			return false;
+		}
+
+		ts[i] = ret.ret1;
+	}
+
+	return true;
+}
+
+static void pm_check_rt_instr(void)
+{
+	uint64_t ts[RT_INSTR_TOTAL_IDS];
+
+	if (!pm_get_rt_instr_ts(read_mpidr_el1() & MPID_MASK, ts)) {
+		tftf_testcase_printf("PMF runtime instrumentation not enabled, "
+				     "only the totals are measured\n");
+	}
+}
+
+static test_result_t pm_hotplug_entrypoint(void)
+{
+	u_register_t mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int pos = platform_get_core_pos(mpid);
+
+	/* The timestamps of the warm boot of this CPU are the latest ones */
+	(void)pm_get_rt_instr_ts(mpid, pm_slot[pos].ts);
+
+	pm_slot[pos].done = true;
+	dsbsy();
+
+	/* The lead CPU reads this once this CPU is off */
+	pm_slot[pos].test_return = syscounter_read();
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static void pm_add_on_phases(unsigned int pos, uint64_t start,
+			     const uint64_t lead_ts[RT_INSTR_TOTAL_IDS])
+{
+	const uint64_t *ts = pm_slot[pos].ts;
+	uint64_t entry = tftf_get_warm_boot_ts(pos);
+
+	pm_phase_add(ON_TOTAL, start, start, entry);
+	pm_phase_add(ON_PSCI_ENTRY, start, start,
+		     lead_ts[RT_INSTR_ENTER_PSCI]);
+	pm_phase_add(ON_POWER_UP, start, lead_ts[RT_INSTR_ENTER_PSCI],
+		     ts[RT_INSTR_EXIT_HW_LOW_PWR]);
+	pm_phase_add(ON_WARM_BOOT, start, ts[RT_INSTR_EXIT_HW_LOW_PWR],
+		     ts[RT_INSTR_EXIT_PSCI]);
+	pm_phase_add(ON_TFTF_ENTRY, start, ts[RT_INSTR_EXIT_PSCI], entry);
+	pm_phase_add(ON_CALLER_SMC, start, lead_ts[RT_INSTR_ENTER_PSCI],
+		     lead_ts[RT_INSTR_EXIT_PSCI]);
+}
+
+static void pm_add_off_phases(u_register_t mpid, unsigned int pos,
+			      uint64_t off)
+{
+	uint64_t start = pm_slot[pos].test_return;
+	uint64_t ts[RT_INSTR_TOTAL_IDS];
+
+	/* The CPU_OFF timestamps are only valid once the CPU is off */
+	(void)pm_get_rt_instr_ts(mpid, ts);
+
+	pm_phase_add(OFF_TOTAL, start, start, off);
+	pm_phase_add(OFF_PSCI_ENTRY, start, start, ts[RT_INSTR_ENTER_PSCI]);
+	pm_phase_add(OFF_POWER_DOWN, start, ts[RT_INSTR_ENTER_PSCI],
+		     ts[RT_INSTR_ENTER_HW_LOW_PWR]);
+	pm_phase_add(OFF_CFLUSH, start, ts[RT_INSTR_ENTER_CFLUSH],
+		     ts[RT_INSTR_EXIT_CFLUSH]);
+	pm_phase_add(OFF_AFF_INFO, start, ts[RT_INSTR_ENTER_HW_LOW_PWR], off);
+}
+
+/*
+ * Power each non-lead CPU on and wait for it to be off again, at most
+ * PM_BENCH_HOTPLUG_ITERATIONS times each but no more than PM_BENCH_MAX_SAMPLES
+ * times in total, and record the phases of either CPU_ON or CPU_OFF.
+ */
+static test_result_t pm_hotplug_bench(bool time_off)
+{
+	u_register_t lead_mpid = read_mpidr_el1() & MPID_MASK;
+	uint64_t lead_ts[RT_INSTR_TOTAL_IDS];
+	unsigned int cpu_node, pos, iterations;
+	u_register_t mpid;
+	uint64_t start, off;
+	int32_t ret;
+
+	iterations = MIN(PM_BENCH_HOTPLUG_ITERATIONS,
+			 PM_BENCH_MAX_SAMPLES /
+			 (tftf_get_total_cpus_count() - 1U));
+
+	for_each_cpu(cpu_node) {
+		mpid = tftf_get_mpidr_from_node(cpu_node);
+		if (mpid == lead_mpid) {
+			continue;
+		}
+
+		pos = platform_get_core_pos(mpid);
+
+		for (unsigned int i = 0U; i < iterations; i++) {
+			pm_slot[pos].done = false;
+			dsbsy();
+
+			start = syscounter_read();
+			ret = tftf_cpu_on(mpid,
+					  (uintptr_t)pm_hotplug_entrypoint, 0U);
+
+			/* Before AFFINITY_INFO overwrites them */
+			(void)pm_get_rt_instr_ts(lead_mpid, lead_ts);
+
+			if (ret != PSCI_E_SUCCESS) {
+				ERROR("CPU ON failed for 0x%llx\n",
+				      (unsigned long long)mpid);
+				return TEST_RESULT_FAIL;
+			}
+
+			while (!pm_slot[pos].done) {
+				continue;
+			}
+
+			while (tftf_psci_affinity_info(mpid, MPIDR_AFFLVL0) !=
+			       PSCI_STATE_OFF) {
+				continue;
+			}
+			off = syscounter_read();
+
+			if (time_off) {
+				pm_add_off_phases(mpid, pos, off);
+			} else {
+				pm_add_on_phases(pos, start, lead_ts);
+			}
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Suspend the calling CPU 'iterations' times to 'power_state' of power level
+ * 'pwrlvl', or the whole system if 'system' is set, and record the phases of
+ * each suspend. The CPU is woken up by a timer interrupt after
+ * PLAT_SUSPEND_ENTRY_TIME ms.
+ */
+static test_result_t pm_suspend_bench(unsigned int power_state,
+				      unsigned int pwrlvl, bool system,
+				      unsigned int iterations)
+{
+	u_register_t mpid = read_mpidr_el1() & MPID_MASK;
+	uint64_t ts[RT_INSTR_TOTAL_IDS];
+	uint64_t start, end;
+	u_register_t flags;
+	int ret;
+
+	for (unsigned int i = 0U; i < iterations; i++) {
+		/*
+		 * The timer IRQ wakes the CPU up even with IRQs masked, which
+		 * keeps it pending if it fires before the CPU is suspended.
+		 */
+		flags = read_daif();
+		disable_irq();
+
+		if (tftf_program_timer(PLAT_SUSPEND_ENTRY_TIME) != 0) {
+			write_daif(flags);
+			isb();
+			ERROR("Failed to program the wake up timer\n");
+			return TEST_RESULT_FAIL;
+		}
+
+		start = syscounter_read();
+		if (system) {
+			ret = tftf_system_suspend();
+		} else if (pwrlvl >= PSTATE_AFF_LVL_2) {
+			/* The system context may be lost at this level */
+			ret = tftf_cpu_suspend_save_sys_ctx(power_state);
+		} else {
+			ret = tftf_cpu_suspend(power_state);
+		}
+		end = syscounter_read();
+
+		write_daif(flags);
+		isb();
+		tftf_cancel_timer();
+
+		if (ret != PSCI_E_SUCCESS) {
+			ERROR("Failed to suspend to 0x%x (%d)\n", power_state,
+			      ret);
+			return TEST_RESULT_FAIL;
+		}
+
+		(void)pm_get_rt_instr_ts(mpid, ts);
+
+		pm_phase_add(SUSP_TOTAL, start, start, end);
+		pm_phase_add(SUSP_PSCI_ENTRY, start, start,
+			     ts[RT_INSTR_ENTER_PSCI]);
+		pm_phase_add(SUSP_POWER_DOWN, start, ts[RT_INSTR_ENTER_PSCI],
+			     ts[RT_INSTR_ENTER_HW_LOW_PWR]);
+		pm_phase_add(SUSP_CFLUSH, start, ts[RT_INSTR_ENTER_CFLUSH],
+			     ts[RT_INSTR_EXIT_CFLUSH]);
+		pm_phase_add(SUSP_LOW_PWR, start, ts[RT_INSTR_ENTER_HW_LOW_PWR],
+			     ts[RT_INSTR_EXIT_HW_LOW_PWR]);
+		pm_phase_add(SUSP_WAKE_UP, start, ts[RT_INSTR_EXIT_HW_LOW_PWR],
+			     ts[RT_INSTR_EXIT_PSCI]);
+		pm_phase_add(SUSP_RESUME, start, ts[RT_INSTR_EXIT_PSCI], end);
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Wait for the non-lead CPUs to finish their previous test, and return true
+ * if they are all off, false if any of them is still on or parked.
+ */
+static bool pm_non_lead_cpus_off(void)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int cpu_node, cpu_mpid;
+	bool all_off = true;
+
+	wait_for_non_lead_cpus();
+
+	for_each_cpu(cpu_node) {
+		cpu_mpid = tftf_get_mpidr_from_node(cpu_node);
+		if (cpu_mpid == lead_mpid) {
+			continue;
+		}
+
+		if (tftf_psci_affinity_info(cpu_mpid, MPIDR_AFFLVL0) !=
+		    PSCI_STATE_OFF) {
+			INFO("CPU 0x%x is not off\n", cpu_mpid);
+			all_off = false;
+		}
+	}
+
+	return all_off;
+}
+
+/*
+ * @Test_Aim@ Measure the latency of CPU_ON, from the call on the lead CPU to
+ * the first instruction of tftf_warm_boot_main() on the target CPU, for each
+ * non-lead CPU, with a breakdown in phases and percentiles.
+ */
+test_result_t test_psci_cpu_on_latency(void)
+{
+	test_result_t result;
+
+	SKIP_TEST_IF_LESS_THAN_N_CPUS(2);
+
+	pm_check_rt_instr();
+	pm_phases_init(on_phase_names, ON_PHASES);
+
+	result = pm_hotplug_bench(false);
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	pm_phases_print("CPU_ON");
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the latency of CPU_OFF, from the return of the test
+ * function on the target CPU to AFFINITY_INFO reporting it off on the lead
+ * CPU, for each non-lead CPU, with a breakdown in phases and percentiles.
+ */
+test_result_t test_psci_cpu_off_latency(void)
+{
+	test_result_t result;
+
+	SKIP_TEST_IF_LESS_THAN_N_CPUS(2);
+
+	pm_check_rt_instr();
+	pm_phases_init(off_phase_names, OFF_PHASES);
+
+	result = pm_hotplug_bench(true);
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	pm_phases_print("CPU_OFF");
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the latency of CPU_SUSPEND from entry to wake up and
+ * resume, for each valid power state of the platform, with a breakdown in
+ * phases and percentiles. The states of the cluster and higher power levels
+ * are only measured if all the other CPUs are off.
+ */
+test_result_t test_psci_cpu_suspend_latency(void)
+{
+	unsigned int pstateid_idx[PLAT_MAX_PWR_LEVEL + 1];
+	unsigned int pwrlvl, susp_type, state_id, power_state;
+	test_result_t result;
+	bool others_off;
+	char prefix[64];
+
+	pm_check_rt_instr();
+
+	/*
+	 * The states above the CPU level are only entered when the other CPUs
+	 * of the domain are off, so they are not measured otherwise.
+	 */
+	others_off = pm_non_lead_cpus_off();
+	if (!others_off) {
+		tftf_testcase_printf("Not all the CPUs are off, skipping the "
+				     "cluster and system power states\n");
+	}
+
+	INIT_PWR_LEVEL_INDEX(pstateid_idx);
+
+	do {
+		tftf_set_next_state_id_idx(PLAT_MAX_PWR_LEVEL, pstateid_idx);
+		if (pstateid_idx[0] == PWR_STATE_INIT_INDEX) {
+			break;
+		}
+
+		if (tftf_get_pstate_vars(&pwrlvl, &susp_type, &state_id,
+					 pstateid_idx) != PSCI_E_SUCCESS) {
+			continue;
+		}
+
+		if (!others_off && (pwrlvl > PSTATE_AFF_LVL_0)) {
+			continue;
+		}
+
+		power_state = tftf_make_psci_pstate(pwrlvl, susp_type,
+						    state_id);
+
+		pm_phases_init(suspend_phase_names, SUSP_PHASES);
+
+		result = pm_suspend_bench(power_state, pwrlvl, false,
+					  PM_BENCH_SUSPEND_ITERATIONS);
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+
+		snprintf(prefix, sizeof(prefix),
+			 "CPU_SUSPEND level %u %s 0x%x", pwrlvl,
+			 (susp_type == PSTATE_TYPE_POWERDOWN) ?
+			 "powerdown" : "standby", power_state);
+		pm_phases_print(prefix);
+	} while (true);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * @Test_Aim@ Measure the latency of SYSTEM_SUSPEND from entry to wake up and
+ * resume, with a breakdown in phases and percentiles.
+ */
+test_result_t test_psci_system_suspend_latency(void)
+{
+	test_result_t result;
+
+	if (tftf_get_psci_feature_info(SMC_PSCI_SYSTEM_SUSPEND64) ==
+	    PSCI_E_NOT_SUPPORTED) {
+		tftf_testcase_printf("SYSTEM_SUSPEND not supported\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	pm_check_rt_instr();
+	pm_phases_init(suspend_phase_names, SUSP_PHASES);
+
+	result = pm_suspend_bench(0U, 0U, true,
+				  PM_BENCH_SYS_SUSPEND_ITERATIONS);
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	pm_phases_print("SYSTEM_SUSPEND");
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include <psci.h>
 #include <smccc.h>
 #include <string.h>
+#include <test_helpers.h>
 #include <tftf_lib.h>
 
 #ifdef __aarch64__
@@ -138,8 +139,8 @@ test_result_t test_smccc_arch_workaround_1(void)
 		target_mpid = tftf_get_mpidr_from_node(cpu_node);
 		if (lead_mpid == target_mpid)
 			continue;
-		ret = tftf_cpu_on(target_mpid,
-		    (uintptr_t)test_smccc_entrypoint, 0);
+		ret = tftf_cpu_on_parkable(target_mpid,
+		    (uintptr_t)test_smccc_entrypoint);
 		if (ret != PSCI_E_SUCCESS) {
 			ERROR("CPU ON failed for 0x%llx\n",
 			    (unsigned long long)target_mpid);
@@ -147,11 +148,9 @@ test_result_t test_smccc_arch_workaround_1(void)
 		}
 		/*
 		 * Wait for test_smccc_entrypoint to return
-		 * and the CPU to power down
+		 * and the CPU to power down or park
 		 */
-		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
-			PSCI_STATE_OFF)
-			continue;
+		wait_for_core_to_turn_off(target_mpid);
 	}
 
 	return test_smccc_entrypoint();
@@ -23,10 +23,11 @@
 #include <test_helpers.h>
 #include <xlat_tables_v2.h>
 
-static struct realm realm;
-static bool realm_payload_created;
-static bool shared_mem_created;
-static volatile bool timer_enabled;
+/*
+ * Number of realms created, which share the page pool: it is initialised by
+ * the first one and reset once they are all destroyed.
+ */
+static unsigned int realms_created;
 
 #define RMI_EXIT(id)	\
 	[RMI_EXIT_##id] = #id
@@ -43,27 +44,58 @@ const char *rmi_exit[] = {
 };
 
 /*
- * The function handler to print the Realm logged buffer,
- * executed by the secondary core
+ * Print the messages a Rec logged since the last call, and free them in its
+ * log ring. This runs on each REC exit, and on the print exits the Rec makes
+ * when its log ring is nearly full.
  */
-void realm_print_handler(unsigned int rec_num)
+void realm_print_handler(struct realm *realm_ptr, unsigned int rec_num)
 {
-	size_t str_len = 0UL;
-	host_shared_data_t *host_shared_data = host_get_shared_structure(rec_num);
-	char *log_buffer = (char *)host_shared_data->log_buffer;
+	char line[REALM_LOG_LINE_MAX + 1U];
+	struct realm_log_ring *ring;
+	uint32_t head, tail;
+	unsigned int len;
+	bool line_start;
 
-	str_len = strlen((const char *)log_buffer);
+	if (rec_num >= realm_ptr->rec_count) {
+		return;
+	}
+
+	ring = &host_get_shared_structure(realm_ptr, rec_num)->log_ring;
+	head = ring->head;
+	tail = ring->tail;
+	if (tail == head) {
+		return;
+	}
+
+	/* Read the messages after their index */
+	dmbishld();
 
 	/*
-	 * Read Realm message from shared printf location and print
-	 * them using UART
+	 * Print the messages one line at a time, and prefix the lines with the
+	 * Rec which logged them.
 	 */
-	if (str_len != 0UL) {
-		/* Avoid memory overflow */
-		log_buffer[MAX_BUF_SIZE - 1] = 0U;
-		mp_printf("Rec%u: %s", rec_num, log_buffer);
-		(void)memset((char *)log_buffer, 0, MAX_BUF_SIZE);
+	while (tail != head) {
+		line_start = (tail == 0U) ||
+			(ring->buf[(tail - 1U) & (REALM_LOG_RING_SIZE - 1U)] ==
+			 '\n');
+		len = 0U;
+		do {
+			line[len++] =
+				ring->buf[tail++ & (REALM_LOG_RING_SIZE - 1U)];
+		} while (tail != head && line[len - 1U] != '\n' &&
+			 len < REALM_LOG_LINE_MAX);
+		line[len] = '\0';
+
+		if (line_start) {
+			mp_printf("Rec%u: %s", rec_num, line);
+		} else {
+			mp_printf("%s", line);
+		}
 	}
+
+	/* Free the messages once printed */
+	dmbish();
+	ring->tail = tail;
 }
 
 /*
@@ -71,32 +103,34 @@ void realm_print_handler(unsigned int rec_num)
  * and try to find another CPU other than the lead one to
  * handle the Realm message logging.
  */
-static void host_init_realm_print_buffer(void)
+static void host_init_realm_print_buffer(struct realm *realm_ptr)
 {
 	host_shared_data_t *host_shared_data;
 
-	for (unsigned int i = 0U; i < realm.rec_count; i++) {
-		host_shared_data = host_get_shared_structure(i);
+	for (unsigned int i = 0U; i < realm_ptr->rec_count; i++) {
+		host_shared_data = host_get_shared_structure(realm_ptr, i);
 		(void)memset((char *)host_shared_data, 0, sizeof(host_shared_data_t));
 	}
 }
 
-static bool host_enter_realm(u_register_t *exit_reason,
+static bool host_enter_realm(struct realm *realm_ptr,
+		u_register_t *exit_reason,
 		unsigned int *host_call_result, unsigned int rec_num)
 {
 	u_register_t ret;
 
-	if (!realm_payload_created) {
-		ERROR("%s() failed\n", "realm_payload_created");
+	if (!realm_ptr->payload_created) {
+		ERROR("%s() failed\n", "payload_created");
 		return false;
 	}
-	if (!shared_mem_created) {
+	if (!realm_ptr->shared_mem_created) {
 		ERROR("%s() failed\n", "shared_mem_created");
 		return false;
 	}
 
 	/* Enter Realm */
-	ret = host_realm_rec_enter(&realm, exit_reason, host_call_result, rec_num);
+	ret = host_realm_rec_enter(realm_ptr, exit_reason, host_call_result,
+				   rec_num);
 	if (ret != REALM_SUCCESS) {
 		ERROR("%s() failed, ret=%lx\n", "host_realm_rec_enter", ret);
 		return false;
@@ -105,14 +139,18 @@ static bool host_enter_realm(u_register_t *exit_reason,
 	return true;
 }
 
-bool host_create_realm_payload(u_register_t realm_payload_adr,
+static bool host_create_realm_payload_common(struct realm *realm_ptr,
+				u_register_t realm_payload_adr,
 				u_register_t plat_mem_pool_adr,
 				u_register_t plat_mem_pool_size,
 				u_register_t realm_pages_size,
 				u_register_t feature_flag,
 				const u_register_t *rec_flag,
-				unsigned int rec_count)
+				unsigned int rec_count,
+				u_register_t par_size,
+				enum host_realm_loader loader)
 {
+	u_register_t ret;
 	int8_t value;
 
 	if (realm_payload_adr == TFTF_BASE) {
@@ -128,80 +166,92 @@ bool host_create_realm_payload(u_register_t realm_payload_adr,
 		return false;
 	}
 
+	if (realm_ptr->payload_created) {
+		ERROR("Realm already created\n");
+		return false;
+	}
+
+	if (rec_count > MAX_REC_COUNT) {
+		ERROR("Invalid Rec Count\n");
+		return false;
+	}
+
+	(void)memset(realm_ptr, 0, sizeof(*realm_ptr));
+
 	INFO("Realm base adr=0x%lx\n", realm_payload_adr);
-	/* Initialize  Host NS heap memory to be used in Realm creation*/
-	if (page_pool_init(plat_mem_pool_adr, realm_pages_size)
+	/*
+	 * Initialize Host NS heap memory to be used in Realm creation, unless
+	 * other realms already use it.
+	 */
+	if (realms_created == 0U &&
+		page_pool_init(plat_mem_pool_adr, realm_pages_size)
 		!= HEAP_INIT_SUCCESS) {
 		ERROR("%s() failed\n", "page_pool_init");
 		return false;
 	}
 
 	/* Read Realm Feature Reg 0 */
-	if (host_rmi_features(0UL, &realm.rmm_feat_reg0) != REALM_SUCCESS) {
+	if (host_rmi_features(0UL, &realm_ptr->rmm_feat_reg0) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_rmi_features");
 		return false;
 	}
 
 	/* Disable PMU if not required */
 	if ((feature_flag & RMI_FEATURE_REGISTER_0_PMU_EN) == 0UL) {
-		realm.rmm_feat_reg0 &= ~RMI_FEATURE_REGISTER_0_PMU_EN;
-		realm.pmu_num_ctrs = 0U;
+		realm_ptr->rmm_feat_reg0 &= ~RMI_FEATURE_REGISTER_0_PMU_EN;
+		realm_ptr->pmu_num_ctrs = 0U;
 	} else {
 		value = EXTRACT(FEATURE_PMU_NUM_CTRS, feature_flag);
 		if (value != -1) {
-			realm.pmu_num_ctrs = (unsigned int)value;
+			realm_ptr->pmu_num_ctrs = (unsigned int)value;
 		} else {
-			realm.pmu_num_ctrs =
+			realm_ptr->pmu_num_ctrs =
 				EXTRACT(RMI_FEATURE_REGISTER_0_PMU_NUM_CTRS,
-					realm.rmm_feat_reg0);
+					realm_ptr->rmm_feat_reg0);
 		}
 	}
 
 	/* Disable SVE if not required */
 	if ((feature_flag & RMI_FEATURE_REGISTER_0_SVE_EN) == 0UL) {
-		realm.rmm_feat_reg0 &= ~RMI_FEATURE_REGISTER_0_SVE_EN;
-		realm.sve_vl = 0U;
+		realm_ptr->rmm_feat_reg0 &= ~RMI_FEATURE_REGISTER_0_SVE_EN;
+		realm_ptr->sve_vl = 0U;
 	} else {
-		realm.sve_vl = EXTRACT(FEATURE_SVE_VL, feature_flag);
+		realm_ptr->sve_vl = EXTRACT(FEATURE_SVE_VL, feature_flag);
 	}
 
 	/* Requested number of breakpoints */
 	value = EXTRACT(FEATURE_NUM_BPS, feature_flag);
 	if (value != -1) {
-		realm.num_bps = (unsigned int)value;
+		realm_ptr->num_bps = (unsigned int)value;
 	} else {
-		realm.num_bps = EXTRACT(RMI_FEATURE_REGISTER_0_NUM_BPS,
-					realm.rmm_feat_reg0);
+		realm_ptr->num_bps = EXTRACT(RMI_FEATURE_REGISTER_0_NUM_BPS,
+					realm_ptr->rmm_feat_reg0);
 	}
 
 	/* Requested number of watchpoints */
 	value = EXTRACT(FEATURE_NUM_WPS, feature_flag);
 	if (value != -1) {
-		realm.num_wps = (unsigned int)value;
+		realm_ptr->num_wps = (unsigned int)value;
 	} else {
-		realm.num_wps = EXTRACT(RMI_FEATURE_REGISTER_0_NUM_WPS,
-					realm.rmm_feat_reg0);
+		realm_ptr->num_wps = EXTRACT(RMI_FEATURE_REGISTER_0_NUM_WPS,
+					realm_ptr->rmm_feat_reg0);
 	}
 
 	/* Set SVE bits from feature_flag */
-	realm.rmm_feat_reg0 &= ~(RMI_FEATURE_REGISTER_0_SVE_EN |
+	realm_ptr->rmm_feat_reg0 &= ~(RMI_FEATURE_REGISTER_0_SVE_EN |
 				 MASK(RMI_FEATURE_REGISTER_0_SVE_VL));
 	if ((feature_flag & RMI_FEATURE_REGISTER_0_SVE_EN) != 0UL) {
-		realm.rmm_feat_reg0 |= RMI_FEATURE_REGISTER_0_SVE_EN |
+		realm_ptr->rmm_feat_reg0 |= RMI_FEATURE_REGISTER_0_SVE_EN |
 				       INPLACE(RMI_FEATURE_REGISTER_0_SVE_VL,
 				       EXTRACT(RMI_FEATURE_REGISTER_0_SVE_VL,
 						feature_flag));
 	}
 
-	if (realm.rec_count > MAX_REC_COUNT) {
-		ERROR("Invalid Rec Count\n");
-		return false;
-	}
-	realm.rec_count = rec_count;
+	realm_ptr->rec_count = rec_count;
 	for (unsigned int i = 0U; i < rec_count; i++) {
 		if (rec_flag[i] == RMI_RUNNABLE ||
 				rec_flag[i] == RMI_NOT_RUNNABLE) {
-			realm.rec_flag[i] = rec_flag[i];
+			realm_ptr->rec_flag[i] = rec_flag[i];
 		} else {
 			ERROR("Invalid Rec Flag\n");
 			return false;
@@ -209,107 +259,189 @@ bool host_create_realm_payload(u_register_t realm_payload_adr,
 	}
 
 	/* Create Realm */
-	if (host_realm_create(&realm) != REALM_SUCCESS) {
+	realm_ptr->par_size = par_size;
+	if (host_realm_create(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_create");
 		return false;
 	}
 
-	if (host_realm_init_ipa_state(&realm, 0U, 0U, 1ULL << 32)
+	if (host_realm_init_ipa_state(realm_ptr, 0U, 0U, 1ULL << 32)
 		!= RMI_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_init_ipa_state");
 		goto destroy_realm;
 	}
 
 	/* RTT map Realm image */
-	if (host_realm_map_payload_image(&realm, realm_payload_adr) !=
-			REALM_SUCCESS) {
+	if (loader == HOST_REALM_LOAD_PAGES) {
+		ret = host_realm_map_payload_image(realm_ptr, realm_payload_adr);
+	} else {
+		ret = host_realm_map_payload_image_blocks(realm_ptr,
+				realm_payload_adr,
+				loader == HOST_REALM_LOAD_BLOCKS_ALL_CORES);
+	}
+	if (ret != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_map_payload_image");
 		goto destroy_realm;
 	}
 
 	/* Create REC */
-	if (host_realm_rec_create(&realm) != REALM_SUCCESS) {
+	if (host_realm_rec_create(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_rec_create");
 		goto destroy_realm;
 	}
 
 	/* Activate Realm */
-	if (host_realm_activate(&realm) != REALM_SUCCESS) {
+	if (host_realm_activate(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_activate");
 		goto destroy_realm;
 	}
 
-	realm_payload_created = true;
+	realm_ptr->payload_created = true;
+	realms_created++;
 
-	return realm_payload_created;
+	return true;
 
 	/* Free test resources */
 destroy_realm:
-	if (host_realm_destroy(&realm) != REALM_SUCCESS) {
+	if (host_realm_destroy(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_destroy");
 	}
-	realm_payload_created = false;
 
-	return realm_payload_created;
+	if (realms_created == 0U) {
+		page_pool_reset();
+	}
+
+	return false;
 }
 
-bool host_create_shared_mem(u_register_t ns_shared_mem_adr,
+bool host_create_realm_payload(struct realm *realm_ptr,
+				u_register_t realm_payload_adr,
+				u_register_t plat_mem_pool_adr,
+				u_register_t plat_mem_pool_size,
+				u_register_t realm_pages_size,
+				u_register_t feature_flag,
+				const u_register_t *rec_flag,
+				unsigned int rec_count)
+{
+	return host_create_realm_payload_common(realm_ptr,
+						realm_payload_adr,
+						plat_mem_pool_adr,
+						plat_mem_pool_size,
+						realm_pages_size,
+						feature_flag,
+						rec_flag, rec_count,
+						REALM_MAX_LOAD_IMG_SIZE,
+						HOST_REALM_LOAD_PAGES);
+}
+
+/*
+ * Create a realm as host_create_realm_payload() does, with a PAR of
+ * 'par_size' bytes mapped by 'loader'. The realm image is repeated to fill
+ * the PAR.
+ */
+bool host_create_realm_payload_sized(struct realm *realm_ptr,
+				u_register_t realm_payload_adr,
+				u_register_t plat_mem_pool_adr,
+				u_register_t plat_mem_pool_size,
+				u_register_t realm_pages_size,
+				u_register_t feature_flag,
+				const u_register_t *rec_flag,
+				unsigned int rec_count,
+				u_register_t par_size,
+				enum host_realm_loader loader)
+{
+	if (par_size < REALM_MAX_LOAD_IMG_SIZE ||
+			!IS_ALIGNED(par_size, PAGE_SIZE)) {
+		ERROR("Invalid PAR size 0x%lx\n", par_size);
+		return false;
+	}
+
+	return host_create_realm_payload_common(realm_ptr,
+						realm_payload_adr,
+						plat_mem_pool_adr,
+						plat_mem_pool_size,
+						realm_pages_size,
+						feature_flag,
+						rec_flag, rec_count,
+						par_size, loader);
+}
+
+/*
+ * Map the NS region holding the shared data of the RECs of the realm. Each
+ * realm alive at the same time needs a region of its own.
+ */
+bool host_create_shared_mem(struct realm *realm_ptr,
+	u_register_t ns_shared_mem_adr,
 	u_register_t ns_shared_mem_size)
 {
+	if (ns_shared_mem_size <
+			(realm_ptr->rec_count * sizeof(host_shared_data_t))) {
+		ERROR("Shared region too small for %u RECs\n",
+			realm_ptr->rec_count);
+		return false;
+	}
+
 	/* RTT map NS shared region */
-	if (host_realm_map_ns_shared(&realm, ns_shared_mem_adr,
+	if (host_realm_map_ns_shared(realm_ptr, ns_shared_mem_adr,
 				ns_shared_mem_size) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_map_ns_shared");
-		shared_mem_created = false;
+		realm_ptr->shared_mem_created = false;
 		return false;
 	}
 
 	memset((void *)ns_shared_mem_adr, 0, (size_t)ns_shared_mem_size);
-	host_init_realm_print_buffer();
-	shared_mem_created = true;
+	realm_ptr->host_shared_data = ns_shared_mem_adr;
+	host_init_realm_print_buffer(realm_ptr);
+	realm_ptr->shared_mem_created = true;
 
-	return shared_mem_created;
+	return realm_ptr->shared_mem_created;
 }
 
-bool host_destroy_realm(void)
+bool host_destroy_realm(struct realm *realm_ptr)
 {
-	/* Free test resources */
-	timer_enabled = false;
-	page_pool_reset();
+	bool ret = true;
 
-	if (!realm_payload_created) {
-		ERROR("%s() failed\n", "realm_payload_created");
+	if (!realm_ptr->payload_created) {
+		ERROR("%s() failed\n", "payload_created");
+		if (realms_created == 0U) {
+			page_pool_reset();
+		}
 		return false;
 	}
 
-	realm_payload_created = false;
-	if (host_realm_destroy(&realm) != REALM_SUCCESS) {
+	realm_ptr->payload_created = false;
+	realm_ptr->shared_mem_created = false;
+	realms_created--;
+
+	/* Unfolding L2 blocks during the teardown allocates new RTTs */
+	if (host_realm_destroy(realm_ptr) != REALM_SUCCESS) {
 		ERROR("%s() failed\n", "host_realm_destroy");
-		return false;
+		ret = false;
 	}
 
-	return true;
+	if (realms_created == 0U) {
+		page_pool_reset();
+	}
+
+	return ret;
 }
 
-bool host_enter_realm_execute(uint8_t cmd, struct realm **realm_ptr,
+bool host_enter_realm_execute(struct realm *realm_ptr, uint8_t cmd,
 		int test_exit_reason, unsigned int rec_num)
 {
 	u_register_t exit_reason = RMI_EXIT_INVALID;
 	unsigned int host_call_result = TEST_RESULT_FAIL;
 
-	if (rec_num >= realm.rec_count) {
+	if (rec_num >= realm_ptr->rec_count) {
 		ERROR("Invalid Rec Count\n");
 		return false;
 	}
-	host_shared_data_set_realm_cmd(cmd, rec_num);
-	if (!host_enter_realm(&exit_reason, &host_call_result, rec_num)) {
+	host_shared_data_set_realm_cmd(realm_ptr, cmd, rec_num);
+	if (!host_enter_realm(realm_ptr, &exit_reason, &host_call_result,
+			      rec_num)) {
 		return false;
 	}
 
-	if (realm_ptr != NULL) {
-		*realm_ptr = &realm;
-	}
-
 	if ((exit_reason == RMI_EXIT_HOST_CALL) && (host_call_result == TEST_RESULT_SUCCESS)) {
 		return true;
 	}
@@ -342,10 +474,11 @@ test_result_t host_cmp_result(void)
  * Returns Host core position for specified Rec
  * Host mpidr is saved on every rec enter
  */
-static unsigned int host_realm_find_core_pos_by_rec(unsigned int rec_num)
+static unsigned int host_realm_find_core_pos_by_rec(struct realm *realm_ptr,
+						    unsigned int rec_num)
 {
-	if (rec_num < MAX_REC_COUNT && realm.run[rec_num] != 0U) {
-		return platform_get_core_pos(realm.host_mpidr[rec_num]);
+	if (rec_num < MAX_REC_COUNT && realm_ptr->run[rec_num] != 0U) {
+		return platform_get_core_pos(realm_ptr->host_mpidr[rec_num]);
 	}
 	return (unsigned int)-1;
 }
@@ -354,9 +487,11 @@ static unsigned int host_realm_find_core_pos_by_rec(unsigned int rec_num)
  * Send SGI on core running specified Rec
  * API can be used to forcefully exit from Realm
  */
-void host_rec_send_sgi(unsigned int sgi, unsigned int rec_num)
+void host_rec_send_sgi(struct realm *realm_ptr, unsigned int sgi,
+		       unsigned int rec_num)
 {
-	unsigned int core_pos = host_realm_find_core_pos_by_rec(rec_num);
+	unsigned int core_pos = host_realm_find_core_pos_by_rec(realm_ptr,
+								rec_num);
 	if (core_pos < PLATFORM_CORE_COUNT) {
 		tftf_send_sgi(sgi, core_pos);
 	}
@@ -8,6 +8,8 @@
 #include <assert.h>
 #include <string.h>
 
+#include <arch_helpers.h>
+#include <bench_stats.h>
 #include <debug.h>
 #include <heap/page_alloc.h>
 #include <test_helpers.h>
@@ -16,6 +18,9 @@
 #include <host_realm_rmi.h>
 #include <host_shared_data.h>
 #include <plat/common/platform.h>
+#include <plat_topology.h>
+#include <power_management.h>
+#include <psci.h>
 #include <realm_def.h>
 #include <tftf_lib.h>
 
@@ -35,15 +40,124 @@
 static bool rmi_cmp_result;
 static unsigned short vmid;
 
-static smc_ret_values host_rmi_handler(smc_args *args, unsigned int in_reg)
+/* Index of an RMI function ID in the tables below */
+#define RMI_FID_INDEX(_fid)						\
+	((((_fid) >> FUNCID_NUM_SHIFT) & FUNCID_NUM_MASK) - RMI_FNUM_MIN_VALUE)
+#define RMI_FID_COUNT	(RMI_FNUM_MAX_VALUE - RMI_FNUM_MIN_VALUE + 1U)
+
+#if HOST_RMI_STATS
+#define RMI_FID_NAME(_fid)	\
+	[RMI_FID_INDEX(RMI_##_fid)] = #_fid
+
+static const char *const rmi_fid_names[RMI_FID_COUNT] = {
+	RMI_FID_NAME(VERSION),
+	RMI_FID_NAME(GRANULE_DELEGATE),
+	RMI_FID_NAME(GRANULE_UNDELEGATE),
+	RMI_FID_NAME(DATA_CREATE),
+	RMI_FID_NAME(DATA_CREATE_UNKNOWN),
+	RMI_FID_NAME(DATA_DESTROY),
+	RMI_FID_NAME(REALM_ACTIVATE),
+	RMI_FID_NAME(REALM_CREATE),
+	RMI_FID_NAME(REALM_DESTROY),
+	RMI_FID_NAME(REC_CREATE),
+	RMI_FID_NAME(REC_DESTROY),
+	RMI_FID_NAME(REC_ENTER),
+	RMI_FID_NAME(RTT_CREATE),
+	RMI_FID_NAME(RTT_DESTROY),
+	RMI_FID_NAME(RTT_MAP_UNPROTECTED),
+	RMI_FID_NAME(RTT_READ_ENTRY),
+	RMI_FID_NAME(RTT_UNMAP_UNPROTECTED),
+	RMI_FID_NAME(PSCI_COMPLETE),
+	RMI_FID_NAME(FEATURES),
+	RMI_FID_NAME(RTT_FOLD),
+	RMI_FID_NAME(REC_AUX_COUNT),
+	RMI_FID_NAME(RTT_INIT_RIPAS),
+	RMI_FID_NAME(RTT_SET_RIPAS)
+};
+
+/*
+ * Statistics are kept per core, such that RECs running on several cores do
+ * not have to synchronise, and are summed up when read.
+ */
+static struct host_rmi_stats rmi_stats[PLATFORM_CORE_COUNT][RMI_FID_COUNT];
+
+static void host_rmi_stats_update(u_register_t fid, uint64_t ticks,
+				  u_register_t status)
+{
+	struct host_rmi_stats *stats;
+	unsigned int index = RMI_FID_INDEX(fid);
+
+	if (index >= RMI_FID_COUNT) {
+		return;
+	}
+
+	stats = &rmi_stats[platform_get_core_pos(read_mpidr_el1())][index];
+	stats->count++;
+	stats->total_ticks += ticks;
+	if (ticks > stats->max_ticks) {
+		stats->max_ticks = ticks;
+	}
+	if (status != RMI_SUCCESS) {
+		stats->errors++;
+	}
+}
+#endif /* HOST_RMI_STATS */
+
+/*
+ * The registers preserved by the RMM are checked in 1 of 'rmi_regs_check' RMI
+ * calls made by each core, or in none of them if it is 0. A test that changes
+ * it with host_rmi_regs_check_set() restores the previous rate before it
+ * returns.
+ */
+static unsigned int rmi_regs_check = HOST_RMI_REGS_CHECK;
+static unsigned int rmi_regs_check_calls[PLATFORM_CORE_COUNT];
+
+static bool host_rmi_regs_check_due(void)
+{
+	unsigned int *calls;
+
+	if (rmi_regs_check <= 1U) {
+		return rmi_regs_check == 1U;
+	}
+
+	calls = &rmi_regs_check_calls[platform_get_core_pos(read_mpidr_el1())];
+	if (++(*calls) < rmi_regs_check) {
+		return false;
+	}
+
+	*calls = 0U;
+	return true;
+}
+
+static smc_ret_values host_rmi_smc(smc_args *args)
+{
+#if HOST_RMI_STATS
+	smc_ret_values ret_val;
+	uint64_t start;
+
+	start = read_cntpct_el0();
+	ret_val = tftf_smc(args);
+	host_rmi_stats_update(args->fid, read_cntpct_el0() - start,
+			      ret_val.ret0);
+
+	return ret_val;
+#else
+	return tftf_smc(args);
+#endif
+}
+
+/*
+ * Make the RMI call with the argument registers from X'in_reg' to X7
+ * randomized, and return the mask of the registers X4 to X7 the RMM did not
+ * preserve.
+ */
+static unsigned int host_rmi_checked_smc(smc_args *args, unsigned int in_reg,
+					 smc_ret_values *ret)
 {
 	u_register_t regs[8];
 	smc_ret_values ret_val;
 	unsigned int cmp_flag = 0U;
 
-	assert(args != NULL);
-	assert((in_reg >= 1U) && (in_reg <= 7U));
-
 	/* Function identifier */
 	regs[0] = (u_register_t)args->fid;
 
@@ -64,7 +178,7 @@ static smc_ret_values host_rmi_handler(smc_args *args, unsigned int in_reg)
 		args->arg7 = regs[7];
 	}
 
-	ret_val = tftf_smc(args);
+	ret_val = host_rmi_smc(args);
 
 	/*
 	 * According to SMCCC v1.2 X4-X7 registers' values
@@ -90,12 +204,56 @@ static smc_ret_values host_rmi_handler(smc_args *args, unsigned int in_reg)
 			(((cmp_flag & (1U << 7)) != 0U) ? "X7" : ""));
 	}
 
+	*ret = ret_val;
+	return cmp_flag;
+}
+
+static smc_ret_values host_rmi_handler(smc_args *args, unsigned int in_reg)
+{
+	smc_ret_values ret_val;
+
+	assert(args != NULL);
+	assert((in_reg >= 1U) && (in_reg <= 7U));
+
+	if (!host_rmi_regs_check_due()) {
+		return host_rmi_smc(args);
+	}
+
+	(void)host_rmi_checked_smc(args, in_reg, &ret_val);
 	return ret_val;
 }
 
+/*
+ * Check the registers preserved by 1 in 'rate' RMI calls on each core from
+ * now on, or by none of them if 0. Returns the previous rate, which the caller
+ * restores once done.
+ */
+unsigned int host_rmi_regs_check_set(unsigned int rate)
+{
+	unsigned int prev = rmi_regs_check;
+
+	rmi_regs_check = rate;
+	(void)memset(rmi_regs_check_calls, 0, sizeof(rmi_regs_check_calls));
+
+	return prev;
+}
+
+/*
+ * Call 'fid' with all of X1 to X7 randomized, whatever the check rate, and
+ * return the mask of the registers X4 to X7 the RMM did not preserve.
+ */
+unsigned int host_rmi_regs_check_fid(u_register_t fid)
+{
+	smc_ret_values ret_val;
+
+	return host_rmi_checked_smc(&(smc_args) {(uint32_t)fid}, 1U,
+				    &ret_val);
+}
+
 void host_rmi_init_cmp_result(void)
 {
 	rmi_cmp_result = true;
+	(void)host_rmi_regs_check_set(HOST_RMI_REGS_CHECK);
 }
 
 bool host_rmi_get_cmp_result(void)
@@ -103,6 +261,393 @@ bool host_rmi_get_cmp_result(void)
 	return rmi_cmp_result;
 }
 
+void host_rmi_stats_reset(void)
+{
+#if HOST_RMI_STATS
+	(void)memset(rmi_stats, 0, sizeof(rmi_stats));
+#endif
+}
+
+/*
+ * Sum up the statistics of 'fid' on all cores. Returns false if the host is
+ * not built with HOST_RMI_STATS.
+ */
+bool host_rmi_stats_get(u_register_t fid, struct host_rmi_stats *stats)
+{
+	(void)memset(stats, 0, sizeof(*stats));
+
+#if HOST_RMI_STATS
+	unsigned int index = RMI_FID_INDEX(fid);
+
+	if (index >= RMI_FID_COUNT) {
+		return true;
+	}
+
+	for (unsigned int core = 0U; core < PLATFORM_CORE_COUNT; core++) {
+		const struct host_rmi_stats *s = &rmi_stats[core][index];
+
+		stats->count += s->count;
+		stats->errors += s->errors;
+		stats->total_ticks += s->total_ticks;
+		if (s->max_ticks > stats->max_ticks) {
+			stats->max_ticks = s->max_ticks;
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * Print the statistics of each RMI function called since the last reset,
+ * with its share of the total time spent in RMI calls. Only the total goes to
+ * the test output, which a line per function would overflow.
+ */
+void host_rmi_stats_print(const char *title)
+{
+#if HOST_RMI_STATS
+	struct host_rmi_stats stats[RMI_FID_COUNT];
+	uint64_t total_ticks = 0U;
+
+	for (unsigned int i = 0U; i < RMI_FID_COUNT; i++) {
+		(void)host_rmi_stats_get(SMC64_RMI_FID(i), &stats[i]);
+		total_ticks += stats[i].total_ticks;
+	}
+
+	tftf_testcase_printf("%s: %lluns in RMI calls\n", title,
+			     (unsigned long long)bench_ticks_to_ns(total_ticks));
+
+	for (unsigned int i = 0U; i < RMI_FID_COUNT; i++) {
+		if (stats[i].count == 0U) {
+			continue;
+		}
+
+		INFO("  %-22s %6llu calls %4llu errors "
+			"total %10lluns (%3llu%%) avg %8lluns max %8lluns\n",
+			(rmi_fid_names[i] != NULL) ? rmi_fid_names[i] : "?",
+			(unsigned long long)stats[i].count,
+			(unsigned long long)stats[i].errors,
+			(unsigned long long)bench_ticks_to_ns(
+				stats[i].total_ticks),
+			(unsigned long long)((total_ticks != 0U) ?
+				(stats[i].total_ticks * 100U / total_ticks) :
+				0U),
+			(unsigned long long)bench_ticks_to_ns(
+				stats[i].total_ticks / stats[i].count),
+			(unsigned long long)bench_ticks_to_ns(
+				stats[i].max_ticks));
+	}
+#else
+	tftf_testcase_printf("%s: RMI statistics need HOST_RMI_STATS=1\n",
+			     title);
+#endif
+}
+
+/*
+ * Host view of the delegated granules of the page pool, one bit per granule,
+ * kept up to date by host_rmi_granule_delegate() and
+ * host_rmi_granule_undelegate(). Granules outside of the page pool are not
+ * tracked. There is at least one word when there is no page pool.
+ */
+#define GRANULE_MAP_WORDS	((PAGE_POOL_MAX_SIZE / PAGE_SIZE / 64U) + 1U)
+
+static uint64_t delegated_map[GRANULE_MAP_WORDS];
+static spinlock_t delegated_lock;
+
+/*
+ * Granules delegated once by host_realm_delegated_pool_init(), which realms
+ * take their delegated granules from and give back to, without delegating or
+ * undelegating them, until host_realm_delegated_pool_destroy(). A set bit of
+ * 'free_map' is a granule not in use.
+ */
+static struct {
+	u_register_t base;
+	u_register_t count;
+	uint64_t free_map[GRANULE_MAP_WORDS];
+} delegated_pool;
+
+static bool host_granule_map_index(u_register_t addr, u_register_t *index)
+{
+	if ((addr < PAGE_POOL_BASE) ||
+	    (addr >= (PAGE_POOL_BASE + PAGE_POOL_MAX_SIZE))) {
+		return false;
+	}
+
+	*index = (addr - PAGE_POOL_BASE) / PAGE_SIZE;
+	return true;
+}
+
+static void host_granule_map_update(u_register_t addr, bool delegated)
+{
+	u_register_t i;
+
+	if (!host_granule_map_index(addr, &i)) {
+		return;
+	}
+
+	spin_lock(&delegated_lock);
+	if (delegated) {
+		delegated_map[i / 64U] |= BIT_64(i % 64U);
+	} else {
+		delegated_map[i / 64U] &= ~BIT_64(i % 64U);
+	}
+	spin_unlock(&delegated_lock);
+}
+
+bool host_granule_is_delegated(u_register_t addr)
+{
+	u_register_t i;
+
+	if (!host_granule_map_index(addr, &i)) {
+		return false;
+	}
+
+	return (delegated_map[i / 64U] & BIT_64(i % 64U)) != 0ULL;
+}
+
+/*
+ * Delegate the granules of [addr, addr + size). If one of them fails, those
+ * delegated so far are undelegated, and its error is returned.
+ */
+u_register_t host_rmi_granule_delegate_range(u_register_t addr,
+					     u_register_t size)
+{
+	u_register_t ret;
+
+	for (u_register_t off = 0UL; off < size; off += PAGE_SIZE) {
+		ret = host_rmi_granule_delegate(addr + off);
+		if (ret == RMI_SUCCESS) {
+			continue;
+		}
+
+		while (off != 0UL) {
+			off -= PAGE_SIZE;
+			(void)host_rmi_granule_undelegate(addr + off);
+		}
+		return ret;
+	}
+
+	return RMI_SUCCESS;
+}
+
+/*
+ * Undelegate the granules of [addr, addr + size). All of them are attempted,
+ * and the error of the first one that fails is returned.
+ */
+u_register_t host_rmi_granule_undelegate_range(u_register_t addr,
+					       u_register_t size)
+{
+	u_register_t ret, first_ret = RMI_SUCCESS;
+
+	for (u_register_t off = 0UL; off < size; off += PAGE_SIZE) {
+		ret = host_rmi_granule_undelegate(addr + off);
+		if ((ret != RMI_SUCCESS) && (first_ret == RMI_SUCCESS)) {
+			first_ret = ret;
+		}
+	}
+
+	return first_ret;
+}
+
+/*
+ * Set up the delegated pool with the granules of [base, base + size), which
+ * must be part of the page pool and not handed out by the page allocator.
+ */
+u_register_t host_realm_delegated_pool_init(u_register_t base,
+					    u_register_t size)
+{
+	u_register_t index, ret;
+
+	if ((delegated_pool.count != 0UL) || (size == 0UL) ||
+	    !IS_ALIGNED(base, PAGE_SIZE) || !IS_ALIGNED(size, PAGE_SIZE) ||
+	    !host_granule_map_index(base, &index) ||
+	    !host_granule_map_index(base + size - PAGE_SIZE, &index)) {
+		ERROR("Invalid delegated pool, base=0x%lx size=0x%lx\n",
+			base, size);
+		return REALM_ERROR;
+	}
+
+	ret = host_rmi_granule_delegate_range(base, size);
+	if (ret != RMI_SUCCESS) {
+		ERROR("%s() failed, base=0x%lx size=0x%lx ret=0x%lx\n",
+			"host_rmi_granule_delegate_range", base, size, ret);
+		return REALM_ERROR;
+	}
+
+	spin_lock(&delegated_lock);
+	delegated_pool.base = base;
+	delegated_pool.count = size / PAGE_SIZE;
+	for (u_register_t i = 0UL; i < delegated_pool.count; i++) {
+		delegated_pool.free_map[i / 64U] |= BIT_64(i % 64U);
+	}
+	spin_unlock(&delegated_lock);
+
+	return REALM_SUCCESS;
+}
+
+/*
+ * Undelegate the granules of the delegated pool, all of which must have been
+ * given back by the realms.
+ */
+u_register_t host_realm_delegated_pool_destroy(void)
+{
+	u_register_t base = delegated_pool.base;
+	u_register_t count = delegated_pool.count;
+	u_register_t ret;
+
+	for (u_register_t i = 0UL; i < count; i++) {
+		if ((delegated_pool.free_map[i / 64U] & BIT_64(i % 64U)) ==
+		    0ULL) {
+			ERROR("Delegated pool granule 0x%lx still in use\n",
+				base + (i * PAGE_SIZE));
+			return REALM_ERROR;
+		}
+	}
+
+	spin_lock(&delegated_lock);
+	(void)memset(&delegated_pool, 0, sizeof(delegated_pool));
+	spin_unlock(&delegated_lock);
+
+	ret = host_rmi_granule_undelegate_range(base, count * PAGE_SIZE);
+	if (ret != RMI_SUCCESS) {
+		ERROR("%s() failed, base=0x%lx ret=0x%lx\n",
+			"host_rmi_granule_undelegate_range", base, ret);
+		return REALM_ERROR;
+	}
+
+	return REALM_SUCCESS;
+}
+
+/*
+ * Take 'size' bytes aligned to 'align' from the delegated pool, first fit.
+ * Returns HEAP_NULL_PTR if there is no pool or no such free range in it.
+ */
+static u_register_t host_delegated_pool_alloc(u_register_t size,
+					      u_register_t align)
+{
+	u_register_t count = size / PAGE_SIZE;
+	u_register_t base = delegated_pool.base;
+	u_register_t first, i, addr = HEAP_NULL_PTR;
+
+	spin_lock(&delegated_lock);
+
+	first = (round_up(base, align) - base) / PAGE_SIZE;
+	while ((first + count) <= delegated_pool.count) {
+		for (i = first; i < (first + count); i++) {
+			if ((delegated_pool.free_map[i / 64U] &
+			     BIT_64(i % 64U)) == 0ULL) {
+				break;
+			}
+		}
+
+		if (i == (first + count)) {
+			for (i = first; i < (first + count); i++) {
+				delegated_pool.free_map[i / 64U] &=
+					~BIT_64(i % 64U);
+			}
+			addr = base + (first * PAGE_SIZE);
+			break;
+		}
+
+		/* Restart past the granule in use */
+		first = (round_up(base + ((i + 1UL) * PAGE_SIZE), align) -
+			 base) / PAGE_SIZE;
+	}
+
+	spin_unlock(&delegated_lock);
+
+	return addr;
+}
+
+/*
+ * Give 'size' bytes back to the delegated pool. Returns false if they are not
+ * part of it.
+ */
+static bool host_delegated_pool_free(u_register_t addr, u_register_t size)
+{
+	u_register_t base = delegated_pool.base;
+	u_register_t first = (addr - base) / PAGE_SIZE;
+
+	if ((delegated_pool.count == 0UL) || (addr < base) ||
+	    ((first + (size / PAGE_SIZE)) > delegated_pool.count)) {
+		return false;
+	}
+
+	spin_lock(&delegated_lock);
+	for (u_register_t i = first; i < (first + (size / PAGE_SIZE)); i++) {
+		delegated_pool.free_map[i / 64U] |= BIT_64(i % 64U);
+	}
+	spin_unlock(&delegated_lock);
+
+	return true;
+}
+
+/*
+ * Allocate 'size' bytes of delegated granules aligned to 'align', from the
+ * delegated pool if there is one, else from the page pool. Returns
+ * HEAP_NULL_PTR on failure.
+ */
+static u_register_t host_realm_alloc_delegated(u_register_t size,
+					       u_register_t align)
+{
+	u_register_t addr, ret;
+
+	addr = host_delegated_pool_alloc(size, align);
+	if (addr != HEAP_NULL_PTR) {
+		return addr;
+	}
+
+	if (align > PAGE_SIZE) {
+		addr = (u_register_t)page_alloc_aligned(size, align);
+	} else {
+		addr = (u_register_t)page_alloc(size);
+	}
+	if (addr == HEAP_NULL_PTR) {
+		return HEAP_NULL_PTR;
+	}
+
+	ret = host_rmi_granule_delegate_range(addr, size);
+	if (ret != RMI_SUCCESS) {
+		ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
+			"host_rmi_granule_delegate_range", addr, ret);
+		page_free(addr);
+		return HEAP_NULL_PTR;
+	}
+
+	return addr;
+}
+
+/*
+ * Free delegated granules, which stay delegated if they go back to the
+ * delegated pool, and are undelegated otherwise.
+ */
+static u_register_t host_realm_free_delegated(u_register_t addr,
+					      u_register_t size)
+{
+	u_register_t ret;
+
+	if (host_delegated_pool_free(addr, size)) {
+		return RMI_SUCCESS;
+	}
+
+	ret = host_rmi_granule_undelegate_range(addr, size);
+	if (ret == RMI_SUCCESS) {
+		page_free(addr);
+	}
+
+	return ret;
+}
+
+/* Free the PAR, whose granules are delegated only if it is from the pool */
+static void host_realm_free_par(struct realm *realm)
+{
+	if (!host_delegated_pool_free(realm->par_base, realm->par_size)) {
+		page_free(realm->par_base);
+	}
+}
+
 u_register_t host_rmi_psci_complete(u_register_t calling_rec, u_register_t target_rec,
 		unsigned long status)
 {
@@ -301,13 +846,172 @@ static inline u_register_t host_rtt_level_mapsize(u_register_t level)
 	return (1UL << RTT_LEVEL_SHIFT(level));
 }
 
-static inline u_register_t host_realm_rtt_create(struct realm *realm,
-						 u_register_t addr,
-						 u_register_t level,
-						 u_register_t phys)
+static inline u_register_t host_realm_ns_ipa_bit(struct realm *realm)
+{
+	return 1UL << (EXTRACT(RMI_FEATURE_REGISTER_0_S2SZ,
+			       realm->rmm_feat_reg0) - 1UL);
+}
+
+/*
+ * Shadow RTTs: the host records each RTT it creates below the starting level,
+ * and each entry it maps, such that teardown only visits populated entries.
+ * The shadow is dropped when it is full or when the RTTs were changed in a way
+ * it does not track, and teardown then walks the RTTs with RMI_RTT_READ_ENTRY.
+ */
+static struct realm_shadow_rtt *host_shadow_rtt_find(struct realm *realm,
+						     u_register_t addr,
+						     u_register_t level)
 {
+	if (level == 0UL || level > RTT_MAX_LEVEL) {
+		return NULL;
+	}
+
 	addr = ALIGN_DOWN(addr, host_rtt_level_mapsize(level - 1U));
-	return host_rmi_rtt_create(realm->rd, phys, addr, level);
+
+	for (unsigned int n = 0U; n < realm->shadow_rtt_count; n++) {
+		if (realm->shadow_rtt[n].level == level &&
+		    realm->shadow_rtt[n].ipa == addr) {
+			return &realm->shadow_rtt[n];
+		}
+	}
+
+	return NULL;
+}
+
+static inline unsigned int host_shadow_rtt_index(struct realm_shadow_rtt *rtt,
+						 u_register_t addr)
+{
+	return (addr - rtt->ipa) / host_rtt_level_mapsize(rtt->level);
+}
+
+static inline bool host_shadow_rtt_is_assigned(struct realm_shadow_rtt *rtt,
+					       unsigned int i)
+{
+	return (rtt->assigned[i / 64U] & BIT_64(i % 64U)) != 0ULL;
+}
+
+static void host_shadow_rtt_set_entry(struct realm *realm, u_register_t addr,
+				      u_register_t level, bool assigned)
+{
+	struct realm_shadow_rtt *rtt;
+	unsigned int i;
+
+	if (!realm->shadow_rtt_valid) {
+		return;
+	}
+
+	rtt = host_shadow_rtt_find(realm, addr, level);
+	if (rtt == NULL) {
+		/* Entry of the starting level RTT */
+		realm->shadow_rtt_valid = false;
+		return;
+	}
+
+	i = host_shadow_rtt_index(rtt, addr);
+	if (assigned) {
+		rtt->assigned[i / 64U] |= BIT_64(i % 64U);
+	} else {
+		rtt->assigned[i / 64U] &= ~BIT_64(i % 64U);
+	}
+}
+
+static void host_shadow_rtt_add(struct realm *realm, u_register_t addr,
+				u_register_t level, u_register_t pa)
+{
+	struct realm_shadow_rtt *rtt, *parent;
+	unsigned int i;
+
+	if (!realm->shadow_rtt_valid) {
+		return;
+	}
+
+	if (realm->shadow_rtt_count == REALM_MAX_SHADOW_RTTS) {
+		VERBOSE("Shadow RTTs full, teardown walks the RTTs\n");
+		realm->shadow_rtt_valid = false;
+		return;
+	}
+
+	rtt = &realm->shadow_rtt[realm->shadow_rtt_count++];
+	rtt->ipa = ALIGN_DOWN(addr, host_rtt_level_mapsize(level - 1U));
+	rtt->pa = pa;
+	rtt->level = level;
+	(void)memset(rtt->assigned, 0, sizeof(rtt->assigned));
+
+	/* An RTT created over an assigned block entry unfolds it */
+	parent = host_shadow_rtt_find(realm, addr, level - 1U);
+	if (parent == NULL) {
+		return;
+	}
+
+	i = host_shadow_rtt_index(parent, addr);
+	if (host_shadow_rtt_is_assigned(parent, i)) {
+		parent->assigned[i / 64U] &= ~BIT_64(i % 64U);
+		(void)memset(rtt->assigned, 0xff, sizeof(rtt->assigned));
+	}
+}
+
+static void host_shadow_rtt_remove(struct realm *realm, u_register_t addr,
+				   u_register_t level)
+{
+	struct realm_shadow_rtt *rtt;
+
+	if (!realm->shadow_rtt_valid) {
+		return;
+	}
+
+	rtt = host_shadow_rtt_find(realm, addr, level);
+	if (rtt == NULL) {
+		realm->shadow_rtt_valid = false;
+		return;
+	}
+
+	*rtt = realm->shadow_rtt[--realm->shadow_rtt_count];
+}
+
+/*
+ * The RTT of 'level' + 1 mapping 'addr' was folded into an entry of 'level',
+ * which is assigned if all the entries of the RTT were.
+ */
+static void host_shadow_rtt_fold(struct realm *realm, u_register_t addr,
+				 u_register_t level)
+{
+	struct realm_shadow_rtt *rtt;
+	bool assigned = true;
+
+	if (!realm->shadow_rtt_valid) {
+		return;
+	}
+
+	rtt = host_shadow_rtt_find(realm, addr, level + 1U);
+	if (rtt == NULL) {
+		realm->shadow_rtt_valid = false;
+		return;
+	}
+
+	for (unsigned int w = 0U; w < ARRAY_SIZE(rtt->assigned); w++) {
+		if (rtt->assigned[w] != ~0ULL) {
+			assigned = false;
+		}
+	}
+
+	host_shadow_rtt_remove(realm, addr, level + 1U);
+	host_shadow_rtt_set_entry(realm, addr, level, assigned);
+}
+
+static u_register_t host_realm_rtt_create(struct realm *realm,
+					  u_register_t addr,
+					  u_register_t level,
+					  u_register_t phys)
+{
+	u_register_t ret;
+
+	addr = ALIGN_DOWN(addr, host_rtt_level_mapsize(level - 1U));
+	ret = host_rmi_rtt_create(realm->rd, phys, addr, level);
+	if (ret == RMI_SUCCESS) {
+		host_shadow_rtt_add(realm, addr, level, phys);
+	}
+
+	return ret;
 }
 
 static u_register_t host_rmi_create_rtt_levels(struct realm *realm,
@@ -318,24 +1022,16 @@ static u_register_t host_rmi_create_rtt_levels(struct realm *realm,
 	u_register_t rtt, ret;
 
 	while (level++ < max_level) {
-		rtt = (u_register_t)page_alloc(PAGE_SIZE);
+		rtt = host_realm_alloc_delegated(PAGE_SIZE, PAGE_SIZE);
 		if (rtt == HEAP_NULL_PTR) {
 			ERROR("Failed to allocate memory for rtt\n");
 			return REALM_ERROR;
-		} else {
-			ret = host_rmi_granule_delegate(rtt);
-			if (ret != RMI_SUCCESS) {
-				ERROR("%s() failed, rtt=0x%lx ret=0x%lx\n",
-					"host_rmi_granule_delegate", rtt, ret);
-				return REALM_ERROR;
-			}
 		}
 		ret = host_realm_rtt_create(realm, map_addr, level, rtt);
 		if (ret != RMI_SUCCESS) {
 			ERROR("%s() failed, rtt=0x%lx ret=0x%lx\n",
 				"host_realm_rtt_create", rtt, ret);
-			host_rmi_granule_undelegate(rtt);
-			page_free(rtt);
+			(void)host_realm_free_delegated(rtt, PAGE_SIZE);
 			return REALM_ERROR;
 		}
 	}
@@ -343,9 +1039,10 @@ static u_register_t host_rmi_create_rtt_levels(struct realm *realm,
 	return REALM_SUCCESS;
 }
 
-static u_register_t host_realm_fold_rtt(u_register_t rd, u_register_t addr,
+static u_register_t host_realm_fold_rtt(struct realm *realm, u_register_t addr,
 					u_register_t level)
 {
+	u_register_t rd = realm->rd;
 	struct rtt_entry rtt;
 	u_register_t pa, ret;
 
@@ -370,7 +1067,16 @@ static u_register_t host_realm_fold_rtt(u_register_t rd, u_register_t addr,
 		return REALM_ERROR;
 	}
 
-	page_free(rtt.out_addr);
+	host_shadow_rtt_fold(realm, addr, level);
+
+	/* The folded RTT goes back to the NS world or the delegated pool */
+	ret = host_realm_free_delegated(rtt.out_addr, PAGE_SIZE);
+	if (ret != RMI_SUCCESS) {
+		ERROR("%s() failed, rtt=0x%lx ret=0x%lx\n",
+			"host_realm_free_delegated",
+			(u_register_t)rtt.out_addr, ret);
+		return REALM_ERROR;
+	}
 
 	return REALM_SUCCESS;
 
@@ -425,11 +1131,14 @@ static u_register_t host_realm_map_protected_data(bool unknown,
 		}
 	}
 	for (size = 0UL; size < map_size; size += PAGE_SIZE) {
-		ret = host_rmi_granule_delegate(phys);
-		if (ret != RMI_SUCCESS) {
-			ERROR("%s() failed, PA=0x%lx ret=0x%lx\n",
-				"host_rmi_granule_delegate", phys, ret);
-			return REALM_ERROR;
+		/* Granules of a PAR from the delegated pool are delegated */
+		if (!host_granule_is_delegated(phys)) {
+			ret = host_rmi_granule_delegate(phys);
+			if (ret != RMI_SUCCESS) {
+				ERROR("%s() failed, PA=0x%lx ret=0x%lx\n",
+					"host_rmi_granule_delegate", phys, ret);
+				return REALM_ERROR;
+			}
 		}
 
 		ret = host_rmi_data_create(unknown, rd, phys, map_addr, src_pa);
@@ -456,13 +1165,15 @@ static u_register_t host_realm_map_protected_data(bool unknown,
 			goto err;
 		}
 
+		host_shadow_rtt_set_entry(realm, map_addr, RTT_MAX_LEVEL, true);
+
 		phys += PAGE_SIZE;
 		src_pa += PAGE_SIZE;
 		map_addr += PAGE_SIZE;
 	}
 
 	if (map_size == RTT_L2_BLOCK_SIZE) {
-		ret = host_realm_fold_rtt(rd, target_pa, map_level);
+		ret = host_realm_fold_rtt(realm, target_pa, map_level);
 		if (ret != RMI_SUCCESS) {
 			ERROR("%s() failed, ret=0x%lx\n",
 				"host_realm_fold_rtt", ret);
@@ -485,13 +1196,16 @@ err:
 		if (ret != RMI_SUCCESS) {
 			ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
 				"host_rmi_data_destroy", map_addr, ret);
+		} else {
+			host_shadow_rtt_set_entry(realm, map_addr,
+						  RTT_MAX_LEVEL, false);
 		}
 
-		ret = host_rmi_granule_undelegate(phys);
+		ret = host_realm_free_delegated(phys, PAGE_SIZE);
 		if (ret != RMI_SUCCESS) {
 			/* Page can't be returned to NS world so is lost */
 			ERROR("%s() failed, ret=0x%lx\n",
-				"host_rmi_granule_undelegate", ret);
+				"host_realm_free_delegated", ret);
 		}
 		phys -= PAGE_SIZE;
 		size -= PAGE_SIZE;
@@ -553,6 +1267,8 @@ u_register_t host_realm_map_unprotected(struct realm *realm,
 		return REALM_ERROR;
 	}
 
+	host_shadow_rtt_set_entry(realm, map_addr, map_level, true);
+
 	return REALM_SUCCESS;
 }
 
@@ -580,14 +1296,14 @@ static u_register_t host_realm_destroy_free_rtt(struct realm *realm,
 		return REALM_ERROR;
 	}
 
-	ret = host_rmi_granule_undelegate(rtt_granule);
+	host_shadow_rtt_remove(realm, addr, level);
+
+	ret = host_realm_free_delegated(rtt_granule, PAGE_SIZE);
 	if (ret != RMI_SUCCESS) {
 		ERROR("%s() failed, rtt=0x%lx ret=0x%lx\n",
-			"host_rmi_granule_undelegate", rtt_granule, ret);
+			"host_realm_free_delegated", rtt_granule, ret);
 		return REALM_ERROR;
 	}
-
-	page_free(rtt_granule);
 	return REALM_SUCCESS;
 }
 
@@ -608,15 +1324,13 @@ static u_register_t host_realm_destroy_undelegate_range(struct realm *realm,
 			return REALM_ERROR;
 		}
 
-		ret = host_rmi_granule_undelegate(addr);
+		ret = host_realm_free_delegated(addr, PAGE_SIZE);
 		if (ret != RMI_SUCCESS) {
 			ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
-				"host_rmi_granule_undelegate", ipa, ret);
+				"host_realm_free_delegated", ipa, ret);
 			return REALM_ERROR;
 		}
 
-		page_free(addr);
-
 		addr += PAGE_SIZE;
 		ipa += PAGE_SIZE;
 		size -= PAGE_SIZE;
@@ -661,7 +1375,10 @@ static u_register_t host_realm_tear_down_rtt_range(struct realm *realm,
 						map_addr, ret);
 					return REALM_ERROR;
 				}
-			} else {
+				break;
+			}
+
+			if (level == RTT_MAX_LEVEL) {
 				ret = host_realm_destroy_undelegate_range(
 									realm,
 									map_addr,
@@ -673,10 +1390,31 @@ static u_register_t host_realm_tear_down_rtt_range(struct realm *realm,
 						map_addr, ret);
 					return REALM_ERROR;
 				}
+				break;
 			}
-			break;
-		case RMI_UNASSIGNED:
-			break;
+
+			/*
+			 * DATA_DESTROY only takes pages: unfold the block into
+			 * a new RTT, and tear it down as any other table.
+			 */
+			ret = host_rmi_create_rtt_levels(realm, map_addr,
+							 level, level + 1U);
+			if (ret != RMI_SUCCESS) {
+				ERROR("%s() failed, map_addr=0x%lx ret=0x%lx\n",
+					"host_rmi_create_rtt_levels",
+					map_addr, ret);
+				return REALM_ERROR;
+			}
+
+			ret = host_rmi_rtt_readentry(rd,
+					ALIGN_DOWN(map_addr, map_size),
+					level, &rtt);
+			if (ret != RMI_SUCCESS || rtt.state != RMI_TABLE) {
+				return REALM_ERROR;
+			}
+
+			rtt_out_addr = rtt.out_addr;
+			__attribute__((fallthrough));
 		case RMI_TABLE:
 			ret = host_realm_tear_down_rtt_range(realm, level + 1U,
 							     map_addr,
@@ -698,6 +1436,8 @@ static u_register_t host_realm_tear_down_rtt_range(struct realm *realm,
 				return REALM_ERROR;
 			}
 			break;
+		case RMI_UNASSIGNED:
+			break;
 		default:
 			return REALM_ERROR;
 		}
@@ -706,14 +1446,199 @@ static u_register_t host_realm_tear_down_rtt_range(struct realm *realm,
 	return REALM_SUCCESS;
 }
 
+#if HOST_RTT_SHADOW_CHECK
+/*
+ * Check the shadow RTTs against the RTTs of the RMM: each shadow RTT must be
+ * pointed to by a table entry, and each of its entries must be assigned if and
+ * only if the shadow says so. Table entries must have a shadow RTT as well.
+ */
+static bool host_realm_check_shadow_rtts(struct realm *realm)
+{
+	struct realm_shadow_rtt *rtt;
+	struct rtt_entry entry;
+	u_register_t ipa, map_size, ret;
+
+	for (unsigned int n = 0U; n < realm->shadow_rtt_count; n++) {
+		rtt = &realm->shadow_rtt[n];
+		map_size = host_rtt_level_mapsize(rtt->level);
+
+		ret = host_rmi_rtt_readentry(realm->rd, rtt->ipa,
+					     rtt->level - 1U, &entry);
+		if (ret != RMI_SUCCESS || entry.state != RMI_TABLE ||
+		    entry.out_addr != rtt->pa) {
+			ERROR("Shadow RTT mismatch, level=%lu ipa=0x%lx\n",
+				rtt->level, rtt->ipa);
+			return false;
+		}
+
+		for (unsigned int i = 0U; i < RTT_ENTRIES; i++) {
+			ipa = rtt->ipa + (i * map_size);
+
+			ret = host_rmi_rtt_readentry(realm->rd, ipa, rtt->level,
+						     &entry);
+			if (ret != RMI_SUCCESS ||
+			    entry.walk_level != rtt->level ||
+			    (entry.state == RMI_ASSIGNED) !=
+			    host_shadow_rtt_is_assigned(rtt, i) ||
+			    (entry.state == RMI_TABLE &&
+			     host_shadow_rtt_find(realm, ipa,
+						  rtt->level + 1U) == NULL)) {
+				ERROR("Shadow RTT entry mismatch, level=%lu "
+				      "ipa=0x%lx state=%lu\n", rtt->level, ipa,
+				      entry.state);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+#endif /* HOST_RTT_SHADOW_CHECK */
+
+/* Unmap the NS memory or destroy the data granule mapped at 'ipa' */
+static u_register_t host_realm_destroy_shadow_entry(struct realm *realm,
+						    u_register_t ipa,
+						    u_register_t level)
+{
+	u_register_t rd = realm->rd;
+	u_register_t data, top, ret;
+
+	if ((ipa & host_realm_ns_ipa_bit(realm)) != 0UL) {
+		ret = host_rmi_rtt_unmap_unprotected(rd, ipa, level, &top);
+		if (ret != RMI_SUCCESS) {
+			ERROR("%s() failed, ipa=0x%lx ret=0x%lx\n",
+				"host_rmi_rtt_unmap_unprotected", ipa, ret);
+			return REALM_ERROR;
+		}
+		return REALM_SUCCESS;
+	}
+
+	ret = host_rmi_data_destroy(rd, ipa, &data, &top);
+	if (ret != RMI_SUCCESS) {
+		ERROR("%s() failed, ipa=0x%lx ret=0x%lx\n",
+			"host_rmi_data_destroy", ipa, ret);
+		return REALM_ERROR;
+	}
+
+	ret = host_realm_free_delegated(data, PAGE_SIZE);
+	if (ret != RMI_SUCCESS) {
+		ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
+			"host_realm_free_delegated", data, ret);
+		return REALM_ERROR;
+	}
+	return REALM_SUCCESS;
+}
+
+/*
+ * Tear down the RTTs from their shadow: unmap or destroy the assigned entries,
+ * then destroy the RTTs leaf-upwards. Returns with the shadow invalid and the
+ * RTTs left as they are if the shadow ran out of space while unfolding blocks.
+ */
+static u_register_t host_realm_tear_down_shadow_rtts(struct realm *realm)
+{
+	u_register_t ns_ipa_bit = host_realm_ns_ipa_bit(realm);
+	struct realm_shadow_rtt *rtt;
+	u_register_t ipa, map_size, ret;
+
+	/*
+	 * DATA_DESTROY only takes pages: unfold the protected blocks first.
+	 * The RTTs this creates are appended to the shadow, and visited too.
+	 */
+	for (unsigned int n = 0U; n < realm->shadow_rtt_count; n++) {
+		rtt = &realm->shadow_rtt[n];
+		if (rtt->level == RTT_MAX_LEVEL) {
+			continue;
+		}
+
+		map_size = host_rtt_level_mapsize(rtt->level);
+
+		for (unsigned int i = 0U; i < RTT_ENTRIES; i++) {
+			ipa = rtt->ipa + (i * map_size);
+			if (!host_shadow_rtt_is_assigned(rtt, i) ||
+			    (ipa & ns_ipa_bit) != 0UL) {
+				continue;
+			}
+
+			ret = host_rmi_create_rtt_levels(realm, ipa, rtt->level,
+							 rtt->level + 1U);
+			if (ret != RMI_SUCCESS) {
+				ERROR("%s() failed, ipa=0x%lx ret=0x%lx\n",
+					"host_rmi_create_rtt_levels", ipa, ret);
+				return REALM_ERROR;
+			}
+
+			if (!realm->shadow_rtt_valid) {
+				return REALM_SUCCESS;
+			}
+		}
+	}
+
+	for (unsigned int n = 0U; n < realm->shadow_rtt_count; n++) {
+		rtt = &realm->shadow_rtt[n];
+		map_size = host_rtt_level_mapsize(rtt->level);
+
+		for (unsigned int i = 0U; i < RTT_ENTRIES; i++) {
+			if (!host_shadow_rtt_is_assigned(rtt, i)) {
+				continue;
+			}
+
+			ret = host_realm_destroy_shadow_entry(realm,
+					rtt->ipa + (i * map_size), rtt->level);
+			if (ret != RMI_SUCCESS) {
+				return REALM_ERROR;
+			}
+
+			rtt->assigned[i / 64U] &= ~BIT_64(i % 64U);
+		}
+	}
+
+	/* Destroying an RTT moves the last shadow RTT to its slot */
+	for (u_register_t level = RTT_MAX_LEVEL; level > 0UL; level--) {
+		for (unsigned int n = 0U; n < realm->shadow_rtt_count;) {
+			rtt = &realm->shadow_rtt[n];
+			if (rtt->level != level) {
+				n++;
+				continue;
+			}
+
+			ret = host_realm_destroy_free_rtt(realm, rtt->ipa,
+							  level, rtt->pa);
+			if (ret != RMI_SUCCESS) {
+				ERROR("%s() failed, ipa=0x%lx ret=0x%lx\n",
+					"host_realm_destroy_free_rtt",
+					rtt->ipa, ret);
+				return REALM_ERROR;
+			}
+		}
+	}
+
+	return REALM_SUCCESS;
+}
+
 u_register_t host_rmi_granule_delegate(u_register_t addr)
 {
-	return host_rmi_handler(&(smc_args) {RMI_GRANULE_DELEGATE, addr}, 2U).ret0;
+	u_register_t ret;
+
+	ret = host_rmi_handler(&(smc_args) {RMI_GRANULE_DELEGATE, addr},
+			       2U).ret0;
+	if (ret == RMI_SUCCESS) {
+		host_granule_map_update(addr, true);
+	}
+
+	return ret;
 }
 
 u_register_t host_rmi_granule_undelegate(u_register_t addr)
 {
-	return host_rmi_handler(&(smc_args) {RMI_GRANULE_UNDELEGATE, addr}, 2U).ret0;
+	u_register_t ret;
+
+	ret = host_rmi_handler(&(smc_args) {RMI_GRANULE_UNDELEGATE, addr},
+			       2U).ret0;
+	if (ret == RMI_SUCCESS) {
+		host_granule_map_update(addr, false);
+	}
+
+	return ret;
 }
 
 u_register_t host_rmi_version(u_register_t requested_ver)
@@ -731,55 +1656,60 @@ u_register_t host_rmi_version(u_register_t requested_ver)
 u_register_t host_realm_create(struct realm *realm)
 {
 	struct rmi_realm_params *params;
-	u_register_t ret;
+	u_register_t par_align, ret;
 
-	realm->par_size = REALM_MAX_LOAD_IMG_SIZE;
+	if (realm->par_size == 0UL) {
+		realm->par_size = REALM_MAX_LOAD_IMG_SIZE;
+	}
 
 	realm->state = REALM_STATE_NULL;
+	realm->shadow_rtt_count = 0U;
+	realm->shadow_rtt_valid = true;
+
 	/*
 	 * Allocate memory for PAR - Realm image. Granule delegation
-	 * of PAR will be performed during rtt creation.
+	 * of PAR will be performed during rtt creation, unless it comes
+	 * delegated from the delegated pool. A PAR made of L2 blocks is
+	 * aligned such that it can be mapped with block entries.
 	 */
-	realm->par_base = (u_register_t)page_alloc(realm->par_size);
+	par_align = ((realm->par_size % RTT_L2_BLOCK_SIZE) == 0UL) ?
+			RTT_L2_BLOCK_SIZE : PAGE_SIZE;
+	realm->par_base = host_delegated_pool_alloc(realm->par_size,
+						    par_align);
+	if (realm->par_base == HEAP_NULL_PTR) {
+		if (par_align > PAGE_SIZE) {
+			realm->par_base = (u_register_t)page_alloc_aligned(
+						realm->par_size, par_align);
+		} else {
+			realm->par_base = (u_register_t)page_alloc(
+						realm->par_size);
+		}
+	}
 	if (realm->par_base == HEAP_NULL_PTR) {
 		ERROR("page_alloc failed, base=0x%lx, size=0x%lx\n",
 			  realm->par_base, realm->par_size);
 		return REALM_ERROR;
 	}
 
-	/* Allocate and delegate RD */
-	realm->rd = (u_register_t)page_alloc(PAGE_SIZE);
+	/* Allocate delegated RD */
+	realm->rd = host_realm_alloc_delegated(PAGE_SIZE, PAGE_SIZE);
 	if (realm->rd == HEAP_NULL_PTR) {
 		ERROR("Failed to allocate memory for rd\n");
 		goto err_free_par;
-	} else {
-		ret = host_rmi_granule_delegate(realm->rd);
-		if (ret != RMI_SUCCESS) {
-			ERROR("%s() failed, rd=0x%lx ret=0x%lx\n",
-				"host_rmi_granule_delegate", realm->rd, ret);
-			goto err_free_rd;
-		}
 	}
 
-	/* Allocate and delegate RTT */
-	realm->rtt_addr = (u_register_t)page_alloc(PAGE_SIZE);
+	/* Allocate delegated RTT */
+	realm->rtt_addr = host_realm_alloc_delegated(PAGE_SIZE, PAGE_SIZE);
 	if (realm->rtt_addr == HEAP_NULL_PTR) {
 		ERROR("Failed to allocate memory for rtt_addr\n");
-		goto err_undelegate_rd;
-	} else {
-		ret = host_rmi_granule_delegate(realm->rtt_addr);
-		if (ret != RMI_SUCCESS) {
-			ERROR("%s() failed, rtt_addr=0x%lx ret=0x%lx\n",
-				"host_rmi_granule_delegate", realm->rtt_addr, ret);
-			goto err_free_rtt;
-		}
+		goto err_free_rd;
 	}
 
 	/* Allocate memory for params */
 	params = (struct rmi_realm_params *)page_alloc(PAGE_SIZE);
 	if (params == NULL) {
 		ERROR("Failed to allocate memory for params\n");
-		goto err_undelegate_rtt;
+		goto err_free_rtt;
 	}
 
 	/* Populate params */
@@ -836,44 +1766,60 @@ u_register_t host_realm_create(struct realm *realm)
 err_free_params:
 	page_free((u_register_t)params);
 
-err_undelegate_rtt:
-	ret = host_rmi_granule_undelegate(realm->rtt_addr);
+err_free_rtt:
+	ret = host_realm_free_delegated(realm->rtt_addr, PAGE_SIZE);
 	if (ret != RMI_SUCCESS) {
 		WARN("%s() failed, rtt_addr=0x%lx ret=0x%lx\n",
-			"host_rmi_granule_undelegate", realm->rtt_addr, ret);
+			"host_realm_free_delegated", realm->rtt_addr, ret);
 	}
 
-err_free_rtt:
-	page_free(realm->rtt_addr);
-
-err_undelegate_rd:
-	ret = host_rmi_granule_undelegate(realm->rd);
+err_free_rd:
+	ret = host_realm_free_delegated(realm->rd, PAGE_SIZE);
 	if (ret != RMI_SUCCESS) {
 		WARN("%s() failed, rd=0x%lx ret=0x%lx\n",
-			"host_rmi_granule_undelegate", realm->rd, ret);
+			"host_realm_free_delegated", realm->rd, ret);
 	}
-err_free_rd:
-	page_free(realm->rd);
 
 err_free_par:
-	page_free(realm->par_base);
+	host_realm_free_par(realm);
 
 	return REALM_ERROR;
 }
 
+/*
+ * The source of the realm image, and for
+ * host_realm_map_payload_image_blocks() the PAR being loaded and the share of
+ * its granules each core delegates and populates.
+ */
+static u_register_t load_src;
+static struct realm *load_realm;
+static unsigned int load_ncores;
+static unsigned int load_slot[PLATFORM_CORE_COUNT];
+static volatile u_register_t load_ret[PLATFORM_CORE_COUNT];
+
+/*
+ * Source of PAR granule 'i'. The realm image is repeated to fill PARs larger
+ * than the image, such that all the data is copied from NS memory.
+ */
+static inline u_register_t host_realm_load_src(u_register_t i)
+{
+	return load_src + ((i * PAGE_SIZE) % REALM_MAX_LOAD_IMG_SIZE);
+}
+
 u_register_t host_realm_map_payload_image(struct realm *realm,
 					  u_register_t realm_payload_adr)
 {
-	u_register_t src_pa = realm_payload_adr;
 	u_register_t i = 0UL;
 	u_register_t ret;
 
+	load_src = realm_payload_adr;
+
 	/* MAP image regions */
 	while (i < (realm->par_size / PAGE_SIZE)) {
 		ret = host_realm_map_protected_data(false, realm,
 						realm->par_base + i * PAGE_SIZE,
 						PAGE_SIZE,
-						src_pa + i * PAGE_SIZE);
+						host_realm_load_src(i));
 		if (ret != RMI_SUCCESS) {
 			ERROR("%s() failed, par_base=0x%lx ret=0x%lx\n",
 				"host_realm_map_protected_data",
@@ -886,6 +1832,194 @@ u_register_t host_realm_map_payload_image(struct realm *realm,
 	return REALM_SUCCESS;
 }
 
+/*
+ * Delegate and populate the share of the PAR granules of the current core.
+ * The first granule of each L2 block has already been mapped by the lead
+ * core, along with the RTTs of the block.
+ */
+static test_result_t host_realm_load_granules(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	unsigned int slot = load_slot[core_pos];
+	u_register_t count = load_realm->par_size / PAGE_SIZE;
+	u_register_t first = (count * slot) / load_ncores;
+	u_register_t last = (count * (slot + 1U)) / load_ncores;
+	u_register_t phys, ret = RMI_SUCCESS;
+
+	for (u_register_t i = first; i < last; i++) {
+		phys = load_realm->par_base + (i * PAGE_SIZE);
+		if ((phys % RTT_L2_BLOCK_SIZE) == 0UL || i == 0UL) {
+			continue;
+		}
+
+		if (!host_granule_is_delegated(phys)) {
+			ret = host_rmi_granule_delegate(phys);
+			if (ret != RMI_SUCCESS) {
+				ERROR("%s() failed, PA=0x%lx ret=0x%lx\n",
+					"host_rmi_granule_delegate", phys, ret);
+				break;
+			}
+		}
+
+		ret = host_rmi_data_create(false, load_realm->rd, phys, phys,
+					   host_realm_load_src(i));
+		if (ret != RMI_SUCCESS) {
+			ERROR("%s() failed, PA=0x%lx ret=0x%lx\n",
+				"host_rmi_data_create", phys, ret);
+			(void)host_realm_free_delegated(phys, PAGE_SIZE);
+			break;
+		}
+	}
+
+	load_ret[core_pos] = ret;
+
+	return (ret == RMI_SUCCESS) ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/*
+ * Map the realm image like host_realm_map_payload_image(), with each 2MB
+ * aligned L2 block of the PAR folded into a block entry once populated.
+ *
+ * The lead core creates the RTTs, sets the RIPAS of the whole PAR, which
+ * RMI_RTT_INIT_RIPAS only does for unassigned entries, and then maps the first
+ * granule of each L2 block.
+ * The remaining granules are delegated and populated from the calling core
+ * only, or spread over all online cores if 'all_cores' is set: RMI calls on
+ * different granules do not depend on each other.
+ */
+u_register_t host_realm_map_payload_image_blocks(struct realm *realm,
+						 u_register_t realm_payload_adr,
+						 bool all_cores)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int lead_pos = platform_get_core_pos(lead_mpid);
+	u_register_t end = realm->par_base + realm->par_size;
+	u_register_t addr, top, ret;
+	unsigned int cpu_node, mpidr;
+
+	load_realm = realm;
+	load_src = realm_payload_adr;
+	load_ncores = 1U;
+
+	/* RTTs and RIPAS of the whole PAR, before any granule is assigned */
+	for (addr = realm->par_base; addr < end; addr = top) {
+		ret = host_rmi_rtt_init_ripas(realm->rd, addr, end, &top);
+		if (RMI_RETURN_STATUS(ret) == RMI_ERROR_RTT &&
+		    RMI_RETURN_INDEX(ret) < RTT_MAX_LEVEL) {
+			ret = host_rmi_create_rtt_levels(realm, addr,
+							 RMI_RETURN_INDEX(ret),
+							 RTT_MAX_LEVEL);
+			if (ret != RMI_SUCCESS) {
+				ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
+					"host_rmi_create_rtt_levels", addr,
+					ret);
+				return REALM_ERROR;
+			}
+			top = addr;
+			continue;
+		}
+
+		if (ret != RMI_SUCCESS || top <= addr) {
+			ERROR("%s() failed, addr=0x%lx top=0x%lx ret=0x%lx\n",
+				"host_rmi_rtt_init_ripas", addr, top, ret);
+			return REALM_ERROR;
+		}
+	}
+
+	/* First granule of each L2 block, or of the PAR */
+	for (addr = realm->par_base; addr < end;
+	     addr = ALIGN(addr + 1U, RTT_L2_BLOCK_SIZE)) {
+		ret = host_realm_map_protected_data(false, realm, addr,
+				PAGE_SIZE,
+				host_realm_load_src(
+					(addr - realm->par_base) / PAGE_SIZE));
+		if (ret != RMI_SUCCESS) {
+			ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
+				"host_realm_map_protected_data", addr, ret);
+			return REALM_ERROR;
+		}
+	}
+
+	load_slot[lead_pos] = 0U;
+	load_ret[lead_pos] = RMI_SUCCESS;
+
+	if (all_cores) {
+		for_each_cpu(cpu_node) {
+			mpidr = tftf_get_mpidr_from_node(cpu_node);
+			if (mpidr == lead_mpid) {
+				continue;
+			}
+
+			load_slot[platform_get_core_pos(mpidr)] = load_ncores++;
+			load_ret[platform_get_core_pos(mpidr)] = REALM_ERROR;
+		}
+
+		/* The share of each core is known before any of them starts */
+		dsbsy();
+
+		for_each_cpu(cpu_node) {
+			mpidr = tftf_get_mpidr_from_node(cpu_node);
+			if (mpidr == lead_mpid) {
+				continue;
+			}
+
+			if (tftf_cpu_on(mpidr,
+					(uintptr_t)host_realm_load_granules,
+					0U) != PSCI_E_SUCCESS) {
+				ERROR("CPU ON failed for 0x%x\n", mpidr);
+				load_ret[platform_get_core_pos(mpidr)] =
+					REALM_ERROR;
+			}
+		}
+	}
+
+	(void)host_realm_load_granules();
+
+	ret = RMI_SUCCESS;
+
+	for_each_cpu(cpu_node) {
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		if (mpidr != lead_mpid && all_cores) {
+			while (tftf_psci_affinity_info(mpidr, MPIDR_AFFLVL0) !=
+					PSCI_STATE_OFF) {
+				continue;
+			}
+		}
+
+		if ((mpidr == lead_mpid || all_cores) &&
+		    load_ret[platform_get_core_pos(mpidr)] != RMI_SUCCESS) {
+			ret = REALM_ERROR;
+		}
+	}
+
+	/*
+	 * Granules that were populated are torn down with the realm. The
+	 * shadow RTTs are updated from this core only, so they do not know
+	 * which ones were populated if any core failed.
+	 */
+	if (ret != RMI_SUCCESS) {
+		realm->shadow_rtt_valid = false;
+		return REALM_ERROR;
+	}
+
+	for (addr = realm->par_base; addr < end; addr += PAGE_SIZE) {
+		host_shadow_rtt_set_entry(realm, addr, RTT_MAX_LEVEL, true);
+	}
+
+	/* Fold each complete L2 block */
+	for (addr = ALIGN(realm->par_base, RTT_L2_BLOCK_SIZE);
+	     (addr + RTT_L2_BLOCK_SIZE) <= end; addr += RTT_L2_BLOCK_SIZE) {
+		ret = host_realm_fold_rtt(realm, addr, 2UL);
+		if (ret != RMI_SUCCESS) {
+			ERROR("%s() failed, addr=0x%lx ret=0x%lx\n",
+				"host_realm_fold_rtt", addr, ret);
+			return REALM_ERROR;
+		}
+	}
+
+	return REALM_SUCCESS;
+}
+
 u_register_t host_realm_init_ipa_state(struct realm *realm, u_register_t level,
 					u_register_t start, uint64_t end)
 {
@@ -968,12 +2102,12 @@ static void host_realm_free_rec_aux(u_register_t
 	for (unsigned int i = 0U; i <= rec_num; i++) {
 		for (unsigned int j = 0U; j < num_aux &&
 					aux_pages[i][j] != 0U; j++) {
-			ret = host_rmi_granule_undelegate(aux_pages[i][j]);
+			ret = host_realm_free_delegated(aux_pages[i][j],
+							PAGE_SIZE);
 			if (ret != RMI_SUCCESS) {
 				WARN("%s() failed, index=%u,%u ret=0x%lx\n",
-				"host_rmi_granule_undelegate", i, j, ret);
+				"host_realm_free_delegated", i, j, ret);
 			}
-			page_free(aux_pages[i][j]);
 		}
 	}
 }
@@ -981,28 +2115,17 @@ static void host_realm_free_rec_aux(u_register_t
 static u_register_t host_realm_alloc_rec_aux(struct realm *realm,
 		struct rmi_rec_params *params, u_register_t rec_num)
 {
-	u_register_t ret;
 	unsigned int j;
 
 	assert(rec_num < MAX_REC_COUNT);
 	for (j = 0U; j < realm->num_aux; j++) {
-		params->aux[j] = (u_register_t)page_alloc(PAGE_SIZE);
+		/* Prev pages are freed at host_realm_free_rec_aux */
+		params->aux[j] = host_realm_alloc_delegated(PAGE_SIZE,
+							    PAGE_SIZE);
 		if (params->aux[j] == HEAP_NULL_PTR) {
 			ERROR("Failed to allocate memory for aux rec\n");
 			return RMI_ERROR_REALM;
 		}
-		ret = host_rmi_granule_delegate(params->aux[j]);
-		if (ret != RMI_SUCCESS) {
-			ERROR("%s() failed, index=%u ret=0x%lx\n",
-				"host_rmi_granule_delegate", j, ret);
-			/*
-			 * Free current page,
-			 * prev pages freed at host_realm_free_rec_aux
-			 */
-			page_free(params->aux[j]);
-			params->aux[j] = 0UL;
-			return RMI_ERROR_REALM;
-		}
 
 		/* We need a copy in Realm object for final destruction */
 		realm->aux_pages_all_rec[rec_num][j] = params->aux[j];
@@ -1042,18 +2165,12 @@ u_register_t host_realm_rec_create(struct realm *realm)
 		}
 		(void)memset((void *)realm->run[i], 0x0, PAGE_SIZE);
 
-		/* Allocate and delegate REC */
-		realm->rec[i] = (u_register_t)page_alloc(PAGE_SIZE);
+		/* Allocate delegated REC */
+		realm->rec[i] = host_realm_alloc_delegated(PAGE_SIZE,
+							   PAGE_SIZE);
 		if (realm->rec[i] == HEAP_NULL_PTR) {
 			ERROR("Failed to allocate memory for REC\n");
 			goto err_free_mem;
-		} else {
-			ret = host_rmi_granule_delegate(realm->rec[i]);
-			if (ret != RMI_SUCCESS) {
-				ERROR("%s() failed, rec=0x%lx ret=0x%lx\n",
-				"host_rmi_granule_delegate", realm->rd, ret);
-				goto err_free_mem;
-			}
 		}
 
 		/* Delegate the required number of auxiliary Granules  */
@@ -1090,13 +2207,16 @@ err_free_aux:
 
 err_free_mem:
 	for (unsigned int j = 0U; j <= i ; j++) {
-		ret = host_rmi_granule_undelegate(realm->rec[j]);
-		if (ret != RMI_SUCCESS) {
-			WARN("%s() failed, rec=0x%lx ret=0x%lx\n",
-			"host_rmi_granule_undelegate", realm->rec[j], ret);
+		if (realm->rec[j] != HEAP_NULL_PTR) {
+			ret = host_realm_free_delegated(realm->rec[j],
+							PAGE_SIZE);
+			if (ret != RMI_SUCCESS) {
+				WARN("%s() failed, rec=0x%lx ret=0x%lx\n",
+				"host_realm_free_delegated", realm->rec[j],
+				ret);
+			}
 		}
 		page_free(realm->run[j]);
-		page_free(realm->rec[j]);
 	}
 	page_free((u_register_t)rec_params);
 	return REALM_ERROR;
@@ -1145,15 +2265,13 @@ u_register_t host_realm_destroy(struct realm *realm)
 			return REALM_ERROR;
 		}
 
-		ret = host_rmi_granule_undelegate(realm->rec[i]);
+		ret = host_realm_free_delegated(realm->rec[i], PAGE_SIZE);
 		if (ret != RMI_SUCCESS) {
 			ERROR("%s() failed, rec=0x%lx ret=0x%lx\n",
-				"host_rmi_granule_undelegate", realm->rec[i], ret);
+				"host_realm_free_delegated", realm->rec[i], ret);
 			return REALM_ERROR;
 		}
 
-		page_free(realm->rec[i]);
-
 		/* Free run object */
 		page_free(realm->run[i]);
 	}
@@ -1165,8 +2283,26 @@ u_register_t host_realm_destroy(struct realm *realm)
 	 * For each data granule - Destroy, undelegate and free
 	 * RTTs (level 1U and below) must be destroyed leaf-upwards,
 	 * using RMI_DATA_DESTROY, RMI_RTT_DESTROY and RMI_GRANULE_UNDELEGATE
-	 * commands.
+	 * commands. Only the entries recorded in the shadow RTTs are visited,
+	 * unless the shadow is not valid.
 	 */
+#if HOST_RTT_SHADOW_CHECK
+	if (realm->shadow_rtt_valid && !host_realm_check_shadow_rtts(realm)) {
+		return REALM_ERROR;
+	}
+#endif
+	if (realm->shadow_rtt_valid) {
+		if (host_realm_tear_down_shadow_rtts(realm) != RMI_SUCCESS) {
+			ERROR("%s() failed\n",
+				"host_realm_tear_down_shadow_rtts");
+			return REALM_ERROR;
+		}
+
+		if (realm->shadow_rtt_valid) {
+			goto undo_from_new_state;
+		}
+	}
+
 	if (host_realm_tear_down_rtt_range(realm, 0UL, 0UL,
 				(1UL << (EXTRACT(RMI_FEATURE_REGISTER_0_S2SZ,
 				realm->rmm_feat_reg0) - 1))) != RMI_SUCCESS) {
@@ -1193,23 +2329,21 @@ undo_from_new_state:
 		return REALM_ERROR;
 	}
 
-	ret = host_rmi_granule_undelegate(realm->rd);
+	ret = host_realm_free_delegated(realm->rd, PAGE_SIZE);
 	if (ret != RMI_SUCCESS) {
 		ERROR("%s() failed, rd=0x%lx ret=0x%lx\n",
-			"host_rmi_granule_undelegate", realm->rd, ret);
+			"host_realm_free_delegated", realm->rd, ret);
 		return REALM_ERROR;
 	}
 
-	ret = host_rmi_granule_undelegate(realm->rtt_addr);
+	ret = host_realm_free_delegated(realm->rtt_addr, PAGE_SIZE);
 	if (ret != RMI_SUCCESS) {
 		ERROR("%s() failed, rtt_addr=0x%lx ret=0x%lx\n",
-			"host_rmi_granule_undelegate", realm->rtt_addr, ret);
+			"host_realm_free_delegated", realm->rtt_addr, ret);
 		return REALM_ERROR;
 	}
 
-	page_free(realm->rd);
-	page_free(realm->rtt_addr);
-	page_free(realm->par_base);
+	host_realm_free_par(realm);
 
 	return REALM_SUCCESS;
 }
@@ -1269,7 +2403,7 @@ u_register_t host_realm_rec_enter(struct realm *realm,
 				re_enter_rec = true;
 				break;
 			case HOST_CALL_EXIT_PRINT_CMD:
-				realm_print_handler(run->exit.gprs[0]);
+				realm_print_handler(realm, rec_num);
 				re_enter_rec = true;
 				break;
 			case HOST_CALL_EXIT_SUCCESS_CMD:
@@ -1283,6 +2417,9 @@ u_register_t host_realm_rec_enter(struct realm *realm,
 		}
 	} while (re_enter_rec);
 
+	/* Print what the REC logged since it was entered */
+	realm_print_handler(realm, rec_num);
+
 	*exit_reason = run->exit.exit_reason;
 	return ret;
 }
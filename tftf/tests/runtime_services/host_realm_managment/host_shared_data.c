@@ -5,57 +5,119 @@
  */
 
 #include <string.h>
+#include <arch_helpers.h>
 #include <assert.h>
 #include <cassert.h>
 #include <host_realm_mem_layout.h>
+#include <host_realm_rmi.h>
 #include <host_shared_data.h>
 
-static host_shared_data_t *host_shared_data = (host_shared_data_t *) NS_REALM_SHARED_MEM_BASE;
-
 /*
- * Currently we support only creation of a single Realm in TFTF.
- * Hence we can assume that Shared area should be sufficient for all
- * the RECs of this Realm.
- * TODO: This API will need to change for multi realm support.
+ * The NS shared region is split evenly between the realms that can exist at
+ * the same time, and each realm's share must hold the shared data of all its
+ * RECs.
  */
-CASSERT(NS_REALM_SHARED_MEM_SIZE > (MAX_REC_COUNT * sizeof(host_shared_data_t)),
+CASSERT(NS_REALM_SHARED_MEM_SLICE >
+		(MAX_REC_COUNT * sizeof(host_shared_data_t)),
 		too_small_realm_shared_mem_size);
 
 /*
  * Return shared buffer pointer mapped as host_shared_data_t structure
  */
-host_shared_data_t *host_get_shared_structure(unsigned int rec_num)
+host_shared_data_t *host_get_shared_structure(struct realm *realm_ptr,
+					      unsigned int rec_num)
 {
+	host_shared_data_t *host_shared_data;
+
 	assert(rec_num < MAX_REC_COUNT);
+	host_shared_data = (host_shared_data_t *)realm_ptr->host_shared_data;
 	return &host_shared_data[rec_num];
 }
 
 /*
  * Set data to be shared from Host to realm
  */
-void host_shared_data_set_host_val(unsigned int rec_num, uint8_t index, u_register_t val)
+void host_shared_data_set_host_val(struct realm *realm_ptr,
+				   unsigned int rec_num, uint8_t index,
+				   u_register_t val)
 {
-	assert(rec_num < MAX_REC_COUNT);
 	assert(index < MAX_DATA_SIZE);
-	host_shared_data[rec_num].host_param_val[index] = val;
+	host_get_shared_structure(realm_ptr, rec_num)->host_param_val[index] =
+		val;
 }
 
 /*
  * Return data shared by realm in realm_out_val.
  */
-u_register_t host_shared_data_get_realm_val(unsigned int rec_num, uint8_t index)
+u_register_t host_shared_data_get_realm_val(struct realm *realm_ptr,
+					    unsigned int rec_num,
+					    uint8_t index)
 {
-	assert(rec_num < MAX_REC_COUNT);
 	assert(index < MAX_DATA_SIZE);
-	return host_shared_data[rec_num].realm_out_val[index];
+	return host_get_shared_structure(realm_ptr,
+					 rec_num)->realm_out_val[index];
 }
 
 /*
  * Set command to be send from Host to realm
  */
-void host_shared_data_set_realm_cmd(uint8_t cmd, unsigned int rec_num)
+void host_shared_data_set_realm_cmd(struct realm *realm_ptr, uint8_t cmd,
+				    unsigned int rec_num)
 {
-	assert(rec_num < MAX_REC_COUNT);
-	host_shared_data[rec_num].realm_cmd = cmd;
+	host_get_shared_structure(realm_ptr, rec_num)->realm_cmd = cmd;
 }
 
+/*
+ * Queue a command with MAX_DATA_SIZE parameters, or none if 'args' is NULL,
+ * on the command ring of a Rec. Returns false if the ring is full.
+ */
+bool host_cmd_ring_push(struct realm *realm_ptr, unsigned int rec_num,
+			uint8_t cmd, const u_register_t *args)
+{
+	struct realm_cmd_ring *ring =
+		&host_get_shared_structure(realm_ptr, rec_num)->cmd_ring;
+	uint32_t head = ring->head;
+	struct realm_cmd_desc *desc;
+
+	if ((head - ring->tail) == REALM_CMD_RING_SIZE) {
+		return false;
+	}
+
+	desc = &ring->desc[head & (REALM_CMD_RING_SIZE - 1U)];
+	desc->cmd = cmd;
+	if (args != NULL) {
+		(void)memcpy(desc->args, args, sizeof(desc->args));
+	} else {
+		(void)memset(desc->args, 0, sizeof(desc->args));
+	}
+
+	/* Publish the descriptor before the Realm can see it */
+	dmbishst();
+	ring->head = head + 1U;
+
+	return true;
+}
+
+/*
+ * Take the oldest completion of a Rec off its completion ring. Returns false
+ * if there is none.
+ */
+bool host_compl_ring_pop(struct realm *realm_ptr, unsigned int rec_num,
+			 struct realm_cmd_compl *compl)
+{
+	struct realm_compl_ring *ring =
+		&host_get_shared_structure(realm_ptr, rec_num)->compl_ring;
+	uint32_t tail = ring->tail;
+
+	if (tail == ring->head) {
+		return false;
+	}
+
+	/* Read the completion after its index, and before freeing it */
+	dmbishld();
+	*compl = ring->compl[tail & (REALM_CMD_RING_SIZE - 1U)];
+	dmbish();
+	ring->tail = tail + 1U;
+
+	return true;
+}
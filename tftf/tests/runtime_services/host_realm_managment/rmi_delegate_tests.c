@@ -19,6 +19,9 @@
 static test_result_t host_realm_multi_cpu_payload_test(void);
 static test_result_t host_realm_multi_cpu_payload_del_undel(void);
 
+/* Calls made to each RMI function ID with random argument registers */
+#define RMI_REGS_CHECK_ROUNDS	U(16)
+
 /* Buffer to delegate and undelegate */
 static char bufferdelegate[NUM_GRANULES * GRANULE_SIZE * PLATFORM_CORE_COUNT]
 	__aligned(GRANULE_SIZE);
@@ -106,22 +109,11 @@ test_result_t host_realm_version_multi_cpu(void)
 
 	lead_mpid = read_mpidr_el1() & MPID_MASK;
 
-	for_each_cpu(cpu_node) {
-		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
-
-		if (lead_mpid == target_mpid) {
-			continue;
-		}
-
-		ret = tftf_cpu_on(target_mpid,
-			(uintptr_t)host_realm_multi_cpu_payload_test, 0);
-
-		if (ret != PSCI_E_SUCCESS) {
-			ERROR("CPU ON failed for 0x%llx\n",
-				(unsigned long long)target_mpid);
-			return TEST_RESULT_FAIL;
-		}
-
+	ret = tftf_cpu_on_all((uintptr_t)host_realm_multi_cpu_payload_test,
+			      NULL);
+	if (ret != PSCI_E_SUCCESS) {
+		ERROR("CPU ON failed (%lld)\n", ret);
+		return TEST_RESULT_FAIL;
 	}
 
 	ret = host_realm_multi_cpu_payload_test();
@@ -133,10 +125,7 @@ test_result_t host_realm_version_multi_cpu(void)
 			continue;
 		}
 
-		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
-				PSCI_STATE_OFF) {
-			continue;
-		}
+		wait_for_core_to_turn_off(target_mpid);
 	}
 
 	return ret;
@@ -173,6 +162,70 @@ test_result_t host_realm_delegate_undelegate(void)
 	return host_cmp_result();
 }
 
+/*
+ * Delegate and Undelegate a range of Non Secure Granules, then check that
+ * a range failing on its last granule leaves the others undelegated
+ */
+test_result_t host_realm_delegate_undelegate_range(void)
+{
+	u_register_t base = (u_register_t)bufferdelegate;
+	u_register_t size = NUM_GRANULES * GRANULE_SIZE;
+	u_register_t last = base + size - GRANULE_SIZE;
+	u_register_t retrmm;
+
+	if (get_armv9_2_feat_rme_support() == 0U) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	host_rmi_init_cmp_result();
+
+	retrmm = host_rmi_granule_delegate_range(base, size);
+	if (retrmm != 0UL) {
+		tftf_testcase_printf("Delegate range operation returns 0x%lx\n",
+					retrmm);
+		return TEST_RESULT_FAIL;
+	}
+	retrmm = host_rmi_granule_undelegate_range(base, size);
+	if (retrmm != 0UL) {
+		tftf_testcase_printf("Undelegate range operation returns 0x%lx\n",
+					retrmm);
+		return TEST_RESULT_FAIL;
+	}
+
+	retrmm = host_rmi_granule_delegate(last);
+	if (retrmm != 0UL) {
+		tftf_testcase_printf("Delegate operation returns 0x%lx\n",
+					retrmm);
+		return TEST_RESULT_FAIL;
+	}
+	retrmm = host_rmi_granule_delegate_range(base, size);
+	if (retrmm == 0UL) {
+		tftf_testcase_printf
+			("Delegate range operation does not fail as expected\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	/* The granules before the last one must be undelegated again */
+	retrmm = host_rmi_granule_delegate_range(base, size - GRANULE_SIZE);
+	if (retrmm != 0UL) {
+		tftf_testcase_printf
+			("Delegate range operation was not undone, 0x%lx\n",
+			retrmm);
+		return TEST_RESULT_FAIL;
+	}
+	retrmm = host_rmi_granule_undelegate_range(base, size);
+	if (retrmm != 0UL) {
+		tftf_testcase_printf
+			("Undelegate range operation returns fail for cleanup, 0x%lx\n",
+			retrmm);
+		return TEST_RESULT_FAIL;
+	}
+	tftf_testcase_printf("Delegate and undelegate of range 0x%lx-0x%lx succeeded\n",
+			base, base + size);
+
+	return host_cmp_result();
+}
+
 static test_result_t host_realm_multi_cpu_payload_test(void)
 {
 	u_register_t retrmm = 0U;
@@ -211,22 +264,11 @@ test_result_t host_realm_delundel_multi_cpu(void)
 		return TEST_RESULT_FAIL;
 	}
 
-	for_each_cpu(cpu_node) {
-		target_mpid = tftf_get_mpidr_from_node(cpu_node) & MPID_MASK;
-
-		if (lead_mpid == target_mpid) {
-			continue;
-		}
-
-		ret = tftf_cpu_on(target_mpid,
-			(uintptr_t)host_realm_multi_cpu_payload_del_undel, 0);
-
-		if (ret != PSCI_E_SUCCESS) {
-			ERROR("CPU ON failed for 0x%llx\n",
-				(unsigned long long)target_mpid);
-			return TEST_RESULT_FAIL;
-		}
-
+	ret = tftf_cpu_on_all((uintptr_t)host_realm_multi_cpu_payload_del_undel,
+			      NULL);
+	if (ret != PSCI_E_SUCCESS) {
+		ERROR("CPU ON failed (%lld)\n", ret);
+		return TEST_RESULT_FAIL;
 	}
 
 	for_each_cpu(cpu_node) {
@@ -236,10 +278,7 @@ test_result_t host_realm_delundel_multi_cpu(void)
 			continue;
 		}
 
-		while (tftf_psci_affinity_info(target_mpid, MPIDR_AFFLVL0) !=
-				PSCI_STATE_OFF) {
-			continue;
-		}
+		wait_for_core_to_turn_off(target_mpid);
 	}
 
 	/*
@@ -346,3 +385,37 @@ test_result_t host_realm_fail_del(void)
 
 	return host_cmp_result();
 }
+
+/*
+ * Call every function ID of the RMI range RMI_REGS_CHECK_ROUNDS times, with
+ * all of X1 to X7 randomized, and check that the RMM preserves the registers
+ * of X4 to X7 each function does not return results in. The argument values
+ * are invalid, such that the calls fail without changing any state.
+ */
+test_result_t host_realm_regs_preserved_all_fids(void)
+{
+	unsigned int failed = 0U;
+
+	if (get_armv9_2_feat_rme_support() == 0U) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	host_rmi_init_cmp_result();
+
+	for (unsigned int offset = 0U;
+	     offset <= (RMI_FNUM_MAX_VALUE - RMI_FNUM_MIN_VALUE); offset++) {
+		for (unsigned int i = 0U; i < RMI_REGS_CHECK_ROUNDS; i++) {
+			if (host_rmi_regs_check_fid(SMC64_RMI_FID(offset)) !=
+			    0U) {
+				failed++;
+			}
+		}
+	}
+
+	if (failed != 0U) {
+		tftf_testcase_printf("%u RMI calls did not preserve registers\n",
+				     failed);
+	}
+
+	return host_cmp_result();
+}
@@ -156,7 +156,7 @@ static test_result_t run_on_cpu(unsigned int  mpidr, uintptr_t cpu_on_handler)
 {
 	int32_t ret;
 
-	ret = tftf_cpu_on(mpidr, cpu_on_handler, 0U);
+	ret = tftf_cpu_on_parkable(mpidr, cpu_on_handler);
 	if (ret != PSCI_E_SUCCESS) {
 		ERROR("tftf_cpu_on mpidr 0x%x returns %d\n", mpidr, ret);
 		return TEST_RESULT_FAIL;
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <debug.h>
+#include <platform.h>
+#include <plat_topology.h>
+#include <power_management.h>
+#include <psci.h>
+#include <spinlock.h>
+#include <stdio.h>
+#include <test_helpers.h>
+
+#include <host_realm_helper.h>
+#include <host_realm_mem_layout.h>
+#include <host_shared_data.h>
+
+/* REC enters made by each core for each configuration of the benchmark */
+#define MULTI_REALM_ENTER_ITERATIONS	U(256)
+
+static struct realm realms[MAX_REALM_COUNT];
+
+/*
+ * Create 'realm_count' realms with 'rec_count' runnable RECs each. They share
+ * the page pool, and each maps its own slice of the NS shared region.
+ */
+static bool host_create_realms(unsigned int realm_count,
+			       unsigned int rec_count)
+{
+	u_register_t rec_flag[MAX_REC_COUNT];
+	unsigned int k;
+
+	for (unsigned int i = 0U; i < rec_count; i++) {
+		rec_flag[i] = RMI_RUNNABLE;
+	}
+
+	for (k = 0U; k < realm_count; k++) {
+		if (!host_create_realm_payload(&realms[k],
+				(u_register_t)REALM_IMAGE_BASE,
+				(u_register_t)PAGE_POOL_BASE,
+				(u_register_t)(PAGE_POOL_MAX_SIZE +
+				NS_REALM_SHARED_MEM_SIZE),
+				(u_register_t)PAGE_POOL_MAX_SIZE,
+				0UL, rec_flag, rec_count)) {
+			break;
+		}
+
+		if (!host_create_shared_mem(&realms[k],
+				NS_REALM_SHARED_MEM_BASE +
+				(k * NS_REALM_SHARED_MEM_SLICE),
+				NS_REALM_SHARED_MEM_SLICE)) {
+			(void)host_destroy_realm(&realms[k]);
+			break;
+		}
+	}
+
+	if (k == realm_count) {
+		return true;
+	}
+
+	ERROR("Failed to create realm %u of %u\n", k, realm_count);
+
+	while (k-- > 0U) {
+		(void)host_destroy_realm(&realms[k]);
+	}
+
+	return false;
+}
+
+static bool host_destroy_realms(unsigned int realm_count)
+{
+	bool ret = true;
+
+	for (unsigned int k = 0U; k < realm_count; k++) {
+		if (!host_destroy_realm(&realms[k])) {
+			ret = false;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * @Test_Aim@ Create MAX_REALM_COUNT realms at the same time, fill the FPU
+ * registers of each of them in turn, then check that each realm still finds
+ * its own values after the others ran.
+ */
+test_result_t host_realm_multi_realm_fpu(void)
+{
+	bool ret1 = true, ret2;
+
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	if (!host_create_realms(MAX_REALM_COUNT, 1U)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int k = 0U; k < MAX_REALM_COUNT && ret1; k++) {
+		ret1 = host_enter_realm_execute(&realms[k],
+						REALM_REQ_FPU_FILL_CMD,
+						RMI_EXIT_HOST_CALL, 0U);
+	}
+
+	for (unsigned int k = 0U; k < MAX_REALM_COUNT && ret1; k++) {
+		ret1 = host_enter_realm_execute(&realms[k],
+						REALM_REQ_FPU_CMP_CMD,
+						RMI_EXIT_HOST_CALL, 0U);
+	}
+
+	ret2 = host_destroy_realms(MAX_REALM_COUNT);
+
+	if (!ret1 || !ret2) {
+		ERROR("%s(): enter=%d destroy=%d\n", __func__, ret1, ret2);
+		return TEST_RESULT_FAIL;
+	}
+
+	return host_cmp_result();
+}
+
+/* The REC each core enters in the benchmark, and how long it took */
+static struct {
+	struct realm *realm;
+	unsigned int rec_num;
+	uint64_t start;
+	uint64_t end;
+	bool ret;
+} bench_slot[PLATFORM_CORE_COUNT];
+
+static spinlock_t bench_lock;
+static volatile unsigned int bench_ready;
+static volatile bool bench_go;
+
+static test_result_t host_realm_enter_worker(void)
+{
+	unsigned int core_pos = platform_get_core_pos(read_mpidr_el1());
+	bool ret = true;
+
+	spin_lock(&bench_lock);
+	bench_ready++;
+	spin_unlock(&bench_lock);
+
+	/* All the cores start entering their REC at the same time */
+	while (!bench_go) {
+		continue;
+	}
+
+	bench_slot[core_pos].start = read_cntpct_el0();
+	for (unsigned int i = 0U; i < MULTI_REALM_ENTER_ITERATIONS && ret;
+	     i++) {
+		ret = host_enter_realm_execute(bench_slot[core_pos].realm,
+					       REALM_REQ_FPU_FILL_CMD,
+					       RMI_EXIT_HOST_CALL,
+					       bench_slot[core_pos].rec_num);
+	}
+	bench_slot[core_pos].end = read_cntpct_el0();
+	bench_slot[core_pos].ret = ret;
+
+	return ret ? TEST_RESULT_SUCCESS : TEST_RESULT_FAIL;
+}
+
+/*
+ * Enter each of the 'rec_count' RECs of each of the 'realm_count' realms from
+ * a core of its own, all at the same time, and print the aggregate number of
+ * REC enters per second and the latency of an enter on each core. Returns
+ * the aggregate rate, or 0 on failure.
+ */
+static uint64_t host_realm_enter_bench(unsigned int realm_count,
+				       unsigned int rec_count)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int lead_pos = platform_get_core_pos(lead_mpid);
+	unsigned int ncores = realm_count * rec_count;
+	uint64_t samples[PLATFORM_CORE_COUNT];
+	uint64_t start = UINT64_MAX, end = 0U, rate;
+	struct bench_stats stats;
+	tftf_cpu_mask_t mask = { 0 };
+	unsigned int cpu_node, mpidr, pos, n;
+	bool ret = true;
+	char name[96];
+
+	if (!host_create_realms(realm_count, rec_count)) {
+		return 0U;
+	}
+
+	bench_ready = 0U;
+	bench_go = false;
+
+	for_each_cpu(cpu_node) {
+		pos = platform_get_core_pos(tftf_get_mpidr_from_node(cpu_node));
+		bench_slot[pos].realm = NULL;
+		bench_slot[pos].ret = false;
+	}
+
+	/* The lead core enters REC 0 of realm 0, other cores the next ones */
+	bench_slot[lead_pos].realm = &realms[0];
+	bench_slot[lead_pos].rec_num = 0U;
+
+	n = 1U;
+	for_each_cpu(cpu_node) {
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		if (mpidr == lead_mpid || n == ncores) {
+			continue;
+		}
+
+		pos = platform_get_core_pos(mpidr);
+		bench_slot[pos].realm = &realms[n / rec_count];
+		bench_slot[pos].rec_num = n % rec_count;
+		tftf_cpu_mask_set(&mask, pos);
+		n++;
+	}
+
+	dsbsy();
+
+	if (tftf_cpu_on_all((uintptr_t)host_realm_enter_worker, &mask) !=
+	    PSCI_E_SUCCESS) {
+		ret = false;
+
+		/* The workers started are online and waiting for bench_go */
+		for_each_cpu(cpu_node) {
+			mpidr = tftf_get_mpidr_from_node(cpu_node);
+			pos = platform_get_core_pos(mpidr);
+			if (tftf_cpu_mask_test(&mask, pos) &&
+			    !tftf_is_core_pos_online(pos)) {
+				ERROR("CPU ON failed for 0x%x\n", mpidr);
+				bench_slot[pos].realm = NULL;
+			}
+		}
+	}
+
+	while (ret && bench_ready != (ncores - 1U)) {
+		continue;
+	}
+
+	bench_go = true;
+	dsbsy();
+
+	if (ret) {
+		(void)host_realm_enter_worker();
+	}
+
+	n = 0U;
+	for_each_cpu(cpu_node) {
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		pos = platform_get_core_pos(mpidr);
+		if (bench_slot[pos].realm == NULL) {
+			continue;
+		}
+
+		wait_for_core_to_turn_off(mpidr);
+
+		if (!bench_slot[pos].ret) {
+			ret = false;
+			continue;
+		}
+
+		start = MIN(start, bench_slot[pos].start);
+		end = MAX(end, bench_slot[pos].end);
+		samples[n++] = (bench_slot[pos].end - bench_slot[pos].start) /
+			       MULTI_REALM_ENTER_ITERATIONS;
+	}
+
+	if (!host_destroy_realms(realm_count) || !ret) {
+		ERROR("%s(): %u realms x %u RECs failed\n", __func__,
+		      realm_count, rec_count);
+		return 0U;
+	}
+
+	rate = bench_ops_per_sec((uint64_t)ncores *
+				 MULTI_REALM_ENTER_ITERATIONS, end - start);
+
+	bench_stats_compute(samples, n, &stats);
+	snprintf(name, sizeof(name),
+		 "%u realms x %u RECs: %llu enters/s", realm_count, rec_count,
+		 (unsigned long long)rate);
+	bench_stats_print(name, &stats);
+
+	return rate;
+}
+
+static test_result_t do_host_realm_multi_realm_enter_perf(void)
+{
+	unsigned int cpus = tftf_get_total_cpus_count();
+	unsigned int rec_counts[2];
+	uint64_t base, rate;
+
+	base = host_realm_enter_bench(1U, 1U);
+	if (base == 0U) {
+		return TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int k = 1U; k <= MAX_REALM_COUNT && k <= cpus; k <<= 1) {
+		rec_counts[0] = 1U;
+		rec_counts[1] = MIN(cpus / k, MAX_REC_COUNT);
+
+		for (unsigned int r = 0U; r < ARRAY_SIZE(rec_counts); r++) {
+			if ((k == 1U && rec_counts[r] == 1U) ||
+			    (r == 1U && rec_counts[1] == rec_counts[0])) {
+				continue;
+			}
+
+			rate = host_realm_enter_bench(k, rec_counts[r]);
+			if (rate == 0U) {
+				return TEST_RESULT_FAIL;
+			}
+
+			printf("%u realms x %u RECs: %llu.%02llux the rate"
+			       " of 1 realm x 1 REC\n", k, rec_counts[r],
+			       (unsigned long long)(rate / base),
+			       (unsigned long long)(((rate % base) * 100U) /
+						    base));
+		}
+	}
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Measure the aggregate rate of REC enters of 1, 2 and 4 realms
+ * entered concurrently with one REC each, then with as many RECs each as
+ * there are cores to run them, and compare it with one realm and one REC to
+ * show how the RMM scales.
+ */
+test_result_t host_realm_multi_realm_enter_perf(void)
+{
+	unsigned int prev_rate;
+	test_result_t result;
+
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	/* Time the RMI calls without checking the registers preserved */
+	prev_rate = host_rmi_regs_check_set(0U);
+	result = do_host_realm_multi_realm_enter_perf();
+	(void)host_rmi_regs_check_set(prev_rate);
+
+	return result;
+}
@@ -0,0 +1,850 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <arch_features.h>
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <debug.h>
+#include <drivers/arm/arm_gic.h>
+#include <irq.h>
+#include <platform.h>
+#include <psci.h>
+#include <sgi.h>
+#include <stdio.h>
+#include <test_helpers.h>
+#include <lib/extensions/sme.h>
+
+#include <host_realm_helper.h>
+#include <host_realm_mem_layout.h>
+#include <host_realm_pmu.h>
+#include <host_realm_rmi.h>
+#include <host_shared_data.h>
+
+/* Largest PAR that fits in the page pool with the realm objects */
+#define LOAD_BENCH_MAX_PAR_SIZE		U(0x800000)
+
+/* REC round trips timed for each exit reason and each realm state */
+#define REC_EXIT_BENCH_ITERATIONS	U(20000)
+
+/* Commands run one per REC entry, then in batches from the command ring */
+#define CMD_RING_BENCH_COMMANDS		U(1024)
+
+/* Realms created and destroyed with and without the delegated pool */
+#define POOL_BENCH_ITERATIONS		U(16)
+
+/* Top of the page pool delegated once for the realms of the benchmark */
+#define POOL_BENCH_POOL_SIZE		U(0x200000)
+
+/* Iterations of each kernel of the realm PMU microbenchmarks */
+#define PMU_BENCH_ITERATIONS		U(1000)
+
+enum rec_exit_bench_state {
+	REC_EXIT_BENCH_BASE = 0,
+	REC_EXIT_BENCH_SVE,
+	REC_EXIT_BENCH_SME,
+	REC_EXIT_BENCH_PMU,
+	REC_EXIT_BENCH_PAUTH,
+};
+
+static const char *const rec_exit_state_names[] = {
+	[REC_EXIT_BENCH_BASE] = "no optional state",
+	[REC_EXIT_BENCH_SVE] = "realm SVE state",
+	[REC_EXIT_BENCH_SME] = "NS Streaming SVE and ZA",
+	[REC_EXIT_BENCH_PMU] = "realm PMU state",
+	[REC_EXIT_BENCH_PAUTH] = "realm PAuth keys",
+};
+
+static struct realm realm;
+
+static uint64_t samples[REC_EXIT_BENCH_ITERATIONS];
+
+/*
+ * Run 'test' without checking the registers preserved by the RMM, so that the
+ * checks are not timed, then restore the previous check rate.
+ */
+static test_result_t host_realm_perf_run(test_result_t (*test)(void))
+{
+	unsigned int prev_rate = host_rmi_regs_check_set(0U);
+	test_result_t result = test();
+
+	(void)host_rmi_regs_check_set(prev_rate);
+
+	return result;
+}
+
+static test_result_t do_host_realm_launch_profile(void)
+{
+	u_register_t rec_flag[] = {RMI_RUNNABLE};
+	uint64_t start, create_ticks, destroy_ticks;
+	bool ret;
+
+	host_rmi_stats_reset();
+
+	start = read_cntpct_el0();
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
+			(u_register_t)PAGE_POOL_BASE,
+			(u_register_t)(PAGE_POOL_MAX_SIZE +
+			NS_REALM_SHARED_MEM_SIZE),
+			(u_register_t)PAGE_POOL_MAX_SIZE,
+			0UL, rec_flag, 1U)) {
+		return TEST_RESULT_FAIL;
+	}
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
+			NS_REALM_SHARED_MEM_SIZE)) {
+		(void)host_destroy_realm(&realm);
+		return TEST_RESULT_FAIL;
+	}
+	create_ticks = read_cntpct_el0() - start;
+
+	tftf_testcase_printf("Realm launch: %lluns\n",
+			     (unsigned long long)
+			     bench_ticks_to_ns(create_ticks));
+	host_rmi_stats_print("Realm launch");
+
+	host_rmi_stats_reset();
+
+	start = read_cntpct_el0();
+	ret = host_destroy_realm(&realm);
+	destroy_ticks = read_cntpct_el0() - start;
+
+	if (!ret) {
+		ERROR("%s(): destroy=%d\n", __func__, ret);
+		return TEST_RESULT_FAIL;
+	}
+
+	tftf_testcase_printf("Realm teardown: %lluns\n",
+			     (unsigned long long)
+			     bench_ticks_to_ns(destroy_ticks));
+	host_rmi_stats_print("Realm teardown");
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Measure the time taken to create, activate and destroy a realm,
+ * and break it down per RMI command when built with HOST_RMI_STATS=1.
+ */
+test_result_t host_realm_launch_profile(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_launch_profile);
+}
+
+/*
+ * Create a realm with a PAR of 'par_size' bytes mapped by 'loader', check it
+ * runs, and print the time taken to launch it.
+ */
+static test_result_t host_realm_load_bench(u_register_t par_size,
+					   enum host_realm_loader loader)
+{
+	static const char *const loader_names[] = {
+		[HOST_REALM_LOAD_PAGES] = "pages",
+		[HOST_REALM_LOAD_BLOCKS] = "2MB blocks, one core",
+		[HOST_REALM_LOAD_BLOCKS_ALL_CORES] = "2MB blocks, all cores",
+	};
+	u_register_t rec_flag[] = {RMI_RUNNABLE};
+	uint64_t start, ticks;
+	bool ret1, ret2;
+
+	start = read_cntpct_el0();
+	if (!host_create_realm_payload_sized(&realm,
+			(u_register_t)REALM_IMAGE_BASE,
+			(u_register_t)PAGE_POOL_BASE,
+			(u_register_t)(PAGE_POOL_MAX_SIZE +
+			NS_REALM_SHARED_MEM_SIZE),
+			(u_register_t)PAGE_POOL_MAX_SIZE,
+			0UL, rec_flag, 1U, par_size, loader)) {
+		return TEST_RESULT_FAIL;
+	}
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
+			NS_REALM_SHARED_MEM_SIZE)) {
+		(void)host_destroy_realm(&realm);
+		return TEST_RESULT_FAIL;
+	}
+	ticks = read_cntpct_el0() - start;
+
+	ret1 = host_enter_realm_execute(&realm, REALM_GET_RSI_VERSION,
+					RMI_EXIT_HOST_CALL, 0U);
+	ret2 = host_destroy_realm(&realm);
+
+	if (!ret1 || !ret2) {
+		ERROR("%s(): enter=%d destroy=%d\n", __func__, ret1, ret2);
+		return TEST_RESULT_FAIL;
+	}
+
+	printf("%4luKB PAR, %-21s: %10lluns (%llu bytes/s)\n",
+	       par_size / 1024UL, loader_names[loader],
+	       (unsigned long long)bench_ticks_to_ns(ticks),
+	       (unsigned long long)bench_ops_per_sec(par_size, ticks));
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t do_host_realm_launch_vs_size(void)
+{
+	test_result_t result;
+
+	for (u_register_t size = REALM_MAX_LOAD_IMG_SIZE;
+	     size <= LOAD_BENCH_MAX_PAR_SIZE; size <<= 1) {
+		for (unsigned int l = HOST_REALM_LOAD_PAGES;
+		     l <= HOST_REALM_LOAD_BLOCKS_ALL_CORES; l++) {
+			result = host_realm_load_bench(size,
+					(enum host_realm_loader)l);
+			if (result != TEST_RESULT_SUCCESS) {
+				return result;
+			}
+		}
+	}
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Compare the time taken to launch realms of increasing PAR sizes,
+ * with the PAR mapped page by page, or with 2MB blocks populated from one
+ * core or from all cores.
+ */
+test_result_t host_realm_launch_vs_size(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_launch_vs_size);
+}
+
+/*
+ * Create a realm with 'feature_flag' and two RECs. Only REC 0 runs, REC 1 is
+ * the target of its PSCI requests.
+ */
+static bool host_rec_exit_bench_create(u_register_t feature_flag)
+{
+	u_register_t rec_flag[] = {RMI_RUNNABLE, RMI_NOT_RUNNABLE};
+
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
+			(u_register_t)PAGE_POOL_BASE,
+			(u_register_t)(PAGE_POOL_MAX_SIZE +
+			NS_REALM_SHARED_MEM_SIZE),
+			(u_register_t)PAGE_POOL_MAX_SIZE,
+			feature_flag, rec_flag, 2U)) {
+		return false;
+	}
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
+			NS_REALM_SHARED_MEM_SIZE)) {
+		(void)host_destroy_realm(&realm);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Enter REC 0 while the realm runs 'cmd', which makes it exit with
+ * 'exit_reason' each time, and print the statistics of
+ * REC_EXIT_BENCH_ITERATIONS round trips, followed by their overhead over
+ * 'base_avg' when it is not 0. The round trips of PSCI exits include the
+ * RMI_PSCI_COMPLETE which lets the REC run again. The first round trip is not
+ * timed, as the realm also fetches its shared buffer. Realms running
+ * REALM_LOOP_CMD do not return from it. Returns the average round trip, or 0
+ * on failure.
+ */
+static uint64_t host_rec_exit_bench_run(uint8_t cmd, u_register_t exit_reason,
+					const char *state, uint64_t base_avg)
+{
+	static const char *const exit_names[] = {
+		[RMI_EXIT_SYNC] = "SYNC",
+		[RMI_EXIT_IRQ] = "IRQ",
+		[RMI_EXIT_FIQ] = "FIQ",
+		[RMI_EXIT_PSCI] = "PSCI",
+		[RMI_EXIT_RIPAS_CHANGE] = "RIPAS_CHANGE",
+		[RMI_EXIT_HOST_CALL] = "HOST_CALL",
+	};
+	struct rmi_rec_run *run = (struct rmi_rec_run *)realm.run[0];
+	unsigned int host_call_result = TEST_RESULT_FAIL;
+	u_register_t ret, reason = RMI_EXIT_INVALID;
+	struct bench_stats stats;
+	uint64_t start, ticks;
+	char name[96];
+
+	host_shared_data_set_host_val(&realm, 0U, HOST_ARG1_INDEX,
+				      REC_EXIT_BENCH_ITERATIONS + 1U);
+	host_shared_data_set_realm_cmd(&realm, cmd, 0U);
+
+	for (unsigned int i = 0U; i <= REC_EXIT_BENCH_ITERATIONS; i++) {
+		start = read_cntpct_el0();
+		ret = host_realm_rec_enter(&realm, &reason, &host_call_result,
+					   0U);
+		if (ret == RMI_SUCCESS && reason == RMI_EXIT_PSCI) {
+			ret = host_rmi_psci_complete(realm.rec[0],
+					realm.rec[1], PSCI_E_SUCCESS);
+		}
+		ticks = read_cntpct_el0() - start;
+
+		if (ret != RMI_SUCCESS || reason != exit_reason ||
+		    (reason == RMI_EXIT_HOST_CALL &&
+		     run->exit.imm != HOST_CALL_NOP_CMD) ||
+		    (reason == RMI_EXIT_PSCI &&
+		     run->exit.gprs[0] != SMC_PSCI_AFFINITY_INFO_AARCH64)) {
+			ERROR("%s exit %u failed, ret=0x%lx exit_reason=%lu\n",
+			      exit_names[exit_reason], i, ret, reason);
+			return 0U;
+		}
+
+		if (i > 0U) {
+			samples[i - 1U] = ticks;
+		}
+	}
+
+	/* The next entry returns from 'cmd' */
+	if (cmd != REALM_LOOP_CMD) {
+		ret = host_realm_rec_enter(&realm, &reason, &host_call_result,
+					   0U);
+		if (ret != RMI_SUCCESS || reason != RMI_EXIT_HOST_CALL ||
+		    host_call_result != TEST_RESULT_SUCCESS) {
+			ERROR("Realm command %u failed\n", cmd);
+			return 0U;
+		}
+	}
+
+	bench_stats_compute(samples, REC_EXIT_BENCH_ITERATIONS, &stats);
+
+	if (base_avg == 0U) {
+		snprintf(name, sizeof(name), "%-9s %s",
+			 exit_names[exit_reason], state);
+	} else {
+		snprintf(name, sizeof(name), "%-9s %s (%+lldns)",
+			 exit_names[exit_reason], state,
+			 (long long)bench_ticks_to_ns(stats.avg) -
+			 (long long)bench_ticks_to_ns(base_avg));
+	}
+	bench_stats_print(name, &stats);
+
+	return stats.avg;
+}
+
+/*
+ * Time IRQ exits, caused by an SGI the host leaves pending with its own IRQs
+ * masked, such that the REC exits as soon as it is entered. The SGI is taken
+ * once the IRQs are unmasked again.
+ */
+static uint64_t host_rec_exit_bench_irq(uint64_t base_avg)
+{
+	uint64_t avg;
+
+	tftf_irq_enable(IRQ_NS_SGI_7, GIC_HIGHEST_NS_PRIORITY);
+	disable_irq();
+
+	tftf_send_sgi(IRQ_NS_SGI_7, platform_get_core_pos(read_mpidr_el1()));
+	avg = host_rec_exit_bench_run(REALM_LOOP_CMD, RMI_EXIT_IRQ,
+				      "pending SGI", base_avg);
+
+	enable_irq();
+	tftf_irq_disable(IRQ_NS_SGI_7);
+
+	return avg;
+}
+
+static test_result_t do_host_realm_rec_exit_perf(void)
+{
+	struct rmi_rec_run *run;
+	uint64_t base = 0U, avg;
+	bool ret1, ret2;
+
+	if (!host_rec_exit_bench_create(0UL)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	run = (struct rmi_rec_run *)realm.run[0];
+
+	base = host_rec_exit_bench_run(REALM_NOP_HOST_CALL, RMI_EXIT_HOST_CALL,
+				       "NOP host call", 0U);
+	ret1 = (base != 0U);
+
+	if (ret1) {
+		/* The RMM only traps the WFI of the realm if asked to */
+		run->entry.flags |= REC_ENTRY_FLAG_TRAP_WFI;
+		avg = host_rec_exit_bench_run(REALM_NOP_WFI, RMI_EXIT_SYNC,
+					      "trapped WFI", base);
+		run->entry.flags &= ~REC_ENTRY_FLAG_TRAP_WFI;
+		ret1 = (avg != 0U);
+	}
+
+	if (ret1) {
+		avg = host_rec_exit_bench_run(REALM_NOP_PSCI, RMI_EXIT_PSCI,
+					      "AFFINITY_INFO", base);
+		ret1 = (avg != 0U);
+	}
+
+	if (ret1) {
+		ret1 = (host_rec_exit_bench_irq(base) != 0U);
+	}
+
+	ret2 = host_destroy_realm(&realm);
+
+	if (!ret1 || !ret2) {
+		ERROR("%s(): enter=%d destroy=%d\n", __func__, ret1, ret2);
+		return TEST_RESULT_FAIL;
+	}
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Measure the round trip of a REC enter and the REC exit which
+ * follows for each kind of exit: a host call the host returns from straight
+ * away, a trapped WFI, an IRQ and a PSCI request, and compare them with the
+ * host call.
+ */
+test_result_t host_realm_rec_exit_perf(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_rec_exit_perf);
+}
+
+/*
+ * Measure host call round trips with 'state' live in the realm, or in the NS
+ * world for SME, which the realm cannot use but the RMM must preserve. Returns
+ * TEST_RESULT_SKIPPED if the PE or the RMM does not support 'state'.
+ */
+static test_result_t host_rec_state_bench(enum rec_exit_bench_state state,
+					  uint64_t *base_avg)
+{
+	u_register_t feature_flag = 0UL, feat_reg0;
+	uint8_t sve_vq;
+	uint64_t avg;
+	bool ret1 = true, ret2;
+
+	if (host_rmi_features(0UL, &feat_reg0) != REALM_SUCCESS) {
+		ERROR("Failed to get RMI feat_reg0\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	switch (state) {
+	case REC_EXIT_BENCH_SVE:
+		if (!is_armv8_2_sve_present() ||
+		    (feat_reg0 & RMI_FEATURE_REGISTER_0_SVE_EN) == 0UL) {
+			return TEST_RESULT_SKIPPED;
+		}
+		sve_vq = EXTRACT(RMI_FEATURE_REGISTER_0_SVE_VL, feat_reg0);
+		feature_flag = RMI_FEATURE_REGISTER_0_SVE_EN |
+				INPLACE(FEATURE_SVE_VL, sve_vq);
+		break;
+	case REC_EXIT_BENCH_SME:
+		if (!is_feat_sme_supported()) {
+			return TEST_RESULT_SKIPPED;
+		}
+		break;
+	case REC_EXIT_BENCH_PMU:
+		if ((feat_reg0 & RMI_FEATURE_REGISTER_0_PMU_EN) == 0UL) {
+			return TEST_RESULT_SKIPPED;
+		}
+		host_set_pmu_state();
+		feature_flag = RMI_FEATURE_REGISTER_0_PMU_EN |
+			INPLACE(FEATURE_PMU_NUM_CTRS, (unsigned long long)(-1));
+		break;
+	case REC_EXIT_BENCH_PAUTH:
+		if (ENABLE_PAUTH == 0 || !is_armv8_3_pauth_present()) {
+			return TEST_RESULT_SKIPPED;
+		}
+		break;
+	default:
+		break;
+	}
+
+	if (!host_rec_exit_bench_create(feature_flag)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	if (state == REC_EXIT_BENCH_SVE) {
+		ret1 = host_enter_realm_execute(&realm, REALM_SVE_FILL_REGS,
+						RMI_EXIT_HOST_CALL, 0U);
+	} else if (state == REC_EXIT_BENCH_PAUTH) {
+		ret1 = host_enter_realm_execute(&realm, REALM_PAUTH_SET_CMD,
+						RMI_EXIT_HOST_CALL, 0U);
+	} else if (state == REC_EXIT_BENCH_SME) {
+		sme_smstart(SMSTART);
+	}
+
+	if (ret1) {
+		avg = host_rec_exit_bench_run(REALM_NOP_HOST_CALL,
+					      RMI_EXIT_HOST_CALL,
+					      rec_exit_state_names[state],
+					      *base_avg);
+		ret1 = (avg != 0U);
+		if (state == REC_EXIT_BENCH_BASE) {
+			*base_avg = avg;
+		}
+	}
+
+	if (state == REC_EXIT_BENCH_SME) {
+		sme_smstop(SMSTOP);
+	}
+
+	ret2 = host_destroy_realm(&realm);
+
+	if (!ret1 || !ret2) {
+		ERROR("%s(): enter=%d destroy=%d\n", __func__, ret1, ret2);
+		return TEST_RESULT_FAIL;
+	}
+
+	if (state == REC_EXIT_BENCH_PMU && !host_check_pmu_state()) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t do_host_realm_rec_state_perf(void)
+{
+	test_result_t result;
+	uint64_t base = 0U;
+
+	for (unsigned int s = REC_EXIT_BENCH_BASE; s <= REC_EXIT_BENCH_PAUTH;
+	     s++) {
+		result = host_rec_state_bench((enum rec_exit_bench_state)s,
+					      &base);
+		if (result == TEST_RESULT_SKIPPED) {
+			tftf_testcase_printf("HOST_CALL %s not supported\n",
+					     rec_exit_state_names[s]);
+			continue;
+		}
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+	}
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Measure how much the SVE state, the PMU state and the PAuth keys
+ * of a realm, and the SME state of the NS world, add to the round trip of a
+ * host call, which the RMM saves and restores on each REC enter and exit.
+ * The states the PE or the RMM does not support are skipped.
+ */
+test_result_t host_realm_rec_state_perf(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_rec_state_perf);
+}
+
+/*
+ * Run CMD_RING_BENCH_COMMANDS REALM_REQ_FPU_FILL_CMD, queued on the command
+ * ring in batches of up to REALM_CMD_RING_SIZE if 'ring' is true, or one per
+ * REC entry otherwise. Returns the time taken, or 0 on failure.
+ */
+static uint64_t host_cmd_ring_bench(bool ring)
+{
+	struct realm_cmd_compl compl;
+	unsigned int queued;
+	uint64_t start;
+
+	start = read_cntpct_el0();
+
+	for (unsigned int i = 0U; i < CMD_RING_BENCH_COMMANDS; i += queued) {
+		queued = 1U;
+		if (ring) {
+			queued = 0U;
+			while ((i + queued) < CMD_RING_BENCH_COMMANDS &&
+			       host_cmd_ring_push(&realm, 0U,
+						  REALM_REQ_FPU_FILL_CMD,
+						  NULL)) {
+				queued++;
+			}
+		}
+
+		if (!host_enter_realm_execute(&realm, ring ? REALM_CMD_RING :
+					      REALM_REQ_FPU_FILL_CMD,
+					      RMI_EXIT_HOST_CALL, 0U)) {
+			return 0U;
+		}
+
+		for (unsigned int c = 0U; ring && c < queued; c++) {
+			if (!host_compl_ring_pop(&realm, 0U, &compl) ||
+			    compl.result == 0UL) {
+				ERROR("Command %u failed\n", i + c);
+				return 0U;
+			}
+		}
+	}
+
+	return read_cntpct_el0() - start;
+}
+
+static test_result_t do_host_realm_cmd_ring_perf(void)
+{
+	uint64_t single, batched;
+	bool ret;
+
+	if (!host_rec_exit_bench_create(0UL)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	single = host_cmd_ring_bench(false);
+	batched = (single != 0U) ? host_cmd_ring_bench(true) : 0U;
+
+	ret = host_destroy_realm(&realm);
+
+	if (single == 0U || batched == 0U || !ret) {
+		ERROR("%s(): single=%llu batched=%llu destroy=%d\n", __func__,
+		      (unsigned long long)single, (unsigned long long)batched,
+		      ret);
+		return TEST_RESULT_FAIL;
+	}
+
+	tftf_testcase_printf("One command per REC entry: %llu commands/s\n",
+			     (unsigned long long)bench_ops_per_sec(
+				     CMD_RING_BENCH_COMMANDS, single));
+	tftf_testcase_printf("%u commands per REC entry: %llu commands/s\n",
+			     REALM_CMD_RING_SIZE,
+			     (unsigned long long)bench_ops_per_sec(
+				     CMD_RING_BENCH_COMMANDS, batched));
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Compare the rate of realm commands run one per REC entry with
+ * the rate of the same commands queued on the command ring, which the realm
+ * drains in one REC entry per batch.
+ */
+test_result_t host_realm_cmd_ring_perf(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_cmd_ring_perf);
+}
+
+/*
+ * Create and destroy POOL_BENCH_ITERATIONS realms in a row, with their RD,
+ * RTTs, REC, auxiliary granules and PAR taken from a delegated pool at the
+ * top of the page pool if 'pool' is true, and print the time taken by each
+ * creation and destruction. Returns the average cycle, or 0 on failure.
+ */
+static uint64_t host_delegated_pool_bench(bool pool)
+{
+	u_register_t pool_base = PAGE_POOL_BASE + PAGE_POOL_MAX_SIZE -
+				 POOL_BENCH_POOL_SIZE;
+	u_register_t rec_flag[] = {RMI_RUNNABLE};
+	uint64_t create[POOL_BENCH_ITERATIONS];
+	uint64_t destroy[POOL_BENCH_ITERATIONS];
+	struct bench_stats create_stats, destroy_stats;
+	uint64_t start;
+	unsigned int i;
+	bool ret = true;
+	char name[64];
+
+	if (pool && host_realm_delegated_pool_init(pool_base,
+			POOL_BENCH_POOL_SIZE) != REALM_SUCCESS) {
+		return 0U;
+	}
+
+	for (i = 0U; i < POOL_BENCH_ITERATIONS && ret; i++) {
+		start = read_cntpct_el0();
+		ret = host_create_realm_payload(&realm,
+				(u_register_t)REALM_IMAGE_BASE,
+				(u_register_t)PAGE_POOL_BASE,
+				(u_register_t)(PAGE_POOL_MAX_SIZE +
+				NS_REALM_SHARED_MEM_SIZE),
+				(u_register_t)(PAGE_POOL_MAX_SIZE -
+				POOL_BENCH_POOL_SIZE),
+				0UL, rec_flag, 1U);
+		create[i] = read_cntpct_el0() - start;
+
+		if (ret) {
+			start = read_cntpct_el0();
+			ret = host_destroy_realm(&realm);
+			destroy[i] = read_cntpct_el0() - start;
+		}
+	}
+
+	if (pool && host_realm_delegated_pool_destroy() != REALM_SUCCESS) {
+		ret = false;
+	}
+
+	if (!ret) {
+		ERROR("%s(): pool=%d failed at realm %u\n", __func__, pool, i);
+		return 0U;
+	}
+
+	bench_stats_compute(create, POOL_BENCH_ITERATIONS, &create_stats);
+	bench_stats_compute(destroy, POOL_BENCH_ITERATIONS, &destroy_stats);
+
+	snprintf(name, sizeof(name), "Realm create, %s",
+		 pool ? "delegated pool" : "delegate per realm");
+	bench_stats_print(name, &create_stats);
+	snprintf(name, sizeof(name), "Realm destroy, %s",
+		 pool ? "delegated pool" : "undelegate per realm");
+	bench_stats_print(name, &destroy_stats);
+
+	return create_stats.avg + destroy_stats.avg;
+}
+
+static test_result_t do_host_realm_delegated_pool_perf(void)
+{
+	uint64_t base, pooled;
+
+	base = host_delegated_pool_bench(false);
+	if (base == 0U) {
+		return TEST_RESULT_FAIL;
+	}
+
+	pooled = host_delegated_pool_bench(true);
+	if (pooled == 0U) {
+		return TEST_RESULT_FAIL;
+	}
+
+	tftf_testcase_printf("Delegated pool: %+lldns per realm cycle\n",
+			     (long long)bench_ticks_to_ns(pooled) -
+			     (long long)bench_ticks_to_ns(base));
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Compare the time taken to create and destroy a realm when its
+ * granules are delegated and undelegated with each realm, and when they are
+ * taken from and given back to a pool of granules delegated once.
+ */
+test_result_t host_realm_delegated_pool_perf(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_delegated_pool_perf);
+}
+
+/*
+ * Format 'count' events of PMU_BENCH_ITERATIONS iterations as the count per
+ * iteration, with two decimals.
+ */
+static void host_pmu_bench_format(char *buf, size_t len, u_register_t count)
+{
+	unsigned long long scaled;
+
+	if (count == REALM_PMU_BENCH_NOT_COUNTED) {
+		snprintf(buf, len, "-");
+		return;
+	}
+
+	scaled = ((unsigned long long)count * 100ULL) / PMU_BENCH_ITERATIONS;
+	snprintf(buf, len, "%llu.%02llu", scaled / 100ULL, scaled % 100ULL);
+}
+
+/*
+ * Run 'kernel' in the realm for PMU_BENCH_ITERATIONS iterations, reading
+ * 'size' bytes on each of them for the streaming kernels, and print what the
+ * realm counted per iteration.
+ */
+static bool host_pmu_bench_run(enum realm_pmu_bench_kernel kernel,
+			       u_register_t size)
+{
+	static const char *const kernel_names[] = {
+		[REALM_PMU_BENCH_RSI_VERSION] = "RSI_VERSION",
+		[REALM_PMU_BENCH_STREAM_PROTECTED] = "Protected IPA stream",
+		[REALM_PMU_BENCH_STREAM_UNPROTECTED] = "Unprotected IPA stream",
+		[REALM_PMU_BENCH_SVE] = "SVE array subtract",
+	};
+	char counts[REALM_PMU_BENCH_TICKS][16];
+
+	host_shared_data_set_host_val(&realm, 0U, HOST_ARG1_INDEX, kernel);
+	host_shared_data_set_host_val(&realm, 0U, HOST_ARG2_INDEX,
+				      PMU_BENCH_ITERATIONS);
+	host_shared_data_set_host_val(&realm, 0U, HOST_ARG3_INDEX, size);
+
+	if (!host_enter_realm_execute(&realm, REALM_PMU_BENCH,
+				      RMI_EXIT_HOST_CALL, 0U)) {
+		ERROR("%s kernel failed\n", kernel_names[kernel]);
+		return false;
+	}
+
+	for (unsigned int i = 0U; i < REALM_PMU_BENCH_TICKS; i++) {
+		host_pmu_bench_format(counts[i], sizeof(counts[i]),
+				      host_shared_data_get_realm_val(&realm,
+								     0U, i));
+	}
+
+	printf("%-22s: %10s cycles %10s insts %8s L1D refills "
+	       "%8s TLB refills %8lluns\n", kernel_names[kernel],
+	       counts[REALM_PMU_BENCH_CYCLES], counts[REALM_PMU_BENCH_INSTS],
+	       counts[REALM_PMU_BENCH_L1D_REFILLS],
+	       counts[REALM_PMU_BENCH_TLB_REFILLS],
+	       (unsigned long long)bench_ticks_to_ns(
+		       host_shared_data_get_realm_val(&realm, 0U,
+						      REALM_PMU_BENCH_TICKS) /
+		       PMU_BENCH_ITERATIONS));
+
+	return true;
+}
+
+static test_result_t do_host_realm_pmu_bench_perf(void)
+{
+	u_register_t feature_flag, feat_reg0;
+	bool sve, ret1, ret2;
+
+	if (host_rmi_features(0UL, &feat_reg0) != REALM_SUCCESS) {
+		ERROR("Failed to get RMI feat_reg0\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	if ((feat_reg0 & RMI_FEATURE_REGISTER_0_PMU_EN) == 0UL) {
+		tftf_testcase_printf("RMM does not support PMU\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	host_set_pmu_state();
+
+	feature_flag = RMI_FEATURE_REGISTER_0_PMU_EN |
+		INPLACE(FEATURE_PMU_NUM_CTRS, (unsigned long long)(-1));
+
+	sve = is_armv8_2_sve_present() &&
+	      (feat_reg0 & RMI_FEATURE_REGISTER_0_SVE_EN) != 0UL;
+	if (sve) {
+		feature_flag |= RMI_FEATURE_REGISTER_0_SVE_EN |
+			INPLACE(FEATURE_SVE_VL,
+				EXTRACT(RMI_FEATURE_REGISTER_0_SVE_VL,
+					feat_reg0));
+	}
+
+	if (!host_rec_exit_bench_create(feature_flag)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	ret1 = host_pmu_bench_run(REALM_PMU_BENCH_RSI_VERSION, 0UL) &&
+	       host_pmu_bench_run(REALM_PMU_BENCH_STREAM_PROTECTED,
+				  REALM_PMU_BENCH_STREAM_MAX) &&
+	       host_pmu_bench_run(REALM_PMU_BENCH_STREAM_UNPROTECTED,
+				  REALM_PMU_BENCH_STREAM_MAX) &&
+	       (!sve || host_pmu_bench_run(REALM_PMU_BENCH_SVE, 0UL));
+
+	ret2 = host_destroy_realm(&realm);
+
+	if (!ret1 || !ret2) {
+		ERROR("%s(): enter=%d destroy=%d\n", __func__, ret1, ret2);
+		return TEST_RESULT_FAIL;
+	}
+
+	if (!host_check_pmu_state()) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return host_cmp_result();
+}
+
+/*
+ * @Test_Aim@ Count the cycles, instructions, L1D cache refills and L1D TLB
+ * refills per iteration of code patterns run in realm EL1: RSI calls, reads
+ * streamed from protected and from unprotected IPAs, and SVE operations,
+ * which are skipped if the PE or the RMM does not support SVE.
+ * The realm runs with the MMU and the data cache off, so the streams time
+ * non-cacheable reads, and their L1D cache refills are not reported.
+ */
+test_result_t host_realm_pmu_bench_perf(void)
+{
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	return host_realm_perf_run(do_host_realm_pmu_bench_perf);
+}
@@ -24,6 +24,8 @@
 
 extern const char *rmi_exit[];
 
+static struct realm realm;
+
 /*
  * @Test_Aim@ Test realm payload creation and execution
  */
@@ -34,7 +36,7 @@ test_result_t host_test_realm_create_enter(void)
 
 	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
 
-	if (!host_create_realm_payload((u_register_t)REALM_IMAGE_BASE,
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
 			(u_register_t)PAGE_POOL_BASE,
 			(u_register_t)(PAGE_POOL_MAX_SIZE +
 			NS_REALM_SHARED_MEM_SIZE),
@@ -42,14 +44,15 @@ test_result_t host_test_realm_create_enter(void)
 			0UL, rec_flag, 1U)) {
 		return TEST_RESULT_FAIL;
 	}
-	if (!host_create_shared_mem(NS_REALM_SHARED_MEM_BASE,
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
 			NS_REALM_SHARED_MEM_SIZE)) {
 		return TEST_RESULT_FAIL;
 	}
 
-	host_shared_data_set_host_val(0U, HOST_ARG1_INDEX, SLEEP_TIME_MS);
-	ret1 = host_enter_realm_execute(REALM_SLEEP_CMD, NULL, RMI_EXIT_HOST_CALL, 0U);
-	ret2 = host_destroy_realm();
+	host_shared_data_set_host_val(&realm, 0U, HOST_ARG1_INDEX,
+				      SLEEP_TIME_MS);
+	ret1 = host_enter_realm_execute(&realm, REALM_SLEEP_CMD, RMI_EXIT_HOST_CALL, 0U);
+	ret2 = host_destroy_realm(&realm);
 
 	if (!ret1 || !ret2) {
 		ERROR("%s(): enter=%d destroy=%d\n",
@@ -70,7 +73,7 @@ test_result_t host_test_realm_rsi_version(void)
 
 	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
 
-	if (!host_create_realm_payload((u_register_t)REALM_IMAGE_BASE,
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
 			(u_register_t)PAGE_POOL_BASE,
 			(u_register_t)(PAGE_POOL_MAX_SIZE +
 			NS_REALM_SHARED_MEM_SIZE),
@@ -78,13 +81,13 @@ test_result_t host_test_realm_rsi_version(void)
 			0UL, rec_flag, 1U)) {
 		return TEST_RESULT_FAIL;
 	}
-	if (!host_create_shared_mem(NS_REALM_SHARED_MEM_BASE,
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
 			NS_REALM_SHARED_MEM_SIZE)) {
 		return TEST_RESULT_FAIL;
 	}
 
-	ret1 = host_enter_realm_execute(REALM_GET_RSI_VERSION, NULL, RMI_EXIT_HOST_CALL, 0U);
-	ret2 = host_destroy_realm();
+	ret1 = host_enter_realm_execute(&realm, REALM_GET_RSI_VERSION, RMI_EXIT_HOST_CALL, 0U);
+	ret2 = host_destroy_realm(&realm);
 
 	if (!ret1 || !ret2) {
 		ERROR("%s(): enter=%d destroy=%d\n",
@@ -95,6 +98,124 @@ test_result_t host_test_realm_rsi_version(void)
 	return host_cmp_result();
 }
 
+/*
+ * Queue REALM_CMD_RING_SIZE commands on the command ring of REC 0: FPU fills
+ * and compares in turn, with a nested REALM_CMD_RING last, which the realm
+ * rejects. Returns false if the ring did not take them all, or took more.
+ */
+static bool host_cmd_ring_fill(void)
+{
+	u_register_t args[MAX_DATA_SIZE] = {0UL};
+	uint8_t cmd;
+
+	for (unsigned int i = 0U; i < REALM_CMD_RING_SIZE; i++) {
+		if (i == (REALM_CMD_RING_SIZE - 1U)) {
+			cmd = REALM_CMD_RING;
+		} else if ((i % 2U) == 0U) {
+			cmd = REALM_REQ_FPU_FILL_CMD;
+		} else {
+			cmd = REALM_REQ_FPU_CMP_CMD;
+		}
+
+		args[HOST_ARG1_INDEX] = i;
+		if (!host_cmd_ring_push(&realm, 0U, cmd, args)) {
+			ERROR("Command ring full after %u commands\n", i);
+			return false;
+		}
+	}
+
+	return !host_cmd_ring_push(&realm, 0U, REALM_REQ_FPU_FILL_CMD, NULL);
+}
+
+/*
+ * Check the completions of the commands queued by host_cmd_ring_fill(), and
+ * that there are no others.
+ */
+static bool host_compl_ring_check(void)
+{
+	struct realm_cmd_compl compl;
+	u_register_t result;
+	unsigned int i;
+
+	for (i = 0U; host_compl_ring_pop(&realm, 0U, &compl); i++) {
+		result = (i == (REALM_CMD_RING_SIZE - 1U)) ? 0UL : 1UL;
+		if (compl.result != result) {
+			ERROR("Command %u (%lu) returned %lu\n", i, compl.cmd,
+			      compl.result);
+			return false;
+		}
+	}
+
+	if (i != REALM_CMD_RING_SIZE) {
+		ERROR("%u completions, expected %u\n", i, REALM_CMD_RING_SIZE);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * @Test_Aim@ Queue a batch of commands on the command ring of a REC, and
+ * check that the realm runs all of them in order in a single REC entry, and
+ * posts their results on the completion ring. Then check that the realm
+ * leaves the commands it has no room to complete on the ring, until the host
+ * takes the completions of the previous batch.
+ */
+test_result_t host_realm_cmd_ring(void)
+{
+	u_register_t rec_flag[] = {RMI_RUNNABLE};
+	bool ret1, ret2;
+
+	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
+
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
+			(u_register_t)PAGE_POOL_BASE,
+			(u_register_t)(PAGE_POOL_MAX_SIZE +
+			NS_REALM_SHARED_MEM_SIZE),
+			(u_register_t)PAGE_POOL_MAX_SIZE,
+			0UL, rec_flag, 1U)) {
+		return TEST_RESULT_FAIL;
+	}
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
+			NS_REALM_SHARED_MEM_SIZE)) {
+		(void)host_destroy_realm(&realm);
+		return TEST_RESULT_FAIL;
+	}
+
+	ret1 = host_cmd_ring_fill() &&
+	       host_enter_realm_execute(&realm, REALM_CMD_RING,
+					RMI_EXIT_HOST_CALL, 0U) &&
+	       host_compl_ring_check();
+
+	/*
+	 * The realm leaves the second batch on the command ring until the host
+	 * takes the completions of the first one.
+	 */
+	if (ret1) {
+		ret1 = host_cmd_ring_fill() &&
+		       host_enter_realm_execute(&realm, REALM_CMD_RING,
+						RMI_EXIT_HOST_CALL, 0U) &&
+		       host_cmd_ring_fill() &&
+		       host_enter_realm_execute(&realm, REALM_CMD_RING,
+						RMI_EXIT_HOST_CALL, 0U) &&
+		       !host_cmd_ring_push(&realm, 0U, REALM_REQ_FPU_FILL_CMD,
+					   NULL) &&
+		       host_compl_ring_check() &&
+		       host_enter_realm_execute(&realm, REALM_CMD_RING,
+						RMI_EXIT_HOST_CALL, 0U) &&
+		       host_compl_ring_check();
+	}
+
+	ret2 = host_destroy_realm(&realm);
+
+	if (!ret1 || !ret2) {
+		ERROR("%s(): ring=%d destroy=%d\n", __func__, ret1, ret2);
+		return TEST_RESULT_FAIL;
+	}
+
+	return host_cmp_result();
+}
+
 /*
  * @Test_Aim@ Test PAuth in realm
  */
@@ -109,7 +230,7 @@ test_result_t host_realm_enable_pauth(void)
 	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
 
 	pauth_test_lib_fill_regs_and_template();
-	if (!host_create_realm_payload((u_register_t)REALM_IMAGE_BASE,
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
 				(u_register_t)PAGE_POOL_BASE,
 				(u_register_t)(PAGE_POOL_MAX_SIZE +
 					NS_REALM_SHARED_MEM_SIZE),
@@ -118,20 +239,20 @@ test_result_t host_realm_enable_pauth(void)
 		return TEST_RESULT_FAIL;
 	}
 
-	if (!host_create_shared_mem(NS_REALM_SHARED_MEM_BASE,
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
 				NS_REALM_SHARED_MEM_SIZE)) {
 		return TEST_RESULT_FAIL;
 	}
 
-	ret1 = host_enter_realm_execute(REALM_PAUTH_SET_CMD, NULL, RMI_EXIT_HOST_CALL, 0U);
+	ret1 = host_enter_realm_execute(&realm, REALM_PAUTH_SET_CMD, RMI_EXIT_HOST_CALL, 0U);
 
 	if (ret1) {
 		/* Re-enter Realm to compare PAuth registers. */
-		ret1 = host_enter_realm_execute(REALM_PAUTH_CHECK_CMD, NULL,
+		ret1 = host_enter_realm_execute(&realm, REALM_PAUTH_CHECK_CMD,
 				RMI_EXIT_HOST_CALL, 0U);
 	}
 
-	ret2 = host_destroy_realm();
+	ret2 = host_destroy_realm(&realm);
 
 	if (!ret1) {
 		ERROR("%s(): enter=%d destroy=%d\n",
@@ -162,7 +283,7 @@ test_result_t host_realm_pauth_fault(void)
 	u_register_t rec_flag[1] = {RMI_RUNNABLE};
 
 	SKIP_TEST_IF_RME_NOT_SUPPORTED_OR_RMM_IS_TRP();
-	if (!host_create_realm_payload((u_register_t)REALM_IMAGE_BASE,
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
 				(u_register_t)PAGE_POOL_BASE,
 				(u_register_t)(PAGE_POOL_MAX_SIZE +
 					NS_REALM_SHARED_MEM_SIZE),
@@ -170,13 +291,13 @@ test_result_t host_realm_pauth_fault(void)
 				0UL, rec_flag, 1U)) {
 		return TEST_RESULT_FAIL;
 	}
-	if (!host_create_shared_mem(NS_REALM_SHARED_MEM_BASE,
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
 				NS_REALM_SHARED_MEM_SIZE)) {
 		return TEST_RESULT_FAIL;
 	}
 
-	ret1 = host_enter_realm_execute(REALM_PAUTH_FAULT, NULL, RMI_EXIT_HOST_CALL, 0U);
-	ret2 = host_destroy_realm();
+	ret1 = host_enter_realm_execute(&realm, REALM_PAUTH_FAULT, RMI_EXIT_HOST_CALL, 0U);
+	ret2 = host_destroy_realm(&realm);
 
 	if (!ret1) {
 		ERROR("%s(): enter=%d destroy=%d\n",
@@ -248,7 +369,6 @@ static bool host_realm_handle_irq_exit(struct realm *realm_ptr,
  */
 static test_result_t host_test_realm_pmuv3(uint8_t cmd)
 {
-	struct realm *realm_ptr;
 	u_register_t feature_flag;
 	u_register_t rec_flag[1] = {RMI_RUNNABLE};
 	bool ret1, ret2;
@@ -260,7 +380,7 @@ static test_result_t host_test_realm_pmuv3(uint8_t cmd)
 	feature_flag = RMI_FEATURE_REGISTER_0_PMU_EN |
 			INPLACE(FEATURE_PMU_NUM_CTRS, (unsigned long long)(-1));
 
-	if (!host_create_realm_payload((u_register_t)REALM_IMAGE_BASE,
+	if (!host_create_realm_payload(&realm, (u_register_t)REALM_IMAGE_BASE,
 			(u_register_t)PAGE_POOL_BASE,
 			(u_register_t)(PAGE_POOL_MAX_SIZE +
 			NS_REALM_SHARED_MEM_SIZE),
@@ -268,20 +388,20 @@ static test_result_t host_test_realm_pmuv3(uint8_t cmd)
 			feature_flag, rec_flag, 1U)) {
 		return TEST_RESULT_FAIL;
 	}
-	if (!host_create_shared_mem(NS_REALM_SHARED_MEM_BASE,
+	if (!host_create_shared_mem(&realm, NS_REALM_SHARED_MEM_BASE,
 			NS_REALM_SHARED_MEM_SIZE)) {
 		return TEST_RESULT_FAIL;
 	}
 
-	ret1 = host_enter_realm_execute(cmd, &realm_ptr, RMI_EXIT_IRQ, 0U);
+	ret1 = host_enter_realm_execute(&realm, cmd, RMI_EXIT_IRQ, 0U);
 	if (!ret1 || (cmd != REALM_PMU_INTERRUPT)) {
 		goto test_exit;
 	}
 
-	ret1 = host_realm_handle_irq_exit(realm_ptr, 0U);
+	ret1 = host_realm_handle_irq_exit(&realm, 0U);
 
 test_exit:
-	ret2 = host_destroy_realm();
+	ret2 = host_destroy_realm(&realm);
 	if (!ret1 || !ret2) {
 		ERROR("%s() enter=%u destroy=%u\n", __func__, ret1, ret2);
 		return TEST_RESULT_FAIL;
@@ -142,6 +142,26 @@ struct ffa_value ffa_msg_send_direct_resp32(ffa_id_t source_id,
 	return ffa_service_call(&args);
 }
 
+/*
+ * Send the indirect message written in the TX buffer, after its partition
+ * message header, to the receiver named in the header.
+ */
+struct ffa_value ffa_msg_send2(uint32_t flags)
+{
+	struct ffa_value args = {
+		.fid = FFA_MSG_SEND2,
+		.arg1 = FFA_PARAM_MBZ,
+		.arg2 = flags,
+		.arg3 = FFA_PARAM_MBZ,
+		.arg4 = FFA_PARAM_MBZ,
+		.arg5 = FFA_PARAM_MBZ,
+		.arg6 = FFA_PARAM_MBZ,
+		.arg7 = FFA_PARAM_MBZ
+	};
+
+	return ffa_service_call(&args);
+}
+
 
 /**
  * Initialises the header of the given `ffa_memory_region`, not including the
@@ -265,6 +285,41 @@ uint32_t ffa_memory_region_init(
 	return composite_memory_region->constituent_count - count_to_copy;
 }
 
+/**
+ * Copies as many as possible of the given constituents to the given
+ * fragment, used for the fragments following the first one of a memory
+ * transaction descriptor initialised with `ffa_memory_region_init`.
+ *
+ * Returns the number of constituents remaining which wouldn't fit, and (via
+ * return parameter) the size in bytes of the fragment.
+ */
+uint32_t ffa_memory_fragment_init(
+	struct ffa_memory_region_constituent *fragment,
+	size_t fragment_max_size,
+	const struct ffa_memory_region_constituent constituents[],
+	uint32_t constituent_count, uint32_t *fragment_length)
+{
+	uint32_t fragment_max_constituents =
+		fragment_max_size / sizeof(struct ffa_memory_region_constituent);
+	uint32_t count_to_copy = constituent_count;
+	uint32_t i;
+
+	if (count_to_copy > fragment_max_constituents) {
+		count_to_copy = fragment_max_constituents;
+	}
+
+	for (i = 0; i < count_to_copy; ++i) {
+		fragment[i] = constituents[i];
+	}
+
+	if (fragment_length != NULL) {
+		*fragment_length = count_to_copy *
+				   sizeof(struct ffa_memory_region_constituent);
+	}
+
+	return constituent_count - count_to_copy;
+}
+
 /**
  * Initialises the given `ffa_memory_region` to be used for an
  * `FFA_MEM_RETRIEVE_REQ` by the receiver of a memory transaction.
@@ -545,6 +600,42 @@ struct ffa_value ffa_mem_reclaim(uint64_t handle, uint32_t flags)
 	return ffa_service_call(&args);
 }
 
+/*
+ * Request the next fragment of a memory transaction descriptor, starting at
+ * 'fragment_offset' bytes from its beginning.
+ */
+struct ffa_value ffa_mem_frag_rx(ffa_memory_handle_t handle,
+				 uint32_t fragment_offset)
+{
+	struct ffa_value args = {
+		.fid = FFA_MEM_FRAG_RX,
+		.arg1 = (uint32_t) handle,
+		.arg2 = (uint32_t) (handle >> 32),
+		.arg3 = fragment_offset,
+		.arg4 = FFA_PARAM_MBZ
+	};
+
+	return ffa_service_call(&args);
+}
+
+/*
+ * Transmit the next fragment of a memory transaction descriptor, written
+ * in the TX buffer.
+ */
+struct ffa_value ffa_mem_frag_tx(ffa_memory_handle_t handle,
+				 uint32_t fragment_length)
+{
+	struct ffa_value args = {
+		.fid = FFA_MEM_FRAG_TX,
+		.arg1 = (uint32_t) handle,
+		.arg2 = (uint32_t) (handle >> 32),
+		.arg3 = fragment_length,
+		.arg4 = FFA_PARAM_MBZ
+	};
+
+	return ffa_service_call(&args);
+}
+
 /** Create Notifications Bitmap for the given VM */
 struct ffa_value ffa_notification_bitmap_create(ffa_id_t vm_id,
 						ffa_vcpu_count_t vcpu_count)
@@ -6,6 +6,7 @@
 
 #include "ffa_helpers.h"
 #include <cactus_test_cmds.h>
+#include <cassert.h>
 #include <debug.h>
 #include <ffa_endpoints.h>
 #include <ffa_svc.h>
@@ -206,26 +207,25 @@ unsigned int get_ffa_feature_test_target(
 	       sizeof(struct ffa_features_test);
 }
 
-bool memory_retrieve(struct mailbox_buffers *mb,
-		     struct ffa_memory_region **retrieved, uint64_t handle,
-		     ffa_id_t sender, ffa_id_t receiver,
-		     ffa_memory_region_flags_t flags,
-		     uint32_t mem_func)
+/*
+ * Sends the retrieve request of a memory transaction. On success, the first
+ * fragment of the descriptor is in the RX buffer and its size, as well as the
+ * total size of the descriptor, are returned via the return parameters.
+ */
+static bool memory_retrieve_request(struct mailbox_buffers *mb,
+				    uint64_t handle, ffa_id_t sender,
+				    ffa_id_t receiver,
+				    ffa_memory_region_flags_t flags,
+				    uint32_t mem_func, uint32_t *total_size,
+				    uint32_t *fragment_size)
 {
 	struct ffa_value ret;
-	uint32_t fragment_size;
-	uint32_t total_size;
 	uint32_t descriptor_size;
 	const enum ffa_instruction_access inst_access =
 				(mem_func == FFA_MEM_SHARE_SMC32)
 					? FFA_INSTRUCTION_ACCESS_NOT_SPECIFIED
 					: FFA_INSTRUCTION_ACCESS_NX;
 
-	if (retrieved == NULL || mb == NULL) {
-		ERROR("Invalid parameters!\n");
-		return false;
-	}
-
 	descriptor_size = ffa_memory_retrieve_request_init(
 	    mb->send, handle, sender, receiver, 0, flags,
 	    FFA_DATA_ACCESS_RW,
@@ -247,20 +247,45 @@ bool memory_retrieve(struct mailbox_buffers *mb,
 	 * of the state of transaction. When the sum of all fragment_size of all
 	 * fragments is equal to total_size, the memory transaction has been
 	 * completed.
-	 * This is a simple test with only one segment. As such, upon
-	 * successful ffa_mem_retrieve_req, total_size must be equal to
-	 * fragment_size.
 	 */
-	total_size = ret.arg1;
-	fragment_size = ret.arg2;
+	*total_size = ret.arg1;
+	*fragment_size = ret.arg2;
 
-	if (total_size != fragment_size) {
-		ERROR("Only expect one memory segment to be sent!\n");
+	if (*fragment_size > PAGE_SIZE) {
+		ERROR("Fragment should be smaller than RX buffer!\n");
 		return false;
 	}
 
-	if (fragment_size > PAGE_SIZE) {
-		ERROR("Fragment should be smaller than RX buffer!\n");
+	return true;
+}
+
+bool memory_retrieve(struct mailbox_buffers *mb,
+		     struct ffa_memory_region **retrieved, uint64_t handle,
+		     ffa_id_t sender, ffa_id_t receiver,
+		     ffa_memory_region_flags_t flags,
+		     uint32_t mem_func)
+{
+	uint32_t fragment_size;
+	uint32_t total_size;
+
+	if (retrieved == NULL || mb == NULL) {
+		ERROR("Invalid parameters!\n");
+		return false;
+	}
+
+	if (!memory_retrieve_request(mb, handle, sender, receiver, flags,
+				     mem_func, &total_size, &fragment_size)) {
+		return false;
+	}
+
+	/*
+	 * This helper leaves the descriptor in the RX buffer, so it can only
+	 * deal with one fragment. As such, upon successful
+	 * ffa_mem_retrieve_req, total_size must be equal to fragment_size.
+	 * Use memory_retrieve_frag for larger descriptors.
+	 */
+	if (total_size != fragment_size) {
+		ERROR("Only expect one memory segment to be sent!\n");
 		return false;
 	}
 
@@ -277,6 +302,84 @@ bool memory_retrieve(struct mailbox_buffers *mb,
 	return true;
 }
 
+bool memory_retrieve_frag(struct mailbox_buffers *mb,
+			  struct ffa_memory_region **retrieved,
+			  void *buf, size_t buf_size, uint64_t handle,
+			  ffa_id_t sender, ffa_id_t receiver,
+			  ffa_memory_region_flags_t flags,
+			  uint32_t mem_func)
+{
+	struct ffa_value ret;
+	uint32_t fragment_size;
+	uint32_t total_size;
+	uint32_t offset = 0U;
+
+	if (retrieved == NULL || mb == NULL || buf == NULL) {
+		ERROR("Invalid parameters!\n");
+		return false;
+	}
+
+	if (!memory_retrieve_request(mb, handle, sender, receiver, flags,
+				     mem_func, &total_size, &fragment_size)) {
+		return false;
+	}
+
+	if (total_size > buf_size) {
+		ERROR("Descriptor of %u bytes doesn't fit the buffer!\n",
+		      total_size);
+		ffa_rx_release();
+		return false;
+	}
+
+	/*
+	 * Copy each fragment out of the RX buffer, and release it so that the
+	 * SPMC can write the next one, until the whole descriptor is
+	 * reassembled in 'buf'.
+	 */
+	while (true) {
+		if (fragment_size > PAGE_SIZE ||
+		    fragment_size > total_size - offset) {
+			ERROR("Invalid fragment size %u at offset %u!\n",
+			      fragment_size, offset);
+			ffa_rx_release();
+			return false;
+		}
+
+		memcpy((uint8_t *)buf + offset, mb->recv, fragment_size);
+		offset += fragment_size;
+
+		if (ffa_func_id(ffa_rx_release()) != FFA_SUCCESS_SMC32) {
+			ERROR("Failed to release buffer!\n");
+			return false;
+		}
+
+		if (offset == total_size) {
+			break;
+		}
+
+		ret = ffa_mem_frag_rx(handle, offset);
+		if (ffa_func_id(ret) != FFA_MEM_FRAG_TX) {
+			ERROR("Couldn't retrieve fragment at offset %u. "
+			      "Error: %x\n", offset, ffa_error_code(ret));
+			return false;
+		}
+
+		fragment_size = ret.arg3;
+	}
+
+	*retrieved = (struct ffa_memory_region *)buf;
+
+	if ((*retrieved)->receiver_count > MAX_MEM_SHARE_RECIPIENTS) {
+		VERBOSE("SPMC memory sharing operations support max of %u "
+			"receivers!\n", MAX_MEM_SHARE_RECIPIENTS);
+		return false;
+	}
+
+	VERBOSE("Memory Retrieved in %u bytes!\n", total_size);
+
+	return true;
+}
+
 bool memory_relinquish(struct ffa_mem_relinquish *m, uint64_t handle,
 		       ffa_id_t id)
 {
@@ -300,15 +403,16 @@ bool memory_relinquish(struct ffa_mem_relinquish *m, uint64_t handle,
  * FFA_MEMORY_HANDLE_INVALID if something goes wrong. Populates *ret with a
  * resulting smc value to handle the error higher in the test chain.
  *
- * TODO: Do memory send with 'ffa_memory_region' taking multiple segments
+ * If fragment_length is smaller than total_length, the SPMC replies with
+ * FFA_MEM_FRAG_RX and the returned handle refers to a transaction still in
+ * progress, to be completed with memory_send_fragments.
  */
 ffa_memory_handle_t memory_send(
 	struct ffa_memory_region *memory_region, uint32_t mem_func,
 	uint32_t fragment_length, uint32_t total_length, struct ffa_value *ret)
 {
-	if (fragment_length != total_length) {
-		ERROR("For now, fragment_length and total_length need to be"
-		      " equal");
+	if (fragment_length > total_length) {
+		ERROR("Fragment bigger than the memory transaction!\n");
 		return FFA_MEMORY_HANDLE_INVALID;
 	}
 
@@ -336,6 +440,72 @@ ffa_memory_handle_t memory_send(
 		return FFA_MEMORY_HANDLE_INVALID;
 	}
 
+	if (fragment_length != total_length) {
+		if (ffa_func_id(*ret) != FFA_MEM_FRAG_RX ||
+		    ret->arg3 != fragment_length) {
+			ERROR("Expected FFA_MEM_FRAG_RX at offset %u, got %x\n",
+			      fragment_length, ffa_func_id(*ret));
+			return FFA_MEMORY_HANDLE_INVALID;
+		}
+
+		return ffa_frag_handle(*ret);
+	}
+
+	return ffa_mem_success_handle(*ret);
+}
+
+/**
+ * Helper to complete a memory transaction whose first fragment was sent with
+ * memory_send. The remaining constituents are streamed through the TX buffer
+ * 'send', filling it one fragment at a time, as the SPMC asks for them.
+ * 'offset' is the size of the descriptor sent so far.
+ * Returns the handle of the memory region, or FFA_MEMORY_HANDLE_INVALID.
+ */
+ffa_memory_handle_t memory_send_fragments(
+	void *send, size_t send_size, ffa_memory_handle_t handle,
+	uint32_t offset,
+	const struct ffa_memory_region_constituent *constituents,
+	uint32_t constituents_count, struct ffa_value *ret)
+{
+	uint32_t remaining_constituent_count;
+	uint32_t fragment_length;
+
+	while (constituents_count != 0U) {
+		remaining_constituent_count = ffa_memory_fragment_init(
+			send, send_size, constituents, constituents_count,
+			&fragment_length);
+
+		*ret = ffa_mem_frag_tx(handle, fragment_length);
+
+		if (is_ffa_call_error(*ret)) {
+			VERBOSE("Failed to send fragment at offset %u\n",
+				offset);
+			return FFA_MEMORY_HANDLE_INVALID;
+		}
+
+		constituents += constituents_count -
+				remaining_constituent_count;
+		constituents_count = remaining_constituent_count;
+		offset += fragment_length;
+
+		if (constituents_count == 0U) {
+			break;
+		}
+
+		if (ffa_func_id(*ret) != FFA_MEM_FRAG_RX ||
+		    ffa_frag_handle(*ret) != handle || ret->arg3 != offset) {
+			ERROR("Expected FFA_MEM_FRAG_RX at offset %u, got %x\n",
+			      offset, ffa_func_id(*ret));
+			return FFA_MEMORY_HANDLE_INVALID;
+		}
+	}
+
+	if (ffa_func_id(*ret) != FFA_SUCCESS_SMC32) {
+		ERROR("Memory transaction not completed, got %x\n",
+		      ffa_func_id(*ret));
+		return FFA_MEMORY_HANDLE_INVALID;
+	}
+
 	return ffa_mem_success_handle(*ret);
 }
 
@@ -343,6 +513,8 @@ ffa_memory_handle_t memory_send(
  * Helper that initializes and sends a memory region. The memory region's
  * configuration is statically defined and is implementation specific. However,
  * doing it in this file for simplicity and for testing purposes.
+ * Constituents which don't fit in 'memory_region' are sent in the following
+ * fragments.
  */
 ffa_memory_handle_t memory_init_and_send(
 	struct ffa_memory_region *memory_region, size_t memory_region_max_size,
@@ -353,6 +525,7 @@ ffa_memory_handle_t memory_init_and_send(
 	uint32_t remaining_constituent_count;
 	uint32_t total_length;
 	uint32_t fragment_length;
+	ffa_memory_handle_t handle;
 
 	enum ffa_data_access data_access = (mem_func == FFA_MEM_DONATE_SMC32) ?
 						FFA_DATA_ACCESS_NOT_SPECIFIED :
@@ -374,17 +547,18 @@ ffa_memory_handle_t memory_init_and_send(
 		FFA_MEMORY_CACHE_WRITE_BACK, FFA_MEMORY_INNER_SHAREABLE,
 		&total_length, &fragment_length);
 
-	/*
-	 * For simplicity of the test, and at least for the time being,
-	 * the following condition needs to be true.
-	 */
-	if (remaining_constituent_count != 0U) {
-		ERROR("Remaining constituent should be 0\n");
-		return FFA_MEMORY_HANDLE_INVALID;
+	handle = memory_send(memory_region, mem_func, fragment_length,
+			     total_length, ret);
+
+	if (handle == FFA_MEMORY_HANDLE_INVALID ||
+	    remaining_constituent_count == 0U) {
+		return handle;
 	}
 
-	return memory_send(memory_region, mem_func, fragment_length,
-			       total_length, ret);
+	return memory_send_fragments(
+		memory_region, memory_region_max_size, handle, fragment_length,
+		&constituents[constituents_count - remaining_constituent_count],
+		remaining_constituent_count, ret);
 }
 
 static bool ffa_uuid_equal(const struct ffa_uuid uuid1,
@@ -580,6 +754,153 @@ bool ffa_partition_info_helper(struct mailbox_buffers *mb,
 	return result;
 }
 
+/*
+ * Cache of the information of all partitions. It lives in .bss, such that it
+ * is invalidated whenever the image is reloaded or cold boots.
+ *
+ * Partitions are found by ID and by UUID through two hash tables with linear
+ * probing. Each slot holds the index of the partition in 'info' plus one, 0
+ * meaning the slot is free.
+ */
+#define PARTITION_INFO_CACHE_SLOTS	(2U * FFA_PARTITION_INFO_CACHE_MAX)
+
+static struct {
+	bool valid;
+	uint32_t count;
+	struct ffa_partition_info info[FFA_PARTITION_INFO_CACHE_MAX];
+	uint8_t id_slots[PARTITION_INFO_CACHE_SLOTS];
+	uint8_t uuid_slots[PARTITION_INFO_CACHE_SLOTS];
+} partition_info_cache;
+
+CASSERT(IS_POWER_OF_TWO(PARTITION_INFO_CACHE_SLOTS),
+	assert_partition_info_cache_slots_power_of_two);
+
+static uint32_t partition_info_cache_id_hash(ffa_id_t id)
+{
+	/* Partition IDs are usually allocated sequentially. */
+	return id & (PARTITION_INFO_CACHE_SLOTS - 1U);
+}
+
+static uint32_t partition_info_cache_uuid_hash(const struct ffa_uuid uuid)
+{
+	uint32_t hash = uuid.uuid[0] ^ uuid.uuid[1] ^ uuid.uuid[2] ^
+			uuid.uuid[3];
+
+	hash ^= hash >> 16;
+	hash ^= hash >> 8;
+
+	return hash & (PARTITION_INFO_CACHE_SLOTS - 1U);
+}
+
+static void partition_info_cache_insert(uint8_t *slots, uint32_t hash,
+					uint32_t index)
+{
+	while (slots[hash] != 0U) {
+		hash = (hash + 1U) & (PARTITION_INFO_CACHE_SLOTS - 1U);
+	}
+
+	slots[hash] = (uint8_t)(index + 1U);
+}
+
+bool ffa_partition_info_cache_init(struct mailbox_buffers *mb)
+{
+	struct ffa_value ret;
+	uint32_t count;
+
+	if (partition_info_cache.valid) {
+		return true;
+	}
+
+	ret = ffa_partition_info_get(NULL_UUID);
+	if (ffa_func_id(ret) != FFA_SUCCESS_SMC32) {
+		return false;
+	}
+
+	count = ffa_partition_info_count(ret);
+
+	/*
+	 * Descriptors of FF-A v1.0 don't have a UUID, so the cache is only used
+	 * from v1.1.
+	 */
+	if (count <= FFA_PARTITION_INFO_CACHE_MAX &&
+	    ffa_partition_info_desc_size(ret) ==
+	    sizeof(struct ffa_partition_info)) {
+		memcpy(partition_info_cache.info, mb->recv,
+		       count * sizeof(struct ffa_partition_info));
+		partition_info_cache.count = count;
+	} else {
+		VERBOSE("Partition info of %u partitions not cached\n", count);
+		count = 0U;
+	}
+
+	if (is_ffa_call_error(ffa_rx_release())) {
+		ERROR("Failed to release RX buffer\n");
+		return false;
+	}
+
+	if (count == 0U) {
+		return false;
+	}
+
+	for (uint32_t i = 0U; i < count; i++) {
+		partition_info_cache_insert(
+			partition_info_cache.id_slots,
+			partition_info_cache_id_hash(
+				partition_info_cache.info[i].id), i);
+		partition_info_cache_insert(
+			partition_info_cache.uuid_slots,
+			partition_info_cache_uuid_hash(
+				partition_info_cache.info[i].uuid), i);
+	}
+
+	partition_info_cache.valid = true;
+
+	return true;
+}
+
+uint32_t ffa_partition_info_cache_count(void)
+{
+	return partition_info_cache.count;
+}
+
+const struct ffa_partition_info *ffa_partition_info_cache_find_id(
+	ffa_id_t id)
+{
+	uint32_t hash = partition_info_cache_id_hash(id);
+	const struct ffa_partition_info *info;
+
+	while (partition_info_cache.id_slots[hash] != 0U) {
+		info = &partition_info_cache.info[
+			partition_info_cache.id_slots[hash] - 1U];
+		if (info->id == id) {
+			return info;
+		}
+
+		hash = (hash + 1U) & (PARTITION_INFO_CACHE_SLOTS - 1U);
+	}
+
+	return NULL;
+}
+
+const struct ffa_partition_info *ffa_partition_info_cache_find_uuid(
+	const struct ffa_uuid uuid)
+{
+	uint32_t hash = partition_info_cache_uuid_hash(uuid);
+	const struct ffa_partition_info *info;
+
+	while (partition_info_cache.uuid_slots[hash] != 0U) {
+		info = &partition_info_cache.info[
+			partition_info_cache.uuid_slots[hash] - 1U];
+		if (ffa_uuid_equal(info->uuid, uuid)) {
+			return info;
+		}
+
+		hash = (hash + 1U) & (PARTITION_INFO_CACHE_SLOTS - 1U);
+	}
+
+	return NULL;
+}
+
 static bool configure_trusted_wdog_interrupt(ffa_id_t source, ffa_id_t dest,
 				bool enable)
 {
@@ -610,3 +931,91 @@ bool disable_trusted_wdog_interrupt(ffa_id_t source, ffa_id_t dest)
 {
 	return configure_trusted_wdog_interrupt(source, dest, false);
 }
+
+void ffa_msg_batch_init(struct ffa_msg_batch *batch, void *send,
+			size_t send_size, ffa_id_t sender, ffa_id_t receiver)
+{
+	batch->header = (struct ffa_partition_rxtx_header *)send;
+	batch->payload = (uint8_t *)send + FFA_RXTX_HEADER_SIZE;
+	batch->max_size = send_size - FFA_RXTX_HEADER_SIZE;
+	batch->size = 0U;
+	batch->count = 0U;
+
+	ffa_rxtx_header_init(batch->header, sender, receiver, 0U);
+}
+
+void *ffa_msg_batch_reserve(struct ffa_msg_batch *batch, uint32_t size)
+{
+	uint32_t entry_size = FFA_MSG_BATCH_ENTRY_SIZE(size);
+	uint8_t *entry;
+
+	if (entry_size > batch->max_size - batch->size) {
+		return NULL;
+	}
+
+	entry = batch->payload + batch->size;
+	*(uint32_t *)entry = size;
+
+	batch->size += entry_size;
+	batch->count++;
+
+	return entry + FFA_MSG_BATCH_ENTRY_HDR_SIZE;
+}
+
+struct ffa_value ffa_msg_batch_send(struct ffa_msg_batch *batch)
+{
+	struct ffa_value ret;
+
+	batch->header->size = batch->size;
+
+	ret = ffa_msg_send2(0U);
+
+	batch->size = 0U;
+	batch->count = 0U;
+
+	return ret;
+}
+
+bool ffa_msg_batch_next(const void *recv, size_t recv_size, uint32_t *cursor,
+			const void **msg, uint32_t *size)
+{
+	const struct ffa_partition_rxtx_header *header =
+		(const struct ffa_partition_rxtx_header *)recv;
+	const uint8_t *payload;
+	uint32_t entry_size;
+
+	if (header->offset < FFA_RXTX_HEADER_SIZE ||
+	    header->offset > recv_size ||
+	    header->size > recv_size - header->offset) {
+		return false;
+	}
+
+	if (header->size - *cursor < FFA_MSG_BATCH_ENTRY_HDR_SIZE) {
+		return false;
+	}
+
+	payload = (const uint8_t *)recv + header->offset + *cursor;
+	*size = *(const uint32_t *)payload;
+
+	entry_size = FFA_MSG_BATCH_ENTRY_SIZE(*size);
+	if (*size > header->size || entry_size > header->size - *cursor) {
+		return false;
+	}
+
+	*msg = payload + FFA_MSG_BATCH_ENTRY_HDR_SIZE;
+	*cursor += entry_size;
+
+	return true;
+}
+
+uint32_t ffa_msg_checksum(const void *msg, uint32_t size)
+{
+	const uint8_t *bytes = (const uint8_t *)msg;
+	uint32_t sum = 5381U;
+
+	for (uint32_t i = 0U; i < size; i++) {
+		sum = (sum << 5) + sum + bytes[i];
+	}
+
+	return sum;
+}
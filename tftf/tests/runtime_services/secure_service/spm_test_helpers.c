@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <assert.h>
 #include <stdlib.h>
 
 #include <power_management.h>
@@ -11,7 +12,78 @@
 #include <test_helpers.h>
 #include <tftf_lib.h>
 
+/*
+ * RX/TX buffer pairs of the TFTF mailbox, one per supported size. A pair is
+ * carved out of the pool the first time its size is selected and kept for the
+ * whole session. The pool is static rather than taken from the heap page
+ * allocator, which the realm tests reinitialise.
+ *
+ * The NWd endpoint can only have one pair mapped with the SPMC at a time: the
+ * pair of the selected size is mapped on first use, and stays mapped until
+ * another size is selected or the mailbox is reset.
+ */
+static const size_t mailbox_sizes[] = {
+	TFTF_MAILBOX_SIZE_4K, TFTF_MAILBOX_SIZE_16K, TFTF_MAILBOX_SIZE_64K
+};
+
+#define MAILBOX_POOL_SIZE						\
+	(2U * (TFTF_MAILBOX_SIZE_4K + TFTF_MAILBOX_SIZE_16K +		\
+	       TFTF_MAILBOX_SIZE_64K))
+
+static uint8_t mailbox_pool[MAILBOX_POOL_SIZE] __aligned(PAGE_SIZE);
+static size_t mailbox_pool_used;
+static struct mailbox_buffers mailbox_pairs[ARRAY_SIZE(mailbox_sizes)];
+
 static struct mailbox_buffers test_mb = {.send = NULL, .recv = NULL};
+static size_t test_mb_size = TFTF_MAILBOX_SIZE_4K;
+
+/*
+ * Return the RX/TX pair of 'size' bytes buffers, allocating it if needed, or
+ * NULL if the size is not supported.
+ */
+static struct mailbox_buffers *mailbox_pair_get(size_t size)
+{
+	struct mailbox_buffers *pair;
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(mailbox_sizes); i++) {
+		if (mailbox_sizes[i] != size) {
+			continue;
+		}
+
+		pair = &mailbox_pairs[i];
+		if (pair->recv == NULL) {
+			assert(mailbox_pool_used + (2U * size) <=
+			       MAILBOX_POOL_SIZE);
+			pair->recv = &mailbox_pool[mailbox_pool_used];
+			pair->send = &mailbox_pool[mailbox_pool_used + size];
+			mailbox_pool_used += 2U * size;
+		}
+
+		return pair;
+	}
+
+	return NULL;
+}
+
+static bool mailbox_map(size_t size)
+{
+	struct mailbox_buffers *pair = mailbox_pair_get(size);
+	struct ffa_value ret;
+
+	if (pair == NULL) {
+		return false;
+	}
+
+	ret = ffa_rxtx_map((uintptr_t)pair->send, (uintptr_t)pair->recv,
+			   size / PAGE_SIZE);
+	if (is_ffa_call_error(ret)) {
+		return false;
+	}
+
+	test_mb = *pair;
+
+	return true;
+}
 
 bool reset_tftf_mailbox(void)
 {
@@ -27,11 +99,8 @@ bool reset_tftf_mailbox(void)
 
 bool get_tftf_mailbox(struct mailbox_buffers *mb)
 {
-	struct ffa_value ret;
-
 	if (test_mb.recv == NULL || test_mb.send == NULL) {
-		CONFIGURE_AND_MAP_MAILBOX(test_mb, PAGE_SIZE, ret);
-		if (is_ffa_call_error(ret)) {
+		if (!mailbox_map(test_mb_size)) {
 			return false;
 		}
 	}
@@ -41,6 +110,43 @@ bool get_tftf_mailbox(struct mailbox_buffers *mb)
 	return true;
 }
 
+bool set_tftf_mailbox_size(size_t size)
+{
+	bool mapped = (test_mb.recv != NULL);
+
+	if (mailbox_pair_get(size) == NULL) {
+		ERROR("Unsupported mailbox size %zu\n", size);
+		return false;
+	}
+
+	if (mapped && size == test_mb_size) {
+		return true;
+	}
+
+	if (mapped && !reset_tftf_mailbox()) {
+		return false;
+	}
+
+	if (!mailbox_map(size)) {
+		VERBOSE("Failed to map %zu bytes mailbox\n", size);
+
+		/* Restore the previous mailbox. */
+		if (mapped) {
+			(void)mailbox_map(test_mb_size);
+		}
+		return false;
+	}
+
+	test_mb_size = size;
+
+	return true;
+}
+
+size_t get_tftf_mailbox_size(void)
+{
+	return test_mb_size;
+}
+
 test_result_t check_spmc_testing_set_up(
 	uint32_t ffa_version_major, uint32_t ffa_version_minor,
 	const struct ffa_uuid *ffa_uuids, size_t ffa_uuids_size)
@@ -65,8 +171,25 @@ test_result_t check_spmc_testing_set_up(
 
 	GET_TFTF_MAILBOX(mb);
 
-	for (unsigned int i = 0U; i < ffa_uuids_size; i++)
-		SKIP_TEST_IF_FFA_ENDPOINT_NOT_DEPLOYED(*mb, ffa_uuids[i]);
+	/*
+	 * Look the endpoints up in the partition info cache, filled on the
+	 * first test of the boot. Fall back to FFA_PARTITION_INFO_GET if the
+	 * partition information can't be cached.
+	 */
+	if (!ffa_partition_info_cache_init(&mb)) {
+		for (unsigned int i = 0U; i < ffa_uuids_size; i++)
+			SKIP_TEST_IF_FFA_ENDPOINT_NOT_DEPLOYED(*mb,
+							       ffa_uuids[i]);
+
+		return TEST_RESULT_SUCCESS;
+	}
+
+	for (unsigned int i = 0U; i < ffa_uuids_size; i++) {
+		if (ffa_partition_info_cache_find_uuid(ffa_uuids[i]) == NULL) {
+			tftf_testcase_printf("FFA endpoint not deployed!\n");
+			return TEST_RESULT_SKIPPED;
+		}
+	}
 
 	return TEST_RESULT_SUCCESS;
 }
@@ -91,7 +214,7 @@ test_result_t spm_run_multi_core_test(uintptr_t cpu_on_handler,
 			continue;
 		}
 
-		ret = tftf_cpu_on(mpidr, cpu_on_handler, 0U);
+		ret = tftf_cpu_on_parkable(mpidr, cpu_on_handler);
 		if (ret != 0) {
 			ERROR("tftf_cpu_on mpidr 0x%x returns %d\n",
 			      mpidr, ret);
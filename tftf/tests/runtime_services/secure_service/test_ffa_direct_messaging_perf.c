@@ -0,0 +1,561 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the round trip time of FF-A direct
+ * message requests from the NWd to each cactus SP and to the ivy S-EL0
+ * partition, using the SMC32 and SMC64 conventions.
+ *
+ * SP1 and SP2 are MP partitions: requests are handled by the vCPU pinned to
+ * the physical core emitting them (same-core). SP3 and ivy are UP partitions
+ * with a single vCPU that migrates to whichever core sends the request
+ * (cross-core). Requests are sent either from the lead core only, alternately
+ * from two cores such that the UP vCPU migrates on every request, or from all
+ * cores at once.
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <cactus_test_cmds.h>
+#include <debug.h>
+#include <ffa_endpoints.h>
+#include <ffa_svc.h>
+#include <lib/events.h>
+#include <lib/power_management.h>
+#include <platform.h>
+#include <spm_common.h>
+#include <spm_test_helpers.h>
+#include <stdio.h>
+#include <string.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+
+#define DM_BENCH_ITERATIONS	U(256)
+
+/* Number of FFA_ERROR_BUSY responses tolerated for a single request. */
+#define DM_BENCH_BUSY_RETRIES	U(1000)
+
+#define DM_BENCH_ECHO_VAL	U(0xbe4c0de5)
+
+#define IVY_ID			SP_ID(4)
+
+struct dm_bench_target {
+	const char *name;
+	ffa_id_t id;
+	bool is_64bit;
+};
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+	};
+
+static const struct ffa_uuid expected_ivy_uuids[] = {
+		{IVY_UUID}
+	};
+
+/* The UP partition targets are last, see test_ffa_direct_msg_perf_migrate. */
+#define CACTUS_UP_TARGETS	U(4)
+
+static const struct dm_bench_target cactus_targets[] = {
+	{ "SP1 (MP) 32-bit", SP_ID(1), false },
+	{ "SP1 (MP) 64-bit", SP_ID(1), true },
+	{ "SP2 (MP) 32-bit", SP_ID(2), false },
+	{ "SP2 (MP) 64-bit", SP_ID(2), true },
+	{ "SP3 (UP) 32-bit", SP_ID(3), false },
+	{ "SP3 (UP) 64-bit", SP_ID(3), true },
+};
+
+/*
+ * Ivy only handles direct message requests using the SMC32 convention, any
+ * other request makes it go through its initialisation again.
+ */
+static const struct dm_bench_target ivy_targets[] = {
+	{ "ivy (UP) 32-bit", IVY_ID, false },
+};
+
+static const struct dm_bench_target *bench_targets;
+static unsigned int bench_targets_count;
+static bool bench_sp2_init;
+
+static uint64_t samples[PLATFORM_CORE_COUNT][DM_BENCH_ITERATIONS];
+static uint64_t all_samples[PLATFORM_CORE_COUNT * DM_BENCH_ITERATIONS];
+static unsigned int busy_count[PLATFORM_CORE_COUNT];
+static test_result_t core_result[PLATFORM_CORE_COUNT];
+
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+static event_t cpu_done[PLATFORM_CORE_COUNT];
+static event_t bench_start;
+
+/*
+ * Send one request to the target and wait for its response. A request to a
+ * UP partition busy on another core is retried straight away, and the time
+ * spent retrying is part of the round trip.
+ */
+static bool dm_bench_round_trip(const struct dm_bench_target *target,
+				uint64_t *ticks, unsigned int *busy)
+{
+	struct ffa_value ret;
+	uint64_t start = read_cntpct_el0();
+
+	for (unsigned int i = 0U; i < DM_BENCH_BUSY_RETRIES; i++) {
+		if (target->id == IVY_ID) {
+			ret = ffa_msg_send_direct_req32(HYP_ID, target->id,
+							0, 0, 0, 0, 0);
+		} else if (target->is_64bit) {
+			ret = cactus_echo_send_cmd(HYP_ID, target->id,
+						   DM_BENCH_ECHO_VAL);
+		} else {
+			ret = cactus_echo32_send_cmd(HYP_ID, target->id,
+						     DM_BENCH_ECHO_VAL);
+		}
+
+		if ((ffa_func_id(ret) == FFA_ERROR) &&
+		    (ffa_error_code(ret) == FFA_ERROR_BUSY)) {
+			(*busy)++;
+			continue;
+		}
+
+		*ticks = read_cntpct_el0() - start;
+
+		if (ffa_func_id(ret) != (target->is_64bit ?
+					 FFA_MSG_SEND_DIRECT_RESP_SMC64 :
+					 FFA_MSG_SEND_DIRECT_RESP_SMC32)) {
+			ERROR("Unexpected response %x from %x\n",
+			      ffa_func_id(ret), target->id);
+			return false;
+		}
+
+		if (target->id != IVY_ID &&
+		    (cactus_get_response(ret) != CACTUS_SUCCESS ||
+		     (uint32_t)cactus_echo_get_val(ret) != DM_BENCH_ECHO_VAL)) {
+			ERROR("Echo to %x failed\n", target->id);
+			return false;
+		}
+
+		return true;
+	}
+
+	ERROR("%x still busy after %u retries\n", target->id,
+	      DM_BENCH_BUSY_RETRIES);
+
+	return false;
+}
+
+static test_result_t dm_bench_run(const struct dm_bench_target *target,
+				  unsigned int core_pos)
+{
+	busy_count[core_pos] = 0U;
+
+	for (unsigned int i = 0U; i < DM_BENCH_ITERATIONS; i++) {
+		if (!dm_bench_round_trip(target, &samples[core_pos][i],
+					 &busy_count[core_pos])) {
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Print the latency statistics of the samples, and the rate of round trips
+ * from 'ncores' cores over 'ticks' ticks.
+ */
+static void dm_bench_report(const char *mode,
+			    const struct dm_bench_target *target,
+			    uint64_t *bench_samples, unsigned int count,
+			    unsigned int ncores, uint64_t ticks,
+			    unsigned int busy)
+{
+	struct bench_stats stats;
+	char name[96];
+
+	bench_stats_compute(bench_samples, count, &stats);
+
+	snprintf(name, sizeof(name),
+		 "%s %s, %u core(s) (%llu round trips/s, %u busy)",
+		 target->name, mode, ncores,
+		 (unsigned long long)bench_ops_per_sec(count, ticks), busy);
+	bench_stats_print(name, &stats);
+}
+
+/*
+ * Print the average time cactus took to dispatch each request on the current
+ * core since the last reset, such that it can be told apart from the time
+ * taken by the SPMC.
+ */
+static bool dm_bench_dispatch_stats(const struct dm_bench_target *target,
+				    bool reset)
+{
+	struct ffa_value ret;
+	uint64_t count;
+
+	ret = cactus_dispatch_stats_send_cmd(HYP_ID, target->id, reset);
+	if (!is_ffa_direct_response(ret) ||
+	    cactus_get_response(ret) != CACTUS_SUCCESS) {
+		ERROR("Failed to get %x dispatch stats\n", target->id);
+		return false;
+	}
+
+	count = cactus_dispatch_stats_get_count(ret);
+	if (reset || count == 0U) {
+		return true;
+	}
+
+	printf("%s cactus dispatch: lookup %lluns, handler %lluns per request\n",
+		target->name,
+		(unsigned long long)bench_ticks_to_ns(
+			cactus_dispatch_stats_get_lookup_ticks(ret) / count),
+		(unsigned long long)bench_ticks_to_ns(
+			cactus_dispatch_stats_get_handler_ticks(ret) / count));
+
+	return true;
+}
+
+static test_result_t dm_bench_single_core(
+	const struct dm_bench_target *targets, unsigned int count)
+{
+	unsigned int core_pos = get_current_core_id();
+	test_result_t result;
+	uint64_t start, ticks;
+
+	for (unsigned int t = 0U; t < count; t++) {
+		if (targets[t].id != IVY_ID &&
+		    !dm_bench_dispatch_stats(&targets[t], true)) {
+			return TEST_RESULT_FAIL;
+		}
+
+		start = read_cntpct_el0();
+		result = dm_bench_run(&targets[t], core_pos);
+		ticks = read_cntpct_el0() - start;
+
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+
+		dm_bench_report("same core", &targets[t], samples[core_pos],
+				DM_BENCH_ITERATIONS, 1U, ticks,
+				busy_count[core_pos]);
+
+		if (targets[t].id != IVY_ID &&
+		    !dm_bench_dispatch_stats(&targets[t], false)) {
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Handler of the secondary cores. Once the SPs are ready on the current core,
+ * it runs every target in turn when the lead core says so.
+ */
+static test_result_t dm_bench_cpu_on_handler(void)
+{
+	unsigned int core_pos = get_current_core_id();
+
+	core_result[core_pos] = TEST_RESULT_SUCCESS;
+
+	/* Only SP2 needs its vCPU on the current core to be run first. */
+	if (bench_sp2_init && !spm_core_sp_init(SP_ID(2))) {
+		core_result[core_pos] = TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int t = 0U; t < bench_targets_count; t++) {
+		tftf_send_event(&cpu_ready[core_pos]);
+		tftf_wait_for_event(&bench_start);
+
+		if (core_result[core_pos] == TEST_RESULT_SUCCESS) {
+			core_result[core_pos] =
+				dm_bench_run(&bench_targets[t], core_pos);
+		}
+
+		tftf_send_event(&cpu_done[core_pos]);
+	}
+
+	return core_result[core_pos];
+}
+
+/*
+ * Run every target from all cores at once. The lead core releases all cores
+ * with a single event and is the last to start, and the rate is measured from
+ * this point until all cores are done.
+ */
+static test_result_t dm_bench_all_cores(
+	const struct dm_bench_target *targets, unsigned int count)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int lead_pos = platform_get_core_pos(lead_mpid);
+	unsigned int cpu_node, mpidr, core_pos;
+	unsigned int ncores = 1U;
+	unsigned int nsamples, busy;
+	bool started[PLATFORM_CORE_COUNT] = { false };
+	test_result_t result = TEST_RESULT_SUCCESS;
+	uint64_t start, ticks;
+	int32_t ret;
+
+	bench_targets = targets;
+	bench_targets_count = count;
+	bench_sp2_init = false;
+
+	for (unsigned int t = 0U; t < count; t++) {
+		if (targets[t].id == SP_ID(2)) {
+			bench_sp2_init = true;
+		}
+	}
+
+	tftf_init_event(&bench_start);
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		tftf_init_event(&cpu_ready[i]);
+		tftf_init_event(&cpu_done[i]);
+		core_result[i] = TEST_RESULT_SUCCESS;
+	}
+
+	for_each_cpu(cpu_node) {
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		if (mpidr == lead_mpid) {
+			continue;
+		}
+
+		ret = tftf_cpu_on(mpidr, (uintptr_t)dm_bench_cpu_on_handler,
+				  0U);
+		if (ret != PSCI_E_SUCCESS) {
+			ERROR("tftf_cpu_on mpidr 0x%x returns %d\n", mpidr,
+			      ret);
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		started[platform_get_core_pos(mpidr)] = true;
+		ncores++;
+	}
+
+	/*
+	 * After a failure, the cores already started are still released for
+	 * every target so that they return, but nothing is reported.
+	 */
+	for (unsigned int t = 0U; t < count; t++) {
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+			if (started[core_pos]) {
+				tftf_wait_for_event(&cpu_ready[core_pos]);
+			}
+		}
+
+		start = read_cntpct_el0();
+		tftf_send_event_to(&bench_start, ncores - 1U);
+
+		if (result == TEST_RESULT_SUCCESS) {
+			core_result[lead_pos] = dm_bench_run(&targets[t],
+							     lead_pos);
+		}
+
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+			if (started[core_pos]) {
+				tftf_wait_for_event(&cpu_done[core_pos]);
+			}
+		}
+
+		ticks = read_cntpct_el0() - start;
+
+		if (result != TEST_RESULT_SUCCESS) {
+			continue;
+		}
+
+		nsamples = 0U;
+		busy = 0U;
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+
+			if (core_result[core_pos] != TEST_RESULT_SUCCESS) {
+				ERROR("Core %u failed to message %x\n",
+				      core_pos, targets[t].id);
+				result = TEST_RESULT_FAIL;
+				break;
+			}
+
+			memcpy(&all_samples[nsamples], samples[core_pos],
+			       sizeof(samples[core_pos]));
+			nsamples += DM_BENCH_ITERATIONS;
+			busy += busy_count[core_pos];
+		}
+
+		if (result != TEST_RESULT_SUCCESS) {
+			continue;
+		}
+
+		dm_bench_report(targets[t].id == SP_ID(1) ||
+				targets[t].id == SP_ID(2) ?
+				"same core" : "cross core",
+				&targets[t], all_samples, nsamples, ncores,
+				ticks, busy);
+	}
+
+	return result;
+}
+
+/*
+ * Handler of the core sending every other request in the migration
+ * benchmark.
+ */
+static test_result_t dm_bench_migrate_handler(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	const struct dm_bench_target *target;
+
+	core_result[core_pos] = TEST_RESULT_SUCCESS;
+
+	for (unsigned int t = 0U; t < bench_targets_count; t++) {
+		target = &bench_targets[t];
+
+		for (unsigned int i = 1U; i < DM_BENCH_ITERATIONS; i += 2U) {
+			tftf_wait_for_event(&bench_start);
+
+			if (core_result[core_pos] == TEST_RESULT_SUCCESS &&
+			    !dm_bench_round_trip(target, &samples[0][i],
+						 &busy_count[core_pos])) {
+				core_result[core_pos] = TEST_RESULT_FAIL;
+			}
+
+			tftf_send_event(&cpu_done[core_pos]);
+		}
+	}
+
+	return core_result[core_pos];
+}
+
+/*
+ * Send requests to UP partitions alternately from the lead core and from one
+ * secondary core, such that the partition vCPU migrates to another physical
+ * core for each request.
+ */
+static test_result_t dm_bench_migrate(const struct dm_bench_target *targets,
+				      unsigned int count)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int lead_pos = platform_get_core_pos(lead_mpid);
+	unsigned int cpu_node, mpidr, core_pos = lead_pos;
+	test_result_t result = TEST_RESULT_SUCCESS;
+	uint64_t start, ticks;
+	int32_t ret;
+
+	bench_targets = targets;
+	bench_targets_count = count;
+
+	for_each_cpu(cpu_node) {
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		if (mpidr != lead_mpid) {
+			core_pos = platform_get_core_pos(mpidr);
+			break;
+		}
+	}
+
+	if (core_pos == lead_pos) {
+		tftf_testcase_printf("Needs at least two cores\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	tftf_init_event(&bench_start);
+	tftf_init_event(&cpu_done[core_pos]);
+	busy_count[core_pos] = 0U;
+
+	ret = tftf_cpu_on(mpidr, (uintptr_t)dm_bench_migrate_handler, 0U);
+	if (ret != PSCI_E_SUCCESS) {
+		ERROR("tftf_cpu_on mpidr 0x%x returns %d\n", mpidr, ret);
+		return TEST_RESULT_FAIL;
+	}
+
+	/*
+	 * After a failure, the other core is still released for every request
+	 * so that it returns, but nothing is reported.
+	 */
+	core_result[lead_pos] = TEST_RESULT_SUCCESS;
+
+	for (unsigned int t = 0U; t < count; t++) {
+		busy_count[lead_pos] = 0U;
+		start = read_cntpct_el0();
+
+		for (unsigned int i = 0U; i < DM_BENCH_ITERATIONS; i += 2U) {
+			if (core_result[lead_pos] == TEST_RESULT_SUCCESS &&
+			    !dm_bench_round_trip(&targets[t], &samples[0][i],
+						 &busy_count[lead_pos])) {
+				core_result[lead_pos] = TEST_RESULT_FAIL;
+			}
+
+			tftf_send_event(&bench_start);
+			tftf_wait_for_event(&cpu_done[core_pos]);
+		}
+
+		ticks = read_cntpct_el0() - start;
+
+		if (result != TEST_RESULT_SUCCESS) {
+			continue;
+		}
+
+		if (core_result[lead_pos] != TEST_RESULT_SUCCESS ||
+		    core_result[core_pos] != TEST_RESULT_SUCCESS) {
+			ERROR("Failed to message %x\n", targets[t].id);
+			result = TEST_RESULT_FAIL;
+			continue;
+		}
+
+		/*
+		 * The rate includes the time taken to hand over to the other
+		 * core, only the latency percentiles are meaningful here.
+		 */
+		dm_bench_report("migrating", &targets[t], samples[0],
+				DM_BENCH_ITERATIONS, 2U, ticks,
+				busy_count[lead_pos] + busy_count[core_pos]);
+		busy_count[core_pos] = 0U;
+	}
+
+	return result;
+}
+
+test_result_t test_ffa_direct_msg_perf_single_core(void)
+{
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	return dm_bench_single_core(cactus_targets,
+				    ARRAY_SIZE(cactus_targets));
+}
+
+test_result_t test_ffa_direct_msg_perf_migrate(void)
+{
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	return dm_bench_migrate(&cactus_targets[CACTUS_UP_TARGETS],
+				ARRAY_SIZE(cactus_targets) - CACTUS_UP_TARGETS);
+}
+
+test_result_t test_ffa_direct_msg_perf_all_cores(void)
+{
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	return dm_bench_all_cores(cactus_targets, ARRAY_SIZE(cactus_targets));
+}
+
+test_result_t test_ffa_direct_msg_perf_ivy(void)
+{
+	test_result_t result;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_ivy_uuids);
+
+	result = dm_bench_single_core(ivy_targets, ARRAY_SIZE(ivy_targets));
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	result = dm_bench_migrate(ivy_targets, ARRAY_SIZE(ivy_targets));
+	if (result != TEST_RESULT_SUCCESS && result != TEST_RESULT_SKIPPED) {
+		return result;
+	}
+
+	return dm_bench_all_cores(ivy_targets, ARRAY_SIZE(ivy_targets));
+}
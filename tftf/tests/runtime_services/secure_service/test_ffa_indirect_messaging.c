@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <cactus_test_cmds.h>
+#include <debug.h>
+#include <ffa_endpoints.h>
+#include <ffa_helpers.h>
+#include <spm_common.h>
+#include <spm_test_helpers.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <xlat_tables_defs.h>
+
+#define SENDER		HYP_ID
+#define RECEIVER	SP_ID(1)
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}
+	};
+
+static bool is_msg_send2_supported(void)
+{
+	struct ffa_value ret = ffa_features(FFA_MSG_SEND2);
+
+	return ffa_func_id(ret) == FFA_SUCCESS_SMC32;
+}
+
+/*
+ * Ask the receiver to read the batch in its RX buffer, and check it got all
+ * the messages that were sent.
+ */
+static bool indirect_msg_recv_check(uint32_t count, uint32_t bytes,
+				    uint32_t checksum)
+{
+	struct ffa_value ret;
+
+	ret = cactus_indirect_msg_recv_send_cmd(SENDER, RECEIVER);
+
+	if (!is_ffa_direct_response(ret) ||
+	    cactus_get_response(ret) != CACTUS_SUCCESS) {
+		ERROR("Receiver failed to read indirect messages\n");
+		return false;
+	}
+
+	if (cactus_indirect_msg_get_count(ret) != count ||
+	    cactus_indirect_msg_get_bytes(ret) != bytes ||
+	    cactus_indirect_msg_get_checksum(ret) != checksum) {
+		ERROR("Received %u messages, %u bytes, checksum %x. Expected "
+		      "%u, %u, %x\n", cactus_indirect_msg_get_count(ret),
+		      cactus_indirect_msg_get_bytes(ret),
+		      cactus_indirect_msg_get_checksum(ret), count, bytes,
+		      checksum);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Send a single message with FFA_MSG_SEND2, and check a second message is
+ * refused while the receiver has not released its RX buffer.
+ */
+test_result_t test_ffa_indirect_message(void)
+{
+	static const char message[] = "FF-A indirect message";
+	struct ffa_msg_batch batch;
+	struct mailbox_buffers mb;
+	struct ffa_value ret;
+	void *msg;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (!is_msg_send2_supported()) {
+		tftf_testcase_printf("FFA_MSG_SEND2 not supported\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	GET_TFTF_MAILBOX(mb);
+
+	ffa_msg_batch_init(&batch, mb.send, PAGE_SIZE, SENDER, RECEIVER);
+
+	msg = ffa_msg_batch_reserve(&batch, sizeof(message));
+	if (msg == NULL) {
+		return TEST_RESULT_FAIL;
+	}
+	memcpy(msg, message, sizeof(message));
+
+	ret = ffa_msg_batch_send(&batch);
+	if (is_ffa_call_error(ret)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	/* The receiver RX buffer is full until it is released. */
+	msg = ffa_msg_batch_reserve(&batch, sizeof(message));
+	if (msg == NULL) {
+		return TEST_RESULT_FAIL;
+	}
+	memcpy(msg, message, sizeof(message));
+
+	ret = ffa_msg_batch_send(&batch);
+	if (!is_expected_ffa_error(ret, FFA_ERROR_BUSY)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	if (!indirect_msg_recv_check(1U, sizeof(message),
+				     ffa_msg_checksum(message,
+						      sizeof(message)))) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Fill the TX buffer with messages of increasing sizes, send them with a
+ * single FFA_MSG_SEND2 and check the receiver reads them all.
+ */
+test_result_t test_ffa_indirect_message_batch(void)
+{
+	struct ffa_msg_batch batch;
+	struct mailbox_buffers mb;
+	struct ffa_value ret;
+	uint32_t checksum = 0U;
+	uint32_t bytes = 0U;
+	uint32_t size = 1U;
+	uint32_t count;
+	uint8_t *msg;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (!is_msg_send2_supported()) {
+		tftf_testcase_printf("FFA_MSG_SEND2 not supported\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	GET_TFTF_MAILBOX(mb);
+
+	ffa_msg_batch_init(&batch, mb.send, PAGE_SIZE, SENDER, RECEIVER);
+
+	while ((msg = ffa_msg_batch_reserve(&batch, size)) != NULL) {
+		for (uint32_t i = 0U; i < size; i++) {
+			msg[i] = (uint8_t)(size + i);
+		}
+
+		checksum += ffa_msg_checksum(msg, size);
+		bytes += size;
+		size++;
+	}
+
+	count = batch.count;
+
+	VERBOSE("Sending %u indirect messages, %u bytes\n", count, bytes);
+
+	ret = ffa_msg_batch_send(&batch);
+	if (is_ffa_call_error(ret)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	if (!indirect_msg_recv_check(count, bytes, checksum)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that compare the throughput of messages sent to an
+ * SP with direct messages and with indirect messages, for payloads from 16
+ * bytes to a full mailbox page.
+ *
+ * Direct messages carry 32 bytes of payload each, in registers. Indirect
+ * messages are written to the TX buffer and sent with FFA_MSG_SEND2, either
+ * one per FFA_MSG_SEND2 or in batches filling the TX buffer. After each
+ * FFA_MSG_SEND2 the SP is told by a direct message to read its RX buffer and
+ * release it.
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <cactus_test_cmds.h>
+#include <debug.h>
+#include <ffa_endpoints.h>
+#include <ffa_helpers.h>
+#include <spm_common.h>
+#include <spm_test_helpers.h>
+#include <stdio.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <xlat_tables_defs.h>
+
+#define SENDER		HYP_ID
+#define RECEIVER	SP_ID(1)
+
+#define MSG_BENCH_MESSAGES	U(64)
+
+/* Payload of a CACTUS_DATA_CMD direct message. */
+#define MSG_BENCH_DIRECT_SIZE	(4U * sizeof(uint64_t))
+
+/* Largest message that fits in the mailbox. */
+#define MSG_BENCH_MAX_SIZE						\
+	(PAGE_SIZE - FFA_RXTX_HEADER_SIZE - FFA_MSG_BATCH_ENTRY_HDR_SIZE)
+
+enum msg_bench_mode {
+	MSG_BENCH_DIRECT = 0,
+	MSG_BENCH_INDIRECT,
+	MSG_BENCH_INDIRECT_BATCH,
+};
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}
+	};
+
+static const uint32_t msg_bench_sizes[] = {
+	16U, 64U, 256U, 1024U, MSG_BENCH_MAX_SIZE
+};
+
+static uint8_t msg_bench_data[PAGE_SIZE];
+static uint64_t samples[MSG_BENCH_MESSAGES];
+
+/*
+ * Send one message of 'size' bytes as a series of direct messages, 32 bytes
+ * at a time.
+ */
+static bool msg_bench_direct(uint32_t size)
+{
+	uint64_t data[4];
+	struct ffa_value ret;
+
+	for (uint32_t offset = 0U; offset < size;
+	     offset += MSG_BENCH_DIRECT_SIZE) {
+		memcpy(data, &msg_bench_data[offset], sizeof(data));
+
+		ret = cactus_data_send_cmd(SENDER, RECEIVER, data);
+		if (!is_ffa_direct_response(ret) ||
+		    cactus_get_response(ret) != CACTUS_SUCCESS) {
+			ERROR("Direct message failed\n");
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Send up to 'max_count' messages of 'size' bytes with a single
+ * FFA_MSG_SEND2, and wait for the receiver to read them. Returns the number of
+ * messages sent, 0 on error.
+ */
+static uint32_t msg_bench_indirect(struct ffa_msg_batch *batch, uint32_t size,
+				   uint32_t max_count, uint32_t checksum)
+{
+	struct ffa_value ret;
+	uint32_t count;
+	void *msg;
+
+	while (batch->count < max_count &&
+	       (msg = ffa_msg_batch_reserve(batch, size)) != NULL) {
+		memcpy(msg, msg_bench_data, size);
+	}
+
+	count = batch->count;
+
+	ret = ffa_msg_batch_send(batch);
+	if (is_ffa_call_error(ret)) {
+		return 0U;
+	}
+
+	ret = cactus_indirect_msg_recv_send_cmd(SENDER, RECEIVER);
+	if (!is_ffa_direct_response(ret) ||
+	    cactus_get_response(ret) != CACTUS_SUCCESS ||
+	    cactus_indirect_msg_get_count(ret) != count ||
+	    cactus_indirect_msg_get_checksum(ret) != count * checksum) {
+		ERROR("Indirect message failed\n");
+		return 0U;
+	}
+
+	return count;
+}
+
+static test_result_t msg_bench_run(enum msg_bench_mode mode, uint32_t size)
+{
+	static const char *const mode_names[] = {
+		[MSG_BENCH_DIRECT] = "direct",
+		[MSG_BENCH_INDIRECT] = "indirect",
+		[MSG_BENCH_INDIRECT_BATCH] = "indirect batch",
+	};
+	uint32_t checksum = ffa_msg_checksum(msg_bench_data, size);
+	struct ffa_msg_batch batch;
+	struct mailbox_buffers mb;
+	struct bench_stats stats;
+	uint32_t sent = 0U;
+	uint32_t count = 1U;
+	unsigned int cycles = 0U;
+	uint64_t start, ticks = 0U;
+	char name[96];
+
+	GET_TFTF_MAILBOX(mb);
+
+	ffa_msg_batch_init(&batch, mb.send, PAGE_SIZE, SENDER, RECEIVER);
+
+	while (sent < MSG_BENCH_MESSAGES) {
+		start = read_cntpct_el0();
+
+		if (mode == MSG_BENCH_DIRECT) {
+			if (!msg_bench_direct(size)) {
+				return TEST_RESULT_FAIL;
+			}
+		} else {
+			count = msg_bench_indirect(
+				&batch, size,
+				(mode == MSG_BENCH_INDIRECT) ?
+				1U : MSG_BENCH_MESSAGES - sent,
+				checksum);
+			if (count == 0U) {
+				return TEST_RESULT_FAIL;
+			}
+		}
+
+		samples[cycles] = read_cntpct_el0() - start;
+		ticks += samples[cycles];
+		cycles++;
+		sent += count;
+	}
+
+	bench_stats_compute(samples, cycles, &stats);
+
+	snprintf(name, sizeof(name),
+		 "%4u bytes %s, %u msgs/cycle (%llu msgs/s, %llu bytes/s)",
+		 size, mode_names[mode], MSG_BENCH_MESSAGES / cycles,
+		 (unsigned long long)bench_ops_per_sec(sent, ticks),
+		 (unsigned long long)bench_ops_per_sec(sent * size, ticks));
+	bench_stats_print(name, &stats);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+test_result_t test_ffa_indirect_msg_throughput(void)
+{
+	test_result_t result;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (ffa_func_id(ffa_features(FFA_MSG_SEND2)) != FFA_SUCCESS_SMC32) {
+		tftf_testcase_printf("FFA_MSG_SEND2 not supported\n");
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (uint32_t i = 0U; i < sizeof(msg_bench_data); i++) {
+		msg_bench_data[i] = (uint8_t)(i * 7U);
+	}
+
+	for (unsigned int s = 0U; s < ARRAY_SIZE(msg_bench_sizes); s++) {
+		for (unsigned int m = MSG_BENCH_DIRECT;
+		     m <= MSG_BENCH_INDIRECT_BATCH; m++) {
+			result = msg_bench_run((enum msg_bench_mode)m,
+					       msg_bench_sizes[s]);
+			if (result != TEST_RESULT_SUCCESS) {
+				return result;
+			}
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
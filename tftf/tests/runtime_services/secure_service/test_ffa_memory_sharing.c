@@ -4,10 +4,13 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <arch_helpers.h>
+#include <bench_stats.h>
 #include <debug.h>
 
 #include <cactus_test_cmds.h>
 #include <ffa_endpoints.h>
+#include <platform.h>
 #include <spm_common.h>
 #include <spm_test_helpers.h>
 #include <test_helpers.h>
@@ -28,6 +31,12 @@ static __aligned(PAGE_SIZE) uint8_t share_page[PAGE_SIZE];
 static __aligned(PAGE_SIZE) uint8_t consecutive_donate_page[PAGE_SIZE];
 static __aligned(PAGE_SIZE) uint8_t four_share_pages[PAGE_SIZE * 4];
 
+/* Constituents of the memory regions sent in several fragments. */
+static struct ffa_memory_region_constituent
+	frag_constituents[MEM_SHARE_MAX_CONSTITUENTS];
+
+#define FRAG_BENCH_ITERATIONS	U(8)
+
 static bool check_written_words(uint32_t *ptr, uint32_t word, uint32_t wcount)
 {
 	VERBOSE("TFTF - Memory contents after SP use:\n");
@@ -140,12 +149,8 @@ static test_result_t test_memory_send_sp(uint32_t mem_func, ffa_id_t borrower,
 
 	GET_TFTF_MAILBOX(mb);
 
-	if (constituents_count != 1) {
-		WARN("Test expects constituents_count to be 1\n");
-	}
-
 	for (size_t i = 0; i < constituents_count; i++) {
-		VERBOSE("TFTF - Address: %p\n", constituents[0].address);
+		VERBOSE("TFTF - Address: %p\n", constituents[i].address);
 	}
 
 	handle = memory_init_and_send((struct ffa_memory_region *)mb.send,
@@ -459,3 +464,189 @@ test_result_t test_mem_share_to_sp_clear_memory(void)
 
 	return TEST_RESULT_SUCCESS;
 }
+
+/*
+ * Describe 'count' single page constituents in the platform memory set aside
+ * for tests, leaving a page between each of them so that no two constituents
+ * describe contiguous memory.
+ */
+static bool init_scattered_constituents(uint32_t count)
+{
+	const mem_region_t *regions;
+	int nelem;
+
+	regions = plat_get_prot_regions(&nelem);
+
+	if (nelem < 1 || regions[0].size < (size_t)count * 2U * PAGE_SIZE) {
+		tftf_testcase_printf("Not enough memory for %u constituents\n",
+				     count);
+		return false;
+	}
+
+	for (uint32_t i = 0U; i < count; i++) {
+		frag_constituents[i].address =
+			(void *)(regions[0].addr + (2U * i * PAGE_SIZE));
+		frag_constituents[i].page_count = 1U;
+		frag_constituents[i].reserved = 0U;
+	}
+
+	return true;
+}
+
+/*
+ * Number of fragments a descriptor with 'count' constituents is sent in,
+ * through a TX buffer of MAILBOX_SIZE.
+ */
+static uint32_t descriptor_fragment_count(uint32_t count)
+{
+	const uint32_t first = (MAILBOX_SIZE -
+				sizeof(struct ffa_memory_region) -
+				sizeof(struct ffa_memory_access) -
+				sizeof(struct ffa_composite_memory_region)) /
+			       sizeof(struct ffa_memory_region_constituent);
+	const uint32_t next = MAILBOX_SIZE /
+			      sizeof(struct ffa_memory_region_constituent);
+
+	if (count <= first) {
+		return 1U;
+	}
+
+	return 1U + div_round_up(count - first, next);
+}
+
+/*
+ * Tests that memory described by more constituents than fit in the TX buffer
+ * can be sent to an SP. The descriptor is sent in several fragments, and the
+ * SP retrieves it in several fragments as well.
+ */
+static test_result_t test_mem_send_fragmented_sp(uint32_t mem_func)
+{
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (!init_scattered_constituents(MEM_SHARE_MAX_CONSTITUENTS)) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	return test_memory_send_sp(mem_func, RECEIVER, frag_constituents,
+				   MEM_SHARE_MAX_CONSTITUENTS);
+}
+
+test_result_t test_mem_share_fragmented_sp(void)
+{
+	return test_mem_send_fragmented_sp(FFA_MEM_SHARE_SMC32);
+}
+
+test_result_t test_mem_lend_fragmented_sp(void)
+{
+	return test_mem_send_fragmented_sp(FFA_MEM_LEND_SMC32);
+}
+
+/*
+ * Measure the time a memory share and the following reclaim take, for a
+ * growing number of scattered constituents, and report it per constituent.
+ * The time taken to fill the TX buffer with the descriptor is measured on its
+ * own, so that the time spent in the SPMC can be told apart.
+ * This test always succeeds, unless one of the FF-A calls fails.
+ */
+test_result_t test_mem_share_fragmented_latency(void)
+{
+	static const uint32_t counts[] = {
+		1U, 16U, 64U, 256U, 1024U, MEM_SHARE_MAX_CONSTITUENTS
+	};
+	struct mailbox_buffers mb;
+	struct ffa_value ret;
+	ffa_memory_handle_t handle;
+	unsigned long long start;
+	unsigned long long build_cycles;
+	unsigned long long share_cycles;
+	unsigned long long reclaim_cycles;
+	unsigned long long spmc_cycles;
+	uint32_t remaining;
+	uint32_t length;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (!init_scattered_constituents(MEM_SHARE_MAX_CONSTITUENTS)) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	GET_TFTF_MAILBOX(mb);
+
+	for (unsigned int c = 0U; c < ARRAY_SIZE(counts); c++) {
+		const uint32_t count = counts[c];
+
+		build_cycles = 0ULL;
+		share_cycles = 0ULL;
+		reclaim_cycles = 0ULL;
+
+		for (unsigned int i = 0U; i < FRAG_BENCH_ITERATIONS; i++) {
+			/* Fill the TX buffer as the share would, but don't send. */
+			start = read_cntpct_el0();
+			remaining = ffa_memory_region_init(
+				(struct ffa_memory_region *)mb.send,
+				MAILBOX_SIZE, SENDER, RECEIVER,
+				frag_constituents, count, 0, 0,
+				FFA_DATA_ACCESS_RW,
+				FFA_INSTRUCTION_ACCESS_NOT_SPECIFIED,
+				FFA_MEMORY_NORMAL_MEM,
+				FFA_MEMORY_CACHE_WRITE_BACK,
+				FFA_MEMORY_INNER_SHAREABLE, NULL, NULL);
+			while (remaining != 0U) {
+				remaining = ffa_memory_fragment_init(
+					mb.send, MAILBOX_SIZE,
+					&frag_constituents[count - remaining],
+					remaining, &length);
+			}
+			build_cycles += read_cntpct_el0() - start;
+
+			start = read_cntpct_el0();
+			handle = memory_init_and_send(
+				(struct ffa_memory_region *)mb.send,
+				MAILBOX_SIZE, SENDER, RECEIVER,
+				frag_constituents, count,
+				FFA_MEM_SHARE_SMC32, &ret);
+			share_cycles += read_cntpct_el0() - start;
+
+			if (handle == FFA_MEMORY_HANDLE_INVALID) {
+				ERROR("Failed to share %u constituents\n",
+				      count);
+				return TEST_RESULT_FAIL;
+			}
+
+			start = read_cntpct_el0();
+			ret = ffa_mem_reclaim(handle, 0);
+			reclaim_cycles += read_cntpct_el0() - start;
+
+			if (is_ffa_call_error(ret)) {
+				ERROR("Failed to reclaim %u constituents\n",
+				      count);
+				return TEST_RESULT_FAIL;
+			}
+		}
+
+		build_cycles /= FRAG_BENCH_ITERATIONS;
+		share_cycles /= FRAG_BENCH_ITERATIONS;
+		reclaim_cycles /= FRAG_BENCH_ITERATIONS;
+
+		/*
+		 * The descriptor is built again as part of the share, but the
+		 * two are timed apart and the difference can be negative for
+		 * small descriptors: don't let it wrap around.
+		 */
+		spmc_cycles = (share_cycles > build_cycles) ?
+			      (share_cycles - build_cycles) : 0ULL;
+
+		printf("%4u constituents, %2u fragments: "
+			"share %llu ns (SPMC %llu ns per constituent), "
+			"reclaim %llu ns (%llu ns per constituent)\n",
+			count, descriptor_fragment_count(count),
+			(unsigned long long)bench_ticks_to_ns(share_cycles),
+			(unsigned long long)bench_ticks_to_ns(spmc_cycles) /
+				count,
+			(unsigned long long)bench_ticks_to_ns(reclaim_cycles),
+			(unsigned long long)bench_ticks_to_ns(reclaim_cycles) /
+				count);
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
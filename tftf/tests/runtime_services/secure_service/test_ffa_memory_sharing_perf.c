@@ -0,0 +1,387 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the time taken by the SPMC to handle
+ * each phase of the FF-A memory management operations: the memory send
+ * (share, lend or donate), retrieve, relinquish and reclaim. The retrieve and
+ * relinquish are timed by the receiver SP, all other phases by the sender.
+ *
+ * Memory sent from the NWd comes from the platform memory set aside for
+ * tests, such that the number of pages and their layout can vary. Memory is
+ * either described by a single constituent (contiguous), or by one constituent
+ * per page with a page gap in between (scattered).
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <cactus_test_cmds.h>
+#include <debug.h>
+#include <ffa_endpoints.h>
+#include <platform.h>
+#include <spm_common.h>
+#include <spm_test_helpers.h>
+#include <stdio.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+#include <xlat_tables_defs.h>
+
+#define SENDER HYP_ID
+#define RECEIVER SP_ID(1)
+
+#define MEM_BENCH_ITERATIONS		U(32)
+
+/*
+ * Donated memory is never given back to the NWd, so donate is measured on
+ * fewer iterations to limit the amount of memory it consumes.
+ */
+#define MEM_BENCH_DONATE_ITERATIONS	U(4)
+
+#define MEM_BENCH_MAX_PAGES		U(256)
+
+enum mem_bench_phase {
+	MEM_BENCH_SEND = 0,
+	MEM_BENCH_RETRIEVE,
+	MEM_BENCH_RELINQUISH,
+	MEM_BENCH_RECLAIM,
+	MEM_BENCH_PHASES
+};
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+	};
+
+static const uint32_t mem_bench_page_counts[] = {
+	1U, 4U, 16U, 64U, MEM_BENCH_MAX_PAGES
+};
+
+static uint64_t samples[MEM_BENCH_PHASES][MEM_BENCH_ITERATIONS];
+
+static struct ffa_memory_region_constituent
+	constituents[MEM_BENCH_MAX_PAGES];
+
+/*
+ * Memory shared and lent from the NWd is taken from the start of the test
+ * region, and is always reclaimed. Donated memory is taken from the end of
+ * the test region, going down, and can't be used again.
+ */
+static uintptr_t bench_base;
+static uintptr_t bench_donate_top;
+
+static bool mem_bench_init_region(void)
+{
+	const mem_region_t *regions;
+	int nelem;
+
+	if (bench_donate_top != 0U) {
+		return true;
+	}
+
+	regions = plat_get_prot_regions(&nelem);
+
+	if (nelem < 1 ||
+	    regions[0].size < 4U * MEM_BENCH_MAX_PAGES * PAGE_SIZE) {
+		tftf_testcase_printf("Not enough test memory\n");
+		return false;
+	}
+
+	bench_base = regions[0].addr;
+	bench_donate_top = regions[0].addr + regions[0].size;
+
+	return true;
+}
+
+/*
+ * Returns the base of 'size' bytes of memory that was never donated, or 0 if
+ * it has all been used.
+ */
+static uintptr_t mem_bench_donate_alloc(size_t size)
+{
+	if (bench_donate_top - size <
+	    bench_base + (2U * MEM_BENCH_MAX_PAGES * PAGE_SIZE)) {
+		return 0U;
+	}
+
+	bench_donate_top -= size;
+
+	return bench_donate_top;
+}
+
+static size_t mem_bench_span(uint32_t pages, bool scattered)
+{
+	return (scattered ? 2U : 1U) * pages * PAGE_SIZE;
+}
+
+static uint32_t mem_bench_init_constituents(uintptr_t base, uint32_t pages,
+					    bool scattered)
+{
+	if (!scattered) {
+		constituents[0].address = (void *)base;
+		constituents[0].page_count = pages;
+		constituents[0].reserved = 0U;
+		return 1U;
+	}
+
+	for (uint32_t i = 0U; i < pages; i++) {
+		constituents[i].address = (void *)(base + (2U * i * PAGE_SIZE));
+		constituents[i].page_count = 1U;
+		constituents[i].reserved = 0U;
+	}
+
+	return pages;
+}
+
+static const char *mem_func_name(uint32_t mem_func)
+{
+	switch (mem_func) {
+	case FFA_MEM_SHARE_SMC32:
+		return "share";
+	case FFA_MEM_LEND_SMC32:
+		return "lend";
+	default:
+		return "donate";
+	}
+}
+
+/*
+ * Print the statistics of each phase measured, with the number of pages
+ * handled per second computed from the average latency.
+ */
+static void mem_bench_report(uint32_t mem_func, const char *layout,
+			     uint32_t pages, unsigned int iterations)
+{
+	static const char *const phase_names[MEM_BENCH_PHASES] = {
+		[MEM_BENCH_SEND] = "send",
+		[MEM_BENCH_RETRIEVE] = "retrieve",
+		[MEM_BENCH_RELINQUISH] = "relinquish",
+		[MEM_BENCH_RECLAIM] = "reclaim",
+	};
+	unsigned int nphases = (mem_func == FFA_MEM_DONATE_SMC32) ?
+			       (MEM_BENCH_RETRIEVE + 1U) : MEM_BENCH_PHASES;
+	struct bench_stats stats;
+	char name[96];
+
+	for (unsigned int p = 0U; p < nphases; p++) {
+		bench_stats_compute(samples[p], iterations, &stats);
+		snprintf(name, sizeof(name),
+			 "%s %3u pages %s, %s (%llu pages/s)",
+			 mem_func_name(mem_func), pages, layout, phase_names[p],
+			 (unsigned long long)bench_ops_per_sec(pages,
+							       stats.avg));
+		bench_stats_print(name, &stats);
+	}
+}
+
+/*
+ * Measure all phases of sending 'pages' pages of memory from the NWd to an SP,
+ * with the given layout.
+ */
+static test_result_t mem_bench_nwd_to_sp_one(uint32_t mem_func, uint32_t pages,
+					     bool scattered)
+{
+	const bool donate = (mem_func == FFA_MEM_DONATE_SMC32);
+	const unsigned int iterations = donate ? MEM_BENCH_DONATE_ITERATIONS :
+						 MEM_BENCH_ITERATIONS;
+	struct mailbox_buffers mb;
+	struct ffa_value ret;
+	ffa_memory_handle_t handle;
+	uintptr_t base = bench_base;
+	uint32_t count;
+	uint64_t start;
+
+	GET_TFTF_MAILBOX(mb);
+
+	for (unsigned int i = 0U; i < iterations; i++) {
+		if (donate) {
+			base = mem_bench_donate_alloc(
+				mem_bench_span(pages, scattered));
+			if (base == 0U) {
+				tftf_testcase_printf("No memory left to "
+						     "donate\n");
+				return TEST_RESULT_SKIPPED;
+			}
+		}
+
+		count = mem_bench_init_constituents(base, pages, scattered);
+
+		start = read_cntpct_el0();
+		handle = memory_init_and_send(
+			(struct ffa_memory_region *)mb.send,
+			get_tftf_mailbox_size(),
+			SENDER, RECEIVER, constituents, count, mem_func, &ret);
+		samples[MEM_BENCH_SEND][i] = read_cntpct_el0() - start;
+
+		if (handle == FFA_MEMORY_HANDLE_INVALID) {
+			ERROR("Failed to %s %u pages\n",
+			      mem_func_name(mem_func), pages);
+			return TEST_RESULT_FAIL;
+		}
+
+		ret = cactus_mem_retrieve_timed_cmd(SENDER, RECEIVER, mem_func,
+						    handle);
+
+		if (!is_ffa_direct_response(ret) ||
+		    cactus_get_response(ret) != CACTUS_SUCCESS) {
+			ERROR("Failed to retrieve %u pages\n", pages);
+			return TEST_RESULT_FAIL;
+		}
+
+		samples[MEM_BENCH_RETRIEVE][i] =
+			cactus_mem_send_get_retrieve_ticks(ret);
+		samples[MEM_BENCH_RELINQUISH][i] =
+			cactus_mem_send_get_relinquish_ticks(ret);
+
+		if (donate) {
+			continue;
+		}
+
+		start = read_cntpct_el0();
+		ret = ffa_mem_reclaim(handle, 0);
+		samples[MEM_BENCH_RECLAIM][i] = read_cntpct_el0() - start;
+
+		if (is_ffa_call_error(ret)) {
+			ERROR("Failed to reclaim %u pages\n", pages);
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	mem_bench_report(mem_func, scattered ? "scattered" : "contiguous",
+			 pages, iterations);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static test_result_t mem_bench_nwd_to_sp(uint32_t mem_func)
+{
+	test_result_t result;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (!mem_bench_init_region()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (unsigned int s = 0U; s < 2U; s++) {
+		for (unsigned int c = 0U;
+		     c < ARRAY_SIZE(mem_bench_page_counts); c++) {
+			result = mem_bench_nwd_to_sp_one(
+				mem_func, mem_bench_page_counts[c], s != 0U);
+			if (result != TEST_RESULT_SUCCESS) {
+				return result;
+			}
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure all phases of sending the share page of an SP to another SP. The
+ * sender SP times the send and reclaim, and the receiver SP times the retrieve
+ * and relinquish, all reported back in the response to
+ * CACTUS_REQ_MEM_SEND_CMD.
+ *
+ * Memory donate is not measured, as the sender SP can only donate its share
+ * page once.
+ */
+static test_result_t mem_bench_sp_to_sp(uint32_t mem_func)
+{
+	struct ffa_value ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	for (unsigned int i = 0U; i < MEM_BENCH_ITERATIONS; i++) {
+		ret = cactus_req_mem_send_send_cmd(HYP_ID, SP_ID(3), mem_func,
+						   SP_ID(2), false);
+
+		if (!is_ffa_direct_response(ret) ||
+		    cactus_get_response(ret) != CACTUS_SUCCESS) {
+			ERROR("Failed to %s memory between SPs\n",
+			      mem_func_name(mem_func));
+			return TEST_RESULT_FAIL;
+		}
+
+		samples[MEM_BENCH_SEND][i] =
+			cactus_req_mem_send_get_send_ticks(ret);
+		samples[MEM_BENCH_RETRIEVE][i] =
+			cactus_req_mem_send_get_retrieve_ticks(ret);
+		samples[MEM_BENCH_RELINQUISH][i] =
+			cactus_req_mem_send_get_relinquish_ticks(ret);
+		samples[MEM_BENCH_RECLAIM][i] =
+			cactus_req_mem_send_get_reclaim_ticks(ret);
+	}
+
+	mem_bench_report(mem_func, "SP to SP", 1U, MEM_BENCH_ITERATIONS);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+test_result_t test_mem_share_nwd_to_sp_perf(void)
+{
+	return mem_bench_nwd_to_sp(FFA_MEM_SHARE_SMC32);
+}
+
+test_result_t test_mem_lend_nwd_to_sp_perf(void)
+{
+	return mem_bench_nwd_to_sp(FFA_MEM_LEND_SMC32);
+}
+
+test_result_t test_mem_donate_nwd_to_sp_perf(void)
+{
+	return mem_bench_nwd_to_sp(FFA_MEM_DONATE_SMC32);
+}
+
+/*
+ * Measure sharing the largest scattered region with each size of TX buffer.
+ * Its descriptor doesn't fit in a 4KiB buffer, so the number of fragments it
+ * is sent in decreases as the buffer grows.
+ */
+test_result_t test_mem_share_mailbox_size_perf(void)
+{
+	static const size_t mailbox_sizes[] = {
+		TFTF_MAILBOX_SIZE_4K, TFTF_MAILBOX_SIZE_16K,
+		TFTF_MAILBOX_SIZE_64K
+	};
+	test_result_t result = TEST_RESULT_SUCCESS;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	if (!mem_bench_init_region()) {
+		return TEST_RESULT_SKIPPED;
+	}
+
+	for (unsigned int s = 0U; s < ARRAY_SIZE(mailbox_sizes); s++) {
+		if (!set_tftf_mailbox_size(mailbox_sizes[s])) {
+			tftf_testcase_printf("%zu bytes mailbox not supported\n",
+					     mailbox_sizes[s]);
+			continue;
+		}
+
+		printf("%zu bytes mailbox:\n", mailbox_sizes[s]);
+
+		result = mem_bench_nwd_to_sp_one(FFA_MEM_SHARE_SMC32,
+						 MEM_BENCH_MAX_PAGES, true);
+		if (result != TEST_RESULT_SUCCESS) {
+			break;
+		}
+	}
+
+	if (!set_tftf_mailbox_size(TFTF_MAILBOX_SIZE_4K)) {
+		return TEST_RESULT_FAIL;
+	}
+
+	return result;
+}
+
+test_result_t test_mem_share_sp_to_sp_perf(void)
+{
+	return mem_bench_sp_to_sp(FFA_MEM_SHARE_SMC32);
+}
+
+test_result_t test_mem_lend_sp_to_sp_perf(void)
+{
+	return mem_bench_sp_to_sp(FFA_MEM_LEND_SMC32);
+}
@@ -0,0 +1,715 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the latency of FF-A notifications,
+ * from the FFA_NOTIFICATION_SET of the sender to the FFA_NOTIFICATION_GET of
+ * the receiver, for global and per-vCPU notifications between the NWd and the
+ * SPs, and between SPs.
+ *
+ * Each signal is broken down into the phases a NWd scheduler goes through:
+ * - set: FFA_NOTIFICATION_SET, or the direct message asking an SP to call it.
+ * - SRI: time from the start of the set to the Schedule Receiver Interrupt
+ *   (SRI) being handled. SPs set notifications with the SRI delayed, such that
+ *   it is taken once they return to the NWd.
+ * - info get: FFA_NOTIFICATION_INFO_GET, on the lead core only.
+ * - get: FFA_NOTIFICATION_GET, or the direct message asking an SP to call it.
+ * - set to get: from the start of the set to the end of the get.
+ *
+ * The cost of FFA_NOTIFICATION_INFO_GET is also measured as the number of
+ * partitions with pending notifications, and the number of notifications
+ * pending for each of them, grows.
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <cactus_test_cmds.h>
+#include <debug.h>
+#include <ffa_endpoints.h>
+#include <ffa_svc.h>
+#include <irq.h>
+#include <lib/events.h>
+#include <lib/power_management.h>
+#include <platform.h>
+#include <spm_common.h>
+#include <spm_test_helpers.h>
+#include <stdio.h>
+#include <string.h>
+#include <test_helpers.h>
+#include <tftf_lib.h>
+
+#define NOTIF_BENCH_ITERATIONS		U(32)
+#define NOTIF_BENCH_INFO_GET_ITERATIONS	U(16)
+
+/* Priority of the SRI, as in the notifications functional tests. */
+#define NOTIF_BENCH_SRI_PRIORITY	U(0xA)
+
+enum notif_bench_phase {
+	NOTIF_BENCH_SET = 0,
+	NOTIF_BENCH_SRI,
+	NOTIF_BENCH_INFO_GET,
+	NOTIF_BENCH_GET,
+	NOTIF_BENCH_SET_TO_GET,
+	NOTIF_BENCH_PHASES
+};
+
+struct notif_bench_path {
+	const char *name;
+	ffa_id_t sender;
+	ffa_id_t receiver;
+	bool per_vcpu;
+};
+
+static const struct ffa_uuid expected_sp_uuids[] = {
+		{PRIMARY_UUID}, {SECONDARY_UUID}, {TERTIARY_UUID}
+	};
+
+static const struct notif_bench_path single_core_paths[] = {
+	{"VM to SP global", VM_ID(1), SP_ID(1), false},
+	{"VM to SP per-vCPU", VM_ID(1), SP_ID(1), true},
+	{"SP to SP global", SP_ID(1), SP_ID(2), false},
+	{"SP to VM global", SP_ID(1), VM_ID(1), false},
+};
+
+/*
+ * Per-vCPU notifications are retrieved by each vCPU independently, such that
+ * all cores can signal at once without taking each other's notifications.
+ */
+static const struct notif_bench_path all_cores_paths[] = {
+	{"VM to SP per-vCPU", VM_ID(1), SP_ID(1), true},
+	{"SP to VM per-vCPU", SP_ID(1), VM_ID(1), true},
+};
+
+/*
+ * Receivers given pending notifications in the FFA_NOTIFICATION_INFO_GET
+ * benchmark, in order. The SPs are signaled by VM_ID(1) and the VMs by SP1.
+ */
+static const ffa_id_t info_get_receivers[] = {
+	SP_ID(1), SP_ID(2), SP_ID(3), VM_ID(1), VM_ID(2), VM_ID(3), VM_ID(4)
+};
+
+static const uint32_t info_get_notif_counts[] = { 1U, 8U, 64U };
+
+static uint64_t samples[PLATFORM_CORE_COUNT][NOTIF_BENCH_PHASES]
+		       [NOTIF_BENCH_ITERATIONS];
+static uint64_t all_samples[PLATFORM_CORE_COUNT * NOTIF_BENCH_ITERATIONS];
+static unsigned int sri_count[PLATFORM_CORE_COUNT];
+
+static volatile uint64_t sri_ticks[PLATFORM_CORE_COUNT];
+static volatile bool sri_received[PLATFORM_CORE_COUNT];
+
+static const struct notif_bench_path *bench_paths;
+static unsigned int bench_paths_count;
+static test_result_t core_result[PLATFORM_CORE_COUNT];
+static event_t cpu_ready[PLATFORM_CORE_COUNT];
+static event_t cpu_done[PLATFORM_CORE_COUNT];
+static event_t bench_start;
+
+/* SGIs are banked, so each core handles the SRI sent to it. */
+static int notif_bench_sri_handler(void *data)
+{
+	unsigned int core_pos = get_current_core_id();
+
+	sri_ticks[core_pos] = read_cntpct_el0();
+	sri_received[core_pos] = true;
+
+	return 0;
+}
+
+static void notif_bench_sri_init(void)
+{
+	tftf_irq_register_handler(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID,
+				  notif_bench_sri_handler);
+	tftf_irq_enable(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID,
+			NOTIF_BENCH_SRI_PRIORITY);
+}
+
+static void notif_bench_sri_deinit(void)
+{
+	tftf_irq_disable(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID);
+	tftf_irq_unregister_handler(FFA_SCHEDULE_RECEIVER_INTERRUPT_ID);
+}
+
+static ffa_notification_bitmap_t notif_bench_all_cores_bitmap(void)
+{
+	ffa_notification_bitmap_t notifications = 0U;
+
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		notifications |= FFA_NOTIFICATION(i);
+	}
+
+	return notifications;
+}
+
+/*
+ * Bind, or unbind, 'notifications' from the sender to the receiver. A VM
+ * receiver has its bitmap created before binding and destroyed after
+ * unbinding.
+ */
+static bool notif_bench_bind(ffa_id_t sender, ffa_id_t receiver,
+			     ffa_notification_bitmap_t notifications,
+			     bool per_vcpu, bool bind)
+{
+	uint32_t flags = per_vcpu ? FFA_NOTIFICATIONS_FLAG_PER_VCPU : 0U;
+	struct ffa_value ret;
+
+	if (IS_SP_ID(receiver)) {
+		ret = bind ?
+		      cactus_notification_bind_send_cmd(HYP_ID, receiver,
+							receiver, sender,
+							notifications, flags) :
+		      cactus_notification_unbind_send_cmd(HYP_ID, receiver,
+							  receiver, sender,
+							  notifications);
+
+		if (!is_ffa_direct_response(ret) ||
+		    cactus_get_response(ret) != CACTUS_SUCCESS) {
+			ERROR("Failed to %sbind notifications of %x\n",
+			      bind ? "" : "un", receiver);
+			return false;
+		}
+
+		return true;
+	}
+
+	if (bind) {
+		ret = ffa_notification_bitmap_create(receiver,
+						     PLATFORM_CORE_COUNT);
+		if (is_ffa_call_error(ret)) {
+			return false;
+		}
+
+		ret = ffa_notification_bind(sender, receiver, flags,
+					    notifications);
+		return !is_ffa_call_error(ret);
+	}
+
+	ret = ffa_notification_unbind(sender, receiver, notifications);
+	if (is_ffa_call_error(ret)) {
+		return false;
+	}
+
+	ret = ffa_notification_bitmap_destroy(receiver);
+
+	return !is_ffa_call_error(ret);
+}
+
+/*
+ * Set 'notifications' from the sender to the receiver. SPs are asked to set
+ * them with a direct message, and delay the SRI until they return.
+ */
+static bool notif_bench_set(ffa_id_t sender, ffa_id_t receiver,
+			    uint32_t flags,
+			    ffa_notification_bitmap_t notifications)
+{
+	struct ffa_value ret;
+
+	if (!IS_SP_ID(sender)) {
+		ret = ffa_notification_set(sender, receiver, flags,
+					   notifications);
+		return is_expected_ffa_return(ret, FFA_SUCCESS_SMC32);
+	}
+
+	ret = cactus_notifications_set_send_cmd(
+		HYP_ID, sender, receiver, sender,
+		flags | FFA_NOTIFICATIONS_FLAG_DELAY_SRI, notifications, 0);
+
+	return is_ffa_direct_response(ret) &&
+	       cactus_get_response(ret) == CACTUS_SUCCESS;
+}
+
+/*
+ * Get the notifications pending for the receiver on the current vCPU, and
+ * check they are the ones expected from the sender.
+ */
+static bool notif_bench_get(ffa_id_t sender, ffa_id_t receiver,
+			    uint32_t vcpu_id,
+			    ffa_notification_bitmap_t notifications)
+{
+	uint32_t flags = IS_SP_ID(sender) ? FFA_NOTIFICATIONS_FLAG_BITMAP_SP :
+					    FFA_NOTIFICATIONS_FLAG_BITMAP_VM;
+	struct ffa_value ret;
+	uint64_t from_sp, from_vm;
+
+	if (IS_SP_ID(receiver)) {
+		ret = cactus_notification_get_send_cmd(HYP_ID, receiver,
+						       receiver, vcpu_id, flags,
+						       false);
+		if (!is_ffa_direct_response(ret) ||
+		    cactus_get_response(ret) != CACTUS_SUCCESS) {
+			return false;
+		}
+
+		from_sp = cactus_notifications_get_from_sp(ret);
+		from_vm = cactus_notifications_get_from_vm(ret);
+	} else {
+		ret = ffa_notification_get(receiver, vcpu_id, flags);
+		if (is_ffa_call_error(ret)) {
+			return false;
+		}
+
+		from_sp = ffa_notifications_get_from_sp(ret);
+		from_vm = ffa_notifications_get_from_vm(ret);
+	}
+
+	return (IS_SP_ID(sender) ? from_sp : from_vm) == notifications;
+}
+
+/*
+ * Signal the notification of the current core NOTIF_BENCH_ITERATIONS times
+ * through 'path', and record the duration of each phase. The receiver is
+ * asked for its pending notifications with FFA_NOTIFICATION_INFO_GET only when
+ * 'info_get' is set, as other cores would otherwise retrieve the information
+ * of each other's notifications.
+ */
+static test_result_t notif_bench_run(const struct notif_bench_path *path,
+				     unsigned int core_pos, bool info_get)
+{
+	ffa_notification_bitmap_t notification = FFA_NOTIFICATION(core_pos);
+	uint32_t flags = path->per_vcpu ?
+			 (FFA_NOTIFICATIONS_FLAG_PER_VCPU |
+			  FFA_NOTIFICATIONS_FLAGS_VCPU_ID((uint16_t)core_pos)) :
+			 0U;
+	uint64_t *sri_samples = samples[core_pos][NOTIF_BENCH_SRI];
+	uint64_t start, set_end, get_start, end;
+	struct ffa_value ret;
+
+	sri_count[core_pos] = 0U;
+
+	for (unsigned int i = 0U; i < NOTIF_BENCH_ITERATIONS; i++) {
+		sri_received[core_pos] = false;
+
+		start = read_cntpct_el0();
+		if (!notif_bench_set(path->sender, path->receiver, flags,
+				     notification)) {
+			ERROR("%s: set failed on core %u\n", path->name,
+			      core_pos);
+			return TEST_RESULT_FAIL;
+		}
+		set_end = read_cntpct_el0();
+
+		if (sri_received[core_pos]) {
+			sri_samples[sri_count[core_pos]++] =
+				sri_ticks[core_pos] - start;
+		}
+
+		if (info_get) {
+			get_start = read_cntpct_el0();
+			ret = ffa_notification_info_get();
+			samples[core_pos][NOTIF_BENCH_INFO_GET][i] =
+				read_cntpct_el0() - get_start;
+
+			if (is_ffa_call_error(ret)) {
+				ERROR("%s: info get failed\n", path->name);
+				return TEST_RESULT_FAIL;
+			}
+		}
+
+		get_start = read_cntpct_el0();
+		if (!notif_bench_get(path->sender, path->receiver, core_pos,
+				     notification)) {
+			ERROR("%s: get failed on core %u\n", path->name,
+			      core_pos);
+			return TEST_RESULT_FAIL;
+		}
+		end = read_cntpct_el0();
+
+		samples[core_pos][NOTIF_BENCH_SET][i] = set_end - start;
+		samples[core_pos][NOTIF_BENCH_GET][i] = end - get_start;
+		samples[core_pos][NOTIF_BENCH_SET_TO_GET][i] = end - start;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+static void notif_bench_report(const struct notif_bench_path *path,
+			       enum notif_bench_phase phase,
+			       uint64_t *bench_samples, unsigned int count,
+			       unsigned int ncores, uint64_t ticks)
+{
+	static const char *const phase_names[NOTIF_BENCH_PHASES] = {
+		[NOTIF_BENCH_SET] = "set",
+		[NOTIF_BENCH_SRI] = "set to SRI",
+		[NOTIF_BENCH_INFO_GET] = "info get",
+		[NOTIF_BENCH_GET] = "get",
+		[NOTIF_BENCH_SET_TO_GET] = "set to get",
+	};
+	struct bench_stats stats;
+	char name[96];
+
+	if (count == 0U) {
+		printf("%s, %s: no sample\n", path->name, phase_names[phase]);
+		return;
+	}
+
+	bench_stats_compute(bench_samples, count, &stats);
+
+	if (phase == NOTIF_BENCH_SET_TO_GET) {
+		snprintf(name, sizeof(name),
+			 "%s, %s, %u core(s) (%llu signals/s)", path->name,
+			 phase_names[phase], ncores,
+			 (unsigned long long)bench_ops_per_sec(
+				ncores * NOTIF_BENCH_ITERATIONS, ticks));
+	} else {
+		snprintf(name, sizeof(name), "%s, %s, %u core(s)", path->name,
+			 phase_names[phase], ncores);
+	}
+
+	bench_stats_print(name, &stats);
+}
+
+/*
+ * Measure the latency of a notification signal through each path, from the
+ * lead core only, with a call to FFA_NOTIFICATION_INFO_GET between the SRI and
+ * the get as a NWd scheduler would do.
+ */
+test_result_t test_ffa_notifications_latency(void)
+{
+	unsigned int core_pos = get_current_core_id();
+	const struct notif_bench_path *path;
+	test_result_t result = TEST_RESULT_SUCCESS;
+	uint64_t start, ticks;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	notif_bench_sri_init();
+
+	for (unsigned int p = 0U; p < ARRAY_SIZE(single_core_paths); p++) {
+		path = &single_core_paths[p];
+
+		if (!notif_bench_bind(path->sender, path->receiver,
+				      FFA_NOTIFICATION(core_pos),
+				      path->per_vcpu, true)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		start = read_cntpct_el0();
+		result = notif_bench_run(path, core_pos, true);
+		ticks = read_cntpct_el0() - start;
+
+		if (!notif_bench_bind(path->sender, path->receiver,
+				      FFA_NOTIFICATION(core_pos),
+				      path->per_vcpu, false)) {
+			result = TEST_RESULT_FAIL;
+		}
+
+		if (result != TEST_RESULT_SUCCESS) {
+			break;
+		}
+
+		for (unsigned int ph = 0U; ph < NOTIF_BENCH_PHASES; ph++) {
+			notif_bench_report(path, (enum notif_bench_phase)ph,
+					   samples[core_pos][ph],
+					   (ph == NOTIF_BENCH_SRI) ?
+					   sri_count[core_pos] :
+					   NOTIF_BENCH_ITERATIONS,
+					   1U, ticks);
+		}
+	}
+
+	notif_bench_sri_deinit();
+
+	return result;
+}
+
+/*
+ * Handler of the secondary cores. It handles its own SRI, and signals its
+ * notification through every path in turn when the lead core says so.
+ */
+static test_result_t notif_bench_cpu_on_handler(void)
+{
+	unsigned int core_pos = get_current_core_id();
+
+	notif_bench_sri_init();
+
+	for (unsigned int p = 0U; p < bench_paths_count; p++) {
+		tftf_send_event(&cpu_ready[core_pos]);
+		tftf_wait_for_event(&bench_start);
+
+		if (core_result[core_pos] == TEST_RESULT_SUCCESS) {
+			core_result[core_pos] =
+				notif_bench_run(&bench_paths[p], core_pos,
+						false);
+		}
+
+		tftf_send_event(&cpu_done[core_pos]);
+	}
+
+	notif_bench_sri_deinit();
+
+	return core_result[core_pos];
+}
+
+/*
+ * Print the statistics of all phases but FFA_NOTIFICATION_INFO_GET, merging
+ * the samples of all cores.
+ */
+static test_result_t notif_bench_all_cores_report(
+	const struct notif_bench_path *path, unsigned int ncores,
+	uint64_t ticks)
+{
+	unsigned int cpu_node, core_pos;
+	unsigned int nsamples;
+
+	for (unsigned int ph = 0U; ph < NOTIF_BENCH_PHASES; ph++) {
+		if (ph == NOTIF_BENCH_INFO_GET) {
+			continue;
+		}
+
+		nsamples = 0U;
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+
+			if (core_result[core_pos] != TEST_RESULT_SUCCESS) {
+				ERROR("Core %u failed to signal %s\n",
+				      core_pos, path->name);
+				return TEST_RESULT_FAIL;
+			}
+
+			if (ph == NOTIF_BENCH_SRI) {
+				memcpy(&all_samples[nsamples],
+				       samples[core_pos][ph],
+				       sri_count[core_pos] *
+				       sizeof(all_samples[0]));
+				nsamples += sri_count[core_pos];
+			} else {
+				memcpy(&all_samples[nsamples],
+				       samples[core_pos][ph],
+				       sizeof(samples[core_pos][ph]));
+				nsamples += NOTIF_BENCH_ITERATIONS;
+			}
+		}
+
+		notif_bench_report(path, (enum notif_bench_phase)ph,
+				   all_samples, nsamples, ncores, ticks);
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Signal per-vCPU notifications from all cores at once. The lead core
+ * releases all cores with a single event and is the last to start, and the
+ * rate is measured from this point until all cores are done.
+ */
+test_result_t test_ffa_notifications_latency_all_cores(void)
+{
+	unsigned int lead_mpid = read_mpidr_el1() & MPID_MASK;
+	unsigned int lead_pos = platform_get_core_pos(lead_mpid);
+	ffa_notification_bitmap_t notifications =
+		notif_bench_all_cores_bitmap();
+	const struct notif_bench_path *path;
+	unsigned int cpu_node, mpidr, core_pos;
+	unsigned int ncores = 1U;
+	bool started[PLATFORM_CORE_COUNT] = { false };
+	test_result_t result = TEST_RESULT_SUCCESS;
+	uint64_t start, ticks;
+	int32_t ret;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	bench_paths = all_cores_paths;
+	bench_paths_count = ARRAY_SIZE(all_cores_paths);
+
+	for (unsigned int p = 0U; p < bench_paths_count; p++) {
+		if (!notif_bench_bind(bench_paths[p].sender,
+				      bench_paths[p].receiver, notifications,
+				      true, true)) {
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	notif_bench_sri_init();
+
+	tftf_init_event(&bench_start);
+	for (unsigned int i = 0U; i < PLATFORM_CORE_COUNT; i++) {
+		tftf_init_event(&cpu_ready[i]);
+		tftf_init_event(&cpu_done[i]);
+		core_result[i] = TEST_RESULT_SUCCESS;
+	}
+
+	for_each_cpu(cpu_node) {
+		mpidr = tftf_get_mpidr_from_node(cpu_node);
+		if (mpidr == lead_mpid) {
+			continue;
+		}
+
+		ret = tftf_cpu_on(mpidr, (uintptr_t)notif_bench_cpu_on_handler,
+				  0U);
+		if (ret != PSCI_E_SUCCESS) {
+			ERROR("tftf_cpu_on mpidr 0x%x returns %d\n", mpidr,
+			      ret);
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+
+		started[platform_get_core_pos(mpidr)] = true;
+		ncores++;
+	}
+
+	/*
+	 * Should a core fail to power on, the cores already started still
+	 * run all paths so that they return, but nothing is reported.
+	 */
+	for (unsigned int p = 0U; p < bench_paths_count; p++) {
+		path = &bench_paths[p];
+
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+			if (started[core_pos]) {
+				tftf_wait_for_event(&cpu_ready[core_pos]);
+			}
+		}
+
+		start = read_cntpct_el0();
+		tftf_send_event_to(&bench_start, ncores - 1U);
+
+		core_result[lead_pos] = notif_bench_run(path, lead_pos, false);
+
+		for_each_cpu(cpu_node) {
+			core_pos = platform_get_core_pos(
+				tftf_get_mpidr_from_node(cpu_node));
+			if (started[core_pos]) {
+				tftf_wait_for_event(&cpu_done[core_pos]);
+			}
+		}
+
+		ticks = read_cntpct_el0() - start;
+
+		if (result == TEST_RESULT_SUCCESS) {
+			result = notif_bench_all_cores_report(path, ncores,
+							      ticks);
+		}
+	}
+
+	notif_bench_sri_deinit();
+
+	for (unsigned int p = 0U; p < bench_paths_count; p++) {
+		if (!notif_bench_bind(bench_paths[p].sender,
+				      bench_paths[p].receiver, notifications,
+				      true, false)) {
+			result = TEST_RESULT_FAIL;
+		}
+	}
+
+	return result;
+}
+
+static ffa_id_t info_get_sender(ffa_id_t receiver)
+{
+	return IS_SP_ID(receiver) ? VM_ID(1) : SP_ID(1);
+}
+
+/*
+ * Measure FFA_NOTIFICATION_INFO_GET with 'notif_count' notifications pending
+ * for each of the first 'nreceivers' receivers. The information of a pending
+ * notification is only returned once, so all notifications are set again and
+ * retrieved on each iteration.
+ */
+static test_result_t info_get_bench_run(unsigned int nreceivers,
+					uint32_t notif_count)
+{
+	ffa_notification_bitmap_t notifications =
+		(notif_count == 64U) ? UINT64_MAX :
+				       ((UINT64_C(1) << notif_count) - 1U);
+	uint64_t bench_samples[NOTIF_BENCH_INFO_GET_ITERATIONS];
+	struct bench_stats stats;
+	struct ffa_value ret;
+	ffa_id_t receiver;
+	uint64_t start;
+	char name[96];
+
+	for (unsigned int i = 0U; i < NOTIF_BENCH_INFO_GET_ITERATIONS; i++) {
+		for (unsigned int r = 0U; r < nreceivers; r++) {
+			receiver = info_get_receivers[r];
+			if (!notif_bench_set(info_get_sender(receiver),
+					     receiver, 0U, notifications)) {
+				ERROR("Failed to set notifications of %x\n",
+				      receiver);
+				return TEST_RESULT_FAIL;
+			}
+		}
+
+		start = read_cntpct_el0();
+		ret = ffa_notification_info_get();
+		bench_samples[i] = read_cntpct_el0() - start;
+
+		if (is_ffa_call_error(ret) ||
+		    ffa_notifications_info_get_lists_count(ret) != nreceivers) {
+			ERROR("Info get of %u receivers not as expected\n",
+			      nreceivers);
+			dump_ffa_value(ret);
+			return TEST_RESULT_FAIL;
+		}
+
+		for (unsigned int r = 0U; r < nreceivers; r++) {
+			receiver = info_get_receivers[r];
+			if (!notif_bench_get(info_get_sender(receiver),
+					     receiver, 0U, notifications)) {
+				ERROR("Failed to get notifications of %x\n",
+				      receiver);
+				return TEST_RESULT_FAIL;
+			}
+		}
+	}
+
+	bench_stats_compute(bench_samples, NOTIF_BENCH_INFO_GET_ITERATIONS,
+			    &stats);
+	snprintf(name, sizeof(name),
+		 "info get, %u receiver(s), %2u notification(s) each",
+		 nreceivers, notif_count);
+	bench_stats_print(name, &stats);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure FFA_NOTIFICATION_INFO_GET as the number of partitions with pending
+ * global notifications grows, for a growing number of notifications pending.
+ * Per-vCPU notifications are not covered, as they can only be retrieved from
+ * the core they target.
+ */
+test_result_t test_ffa_notifications_info_get_scaling(void)
+{
+	test_result_t result = TEST_RESULT_SUCCESS;
+	unsigned int nbound;
+	ffa_id_t receiver;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	for (nbound = 0U; nbound < ARRAY_SIZE(info_get_receivers); nbound++) {
+		receiver = info_get_receivers[nbound];
+		if (!notif_bench_bind(info_get_sender(receiver), receiver,
+				      UINT64_MAX, false, true)) {
+			result = TEST_RESULT_FAIL;
+			break;
+		}
+	}
+
+	for (unsigned int c = 0U; c < ARRAY_SIZE(info_get_notif_counts) &&
+	     result == TEST_RESULT_SUCCESS; c++) {
+		for (unsigned int n = 1U; n <= nbound; n++) {
+			result = info_get_bench_run(n,
+						    info_get_notif_counts[c]);
+			if (result != TEST_RESULT_SUCCESS) {
+				break;
+			}
+		}
+	}
+
+	while (nbound-- > 0U) {
+		receiver = info_get_receivers[nbound];
+		if (!notif_bench_bind(info_get_sender(receiver), receiver,
+				      UINT64_MAX, false, false)) {
+			result = TEST_RESULT_FAIL;
+		}
+	}
+
+	return result;
+}
@@ -30,6 +30,7 @@ static const struct ffa_partition_info ffa_expected_partition_info[] = {
 		.exec_context = PRIMARY_EXEC_CTX_COUNT,
 		.properties = FFA_PARTITION_AARCH64_EXEC |
 			      FFA_PARTITION_DIRECT_REQ_RECV |
+			      FFA_PARTITION_INDIRECT_MSG |
 			      FFA_PARTITION_NOTIFICATION,
 		.uuid = {PRIMARY_UUID}
 	},
@@ -475,3 +476,59 @@ test_result_t test_ffa_partition_info_v1_0(void)
 	}
 	return result;
 }
+
+/**
+ * Check the partition info cache holds the information of all partitions,
+ * found both by ID and by UUID.
+ */
+test_result_t test_ffa_partition_info_cache(void)
+{
+	const struct ffa_partition_info *expected;
+	const struct ffa_partition_info *by_id;
+	const struct ffa_partition_info *by_uuid;
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, sp_uuids);
+
+	GET_TFTF_MAILBOX(mb);
+
+	if (!ffa_partition_info_cache_init(&mb)) {
+		ERROR("Failed to cache partition info\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	if (ffa_partition_info_cache_count() !=
+	    ARRAY_SIZE(ffa_expected_partition_info)) {
+		ERROR("Unexpected number of cached partitions %u\n",
+		      ffa_partition_info_cache_count());
+		return TEST_RESULT_FAIL;
+	}
+
+	for (unsigned int i = 0U; i < ARRAY_SIZE(ffa_expected_partition_info);
+	     i++) {
+		expected = &ffa_expected_partition_info[i];
+		by_id = ffa_partition_info_cache_find_id(expected->id);
+		by_uuid = ffa_partition_info_cache_find_uuid(expected->uuid);
+
+		if (by_id == NULL || by_id != by_uuid) {
+			ERROR("Partition %x not found in the cache\n",
+			      expected->id);
+			return TEST_RESULT_FAIL;
+		}
+
+		if (by_id->exec_context != expected->exec_context ||
+		    by_id->properties != expected->properties) {
+			ERROR("Wrong cached info for %x: context %u, "
+			      "properties %x\n", expected->id,
+			      by_id->exec_context, by_id->properties);
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	if (ffa_partition_info_cache_find_id(SP_ID(0x7fff)) != NULL ||
+	    ffa_partition_info_cache_find_uuid(NULL_UUID) != NULL) {
+		ERROR("Unexpected partition found in the cache\n");
+		return TEST_RESULT_FAIL;
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure how much the NWd SIMD state adds to
+ * the round trip time of a direct message to an SP, which the SPMD and SPMC
+ * save and restore on each world switch.
+ *
+ * The NWd live state is either FP/SIMD only, SVE at each vector length (VL)
+ * the PE implements, or Streaming SVE at each streaming vector length, with
+ * and without the SME ZA array enabled. The registers are filled with random
+ * values before each request, and checked to be preserved after the last one.
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <cactus_test_cmds.h>
+#include <ffa_endpoints.h>
+#include <ffa_helpers.h>
+#include <fpu.h>
+#include <spm_test_helpers.h>
+#include <stdio.h>
+#include <test_helpers.h>
+#include <lib/extensions/sme.h>
+#include <lib/extensions/sve.h>
+
+#define SENDER HYP_ID
+#define RECEIVER SP_ID(1)
+
+#define SIMD_BENCH_ITERATIONS	U(64)
+#define SIMD_BENCH_ECHO_VAL	U(0x51d0be4c)
+
+enum simd_bench_state {
+	SIMD_BENCH_FPU = 0,
+	SIMD_BENCH_SVE,
+	SIMD_BENCH_SSVE,
+	SIMD_BENCH_SSVE_ZA,
+};
+
+static const struct ffa_uuid expected_sp_uuids[] = { {PRIMARY_UUID} };
+
+static fpu_state_t fpu_state_in;
+static fpu_state_t fpu_state_out;
+static sve_z_regs_t z_regs_in;
+static sve_z_regs_t z_regs_out;
+static sve_p_regs_t p_regs_in;
+static sve_p_regs_t p_regs_out;
+static sve_ffr_regs_t ffr_regs_in;
+static sve_ffr_regs_t ffr_regs_out;
+
+static uint64_t samples[SIMD_BENCH_ITERATIONS];
+
+/* Average round trip with the FP/SIMD state only. */
+static uint64_t baseline_avg;
+
+/*
+ * Fill the registers of 'state' with random values. The FFR is not accessible
+ * in Streaming SVE mode unless FEAT_SME_FA64 is enabled, so it is left as it
+ * is.
+ */
+static void simd_bench_fill(enum simd_bench_state state)
+{
+	if (state == SIMD_BENCH_FPU) {
+		fpu_state_write_rand(&fpu_state_in);
+		return;
+	}
+
+	sve_z_regs_write_rand(&z_regs_in);
+	sve_p_regs_write_rand(&p_regs_in);
+
+	if (state == SIMD_BENCH_SVE) {
+		sve_ffr_regs_write_rand(&ffr_regs_in);
+	}
+}
+
+static bool simd_bench_check(enum simd_bench_state state)
+{
+	if (state == SIMD_BENCH_FPU) {
+		fpu_state_read(&fpu_state_out);
+		return fpu_state_compare(&fpu_state_in, &fpu_state_out) == 0;
+	}
+
+	sve_z_regs_read(&z_regs_out);
+	sve_p_regs_read(&p_regs_out);
+
+	if (sve_z_regs_compare(&z_regs_in, &z_regs_out) != 0UL ||
+	    sve_p_regs_compare(&p_regs_in, &p_regs_out) != 0UL) {
+		return false;
+	}
+
+	if (state == SIMD_BENCH_SVE) {
+		sve_ffr_regs_read(&ffr_regs_out);
+		return sve_ffr_regs_compare(&ffr_regs_in, &ffr_regs_out) == 0UL;
+	}
+
+	return true;
+}
+
+/*
+ * Measure SIMD_BENCH_ITERATIONS round trips with the live state of 'state',
+ * at the vector length of 'vl' bytes, and print them with the overhead over
+ * the FP/SIMD only baseline.
+ */
+static test_result_t simd_bench_run(enum simd_bench_state state, uint64_t vl)
+{
+	static const char *const state_names[] = {
+		[SIMD_BENCH_FPU] = "FP/SIMD",
+		[SIMD_BENCH_SVE] = "SVE",
+		[SIMD_BENCH_SSVE] = "Streaming SVE",
+		[SIMD_BENCH_SSVE_ZA] = "Streaming SVE and ZA",
+	};
+	struct bench_stats stats;
+	struct ffa_value ret;
+	uint64_t start;
+	char name[96];
+
+	for (unsigned int i = 0U; i < SIMD_BENCH_ITERATIONS; i++) {
+		simd_bench_fill(state);
+
+		start = read_cntpct_el0();
+		ret = cactus_echo_send_cmd(SENDER, RECEIVER,
+					   SIMD_BENCH_ECHO_VAL);
+		samples[i] = read_cntpct_el0() - start;
+
+		if (!is_ffa_direct_response(ret) ||
+		    cactus_get_response(ret) != CACTUS_SUCCESS ||
+		    cactus_echo_get_val(ret) != SIMD_BENCH_ECHO_VAL) {
+			ERROR("Echo to %x failed\n", RECEIVER);
+			return TEST_RESULT_FAIL;
+		}
+	}
+
+	if (!simd_bench_check(state)) {
+		ERROR("%s state not preserved, VL %llu bits\n",
+		      state_names[state], (unsigned long long)(vl * 8U));
+		return TEST_RESULT_FAIL;
+	}
+
+	bench_stats_compute(samples, SIMD_BENCH_ITERATIONS, &stats);
+
+	if (state == SIMD_BENCH_FPU) {
+		baseline_avg = stats.avg;
+		snprintf(name, sizeof(name), "%s", state_names[state]);
+	} else {
+		snprintf(name, sizeof(name), "%s VL %4llu bits (%+lldns)",
+			 state_names[state], (unsigned long long)(vl * 8U),
+			 (long long)bench_ticks_to_ns(stats.avg) -
+			 (long long)bench_ticks_to_ns(baseline_avg));
+	}
+
+	bench_stats_print(name, &stats);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure direct message round trips with the FP/SIMD state, then with the
+ * SVE state at each implemented VL.
+ */
+test_result_t test_spm_sve_context_perf(void)
+{
+	test_result_t result;
+	uint32_t vl_bitmap = 0U;
+	u_register_t zcr_el2;
+	uint64_t vl;
+
+	SKIP_TEST_IF_SVE_NOT_SUPPORTED();
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	result = simd_bench_run(SIMD_BENCH_FPU, 0U);
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	zcr_el2 = read_zcr_el2();
+
+	for (uint8_t vq = 0U; vq <= SVE_VQ_ARCH_MAX; vq++) {
+		sve_config_vq(vq);
+
+		/* Requested lengths not implemented select a smaller one. */
+		vl = sve_rdvl_1();
+		if ((vl_bitmap & BIT_32(SVE_VL_TO_VQ(vl))) != 0U) {
+			continue;
+		}
+		vl_bitmap |= BIT_32(SVE_VL_TO_VQ(vl));
+
+		result = simd_bench_run(SIMD_BENCH_SVE, vl);
+		if (result != TEST_RESULT_SUCCESS) {
+			break;
+		}
+	}
+
+	write_zcr_el2(zcr_el2);
+	isb();
+
+	return result;
+}
+
+/*
+ * Measure direct message round trips in Streaming SVE mode at each
+ * implemented streaming VL, with the ZA array disabled then enabled.
+ */
+test_result_t test_spm_sme_context_perf(void)
+{
+	test_result_t result;
+	uint32_t vl_bitmap = 0U;
+	u_register_t smcr_el2;
+	uint64_t vl;
+
+	SKIP_TEST_IF_SME_NOT_SUPPORTED();
+
+	CHECK_SPMC_TESTING_SETUP(1, 1, expected_sp_uuids);
+
+	result = simd_bench_run(SIMD_BENCH_FPU, 0U);
+	if (result != TEST_RESULT_SUCCESS) {
+		return result;
+	}
+
+	smcr_el2 = read_smcr_el2();
+
+	for (uint32_t svq = 0U; svq <= SME_SVQ_ARCH_MAX; svq++) {
+		sme_config_svq(svq);
+
+		vl = sme_rdsvl_1();
+		if ((vl_bitmap & BIT_32(SVE_VL_TO_VQ(vl))) != 0U) {
+			continue;
+		}
+		vl_bitmap |= BIT_32(SVE_VL_TO_VQ(vl));
+
+		sme_smstart(SMSTART_SM);
+		result = simd_bench_run(SIMD_BENCH_SSVE, vl);
+
+		if (result == TEST_RESULT_SUCCESS) {
+			sme_smstart(SMSTART_ZA);
+			result = simd_bench_run(SIMD_BENCH_SSVE_ZA, vl);
+		}
+
+		sme_smstop(SMSTOP);
+
+		if (result != TEST_RESULT_SUCCESS) {
+			break;
+		}
+	}
+
+	write_smcr_el2(smcr_el2);
+	isb();
+
+	return result;
+}
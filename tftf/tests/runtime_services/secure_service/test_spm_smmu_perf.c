@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2024, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * This file contains tests that measure the throughput and the completion
+ * latency of DMA transactions by the SMMUv3 test engine of the FVP, upstream
+ * of the SMMUv3 IP which translates them with the stage 2 tables of SP1.
+ *
+ * SP1 programs the engine and times it, such that the results are not skewed
+ * by the world switches. The model runs the engine in model time, so the
+ * throughput is given in bytes per second of the system counter.
+ */
+
+#include <arch_helpers.h>
+#include <bench_stats.h>
+#include <cactus_test_cmds.h>
+#include <debug.h>
+#include <ffa_endpoints.h>
+#include <spm_test_helpers.h>
+#include <stdio.h>
+#include <test_helpers.h>
+
+#define SENDER		HYP_ID
+#define RECEIVER	SP_ID(1)
+
+#define DMA_BENCH_ITERATIONS	U(16)
+
+/* Size of the scratch memory SP1 copies from. */
+#define DMA_BENCH_MAX_SIZE	U(0x4000)
+
+static const struct ffa_uuid expected_sp_uuids[] = { {PRIMARY_UUID} };
+
+static const char *const mode_names[] = {
+	[CACTUS_DMA_BENCH_MEMCPY] = "MEMCPY",
+	[CACTUS_DMA_BENCH_RAND48] = "RAND48",
+	[CACTUS_DMA_BENCH_SUM64] = "SUM64",
+};
+
+static uint64_t samples[DMA_BENCH_ITERATIONS];
+
+/*
+ * Run DMA_BENCH_ITERATIONS transactions with the given parameters, and print
+ * the throughput and the statistics of the latency of each frame. Returns
+ * TEST_RESULT_SKIPPED if the engine failed with the substream ID given, which
+ * not all SMMU configurations support.
+ */
+static test_result_t dma_bench_run(uint32_t size, uint32_t stride,
+				   uint32_t frames,
+				   enum cactus_dma_bench_mode mode,
+				   uint32_t stream_id, uint32_t substream_id)
+{
+	struct bench_stats stats;
+	struct ffa_value ret;
+	uint64_t ticks = 0U;
+	uint64_t latency_max = 0U;
+	char name[128];
+	char ssid[16];
+
+	if (substream_id == CACTUS_DMA_NO_SUBSTREAMID) {
+		snprintf(ssid, sizeof(ssid), "-");
+	} else {
+		snprintf(ssid, sizeof(ssid), "%u", substream_id);
+	}
+
+	for (unsigned int i = 0U; i < DMA_BENCH_ITERATIONS; i++) {
+		ret = cactus_send_dma_bench_cmd(SENDER, RECEIVER, size, stride,
+						frames, mode, stream_id,
+						substream_id);
+
+		if (!is_ffa_direct_response(ret)) {
+			return TEST_RESULT_FAIL;
+		}
+
+		if (cactus_get_response(ret) != CACTUS_SUCCESS) {
+			if (substream_id != CACTUS_DMA_NO_SUBSTREAMID &&
+			    cactus_error_code(ret) == CACTUS_ERROR_TEST) {
+				tftf_testcase_printf("SID %u SSID %s not "
+						     "supported\n", stream_id,
+						     ssid);
+				return TEST_RESULT_SKIPPED;
+			}
+
+			ERROR("DMA benchmark failed: %u bytes, stride %u, "
+			      "%u frames, %s, SID %u SSID %s\n", size, stride,
+			      frames, mode_names[mode], stream_id, ssid);
+			return TEST_RESULT_FAIL;
+		}
+
+		ticks += cactus_dma_bench_get_total_ticks(ret);
+		samples[i] = cactus_dma_bench_get_latency_sum_ticks(ret) /
+			     frames;
+		if (cactus_dma_bench_get_latency_max_ticks(ret) > latency_max) {
+			latency_max = cactus_dma_bench_get_latency_max_ticks(ret);
+		}
+	}
+
+	bench_stats_compute(samples, DMA_BENCH_ITERATIONS, &stats);
+
+	snprintf(name, sizeof(name),
+		 "%-6s %5u bytes, stride %3u, %2u frames, SID %u SSID %s "
+		 "(%llu bytes/s, frame max %lluns)",
+		 mode_names[mode], size, stride, frames, stream_id, ssid,
+		 (unsigned long long)bench_ops_per_sec(
+			 (uint64_t)size * DMA_BENCH_ITERATIONS, ticks),
+		 (unsigned long long)bench_ticks_to_ns(latency_max));
+	bench_stats_print(name, &stats);
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure each engine command with a single frame and contiguous accesses,
+ * for transfers from 256 bytes to the whole scratch memory.
+ */
+test_result_t test_smmu_dma_throughput(void)
+{
+	test_result_t result;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	for (unsigned int m = CACTUS_DMA_BENCH_MEMCPY;
+	     m <= CACTUS_DMA_BENCH_SUM64; m++) {
+		for (uint32_t size = U(0x100); size <= DMA_BENCH_MAX_SIZE;
+		     size <<= 2) {
+			result = dma_bench_run(size, 1U, 1U,
+					       (enum cactus_dma_bench_mode)m,
+					       0U, CACTUS_DMA_NO_SUBSTREAMID);
+			if (result != TEST_RESULT_SUCCESS) {
+				return result;
+			}
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure copies of the whole scratch memory split between an increasing
+ * number of frames running concurrently, then with a single frame and an
+ * increasing stride.
+ */
+test_result_t test_smmu_dma_frames_stride(void)
+{
+	static const uint32_t strides[] = { 1U, 8U, 64U, 512U, 4096U };
+	test_result_t result;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	for (uint32_t frames = 1U; frames <= 16U; frames <<= 1) {
+		result = dma_bench_run(DMA_BENCH_MAX_SIZE, 1U, frames,
+				       CACTUS_DMA_BENCH_MEMCPY, 0U,
+				       CACTUS_DMA_NO_SUBSTREAMID);
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+	}
+
+	for (unsigned int s = 0U; s < ARRAY_SIZE(strides); s++) {
+		result = dma_bench_run(DMA_BENCH_MAX_SIZE, strides[s], 1U,
+				       CACTUS_DMA_BENCH_MEMCPY, 0U,
+				       CACTUS_DMA_NO_SUBSTREAMID);
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
+
+/*
+ * Measure copies with each stream ID assigned to the engine in the SP1
+ * manifest, then with substream IDs, which are skipped if the SMMU is not
+ * set up to translate them.
+ */
+test_result_t test_smmu_dma_streams(void)
+{
+	static const uint32_t stream_ids[] = { 0U, 1U };
+	static const uint32_t substream_ids[] = { 0U, 1U };
+	test_result_t result;
+
+	CHECK_SPMC_TESTING_SETUP(1, 0, expected_sp_uuids);
+
+	for (unsigned int s = 0U; s < ARRAY_SIZE(stream_ids); s++) {
+		result = dma_bench_run(DMA_BENCH_MAX_SIZE, 1U, 2U,
+				       CACTUS_DMA_BENCH_MEMCPY, stream_ids[s],
+				       CACTUS_DMA_NO_SUBSTREAMID);
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+	}
+
+	for (unsigned int s = 0U; s < ARRAY_SIZE(substream_ids); s++) {
+		result = dma_bench_run(DMA_BENCH_MAX_SIZE, 1U, 2U,
+				       CACTUS_DMA_BENCH_MEMCPY, 0U,
+				       substream_ids[s]);
+		if (result == TEST_RESULT_SKIPPED) {
+			break;
+		}
+		if (result != TEST_RESULT_SUCCESS) {
+			return result;
+		}
+	}
+
+	return TEST_RESULT_SUCCESS;
+}
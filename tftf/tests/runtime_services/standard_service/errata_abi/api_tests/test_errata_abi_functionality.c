@@ -688,7 +688,8 @@ test_result_t test_errata_abi_features(void)
 		if (cpu_mpid == lead_mpid)
 			continue;
 
-		psci_ret = tftf_cpu_on(cpu_mpid, (uintptr_t)test_em_cpu_features, 0);
+		psci_ret = tftf_cpu_on_parkable(cpu_mpid,
+						(uintptr_t)test_em_cpu_features);
 		if (psci_ret != PSCI_E_SUCCESS) {
 			tftf_testcase_printf("Failed to power on CPU 0x%x (%d)\n", \
 			cpu_mpid, psci_ret);
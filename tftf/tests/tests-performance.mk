@@ -7,4 +7,5 @@
 TESTS_SOURCES	+=	$(addprefix tftf/tests/performance_tests/,	\
 	smc_latencies.c							\
 	test_psci_latencies.c						\
+	test_psci_pm_latencies.c					\
 )
@@ -10,7 +10,9 @@ TFTF_INCLUDES +=							\
 
 TESTS_SOURCES	+=							\
 	$(addprefix tftf/tests/runtime_services/realm_payload/,		\
+		host_realm_payload_multiple_realm_tests.c		\
 		host_realm_payload_multiple_rec_tests.c			\
+		host_realm_payload_perf_tests.c				\
 		host_realm_payload_tests.c				\
 		host_realm_spm.c					\
 		host_realm_payload_simd_tests.c				\
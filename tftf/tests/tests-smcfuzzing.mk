@@ -12,6 +12,11 @@ SMC_FUZZ_INSTANCE_COUNT ?= 1
 SMC_FUZZ_SEEDS ?= $(shell python -c "from random import randint; seeds = [randint(0, 4294967295) for i in range($(SMC_FUZZ_INSTANCE_COUNT))];print(\",\".join(str(x) for x in seeds));")
 SMC_FUZZ_CALLS_PER_INSTANCE ?= 100
 
+# Coverage-guided feedback: measure every call, adjust the biases toward calls
+# that produce new return codes or outlier latencies and print the learned
+# bias table at the end of each instance.
+SMC_FUZZ_FEEDBACK ?= 0
+
 # Validate SMC fuzzer parameters
 
 # Instance count must not be zero
@@ -24,6 +29,8 @@ ifeq ($(SMC_FUZZ_CALLS_PER_INSTANCE),0)
 $(error SMC_FUZZ_CALLS_PER_INSTANCE must not be zero!)
 endif
 
+$(eval $(call assert_boolean,SMC_FUZZ_FEEDBACK))
+
 # Make sure seed count and instance count match
 TEST_SEED_COUNT = $(shell python -c "print(len(\"$(SMC_FUZZ_SEEDS)\".split(\",\")))")
 ifneq ($(TEST_SEED_COUNT), $(SMC_FUZZ_INSTANCE_COUNT))
@@ -34,10 +41,13 @@ endif
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_SEEDS))
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_INSTANCE_COUNT))
 $(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_CALLS_PER_INSTANCE))
+$(eval $(call add_define,TFTF_DEFINES,SMC_FUZZ_FEEDBACK))
 
 TESTS_SOURCES	+=							\
 	$(addprefix smc_fuzz/src/,					\
 		randsmcmod.c						\
 		smcmalloc.c						\
 		fifo3d.c						\
+		fuzzargs.c						\
+		fuzzfeedback.c						\
 	)
@@ -14,12 +14,18 @@ TESTS_SOURCES	+=							\
 		spm_common.c						\
 		spm_test_helpers.c					\
 		test_ffa_direct_messaging.c				\
+		test_ffa_direct_messaging_perf.c			\
+		test_ffa_indirect_messaging.c				\
+		test_ffa_indirect_messaging_perf.c			\
 		test_ffa_interrupts.c					\
 		test_ffa_secure_interrupts.c				\
 		test_ffa_memory_sharing.c				\
+		test_ffa_memory_sharing_perf.c				\
 		test_ffa_setup_and_discovery.c				\
 		test_ffa_notifications.c				\
+		test_ffa_notifications_perf.c				\
 		test_spm_smmu.c						\
+		test_spm_smmu_perf.c					\
 		test_ffa_exceptions.c					\
 		test_ffa_group0_interrupts.c				\
 	)
@@ -28,6 +34,7 @@ ifeq (${ARCH},aarch64)
 TESTS_SOURCES   +=                                                      \
         $(addprefix tftf/tests/runtime_services/secure_service/,        \
 	  test_spm_cpu_features.c					\
+	  test_spm_simd_perf.c						\
 	 )
 
 TESTS_SOURCES	+=							\